@@ -16,10 +16,14 @@
 
 #include "codegen.h"
 #include <stdlib.h>
+#include <string.h>
 #include "codes.h"
 #include "defs.h"
 #include "errors.h"
+#include "function_cache.h"
 #include "item.h"
+#include "peephole.h"
+#include "profiler.h"
 #include "tree.h"
 #include "uniprinter.h"
 #include "utf8.h"
@@ -30,6 +34,11 @@ const char *const DEFAULT_CODES = "codes.txt";
 const size_t MAX_MEM_SIZE = 100000;
 const size_t MAX_STACK_SIZE = 256;
 
+#define BINARY_VERSION		1
+#define BINARY_SECTIONS		5
+#define BINARY_ALIGN		8
+#define BINARY_CHUNK_SIZE	4096
+
 
 /** Virtual machine environment */
 typedef struct virtual
@@ -38,52 +47,118 @@ typedef struct virtual
 
 	vector memory;					/**< Memory table */
 	vector processes;				/**< Init processes table */
+	vector entries;					/**< Numbers of defined functions */
 	vector stack;					/**< Stack for logic operations */
 
 	vector identifiers;				/**< Local identifiers table */
 	vector representations;			/**< Local representations table */
 
 	size_t max_threads;				/**< Max threads count */
+	int was_error;					/**< Set, if code emission failed */
 
 	size_t addr_cond;				/**< Condition address */
 	size_t addr_case;				/**< Case operator address */
 	size_t addr_break;				/**< Break operator address */
 
 	item_status target;				/**< Target tables item type */
+
+	function_cache *cache;			/**< Function cache, @c NULL if disabled */
+	vector reloc_addresses;			/**< Positions of emitted addresses */
+	vector reloc_identifiers;		/**< Positions of compressed identifiers */
+	vector reloc_processes;			/**< Init processes by pairs: process, address */
 } virtual;
 
 
 static void block(virtual *const vm, node *const nd);
 
 
+/**
+ *	Memory is reserved by tree size before generation, so emission is an append to array.
+ *	Failures are remembered in @c was_error, generation is stopped after the whole tree.
+ */
+static int mem_grow(virtual *const vm)
+{
+	return vector_reserve(&vm->memory, 2 * vm->memory.size_alloc);
+}
+
 static inline void mem_increase(virtual *const vm, const size_t size)
 {
-	vector_increase(&vm->memory, size);
+	if (vector_increase(&vm->memory, size))
+	{
+		vm->was_error = 1;
+	}
 }
 
-static inline void mem_add(virtual *const vm, const item_t value)
+static inline int mem_add(virtual *const vm, const item_t value)
 {
-	vector_add(&vm->memory, value);
+	if (vm->memory.size == vm->memory.size_alloc && mem_grow(vm))
+	{
+		vm->was_error = 1;
+		return -1;
+	}
+
+	vm->memory.array[vm->memory.size++] = value;
+	return 0;
 }
 
-static inline void mem_set(virtual *const vm, const size_t index, const item_t value)
+static inline int mem_set(virtual *const vm, const size_t index, const item_t value)
 {
-	vector_set(&vm->memory, index, value);
+	if (index >= vm->memory.size)
+	{
+		vm->was_error = 1;
+		return -1;
+	}
+
+	vm->memory.array[index] = value;
+	return 0;
 }
 
-static inline item_t mem_get(const virtual *const vm, const size_t index)
+static inline item_t mem_get(virtual *const vm, const size_t index)
 {
-	return vector_get(&vm->memory, index);
+	if (index >= vm->memory.size)
+	{
+		vm->was_error = 1;
+		return ITEM_MAX;
+	}
+
+	return vm->memory.array[index];
 }
 
 static inline size_t mem_size(const virtual *const vm)
 {
-	return vector_size(&vm->memory);
+	return vm->memory.size;
+}
+
+/** Address is relocated when function code is taken from cache */
+static inline void mem_add_address(virtual *const vm, const item_t value)
+{
+	if (vm->cache != NULL)
+	{
+		vector_add(&vm->reloc_addresses, (item_t)mem_size(vm));
+	}
+
+	mem_add(vm, value);
+}
+
+static inline void mem_set_address(virtual *const vm, const size_t index, const item_t value)
+{
+	if (vm->cache != NULL)
+	{
+		vector_add(&vm->reloc_addresses, (item_t)index);
+	}
+
+	mem_set(vm, index, value);
 }
 
 
 static inline void proc_set(virtual *const vm, const size_t index, const item_t value)
 {
+	if (vm->cache != NULL)
+	{
+		vector_add(&vm->reloc_processes, (item_t)index);
+		vector_add(&vm->reloc_processes, value);
+	}
+
 	vector_set(&vm->processes, index, value);
 }
 
@@ -109,7 +184,7 @@ static void addr_begin_condition(virtual *const vm, const size_t addr)
 	while (vm->addr_cond != addr)
 	{
 		const size_t ref = (size_t)mem_get(vm, vm->addr_cond);
-		mem_set(vm, vm->addr_cond, (item_t)addr);
+		mem_set_address(vm, vm->addr_cond, (item_t)addr);
 		vm->addr_cond = ref;
 	}
 }
@@ -119,7 +194,7 @@ static void addr_end_condition(virtual *const vm)
 	while (vm->addr_cond)
 	{
 		const size_t ref = (size_t)mem_get(vm, vm->addr_cond);
-		mem_set(vm, vm->addr_cond, (item_t)mem_size(vm));
+		mem_set_address(vm, vm->addr_cond, (item_t)mem_size(vm));
 		vm->addr_cond = ref;
 	}
 }
@@ -129,7 +204,7 @@ static void addr_end_break(virtual *const vm)
 	while (vm->addr_break)
 	{
 		const size_t ref = (size_t)mem_get(vm, vm->addr_break);
-		mem_set(vm, vm->addr_break, (item_t)mem_size(vm));
+		mem_set_address(vm, vm->addr_break, (item_t)mem_size(vm));
 		vm->addr_break = ref;
 	}
 }
@@ -161,7 +236,7 @@ static void final_operation(virtual *const vm, node *const nd)
 				mem_add(vm, op);
 				if (op == LOGOR || op == LOGAND)
 				{
-					mem_set(vm, (size_t)stack_pop(vm), (item_t)mem_size(vm));
+					mem_set_address(vm, (size_t)stack_pop(vm), (item_t)mem_size(vm));
 				}
 				else if (op == COPY00 || op == COPYST)
 				{
@@ -258,7 +333,7 @@ static void expression(virtual *const vm, node *const nd, int mode)
 			{
 				mem_add(vm, LI);
 				const size_t reserved = mem_size(vm) + 4;
-				mem_add(vm, (item_t)reserved);
+				mem_add_address(vm, (item_t)reserved);
 				mem_add(vm, B);
 				mem_increase(vm, 2);
 
@@ -277,7 +352,7 @@ static void expression(virtual *const vm, node *const nd, int mode)
 				}
 
 				mem_set(vm, reserved - 1, N);
-				mem_set(vm, reserved - 2, (item_t)mem_size(vm));
+				mem_set_address(vm, reserved - 2, (item_t)mem_size(vm));
 			}
 			break;
 			case TBeginit:
@@ -377,9 +452,9 @@ static void expression(virtual *const vm, node *const nd, int mode)
 
 				expression(vm, nd, 0); // then
 				mem_add(vm, B);
-				mem_add(vm, (item_t)addr);
+				mem_add_address(vm, (item_t)addr);
 				addr = mem_size(vm) - 1;
-				mem_set(vm, addr_else, (item_t)mem_size(vm));
+				mem_set_address(vm, addr_else, (item_t)mem_size(vm));
 
 				expression(vm, nd, 1); // else или cond
 			} while (node_get_type(nd) == TCondexpr);
@@ -387,7 +462,7 @@ static void expression(virtual *const vm, node *const nd, int mode)
 			while (addr)
 			{
 				const size_t ref = (size_t)mem_get(vm, addr);
-				mem_set(vm, addr, (item_t)mem_size(vm));
+				mem_set_address(vm, addr, (item_t)mem_size(vm));
 				addr = ref;
 			}
 
@@ -445,7 +520,7 @@ static void identifier(virtual *const vm, node *const nd)
 		{
 			mem_add(vm, STRUCTWITHARR);
 			mem_add(vm, old_displ);
-			mem_add(vm, proc_get(vm, (size_t)process));
+			mem_add_address(vm, proc_get(vm, (size_t)process));
 		}
 		if (all) // int a = или struct{} a =
 		{
@@ -475,7 +550,7 @@ static void identifier(virtual *const vm, node *const nd)
 		mem_add(vm, all == 0 ? N : abs((int)N) - 1);
 		mem_add(vm, length);
 		mem_add(vm, old_displ);
-		mem_add(vm, proc_get(vm, (size_t)process));
+		mem_add_address(vm, proc_get(vm, (size_t)process));
 		mem_add(vm, usual);
 		mem_add(vm, all);
 		mem_add(vm, instruction);
@@ -523,7 +598,7 @@ static int declaration(virtual *const vm, node *const nd)
 			const size_t num_proc = (size_t)node_get_arg(nd, 0);
 
 			mem_add(vm, STOP);
-			mem_set(vm, (size_t)proc_get(vm, num_proc) - 1, (item_t)mem_size(vm));
+			mem_set_address(vm, (size_t)proc_get(vm, num_proc) - 1, (item_t)mem_size(vm));
 		}
 		break;
 
@@ -534,12 +609,12 @@ static int declaration(virtual *const vm, node *const nd)
 	return 0;
 }
 
-static void compress_ident(virtual *const vm, const size_t ref)
+/** Номер идентификатора в таблице виртуальной машины, при первом обращении он туда добавляется */
+static item_t compress_ref(virtual *const vm, const size_t ref)
 {
 	if (vector_get(&vm->sx->identifiers, ref) == ITEM_MAX)
 	{
-		mem_add(vm, ident_get_repr(vm->sx, ref));
-		return;
+		return ident_get_repr(vm->sx, ref);
 	}
 
 	const item_t new_ref = (item_t)vector_size(&vm->identifiers) - 1;
@@ -556,7 +631,17 @@ static void compress_ident(virtual *const vm, const size_t ref)
 
 	vector_set(&vm->sx->identifiers, ref, ITEM_MAX);
 	ident_set_repr(vm->sx, ref, new_ref);
-	mem_add(vm, new_ref);
+	return new_ref;
+}
+
+static void compress_ident(virtual *const vm, const size_t ref)
+{
+	if (vm->cache != NULL)
+	{
+		vector_add(&vm->reloc_identifiers, (item_t)mem_size(vm));
+	}
+
+	mem_add(vm, compress_ref(vm, ref));
 }
 
 static void statement(virtual *const vm, node *const nd)
@@ -591,13 +676,13 @@ static void statement(virtual *const vm, node *const nd)
 			if (ref_else)
 			{
 				node_set_next(nd);
-				mem_set(vm, addr, (item_t)mem_size(vm) + 2);
+				mem_set_address(vm, addr, (item_t)mem_size(vm) + 2);
 				mem_add(vm, B);
 				addr = mem_size(vm);
 				mem_increase(vm, 1);
 				statement(vm, nd);
 			}
-			mem_set(vm, addr, (item_t)mem_size(vm));
+			mem_set_address(vm, addr, (item_t)mem_size(vm));
 		}
 		break;
 		case TWhile:
@@ -617,7 +702,7 @@ static void statement(virtual *const vm, node *const nd)
 
 			addr_begin_condition(vm, addr);
 			mem_add(vm, B);
-			mem_add(vm, (item_t)addr);
+			mem_add_address(vm, (item_t)addr);
 			addr_end_break(vm);
 
 			vm->addr_break = old_break;
@@ -639,7 +724,7 @@ static void statement(virtual *const vm, node *const nd)
 
 			expression(vm, nd, 0);
 			mem_add(vm, BNE0);
-			mem_add(vm, addr);
+			mem_add_address(vm, addr);
 			addr_end_break(vm);
 
 			vm->addr_break = old_break;
@@ -693,7 +778,7 @@ static void statement(virtual *const vm, node *const nd)
 			node_copy(nd, &stmt);
 
 			mem_add(vm, B);
-			mem_add(vm, (item_t)initad);
+			mem_add_address(vm, (item_t)initad);
 			addr_end_break(vm);
 
 			vm->addr_break = old_break;
@@ -710,7 +795,7 @@ static void statement(virtual *const vm, node *const nd)
 
 			if (addr > 0) // метка уже описана
 			{
-				mem_add(vm, addr);
+				mem_add_address(vm, addr);
 			}
 			else // метка еще не описана
 			{
@@ -731,7 +816,7 @@ static void statement(virtual *const vm, node *const nd)
 				while (addr) // проставить ссылку на метку во всех ранних переходах
 				{
 					item_t ref = mem_get(vm, (size_t)(-addr));
-					mem_set(vm, (size_t)(-addr), (item_t)mem_size(vm));
+					mem_set_address(vm, (size_t)(-addr), (item_t)mem_size(vm));
 					addr = ref;
 				}
 			}
@@ -751,7 +836,7 @@ static void statement(virtual *const vm, node *const nd)
 			statement(vm, nd);
 			if (vm->addr_case > 0)
 			{
-				mem_set(vm, vm->addr_case, (item_t)mem_size(vm));
+				mem_set_address(vm, vm->addr_case, (item_t)mem_size(vm));
 			}
 			addr_end_break(vm);
 
@@ -763,7 +848,7 @@ static void statement(virtual *const vm, node *const nd)
 		{
 			if (vm->addr_case)
 			{
-				mem_set(vm, vm->addr_case, (item_t)mem_size(vm));
+				mem_set_address(vm, vm->addr_case, (item_t)mem_size(vm));
 			}
 			mem_add(vm, _DOUBLE);
 			expression(vm, nd, 0);
@@ -780,7 +865,7 @@ static void statement(virtual *const vm, node *const nd)
 		{
 			if (vm->addr_case)
 			{
-				mem_set(vm, vm->addr_case, (item_t)mem_size(vm));
+				mem_set_address(vm, vm->addr_case, (item_t)mem_size(vm));
 			}
 			vm->addr_case = 0;
 
@@ -859,33 +944,308 @@ static void block(virtual *const vm, node *const nd)
 	}
 }
 
-/** Генерация кодов */
-static int codegen(virtual *const vm)
+static void function_definition(virtual *const vm, node *const nd)
 {
-	node root = node_get_root(&vm->sx->tree);
-	while (node_set_next(&root) == 0)
+	const item_t ref_ident = node_get_arg(nd, 0);
+	const item_t max_displ = node_get_arg(nd, 1);
+	const size_t func = (size_t)ident_get_displ(vm->sx, (size_t)ref_ident);
+
+	func_set(vm->sx, func, (item_t)mem_size(vm));
+	vector_add(&vm->entries, (item_t)func);
+	mem_add(vm, FUNCBEG);
+	mem_add(vm, max_displ);
+
+	const size_t old_pc = mem_size(vm);
+	mem_increase(vm, 1);
+
+	node_set_next(nd);
+	block(vm, nd);
+
+	mem_set_address(vm, old_pc, (item_t)mem_size(vm));
+}
+
+
+static inline item_t arena_get_arg(const tree_arena *const arena, const size_t id, const size_t index)
+{
+	return vector_get(arena->tree, arena->nodes[id].ref + 1 + index);
+}
+
+/**
+ *	Аргумент узла без зависимости от описаний вне функции:
+ *	ссылки внутри дерева отсчитываются от начала функции, метки - от её идентификатора,
+ *	вместо остальных идентификаторов учитывается то, что от них берется при генерации
+ */
+static item_t span_get_arg(const tree_arena *const arena, const size_t id, const size_t index
+	, const size_t begin, const item_t func)
+{
+	const item_t arg = arena_get_arg(arena, id, index);
+	switch (arena->nodes[id].type)
 	{
-		switch (node_get_type(&root))
-		{
-			case TFuncdef:
-			{
-				const item_t ref_ident = node_get_arg(&root, 0);
-				const item_t max_displ = node_get_arg(&root, 1);
-				const size_t func = (size_t)ident_get_displ(vm->sx, (size_t)ref_ident);
+		case TFuncdef:
+		case TCall2:
+		case TPrintid:
+		case TGetid:
+			return index == 0 ? 0 : arg;
+		case TGoto:
+			return index == 0 ? (arg < 0 ? -1 : 1) * (abs((int)arg) - func) : arg;
+		case TLabel:
+			return index == 0 ? arg - func : arg;
+		case TIf:
+		case ADLOGOR:
+		case ADLOGAND:
+			return index == 0 && arg != 0 ? arg - (item_t)begin : arg;
+		case TFor:
+			return index < 4 && arg != 0 ? arg - (item_t)begin : arg;
+		default:
+			return arg;
+	}
+}
 
-				func_set(vm->sx, func, (item_t)mem_size(vm));
-				mem_add(vm, FUNCBEG);
-				mem_add(vm, max_displ);
+/**
+ *	Отпечаток функции: её участок дерева и всё, что при генерации берется из таблиц
+ */
+static uint64_t function_fingerprint(const virtual *const vm, node *const nd, vector *const span)
+{
+	const tree_arena *const arena = nd->arena;
+	const size_t begin = arena->nodes[nd->id].ref;
+	const item_t func = node_get_arg(nd, 0);
+	const node last = node_get_last(nd);
 
-				const size_t old_pc = mem_size(vm);
-				mem_increase(vm, 1);
+	size_t size = 0;
+	for (size_t id = nd->id; id <= last.id; id++)
+	{
+		size += 1 + arena->nodes[id].argc;
+	}
+
+	// Участок заполняется напрямую, он пересчитывается для каждой функции
+	vector_resize(span, size);
+	item_t *const items = span->array;
+	size = 0;
+	for (size_t id = nd->id; id <= last.id; id++)
+	{
+		items[size++] = arena->nodes[id].type;
+		for (size_t i = 0; i < arena->nodes[id].argc; i++)
+		{
+			items[size++] = span_get_arg(arena, id, i, begin, func);
+		}
+	}
 
-				node_set_next(&root);
-				block(vm, &root);
+	uint64_t hash = fc_hash(0, span->array, vector_size(span));
+	for (size_t id = nd->id; id <= last.id; id++)
+	{
+		const item_t type = arena->nodes[id].type;
+		item_t used[3] = { 0, 0, 0 };
 
-				mem_set(vm, old_pc, (item_t)mem_size(vm));
+		switch (type)
+		{
+			case TCall2:
+			case TLabel:
+				// Номера вызываемых функций и адреса меток
+				used[0] = ident_get_displ(vm->sx, (size_t)arena_get_arg(arena, id, 0));
+				break;
+			case TGoto:
+				used[0] = ident_get_displ(vm->sx, (size_t)abs((int)arena_get_arg(arena, id, 0)));
+				break;
+			case TSlice:
+			case TSliceident:
+			{
+				const item_t mode = arena_get_arg(arena, id, type == TSlice ? 0 : 1);
+				used[0] = (item_t)size_of(vm->sx, mode);
+				used[1] = mode > 0 ? mode_get(vm->sx, (size_t)mode) : 0;
 			}
 			break;
+			case TDeclid:
+			{
+				// Процессы инициализации, описанные до функции, берутся по абсолютному адресу
+				const item_t mode = arena_get_arg(arena, id, 1);
+				used[0] = (item_t)size_of(vm->sx, mode);
+				used[1] = mode > 0 ? mode_get(vm->sx, (size_t)mode) : 0;
+				used[2] = proc_get(vm, (size_t)arena_get_arg(arena, id, 4));
+			}
+			break;
+			default:
+				continue;
+		}
+
+		hash = fc_hash(hash, used, 3);
+	}
+
+	return hash;
+}
+
+/** Вставка кода функции из кеша, @c -1 если его там нет */
+static int function_replay(virtual *const vm, node *const nd, const function_code *const fc)
+{
+	if (fc == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < vector_size(&fc->processes); i += 2)
+	{
+		if ((size_t)vector_get(&fc->processes, i) >= vector_size(&vm->processes))
+		{
+			return -1;
+		}
+	}
+
+	// Код копируется целиком, затем сдвигаются адреса
+	const size_t base = mem_size(vm);
+	const size_t size = vector_size(&fc->code);
+	if (vector_increase(&vm->memory, size))
+	{
+		return -1;
+	}
+
+	const size_t func = (size_t)ident_get_displ(vm->sx, (size_t)node_get_arg(nd, 0));
+	func_set(vm->sx, func, (item_t)base);
+	vector_add(&vm->entries, (item_t)func);
+
+	item_t *const code = &vm->memory.array[base];
+	memcpy(code, fc->code.array, size * sizeof(item_t));
+
+	const item_t *const addresses = fc->addresses.array;
+	for (size_t i = 0; i < vector_size(&fc->addresses); i++)
+	{
+		code[addresses[i]] += (item_t)base;
+	}
+
+	// Идентификаторы добавляются в таблицу в том же порядке, что и при генерации
+	const tree_arena *const arena = nd->arena;
+	const node last = node_get_last(nd);
+	size_t compressed = 0;
+	for (size_t id = nd->id; id <= last.id && compressed < vector_size(&fc->identifiers); id++)
+	{
+		if (arena->nodes[id].type == TPrintid || arena->nodes[id].type == TGetid)
+		{
+			const size_t index = base + (size_t)vector_get(&fc->identifiers, compressed++);
+			mem_set(vm, index, compress_ref(vm, (size_t)arena_get_arg(arena, id, 0)));
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(&fc->processes); i += 2)
+	{
+		proc_set(vm, (size_t)vector_get(&fc->processes, i), (item_t)base + vector_get(&fc->processes, i + 1));
+	}
+
+	vm->max_threads += fc->threads;
+	*nd = last;
+
+	return 0;
+}
+
+/** Сохранение в кеш кода функции, сгенерированного с адреса base */
+static void function_store(virtual *const vm, function_code *const fc, const size_t base)
+{
+	const size_t end = mem_size(vm);
+	char *const is_address = calloc(end - base, sizeof(char));
+	if (is_address == NULL)
+	{
+		return;
+	}
+
+	// Значения вне функции, например, адреса процессов, описанных до нее, не меняются
+	for (size_t i = 0; i < vector_size(&vm->reloc_addresses); i++)
+	{
+		const size_t index = (size_t)vector_get(&vm->reloc_addresses, i);
+		const item_t value = index >= base && index < end ? mem_get(vm, index) : -1;
+		if (value >= (item_t)base && value <= (item_t)end)
+		{
+			is_address[index - base] = 1;
+		}
+	}
+
+	for (size_t i = base; i < end; i++)
+	{
+		const item_t value = mem_get(vm, i);
+		if (is_address[i - base])
+		{
+			vector_add(&fc->addresses, (item_t)(i - base));
+			vector_add(&fc->code, value - (item_t)base);
+		}
+		else
+		{
+			vector_add(&fc->code, value);
+		}
+	}
+	free(is_address);
+
+	for (size_t i = 0; i < vector_size(&vm->reloc_identifiers); i++)
+	{
+		const size_t index = (size_t)vector_get(&vm->reloc_identifiers, i);
+		if (index >= base && index < end)
+		{
+			vector_add(&fc->identifiers, (item_t)(index - base));
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(&vm->reloc_processes); i += 2)
+	{
+		const item_t value = vector_get(&vm->reloc_processes, i + 1);
+		if (value >= (item_t)base && value <= (item_t)end)
+		{
+			vector_add(&fc->processes, vector_get(&vm->reloc_processes, i));
+			vector_add(&fc->processes, value - (item_t)base);
+		}
+	}
+}
+
+/**
+ *	Генерация функции с кешем: код неизменной функции берется из кеша,
+ *	код измененной генерируется заново и сохраняется
+ */
+static void function_cached(virtual *const vm, node *const nd)
+{
+	node func;
+	node_copy(&func, nd);
+
+	function_code fc = fc_code_create();
+	fc.key = function_fingerprint(vm, &func, &fc.tree);
+	if (!function_replay(vm, nd, fc_find(vm->cache, &fc)))
+	{
+		fc_code_clear(&fc);
+		return;
+	}
+
+	vector_resize(&vm->reloc_addresses, 0);
+	vector_resize(&vm->reloc_identifiers, 0);
+	vector_resize(&vm->reloc_processes, 0);
+
+	const size_t base = mem_size(vm);
+	const size_t threads = vm->max_threads;
+	function_definition(vm, nd);
+
+	const node last = node_get_last(&func);
+	if (nd->id == last.id)
+	{
+		fc.threads = vm->max_threads - threads;
+		function_store(vm, &fc, base);
+		fc_add(vm->cache, &fc);
+		return;
+	}
+
+	fc_code_clear(&fc);
+}
+
+
+/** Генерация кодов */
+static int codegen(virtual *const vm)
+{
+	node root = arena_get_root(&vm->sx->arena);
+	while (node_set_next(&root) == 0)
+	{
+		switch (node_get_type(&root))
+		{
+			case TFuncdef:
+				if (vm->cache != NULL && root.arena != NULL)
+				{
+					function_cached(vm, &root);
+				}
+				else
+				{
+					function_definition(vm, &root);
+				}
+				break;
 
 			case NOP:
 			case TEnd:
@@ -905,10 +1265,20 @@ static int codegen(virtual *const vm)
 	mem_add(vm, CALL2);
 	mem_add(vm, ident_get_displ(vm->sx, vm->sx->ref_main));
 	mem_add(vm, STOP);
-	return 0;
+	return vm->was_error ? -1 : 0;
 }
 
 
+static inline void output_item(universal_io *const io, const item_t item)
+{
+#if ITEM >= 0
+	uni_print_uint(io, item);
+#else
+	uni_print_int(io, item);
+#endif
+	uni_print_string(io, " ");
+}
+
 static int output_table(universal_io *const io, const item_status target, const vector *const table)
 {
 	const size_t size = vector_size(table);
@@ -921,25 +1291,31 @@ static int output_table(universal_io *const io, const item_status target, const
 			return -1;
 		}
 
-		uni_printf(io, "%" PRIitem " ", item);
+		output_item(io, item);
 	}
 
-	uni_printf(io, "\n");
+	uni_print_string(io, "\n");
 	return 0;
 }
 
 /** Вывод таблиц в файл */
 static int output_export(universal_io *const io, const virtual *const vm)
 {
-	uni_printf(io, "#!/usr/bin/ruc-vm\n");
-
-	uni_printf(io, "%zi %zi %zi %zi %zi %" PRIitem " %zi\n"
-		, vector_size(&vm->memory)
-		, vector_size(&vm->sx->functions)
-		, vector_size(&vm->identifiers)
-		, vector_size(&vm->representations)
-		, vector_size(&vm->sx->modes)
-		, vm->sx->max_displg, vm->max_threads);
+	uni_print_string(io, "#!/usr/bin/ruc-vm\n");
+
+	uni_print_uint(io, vector_size(&vm->memory));
+	uni_print_string(io, " ");
+	uni_print_uint(io, vector_size(&vm->sx->functions));
+	uni_print_string(io, " ");
+	uni_print_uint(io, vector_size(&vm->identifiers));
+	uni_print_string(io, " ");
+	uni_print_uint(io, vector_size(&vm->representations));
+	uni_print_string(io, " ");
+	uni_print_uint(io, vector_size(&vm->sx->modes));
+	uni_print_string(io, " ");
+	output_item(io, vm->sx->max_displg);
+	uni_print_uint(io, vm->max_threads);
+	uni_print_string(io, "\n");
 
 	return output_table(io, vm->target, &vm->memory)
 		|| output_table(io, vm->target, &vm->sx->functions)
@@ -949,6 +1325,135 @@ static int output_export(universal_io *const io, const virtual *const vm)
 }
 
 
+/** Размер элемента таблиц в байтах */
+static size_t binary_width(const item_status target)
+{
+	switch (target)
+	{
+		case item_int8:
+		case item_uint8:
+			return 1;
+		case item_int16:
+		case item_uint16:
+			return 2;
+		case item_int32:
+		case item_uint32:
+			return 4;
+		default:
+			return 8;
+	}
+}
+
+/** Запись числа в little-endian */
+static inline size_t binary_encode(char *const buffer, const uint64_t value, const size_t width)
+{
+	for (size_t i = 0; i < width; i++)
+	{
+		buffer[i] = (char)(value >> (8 * i));
+	}
+
+	return width;
+}
+
+static int output_binary_raw(universal_io *const io, const char *const data, const size_t size, size_t *const offset)
+{
+	if (size != 0 && out_write(io, data, size) != (int)size)
+	{
+		system_error(tables_cannot_be_written);
+		return -1;
+	}
+
+	*offset += size;
+	return 0;
+}
+
+static int output_binary_value(universal_io *const io, const uint64_t value, const size_t width, size_t *const offset)
+{
+	char buffer[sizeof(uint64_t)];
+	return output_binary_raw(io, buffer, binary_encode(buffer, value, width), offset);
+}
+
+static int output_binary_padding(universal_io *const io, size_t *const offset)
+{
+	const char zeros[BINARY_ALIGN] = { 0 };
+	return output_binary_raw(io, zeros, (BINARY_ALIGN - *offset % BINARY_ALIGN) % BINARY_ALIGN, offset);
+}
+
+static int output_binary_table(universal_io *const io, const item_status target, const vector *const table
+	, const uint32_t id, size_t *const offset)
+{
+	const size_t width = binary_width(target);
+	const size_t size = vector_size(table);
+
+	if (output_binary_value(io, id, sizeof(uint32_t), offset)
+		|| output_binary_value(io, 0, sizeof(uint32_t), offset)
+		|| output_binary_value(io, size, sizeof(uint64_t), offset))
+	{
+		return -1;
+	}
+
+	char buffer[BINARY_CHUNK_SIZE];
+	size_t used = 0;
+	for (size_t i = 0; i < size; i++)
+	{
+		const item_t item = vector_get(table, i);
+		if (!item_check_var(target, item))
+		{
+			system_error(tables_cannot_be_compressed);
+			return -1;
+		}
+
+		if (used + width > BINARY_CHUNK_SIZE)
+		{
+			if (output_binary_raw(io, buffer, used, offset))
+			{
+				return -1;
+			}
+			used = 0;
+		}
+
+		used += binary_encode(&buffer[used], (uint64_t)item, width);
+	}
+
+	return output_binary_raw(io, buffer, used, offset) || output_binary_padding(io, offset) ? -1 : 0;
+}
+
+/**
+ *	Вывод таблиц в двоичном виде:
+ *		строка "#!/usr/bin/ruc-vm\n" и сигнатура "RUCB";
+ *		u8 версия, u8 целевой item_status, u8 размер элемента, u8 число таблиц;
+ *		u64 max_displg, u64 max_threads, выравнивание до 8 байт;
+ *		для каждой таблицы: u32 номер, u32 резерв, u64 число элементов,
+ *		элементы фиксированного размера и выравнивание до 8 байт.
+ *	Все числа записаны в little-endian, таблицы идут в том же порядке, что и в текстовом виде.
+ */
+static int output_export_binary(universal_io *const io, const virtual *const vm)
+{
+	if (out_set_binary(io))
+	{
+		return -1;
+	}
+
+	const char *const header = "#!/usr/bin/ruc-vm\nRUCB";
+	const size_t width = binary_width(vm->target);
+	size_t offset = 0;
+
+	return output_binary_raw(io, header, strlen(header), &offset)
+		|| output_binary_value(io, BINARY_VERSION, sizeof(uint8_t), &offset)
+		|| output_binary_value(io, (uint64_t)vm->target, sizeof(uint8_t), &offset)
+		|| output_binary_value(io, width, sizeof(uint8_t), &offset)
+		|| output_binary_value(io, BINARY_SECTIONS, sizeof(uint8_t), &offset)
+		|| output_binary_value(io, (uint64_t)vm->sx->max_displg, sizeof(uint64_t), &offset)
+		|| output_binary_value(io, vm->max_threads, sizeof(uint64_t), &offset)
+		|| output_binary_padding(io, &offset)
+		|| output_binary_table(io, vm->target, &vm->memory, 1, &offset)
+		|| output_binary_table(io, vm->target, &vm->sx->functions, 2, &offset)
+		|| output_binary_table(io, vm->target, &vm->identifiers, 3, &offset)
+		|| output_binary_table(io, vm->target, &vm->representations, 4, &offset)
+		|| output_binary_table(io, vm->target, &vm->sx->modes, 5, &offset) ? -1 : 0;
+}
+
+
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
  *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
@@ -968,8 +1473,11 @@ int encode_to_vm(const workspace *const ws, universal_io *const io, syntax *cons
 	virtual vm;
 	vm.sx = sx;
 
-	vm.memory = vector_create(MAX_MEM_SIZE);
+	// Кодов обычно меньше, чем ячеек дерева, запас на случай выражений
+	const size_t tree_size = 2 * vector_size(&sx->tree);
+	vm.memory = vector_create(tree_size > MAX_MEM_SIZE ? tree_size : MAX_MEM_SIZE);
 	vm.processes = vector_create(sx->procd);
+	vm.entries = vector_create(vector_size(&sx->functions));
 	vm.stack = vector_create(MAX_STACK_SIZE);
 
 	const size_t records = vector_size(&sx->identifiers) / 4;
@@ -979,14 +1487,35 @@ int encode_to_vm(const workspace *const ws, universal_io *const io, syntax *cons
 	vector_increase(&vm.memory, 4);
 	vector_increase(&vm.processes, sx->procd);
 	vm.max_threads = 0;
+	vm.was_error = 0;
 
 	vm.target = item_get_status(ws);
 
+	vm.cache = fc_open(ws_get_flag_value(ws, "-fcache"), ws_get_output(ws));
+	vm.reloc_addresses = vector_create(vm.cache != NULL ? MAX_STACK_SIZE : 1);
+	vm.reloc_identifiers = vector_create(vm.cache != NULL ? MAX_STACK_SIZE : 1);
+	vm.reloc_processes = vector_create(vm.cache != NULL ? MAX_STACK_SIZE : 1);
 
-	int ret = codegen(&vm);
+
+	int ret = vector_is_correct(&vm.memory) ? codegen(&vm) : -1;
+	if (!ret && ws_has_flag(ws, "-O"))
+	{
+		// Нераспознанный код оптимизатор оставляет без изменений
+		peephole_optimize(&vm.memory, &sx->functions, &vm.entries, &vm.processes);
+	}
+
+	if (!ret && ws_has_flag(ws, "-super"))
+	{
+		// Суперинструкции сливаются последними, оптимизатор их не разбирает
+		peephole_fuse(&vm.memory, &sx->functions, &vm.entries, &vm.processes);
+	}
+
+	prof_set(COUNTER_MEMORY, vector_size(&vm.memory));
 	if (!ret)
 	{
-		ret = output_export(io, &vm);
+		const phase_t prev = prof_enter(PHASE_EXPORT);
+		ret = ws_has_flag(ws, "-bin") ? output_export_binary(io, &vm) : output_export(io, &vm);
+		prof_enter(prev);
 	}
 
 #ifdef GENERATE_CODES
@@ -996,9 +1525,15 @@ int encode_to_vm(const workspace *const ws, universal_io *const io, syntax *cons
 
 	vector_clear(&vm.memory);
 	vector_clear(&vm.processes);
+	vector_clear(&vm.entries);
 	vector_clear(&vm.stack);
 
 	vector_clear(&vm.identifiers);
 	vector_clear(&vm.representations);
+
+	vector_clear(&vm.reloc_addresses);
+	vector_clear(&vm.reloc_identifiers);
+	vector_clear(&vm.reloc_processes);
+	fc_close(vm.cache);
 	return ret;
 }
@@ -29,7 +29,12 @@ extern "C" {
 #endif
 
 /**
- *	Encode to virtual machine codes
+ *	Encode to virtual machine codes,
+ *	tables are written as text or as binary image with @c -bin flag,
+ *	code is passed through peephole optimizer with @c -O flag,
+ *	frequent instruction pairs are fused into superinstructions with @c -super flag,
+ *	code of functions unchanged since the previous run is taken from @c -fcache=<dir> directory,
+ *	which is separate from @c -cache=<dir> of preprocessor headers
  *
  *	@param	ws		Compiler workspace
  *	@param	io		Universal io structure
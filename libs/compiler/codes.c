@@ -1275,6 +1275,55 @@ size_t elem_get_name(const item_t elem, const size_t num, char *const buffer)
 			}
 			break;
 
+		case LOADSLICE:
+			argc = 2;
+			sprintf(buffer, "LOADSLICE");
+			break;
+		case SLICELAT:
+			argc = 1;
+			sprintf(buffer, "SLICELAT");
+			break;
+		case LOADLOAD:
+			argc = 2;
+			sprintf(buffer, "LOADLOAD");
+			break;
+		case LOADLI:
+			argc = 2;
+			sprintf(buffer, "LOADLI");
+			break;
+		case LIASSV:
+			argc = 2;
+			sprintf(buffer, "LIASSV");
+			break;
+		case LIASSATV:
+			argc = 1;
+			sprintf(buffer, "LIASSATV");
+			break;
+		case EQEQBE0:
+			argc = 1;
+			sprintf(buffer, "EQEQBE0");
+			break;
+		case NOTEQBE0:
+			argc = 1;
+			sprintf(buffer, "NOTEQBE0");
+			break;
+		case LLTBE0:
+			argc = 1;
+			sprintf(buffer, "LLTBE0");
+			break;
+		case LGTBE0:
+			argc = 1;
+			sprintf(buffer, "LGTBE0");
+			break;
+		case LLEBE0:
+			argc = 1;
+			sprintf(buffer, "LLEBE0");
+			break;
+		case LGEBE0:
+			argc = 1;
+			sprintf(buffer, "LGEBE0");
+			break;
+
 		default:
 			sprintf(buffer, "%" PRIitem, elem);
 			break;
@@ -18,9 +18,14 @@
 #include "parser.h"
 #include "codegen.h"
 #include "errors.h"
+#include "folding.h"
+#include "llvmgen.h"
+#include "mipsgen.h"
 #include "preprocessor.h"
+#include "profiler.h"
 #include "syntax.h"
 #include "uniio.h"
+#include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
@@ -36,10 +41,17 @@ const char *const DEFAULT_VM = "out.ruc";
 const char *const DEFAULT_LLVM = "out.ll";
 const char *const DEFAULT_MIPS = "out.s";
 
+#define MAX_REQUEST_ARGS (MAX_PATHS + MAX_FLAGS + 3)
+#define MAX_REQUEST_SIZE (MAX_REQUEST_ARGS * MAX_ARG_SIZE)
+
 
 typedef int (*encoder)(const workspace *const ws, universal_io *const io, syntax *const sx);
 
 
+/** Syntax tables kept warm between requests in server mode */
+static syntax *prototype = NULL;
+
+
 /** Make executable actually executable on best-effort basis (if possible) */
 static void make_executable(const char *const path)
 {
@@ -67,16 +79,35 @@ int compile_from_io(const workspace *const ws, universal_io *const io, const enc
 		return -1;
 	}
 
-	syntax sx = sx_create();
+	syntax sx = sx_create_from(prototype);
+	const phase_t prev = prof_enter(PHASE_PARSER);
 	int ret = parse(io, &sx);
 
+	// Свертка меняет код для всех целевых платформ, поэтому она включается явно
+	if (!ret && ws_has_flag(ws, "-O") && tree_fold(&sx))
+	{
+		warning_msg("не удалось свернуть константные выражения, дерево оставлено без изменений");
+	}
+
+	prof_set(COUNTER_TREE, vector_size(&sx.tree));
+	prof_set(COUNTER_IDENTIFIERS, vector_size(&sx.identifiers) / 4);
+	prof_set(COUNTER_MODES, vector_size(&sx.modes));
+
 	if (!ret)
 	{
+		prof_enter(PHASE_CODEGEN);
 		ret = enc(ws, io, &sx);
 	}
+	prof_enter(prev);
 
 	sx_clear(&sx);
-	io_erase(io);
+	if (io_erase(io) && !ret)
+	{
+		// Остаток буфера записывается в файл только при закрытии
+		error_msg("не удалось записать выходной файл");
+		ret = -1;
+	}
+
 	return ret;
 }
 
@@ -89,32 +120,45 @@ int compile_from_ws(workspace *const ws, const encoder enc)
 	}
 
 	universal_io io = io_create();
+	const char *const report = ws_get_flag_value(ws, "-report");
+	if (report != NULL)
+	{
+		prof_start();
+	}
+	prof_enter(PHASE_MACRO);
 
 #ifndef GENERATE_MACRO
 	// Препроцессинг в массив
 	char *const preprocessing = macro(ws); // макрогенерация
-	if (preprocessing == NULL)
+	int ret = preprocessing == NULL ? -1 : 0;
+
+	if (!ret)
 	{
-		return -1;
+		in_set_buffer(&io, preprocessing);
 	}
-
-	in_set_buffer(&io, preprocessing);
 #else
-	int ret_macro = macro_to_file(ws, DEFAULT_MACRO);
-	if (ret_macro)
+	int ret = macro_to_file(ws, DEFAULT_MACRO);
+	if (!ret)
 	{
-		return ret_macro;
+		in_set_file(&io, DEFAULT_MACRO);
 	}
-
-	in_set_file(&io, DEFAULT_MACRO);
 #endif
 
-	out_set_file(&io, ws_get_output(ws));
-	const int ret = compile_from_io(ws, &io, enc);
+	prof_enter(PHASE_NONE);
+	if (!ret)
+	{
+		out_set_file(&io, ws_get_output(ws));
+		ret = compile_from_io(ws, &io, enc);
+	}
 
 #ifndef GENERATE_MACRO
 	free(preprocessing);
 #endif
+
+	if (report != NULL && prof_finish(report))
+	{
+		warning_msg("не удалось записать отчет о компиляции");
+	}
 	return ret;
 }
 
@@ -138,6 +182,18 @@ int compile(workspace *const ws)
 		{
 			return compile_to_vm(ws);
 		}
+		else if (strcmp(flag, "-LLVM") == 0)
+		{
+			return compile_to_llvm(ws);
+		}
+		else if (strcmp(flag, "-MIPS") == 0)
+		{
+			return compile_to_mips(ws);
+		}
+		else if (strcmp(flag, "-server") == 0 && prototype == NULL)
+		{
+			return compile_server();
+		}
 	}
 }
 
@@ -157,6 +213,67 @@ int compile_to_vm(workspace *const ws)
 	return ret;
 }
 
+int compile_to_llvm(workspace *const ws)
+{
+	if (ws_get_output(ws) == NULL)
+	{
+		ws_set_output(ws, DEFAULT_LLVM);
+	}
+
+	return compile_from_ws(ws, &encode_to_llvm);
+}
+
+int compile_to_mips(workspace *const ws)
+{
+	if (ws_get_output(ws) == NULL)
+	{
+		ws_set_output(ws, DEFAULT_MIPS);
+	}
+
+	return compile_from_ws(ws, &encode_to_mips);
+}
+
+int compile_server()
+{
+	syntax warm = sx_create();
+	if (!map_is_correct(&warm.representations) || !vector_is_correct(&warm.modes) || macro_warm_up())
+	{
+		error_msg("не удалось подготовить таблицы сервера");
+		sx_clear(&warm);
+		return -1;
+	}
+	prototype = &warm;
+
+	char request[MAX_REQUEST_SIZE];
+	while (fgets(request, MAX_REQUEST_SIZE, stdin) != NULL)
+	{
+		// Аргументы запроса разделяются пробелами, нулевой аргумент как у командной строки
+		const char *argv[MAX_REQUEST_ARGS] = { "ruc" };
+		int argc = 1;
+
+		char *arg = strtok(request, " \t\r\n");
+		while (arg != NULL && argc < MAX_REQUEST_ARGS)
+		{
+			argv[argc++] = arg;
+			arg = strtok(NULL, " \t\r\n");
+		}
+
+		if (argc == 1)
+		{
+			break;
+		}
+
+		workspace ws = ws_parse_args(argc, argv);
+		printf("%i\n", compile(&ws));
+		fflush(stdout);
+	}
+
+	prototype = NULL;
+	macro_cool_down();
+	sx_clear(&warm);
+	return 0;
+}
+
 
 int auto_compile(const int argc, const char *const *const argv)
 {
@@ -170,11 +287,23 @@ int auto_compile_to_vm(const int argc, const char *const *const argv)
 	return compile_to_vm(&ws);
 }
 
+int auto_compile_to_llvm(const int argc, const char *const *const argv)
+{
+	workspace ws = ws_parse_args(argc, argv);
+	return compile_to_llvm(&ws);
+}
+
+int auto_compile_to_mips(const int argc, const char *const *const argv)
+{
+	workspace ws = ws_parse_args(argc, argv);
+	return compile_to_mips(&ws);
+}
+
 
 int no_macro_compile_to_vm(const char *const path)
 {
 	universal_io io = io_create();
-	in_set_file(&io, path);
+	in_set_mmap(&io, path);
 
 	workspace ws = ws_create();
 	ws_add_file(&ws, path);
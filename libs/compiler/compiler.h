@@ -28,7 +28,9 @@ extern "C" {
 #endif
 
 /**
- *	Compile code from workspace
+ *	Compile code from workspace,
+ *	constant expressions are folded for every target with @c -O flag,
+ *	JSON report with phase times and counters is written to @c -report=<path>
  *
  *	@param	ws		Compiler workspace
  *
@@ -45,6 +47,34 @@ EXPORTED int compile(workspace *const ws);
  */
 EXPORTED int compile_to_vm(workspace *const ws);
 
+/**
+ *	Compile LLVM IR from workspace
+ *
+ *	@param	ws		Compiler workspace
+ *
+ *	@return	Status code
+ */
+EXPORTED int compile_to_llvm(workspace *const ws);
+
+/**
+ *	Compile MIPS assembly from workspace
+ *
+ *	@param	ws		Compiler workspace
+ *
+ *	@return	Status code
+ */
+EXPORTED int compile_to_mips(workspace *const ws);
+
+/**
+ *	Run compile server: read requests with command line arguments from stdin
+ *	line by line and write status code of each compilation to stdout.
+ *	Keyword tables are prepared once and reused by all requests.
+ *	Empty line or end of input stops the server.
+ *
+ *	@return	Status code
+ */
+EXPORTED int compile_server();
+
 
 /**
  *	Compile code from terminal arguments
@@ -66,6 +96,26 @@ EXPORTED int auto_compile(const int argc, const char *const *const argv);
  */
 EXPORTED int auto_compile_to_vm(const int argc, const char *const *const argv);
 
+/**
+ *	Compile LLVM IR from terminal arguments
+ *
+ *	@param	argc	Number of command line arguments
+ *	@param	argv	Command line arguments
+ *
+ *	@return	Status code
+ */
+EXPORTED int auto_compile_to_llvm(const int argc, const char *const *const argv);
+
+/**
+ *	Compile MIPS assembly from terminal arguments
+ *
+ *	@param	argc	Number of command line arguments
+ *	@param	argv	Command line arguments
+ *
+ *	@return	Status code
+ */
+EXPORTED int auto_compile_to_mips(const int argc, const char *const *const argv);
+
 
 /**
  *	Compile RuC virtual machine code with no macro
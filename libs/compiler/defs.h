@@ -25,6 +25,8 @@
 #define SOURCESIZE	10000
 #define LINESSIZE	300
 #define MAXSTRINGL	128
+#define MAXSTACK	100
+#define MAXLABELS	1000
 
 #define MAXPRINTFPARAMS 20
 
@@ -247,6 +249,25 @@ enum MODE
 #define COPYST	   9308 // d1, d2, l	структура - значение функции
 
 
+// Суперинструкции - частые пары команд, слитые в одну (флаг -super).
+// Пары выбраны по профилю выполнения tests/executable,
+// операнды идут подряд в порядке операндов исходных команд
+
+#define LOADSLICE 9600 // LOAD d; SLICE l
+#define SLICELAT  9601 // SLICE l; LAT
+#define LOADLOAD  9602 // LOAD d1; LOAD d2
+#define LOADLI	  9603 // LOAD d; LI n
+#define LIASSV	  9604 // LI n; ASSV d
+#define LIASSATV  9605 // LI n; ASSATV
+
+#define EQEQBE0	  9611 // EQEQ; BE0 addr	порядок как у EQEQ - LGE
+#define NOTEQBE0  9612 // NOTEQ; BE0 addr
+#define LLTBE0	  9613 // LLT; BE0 addr
+#define LGTBE0	  9614 // LGT; BE0 addr
+#define LLEBE0	  9615 // LLE; BE0 addr
+#define LGEBE0	  9616 // LGE; BE0 addr
+
+
 // Коды операций стандартных функций
 
 #define ABSIC 9651
@@ -549,3 +570,29 @@ enum MODE
 #define nor	 99	 // nor rd, rs, rt		rd = ~(rs | rt)
 #define slt	 102 // slt rd, rs, rt		rd = rs < rt ? 1 : 0
 #define sltu 103 // sltu rd, rs, rt		rd = rs < rt ? 1 : 0		unsigned
+#define lwc1 49	 // lwc1 ft, imm(rs)		ft = [Address]
+#define swc1 57	 // swc1 ft, imm(rs)		[Address] = ft
+#define movf 61	 // movf rd, rs, cc		if !cc then rd = rs
+#define la	 116 // la rt, label			это псевдокоманда (lui + addiu)
+#define move 117 // move rd, rs			это псевдокоманда (addu rd, rs, $zero)
+
+
+// коды команд сопроцессора плавающей точки
+
+#define add_d	  200 // add.d fd, fs, ft		fd = fs + ft
+#define sub_d	  201 // sub.d fd, fs, ft		fd = fs - ft
+#define mul_d	  202 // mul.d fd, fs, ft		fd = fs * ft
+#define div_d	  203 // div.d fd, fs, ft		fd = fs / ft
+#define sqrt_d	  204 // sqrt.d fd, fs			fd = sqrt(fs)
+#define abs_d	  205 // abs.d fd, fs			fd = |fs|
+#define mov_d	  206 // mov.d fd, fs			fd = fs
+#define neg_d	  207 // neg.d fd, fs			fd = -fs
+#define trunc_w_d 213 // trunc.w.d fd, fs		fd = (int)fs
+#define cvt_d_w	  233 // cvt.d.w fd, fs		fd = (double)fs
+#define c_eq_d	  250 // c.eq.d fs, ft		cc = fs == ft
+#define c_lt_d	  260 // c.lt.d fs, ft		cc = fs < ft
+#define c_le_d	  262 // c.le.d fs, ft		cc = fs <= ft
+#define mfc1	  300 // mfc1 rt, fs			rt = fs
+#define mtc1	  304 // mtc1 rt, fs			fs = rt
+#define bc1f	  308 // bc1f label			if !cc
+#define bc1t	  309 // bc1t label			if cc
@@ -518,6 +518,10 @@ void get_error(const error_t num, char *const msg, va_list args)
 			sprintf(msg, "в этой операции этот параметр должен иметь тип массив");
 			break;
 
+		case operand_stack_underflow:
+			sprintf(msg, "нарушен баланс стека операндов выражения");
+			break;
+
 		case tree_expression_not_block:
 		{
 			const size_t i = va_arg(args, size_t);
@@ -591,6 +595,15 @@ void get_error(const error_t num, char *const msg, va_list args)
 		case tables_cannot_be_compressed:
 			sprintf(msg, "невозможно сжать таблицы до заданного размера");
 			break;
+		case tables_cannot_be_written:
+			sprintf(msg, "невозможно записать таблицы в выходной файл");
+			break;
+		case node_unsupported:
+		{
+			const int type = va_arg(args, int);
+			sprintf(msg, "генерация кода для узла %i не поддерживается", type);
+		}
+		break;
 		case default_not_in_switch:
 			sprintf(msg, "метка УМОЛЧАНИЕ не в операторе ВЫБОР");
 			break;
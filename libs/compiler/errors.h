@@ -176,6 +176,8 @@ typedef enum ERROR
 	not_float_in_stanfunc,
 	not_array_in_stanfunc,
 
+	operand_stack_underflow,
+
 	// Tree parsing errors
 	tree_expression_not_block,
 	tree_expression_unknown,
@@ -193,6 +195,8 @@ typedef enum ERROR
 
 	// Codegen errors
 	tables_cannot_be_compressed,
+	tables_cannot_be_written,
+	node_unsupported,
 } error_t;
 
 /** Warnings codes */
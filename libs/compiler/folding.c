@@ -0,0 +1,741 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "folding.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+#include "defs.h"
+#include "operations.h"
+
+
+/** Tree folder */
+typedef struct folder
+{
+	const tree_arena *arena;/**< Arena of source tree */
+
+	vector tree;			/**< Folded tree */
+	vector nodes;			/**< References to emitted nodes in folded tree */
+	vector logic;			/**< Numbers of emitted ADLOGOR and ADLOGAND nodes waiting for their pair */
+
+	size_t *positions;		/**< References in folded tree by source node numbers */
+} folder;
+
+
+static void fold_range(folder *const fld, const size_t first, const size_t last);
+
+
+static inline double double_from_args(const item_t fst, const item_t snd)
+{
+	const uint64_t num64 = ((uint64_t)(uint32_t)snd << 32) | (uint64_t)(uint32_t)fst;
+
+	double num;
+	memcpy(&num, &num64, sizeof(double));
+	return num;
+}
+
+static inline void double_to_args(const double num, int32_t *const fst, int32_t *const snd)
+{
+	uint64_t num64;
+	memcpy(&num64, &num, sizeof(uint64_t));
+
+	*fst = (int32_t)(uint32_t)num64;
+	*snd = (int32_t)(uint32_t)(num64 >> 32);
+}
+
+static inline int double_is_item(const double num)
+{
+	int32_t fst;
+	int32_t snd;
+	double_to_args(num, &fst, &snd);
+	return is_item(fst) && is_item(snd);
+}
+
+
+/** Номер узла, следующего за поддеревом */
+static size_t subtree_end(const tree_arena *const arena, const size_t id)
+{
+	const size_t end = arena->nodes[id].end;
+
+	size_t fst = id + 1;
+	size_t snd = arena->nodes_size;
+	while (fst < snd)
+	{
+		const size_t middle = fst + (snd - fst) / 2;
+		if (arena->nodes[middle].ref < end)
+		{
+			fst = middle + 1;
+		}
+		else
+		{
+			snd = middle;
+		}
+	}
+
+	return fst;
+}
+
+static inline size_t subtree_child(const tree_arena *const arena, const size_t id, const size_t index)
+{
+	return arena->children[arena->nodes[id].children + index];
+}
+
+/** Условные выражения читаются не по поддеревьям, такие операторы не перестраиваются */
+static int subtree_is_regular(const tree_arena *const arena, const size_t id)
+{
+	const size_t last = subtree_end(arena, id);
+	for (size_t i = id; i < last; i++)
+	{
+		if (arena->nodes[i].type == TCondexpr)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+/** Есть ли в поддереве операторы, на которые можно перейти не по порядку */
+static int subtree_has_labels(const tree_arena *const arena, const size_t id)
+{
+	const size_t last = subtree_end(arena, id);
+	for (size_t i = id; i < last; i++)
+	{
+		const item_t type = arena->nodes[i].type;
+		if (type == TLabel || type == TCase || type == TDefault)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+
+static inline size_t emitted_amount(const folder *const fld)
+{
+	return vector_size(&fld->nodes);
+}
+
+static inline size_t emitted_ref(const folder *const fld, const size_t number)
+{
+	return (size_t)vector_get(&fld->nodes, number);
+}
+
+static inline item_t emitted_type(const folder *const fld, const size_t number)
+{
+	return vector_get(&fld->tree, emitted_ref(fld, number));
+}
+
+static inline item_t emitted_arg(const folder *const fld, const size_t number, const size_t index)
+{
+	return vector_get(&fld->tree, emitted_ref(fld, number) + 1 + index);
+}
+
+static inline double emitted_double(const folder *const fld, const size_t number)
+{
+	return double_from_args(emitted_arg(fld, number, 0), emitted_arg(fld, number, 1));
+}
+
+/** Тип узла, отсчитывая от последнего выпущенного */
+static inline item_t emitted_type_from_end(const folder *const fld, const size_t index)
+{
+	return emitted_amount(fld) > index ? emitted_type(fld, emitted_amount(fld) - 1 - index) : ITEM_MAX;
+}
+
+/** Удалить выпущенные узлы, начиная с заданного */
+static inline void emitted_remove(folder *const fld, const size_t number)
+{
+	vector_resize(&fld->tree, emitted_ref(fld, number));
+	vector_resize(&fld->nodes, number);
+}
+
+
+static inline void emit_header(folder *const fld, const item_t type)
+{
+	vector_add(&fld->nodes, (item_t)vector_size(&fld->tree));
+	vector_add(&fld->tree, type);
+}
+
+static inline void emit_const(folder *const fld, const int32_t value)
+{
+	emit_header(fld, TConst);
+	vector_add(&fld->tree, value);
+}
+
+static inline void emit_double(folder *const fld, const double value)
+{
+	int32_t fst;
+	int32_t snd;
+	double_to_args(value, &fst, &snd);
+
+	emit_header(fld, TConstd);
+	vector_add(&fld->tree, fst);
+	vector_add(&fld->tree, snd);
+}
+
+/** Пустой оператор вместо удалённого */
+static inline void emit_nop(folder *const fld)
+{
+	emit_header(fld, NOP);
+}
+
+
+/** Вещественная операция с константой справа, не меняющая значение, в том числе знак нуля */
+static int is_right_identity_double(const item_t code, const double value)
+{
+	switch (code)
+	{
+		case LMINUSR:
+			return value == 0 && !signbit(value);
+		case LMULTR:
+		case LDIVR:
+			return value == 1;
+		default:
+			return 0;
+	}
+}
+
+static int double_fold(const item_t code, const double fst, const double snd, double *const result)
+{
+	switch (code)
+	{
+		case LPLUSR:
+			*result = fst + snd;
+			return 0;
+		case LMINUSR:
+			*result = fst - snd;
+			return 0;
+		case LMULTR:
+			*result = fst * snd;
+			return 0;
+		case LDIVR:
+			if (snd == 0)
+			{
+				return -1;
+			}
+			*result = fst / snd;
+			return 0;
+		default:
+			return -1;
+	}
+}
+
+static int double_compare(const item_t code, const double fst, const double snd)
+{
+	switch (code)
+	{
+		case EQEQR:
+			return fst == snd;
+		case NOTEQR:
+			return fst != snd;
+		case LLTR:
+			return fst < snd;
+		case LGTR:
+			return fst > snd;
+		case LLER:
+			return fst <= snd;
+		default:
+			return fst >= snd;
+	}
+}
+
+
+/** Свёртка унарной операции над последним выпущенным узлом */
+static int fold_unary(folder *const fld, const item_t code)
+{
+	const size_t last = emitted_amount(fld) - 1;
+	const item_t type = emitted_type_from_end(fld, 0);
+
+	if (type == TConst)
+	{
+		const int32_t value = (int32_t)emitted_arg(fld, last, 0);
+
+		int32_t result;
+		if (fold_int_unary(code, value, &result) == 0 && is_item(result))
+		{
+			emitted_remove(fld, last);
+			emit_const(fld, result);
+			return 1;
+		}
+
+		if (code == WIDEN)
+		{
+			emitted_remove(fld, last);
+			emit_double(fld, (double)value);
+			return 1;
+		}
+	}
+	else if (type == TConstd && code == UNMINUSR)
+	{
+		const double result = -emitted_double(fld, last);
+		if (double_is_item(result))
+		{
+			emitted_remove(fld, last);
+			emit_double(fld, result);
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/** Свёртка бинарной целой операции над двумя последними выпущенными узлами */
+static int fold_binary(folder *const fld, const item_t code)
+{
+	const size_t amount = emitted_amount(fld);
+	if (emitted_type_from_end(fld, 0) != TConst)
+	{
+		// 0 + x, 1 * x - остаётся только переменная
+		if (emitted_type_from_end(fld, 0) == TIdenttoval && emitted_type_from_end(fld, 1) == TConst
+			&& is_left_identity(code, (int32_t)emitted_arg(fld, amount - 2, 0)))
+		{
+			const item_t displ = emitted_arg(fld, amount - 1, 0);
+			emitted_remove(fld, amount - 2);
+			emit_header(fld, TIdenttoval);
+			vector_add(&fld->tree, displ);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	const int32_t snd = (int32_t)emitted_arg(fld, amount - 1, 0);
+	if (emitted_type_from_end(fld, 1) == TConst)
+	{
+		const int32_t fst = (int32_t)emitted_arg(fld, amount - 2, 0);
+
+		int32_t result;
+		if (fold_int_binary(code, fst, snd, &result) == 0 && is_item(result))
+		{
+			emitted_remove(fld, amount - 2);
+			emit_const(fld, result);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	if (is_right_identity(code, snd))
+	{
+		emitted_remove(fld, amount - 1);
+		return 1;
+	}
+
+	return 0;
+}
+
+/** Свёртка вещественной операции над двумя последними выпущенными узлами */
+static int fold_binary_double(folder *const fld, const item_t code)
+{
+	const size_t amount = emitted_amount(fld);
+	if (code == WIDEN1)
+	{
+		if (emitted_type_from_end(fld, 1) != TConst || emitted_type_from_end(fld, 0) != TConstd)
+		{
+			return 0;
+		}
+
+		const int32_t fst = (int32_t)emitted_arg(fld, amount - 2, 0);
+		const double snd = emitted_double(fld, amount - 1);
+		emitted_remove(fld, amount - 2);
+		emit_double(fld, (double)fst);
+		emit_double(fld, snd);
+		return 1;
+	}
+
+	if (emitted_type_from_end(fld, 0) != TConstd)
+	{
+		return 0;
+	}
+
+	const double snd = emitted_double(fld, amount - 1);
+	if (emitted_type_from_end(fld, 1) != TConstd)
+	{
+		if (is_right_identity_double(code, snd))
+		{
+			emitted_remove(fld, amount - 1);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	const double fst = emitted_double(fld, amount - 2);
+	if (code >= EQEQR && code <= LGER)
+	{
+		emitted_remove(fld, amount - 2);
+		emit_const(fld, double_compare(code, fst, snd));
+		return 1;
+	}
+
+	double result;
+	if (double_fold(code, fst, snd, &result) == 0 && double_is_item(result))
+	{
+		emitted_remove(fld, amount - 2);
+		emit_double(fld, result);
+		return 1;
+	}
+
+	return 0;
+}
+
+/**
+ *	Свёртка логической операции с константой слева:
+ *	правый операнд не вычисляется, если результат известен по левому
+ */
+static int fold_logic(folder *const fld, const item_t code, const size_t address)
+{
+	if (address == 0 || emitted_type(fld, address - 1) != TConst)
+	{
+		return 0;
+	}
+
+	const int32_t fst = (int32_t)emitted_arg(fld, address - 1, 0);
+	if ((code == LOGOR && fst != 0) || (code == LOGAND && fst == 0))
+	{
+		emitted_remove(fld, address - 1);
+		emit_const(fld, fst != 0);
+		return 1;
+	}
+
+	if (emitted_amount(fld) == address + 2 && emitted_type(fld, address + 1) == TConst)
+	{
+		const int32_t snd = (int32_t)emitted_arg(fld, address + 1, 0);
+		emitted_remove(fld, address - 1);
+		emit_const(fld, snd != 0);
+		return 1;
+	}
+
+	return 0;
+}
+
+/** Попытка свернуть операцию вместо её выпуска */
+static int fold_operation(folder *const fld, const item_t code)
+{
+	switch (code)
+	{
+		case UNMINUS:
+		case LNOT:
+		case LOGNOT:
+		case UNMINUSR:
+		case WIDEN:
+			return fold_unary(fld, code);
+
+		case LREM:
+		case LSHL:
+		case LSHR:
+		case LAND:
+		case LEXOR:
+		case LOR:
+		case EQEQ:
+		case NOTEQ:
+		case LLT:
+		case LGT:
+		case LLE:
+		case LGE:
+		case LPLUS:
+		case LMINUS:
+		case LMULT:
+		case LDIV:
+			return fold_binary(fld, code);
+
+		case EQEQR:
+		case NOTEQR:
+		case LLTR:
+		case LGTR:
+		case LLER:
+		case LGER:
+		case LPLUSR:
+		case LMINUSR:
+		case LMULTR:
+		case LDIVR:
+		case WIDEN1:
+			return fold_binary_double(fld, code);
+
+		default:
+			return 0;
+	}
+}
+
+
+/** Выпуск узла без потомков с попыткой свёртки */
+static void fold_node(folder *const fld, const size_t id)
+{
+	const tree_node *const record = &fld->arena->nodes[id];
+	const vector *const tree = fld->arena->tree;
+
+	size_t address = SIZE_MAX;
+	if (record->type == LOGOR || record->type == LOGAND)
+	{
+		address = (size_t)vector_get(&fld->logic, vector_size(&fld->logic) - 1);
+		vector_remove(&fld->logic);
+
+		if (fold_logic(fld, record->type, address))
+		{
+			return;
+		}
+	}
+	else if (record->argc == 0 && fold_operation(fld, record->type))
+	{
+		return;
+	}
+
+	emit_header(fld, record->type);
+	for (size_t i = 0; i < record->argc; i++)
+	{
+		vector_add(&fld->tree, vector_get(tree, record->ref + 1 + i));
+	}
+
+	if (record->type == ADLOGOR || record->type == ADLOGAND)
+	{
+		vector_add(&fld->logic, (item_t)(emitted_amount(fld) - 1));
+	}
+	else if (address != SIZE_MAX)
+	{
+		// Пара логической операции ссылается на её аргумент
+		vector_set(&fld->tree, emitted_ref(fld, address) + 1, (item_t)(vector_size(&fld->tree) - 1));
+	}
+}
+
+/** Константа условия, которое было выпущено начиная с заданного узла */
+static int fold_condition(const folder *const fld, const size_t number, int32_t *const value)
+{
+	if (emitted_amount(fld) != number + 2 || emitted_type(fld, number) != TConst
+		|| emitted_type(fld, number + 1) != TExprend)
+	{
+		return 0;
+	}
+
+	*value = (int32_t)emitted_arg(fld, number, 0);
+	return 1;
+}
+
+static inline void fold_subtree(folder *const fld, const size_t id)
+{
+	fold_range(fld, id, subtree_end(fld->arena, id));
+}
+
+static int fold_if(folder *const fld, const size_t id)
+{
+	const tree_arena *const arena = fld->arena;
+	if (!subtree_is_regular(arena, id))
+	{
+		return 0;
+	}
+
+	const size_t amount = arena->nodes[id].amount;
+	const size_t number = emitted_amount(fld);
+	fold_node(fld, id);
+	fold_subtree(fld, subtree_child(arena, id, 0));
+
+	int32_t value;
+	if (fold_condition(fld, number + 1, &value))
+	{
+		const size_t then_branch = subtree_child(arena, id, 1);
+		const size_t else_branch = amount == 3 ? subtree_child(arena, id, 2) : SIZE_MAX;
+		const size_t removed = value ? else_branch : then_branch;
+		const size_t remained = value ? then_branch : else_branch;
+
+		if (removed == SIZE_MAX || !subtree_has_labels(arena, removed))
+		{
+			emitted_remove(fld, number);
+			if (remained != SIZE_MAX)
+			{
+				fold_subtree(fld, remained);
+			}
+			else
+			{
+				emit_nop(fld);
+			}
+			return 1;
+		}
+	}
+
+	for (size_t i = 1; i < amount; i++)
+	{
+		fold_subtree(fld, subtree_child(arena, id, i));
+	}
+	return 1;
+}
+
+static int fold_while(folder *const fld, const size_t id)
+{
+	const tree_arena *const arena = fld->arena;
+	if (!subtree_is_regular(arena, id))
+	{
+		return 0;
+	}
+
+	const size_t number = emitted_amount(fld);
+	const size_t body = subtree_child(arena, id, 1);
+	fold_node(fld, id);
+	fold_subtree(fld, subtree_child(arena, id, 0));
+
+	int32_t value;
+	if (fold_condition(fld, number + 1, &value) && (value || !subtree_has_labels(arena, body)))
+	{
+		emitted_remove(fld, number);
+		if (!value)
+		{
+			emit_nop(fld);
+			return 1;
+		}
+
+		// Бесконечный цикл без проверки условия, ссылка на тело перемещается вместе с остальными
+		emit_header(fld, TFor);
+		vector_add(&fld->tree, 0);
+		vector_add(&fld->tree, 0);
+		vector_add(&fld->tree, 0);
+		vector_add(&fld->tree, (item_t)arena->nodes[body].ref);
+	}
+
+	fold_subtree(fld, body);
+	return 1;
+}
+
+/** Выпуск узлов подряд, операторы с условиями разбираются отдельно */
+static void fold_range(folder *const fld, const size_t first, const size_t last)
+{
+	const tree_arena *const arena = fld->arena;
+
+	size_t i = first;
+	while (i < last)
+	{
+		fld->positions[i] = vector_size(&fld->tree);
+
+		const item_t type = arena->nodes[i].type;
+		if ((type == TIf && fold_if(fld, i)) || (type == TWhile && fold_while(fld, i)))
+		{
+			i = subtree_end(arena, i);
+		}
+		else
+		{
+			fold_node(fld, i++);
+		}
+	}
+}
+
+/** Новая ссылка на узел по его ссылке в исходном дереве */
+static item_t fold_reference(const folder *const fld, const item_t ref)
+{
+	const tree_arena *const arena = fld->arena;
+
+	size_t fst = 1;
+	size_t snd = arena->nodes_size;
+	while (fst < snd)
+	{
+		const size_t middle = fst + (snd - fst) / 2;
+		if (arena->nodes[middle].ref < (size_t)ref)
+		{
+			fst = middle + 1;
+		}
+		else
+		{
+			snd = middle;
+		}
+	}
+
+	return fst < arena->nodes_size && arena->nodes[fst].ref == (size_t)ref ? (item_t)fld->positions[fst] : ref;
+}
+
+/** Перемещение ссылок на потомков операторов */
+static void fold_relocate(folder *const fld)
+{
+	for (size_t i = 0; i < emitted_amount(fld); i++)
+	{
+		const size_t ref = emitted_ref(fld, i);
+		const item_t type = vector_get(&fld->tree, ref);
+		const size_t argc = type == TIf ? 1 : type == TFor ? 4 : 0;
+
+		for (size_t j = ref + 1; j <= ref + argc; j++)
+		{
+			if (vector_get(&fld->tree, j) != 0)
+			{
+				vector_set(&fld->tree, j, fold_reference(fld, vector_get(&fld->tree, j)));
+			}
+		}
+	}
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int tree_fold(syntax *const sx)
+{
+	if (sx == NULL || sx->arena.nodes_size == 0)
+	{
+		return -1;
+	}
+
+	folder fld;
+	fld.arena = &sx->arena;
+	fld.tree = vector_create(vector_size(&sx->tree));
+	fld.nodes = vector_create(sx->arena.nodes_size);
+	fld.logic = vector_create(MAXTREESIZE);
+	fld.positions = calloc(sx->arena.nodes_size, sizeof(size_t));
+
+	if (fld.positions == NULL)
+	{
+		vector_clear(&fld.tree);
+		vector_clear(&fld.nodes);
+		vector_clear(&fld.logic);
+		return -1;
+	}
+
+	fold_range(&fld, 1, sx->arena.nodes_size);
+	fold_relocate(&fld);
+
+	tree_arena arena = arena_create(&fld.tree);
+	const int ret = arena.nodes_size == 0;
+
+	if (!ret)
+	{
+		// Функции хранят ссылки на свои определения
+		for (size_t i = 0; i < emitted_amount(&fld); i++)
+		{
+			if (emitted_type(&fld, i) == TFuncdef)
+			{
+				const size_t function_number = (size_t)ident_get_displ(sx, (size_t)emitted_arg(&fld, i, 0));
+				func_set(sx, function_number, (item_t)emitted_ref(&fld, i));
+			}
+		}
+
+		arena_clear(&sx->arena);
+		vector_clear(&sx->tree);
+
+		sx->tree = fld.tree;
+		sx->arena = arena;
+		sx->arena.tree = &sx->tree;
+	}
+	else
+	{
+		arena_clear(&arena);
+		vector_clear(&fld.tree);
+	}
+
+	free(fld.positions);
+	vector_clear(&fld.nodes);
+	vector_clear(&fld.logic);
+	return ret ? -1 : 0;
+}
@@ -0,0 +1,40 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "syntax.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Fold constant expressions, remove identity operations and
+ *	simplify statements with constant conditions in syntax tree.
+ *	Tree arena must be valid, it is recreated after folding.
+ *	On failure tree and arena are left unchanged.
+ *
+ *	@param	sx			Syntax structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int tree_fold(syntax *const sx);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
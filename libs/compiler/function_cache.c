@@ -0,0 +1,515 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "function_cache.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "hash.h"
+#include "workspace.h"
+
+
+#define MAX_CACHE_PATH (MAX_ARG_SIZE + 32)
+#define MAX_CACHE_VECTOR 0x10000000
+
+/** Number of vectors in function code */
+#define FC_VECTORS 5
+
+
+static const char FC_MAGIC[8] = "RUCFC01";
+
+
+/** Byte buffer of cache file */
+typedef struct fc_buffer
+{
+	char *data;					/**< Buffer data */
+	size_t size;				/**< Size of data */
+	size_t alloc;				/**< Allocated size */
+	size_t position;			/**< Read position */
+} fc_buffer;
+
+struct function_cache
+{
+	char path[MAX_CACHE_PATH];	/**< Cache file */
+
+	function_code *entries;		/**< Function codes from previous run */
+	char *is_found;				/**< Set for function codes found in this run */
+	size_t size;				/**< Number of function codes from previous run */
+
+	size_t *table;				/**< Hash table of entries numbers plus one */
+	size_t table_size;			/**< Size of hash table, power of two */
+
+	function_code *added;		/**< Function codes added in this run */
+	size_t added_size;			/**< Number of added function codes */
+	size_t added_alloc;			/**< Allocated size of added function codes */
+};
+
+
+static inline vector *code_get_vector(function_code *const fc, const size_t index)
+{
+	vector *const vectors[FC_VECTORS] = { &fc->tree, &fc->code, &fc->addresses, &fc->identifiers, &fc->processes };
+	return vectors[index];
+}
+
+/** Offsets from relocation tables must point into code */
+static int code_is_correct(const function_code *const fc)
+{
+	const size_t size = vector_size(&fc->code);
+	if (vector_size(&fc->processes) % 2 != 0)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < vector_size(&fc->addresses); i++)
+	{
+		const item_t offset = vector_get(&fc->addresses, i);
+		if (offset < 0 || (size_t)offset >= size)
+		{
+			return 0;
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(&fc->identifiers); i++)
+	{
+		const item_t offset = vector_get(&fc->identifiers, i);
+		if (offset < 0 || (size_t)offset >= size)
+		{
+			return 0;
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(&fc->processes); i += 2)
+	{
+		const item_t offset = vector_get(&fc->processes, i + 1);
+		if (vector_get(&fc->processes, i) < 0 || offset < 0 || (size_t)offset > size)
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+
+static int buffer_write(fc_buffer *const buffer, const void *const data, const size_t size)
+{
+	if (buffer->size + size > buffer->alloc)
+	{
+		const size_t alloc = 2 * (buffer->size + size);
+		char *const array = realloc(buffer->data, alloc);
+		if (array == NULL)
+		{
+			return -1;
+		}
+
+		buffer->data = array;
+		buffer->alloc = alloc;
+	}
+
+	memcpy(&buffer->data[buffer->size], data, size);
+	buffer->size += size;
+	return 0;
+}
+
+static int buffer_write_size(fc_buffer *const buffer, const size_t size)
+{
+	const uint64_t value = size;
+	return buffer_write(buffer, &value, sizeof(value));
+}
+
+static int buffer_read(fc_buffer *const buffer, void *const data, const size_t size)
+{
+	if (buffer->position + size > buffer->size)
+	{
+		return -1;
+	}
+
+	memcpy(data, &buffer->data[buffer->position], size);
+	buffer->position += size;
+	return 0;
+}
+
+static int buffer_read_size(fc_buffer *const buffer, size_t *const size)
+{
+	uint64_t value;
+	if (buffer_read(buffer, &value, sizeof(value)) || value > MAX_CACHE_VECTOR)
+	{
+		return -1;
+	}
+
+	*size = (size_t)value;
+	return 0;
+}
+
+static int buffer_write_code(fc_buffer *const buffer, function_code *const fc)
+{
+	int ret = buffer_write(buffer, &fc->key, sizeof(fc->key)) || buffer_write_size(buffer, fc->threads);
+	for (size_t i = 0; !ret && i < FC_VECTORS; i++)
+	{
+		const vector *const vec = code_get_vector(fc, i);
+		ret = buffer_write_size(buffer, vector_size(vec))
+			|| buffer_write(buffer, vec->array, vector_size(vec) * sizeof(item_t));
+	}
+
+	return ret;
+}
+
+static int buffer_read_code(fc_buffer *const buffer, function_code *const fc)
+{
+	int ret = buffer_read(buffer, &fc->key, sizeof(fc->key)) || buffer_read_size(buffer, &fc->threads);
+	for (size_t i = 0; !ret && i < FC_VECTORS; i++)
+	{
+		vector *const vec = code_get_vector(fc, i);
+		size_t size;
+		ret = buffer_read_size(buffer, &size) || vector_resize(vec, size)
+			|| buffer_read(buffer, vec->array, size * sizeof(item_t));
+	}
+
+	return ret || !code_is_correct(fc) ? -1 : 0;
+}
+
+
+/** Read whole cache file, checksum is its last word */
+static int cache_read(function_cache *const cache, fc_buffer *const buffer)
+{
+	FILE *const file = fopen(cache->path, "rb");
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	const long size = fseek(file, 0, SEEK_END) == 0 ? ftell(file) : -1;
+	if (size < (long)(sizeof(FC_MAGIC) + 2 * sizeof(uint64_t)) || fseek(file, 0, SEEK_SET) != 0)
+	{
+		fclose(file);
+		return -1;
+	}
+
+	buffer->data = malloc((size_t)size);
+	buffer->size = (size_t)size - sizeof(uint64_t);
+	buffer->alloc = (size_t)size;
+	buffer->position = 0;
+
+	const int ret = buffer->data == NULL || fread(buffer->data, 1, (size_t)size, file) != (size_t)size;
+	fclose(file);
+
+	uint64_t sum = 0;
+	if (!ret)
+	{
+		memcpy(&sum, &buffer->data[buffer->size], sizeof(sum));
+	}
+
+	return ret || sum != hash_bytes(HASH_INIT, buffer->data, buffer->size) ? -1 : 0;
+}
+
+static int cache_load(function_cache *const cache)
+{
+	fc_buffer buffer = { NULL, 0, 0, 0 };
+	char magic[sizeof(FC_MAGIC)];
+	uint64_t width = 0;
+	size_t size = 0;
+
+	int ret = cache_read(cache, &buffer)
+		|| buffer_read(&buffer, magic, sizeof(magic))
+		|| memcmp(magic, FC_MAGIC, sizeof(FC_MAGIC)) != 0
+		|| buffer_read(&buffer, &width, sizeof(width))
+		|| width != sizeof(item_t)
+		|| buffer_read_size(&buffer, &size);
+
+	if (!ret)
+	{
+		cache->entries = malloc(size * sizeof(function_code) + 1);
+		cache->is_found = calloc(size + 1, sizeof(char));
+		ret = cache->entries == NULL || cache->is_found == NULL;
+	}
+
+	for (size_t i = 0; !ret && i < size; i++)
+	{
+		cache->entries[i] = fc_code_create();
+		cache->size++;
+		ret = buffer_read_code(&buffer, &cache->entries[i]);
+	}
+
+	free(buffer.data);
+	return ret ? -1 : 0;
+}
+
+static int cache_index(function_cache *const cache)
+{
+	cache->table_size = 16;
+	while (cache->table_size < 2 * cache->size)
+	{
+		cache->table_size *= 2;
+	}
+
+	cache->table = calloc(cache->table_size, sizeof(size_t));
+	if (cache->table == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < cache->size; i++)
+	{
+		size_t j = (size_t)cache->entries[i].key & (cache->table_size - 1);
+		while (cache->table[j] != 0)
+		{
+			j = (j + 1) & (cache->table_size - 1);
+		}
+
+		cache->table[j] = i + 1;
+	}
+
+	return 0;
+}
+
+static void cache_free_entries(function_cache *const cache)
+{
+	for (size_t i = 0; i < cache->size; i++)
+	{
+		fc_code_clear(&cache->entries[i]);
+	}
+
+	free(cache->entries);
+	free(cache->is_found);
+	free(cache->table);
+
+	cache->entries = NULL;
+	cache->is_found = NULL;
+	cache->table = NULL;
+	cache->size = 0;
+	cache->table_size = 0;
+}
+
+static int cache_is_changed(const function_cache *const cache)
+{
+	if (cache->added_size != 0)
+	{
+		return 1;
+	}
+
+	for (size_t i = 0; i < cache->size; i++)
+	{
+		if (!cache->is_found[i])
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/** Save cache through temporary file, so damaged file is never read */
+static void cache_save(function_cache *const cache)
+{
+	size_t size = cache->added_size;
+	for (size_t i = 0; i < cache->size; i++)
+	{
+		size += cache->is_found[i] ? 1 : 0;
+	}
+
+	fc_buffer buffer = { NULL, 0, 0, 0 };
+	const uint64_t width = sizeof(item_t);
+	int ret = buffer_write(&buffer, FC_MAGIC, sizeof(FC_MAGIC))
+		|| buffer_write(&buffer, &width, sizeof(width))
+		|| buffer_write_size(&buffer, size);
+
+	for (size_t i = 0; !ret && i < cache->size; i++)
+	{
+		ret = cache->is_found[i] ? buffer_write_code(&buffer, &cache->entries[i]) : 0;
+	}
+
+	for (size_t i = 0; !ret && i < cache->added_size; i++)
+	{
+		ret = buffer_write_code(&buffer, &cache->added[i]);
+	}
+
+	const uint64_t sum = ret ? 0 : hash_bytes(HASH_INIT, buffer.data, buffer.size);
+	ret = ret || buffer_write(&buffer, &sum, sizeof(sum));
+
+	char temp[MAX_CACHE_PATH + 4];
+	sprintf(temp, "%s.tmp", cache->path);
+	FILE *const file = ret ? NULL : fopen(temp, "wb");
+	if (file != NULL)
+	{
+		const int was_written = fwrite(buffer.data, 1, buffer.size, file) == buffer.size;
+		if (fclose(file) || !was_written)
+		{
+			remove(temp);
+		}
+		else
+		{
+			remove(cache->path);
+			rename(temp, cache->path);
+		}
+	}
+
+	free(buffer.data);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+function_code fc_code_create()
+{
+	function_code fc;
+	fc.key = 0;
+	fc.tree = vector_create(256);
+
+	fc.code = vector_create(256);
+	fc.addresses = vector_create(64);
+	fc.identifiers = vector_create(16);
+	fc.processes = vector_create(16);
+	fc.threads = 0;
+
+	return fc;
+}
+
+int fc_code_clear(function_code *const fc)
+{
+	if (fc == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < FC_VECTORS; i++)
+	{
+		vector_clear(code_get_vector(fc, i));
+	}
+
+	return 0;
+}
+
+uint64_t fc_hash(uint64_t hash, const item_t *const data, const size_t size)
+{
+	return hash_mix(hash_bytes(hash != 0 ? hash : HASH_INIT, data, size * sizeof(item_t)));
+}
+
+
+function_cache *fc_open(const char *const dir, const char *const name)
+{
+	if (dir == NULL || name == NULL || strlen(dir) >= MAX_ARG_SIZE)
+	{
+		return NULL;
+	}
+
+	function_cache *const cache = malloc(sizeof(function_cache));
+	if (cache == NULL)
+	{
+		return NULL;
+	}
+
+	// Один файл на программу, чтобы не открывать файл на каждую функцию
+	const uint64_t key = hash_mix(hash_bytes(HASH_INIT, name, strlen(name)));
+	sprintf(cache->path, "%s/%016" PRIx64 ".fc", dir, key);
+
+	cache->entries = NULL;
+	cache->is_found = NULL;
+	cache->size = 0;
+	cache->table = NULL;
+	cache->table_size = 0;
+
+	cache->added = NULL;
+	cache->added_size = 0;
+	cache->added_alloc = 0;
+
+	if (cache_load(cache) || cache_index(cache))
+	{
+		cache_free_entries(cache);
+	}
+
+	return cache;
+}
+
+const function_code *fc_find(function_cache *const cache, const function_code *const fc)
+{
+	if (cache == NULL || fc == NULL || cache->table_size == 0)
+	{
+		return NULL;
+	}
+
+	const size_t span = vector_size(&fc->tree);
+	for (size_t j = (size_t)fc->key & (cache->table_size - 1); cache->table[j] != 0
+		; j = (j + 1) & (cache->table_size - 1))
+	{
+		const size_t index = cache->table[j] - 1;
+		const function_code *const entry = &cache->entries[index];
+
+		// Совпадение отпечатка проверяется полным сравнением участка дерева
+		if (entry->key == fc->key && vector_size(&entry->tree) == span
+			&& memcmp(entry->tree.array, fc->tree.array, span * sizeof(item_t)) == 0)
+		{
+			cache->is_found[index] = 1;
+			return entry;
+		}
+	}
+
+	return NULL;
+}
+
+int fc_add(function_cache *const cache, function_code *const fc)
+{
+	if (cache == NULL || fc == NULL)
+	{
+		return -1;
+	}
+
+	if (cache->added_size == cache->added_alloc)
+	{
+		const size_t alloc = cache->added_alloc != 0 ? 2 * cache->added_alloc : 64;
+		function_code *const added = realloc(cache->added, alloc * sizeof(function_code));
+		if (added == NULL)
+		{
+			fc_code_clear(fc);
+			return -1;
+		}
+
+		cache->added = added;
+		cache->added_alloc = alloc;
+	}
+
+	cache->added[cache->added_size++] = *fc;
+	return 0;
+}
+
+void fc_close(function_cache *const cache)
+{
+	if (cache == NULL)
+	{
+		return;
+	}
+
+	if (cache_is_changed(cache))
+	{
+		cache_save(cache);
+	}
+
+	for (size_t i = 0; i < cache->added_size; i++)
+	{
+		fc_code_clear(&cache->added[i]);
+	}
+
+	cache_free_entries(cache);
+	free(cache->added);
+	free(cache);
+}
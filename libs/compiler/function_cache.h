@@ -0,0 +1,114 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "vector.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Emitted code of function */
+typedef struct function_code
+{
+	uint64_t key;				/**< Fingerprint of function */
+	vector tree;				/**< Tree span of function with references made independent of other functions */
+
+	vector code;				/**< Code, addresses are relative to function start */
+	vector addresses;			/**< Offsets of addresses in code */
+	vector identifiers;			/**< Offsets of compressed identifiers in code, in order of tree */
+	vector processes;			/**< Init processes by pairs: process, offset in code */
+	size_t threads;				/**< Number of created threads */
+} function_code;
+
+/** Emitted functions of program, which are kept between runs */
+typedef struct function_cache function_cache;
+
+
+/**
+ *	Create empty function code
+ *
+ *	@return	Function code
+ */
+function_code fc_code_create();
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	fc			Function code
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int fc_code_clear(function_code *const fc);
+
+/**
+ *	Add items to fingerprint
+ *
+ *	@param	hash		Fingerprint, @c 0 to start a new one
+ *	@param	data		Items
+ *	@param	size		Number of items
+ *
+ *	@return	Fingerprint
+ */
+uint64_t fc_hash(uint64_t hash, const item_t *const data, const size_t size);
+
+
+/**
+ *	Open cache of program functions, damaged cache is ignored
+ *
+ *	@param	dir			Cache directory
+ *	@param	name		Program name, usually output path
+ *
+ *	@return	Function cache, @c NULL on failure
+ */
+function_cache *fc_open(const char *const dir, const char *const name);
+
+/**
+ *	Find function code with the same fingerprint and tree span,
+ *	found code is kept in cache on close
+ *
+ *	@param	cache		Function cache
+ *	@param	fc			Function code with fingerprint and tree span
+ *
+ *	@return	Cached function code, @c NULL if absent
+ */
+const function_code *fc_find(function_cache *const cache, const function_code *const fc);
+
+/**
+ *	Add function code to cache, cache takes its memory
+ *
+ *	@param	cache		Function cache
+ *	@param	fc			Function code
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int fc_add(function_cache *const cache, function_code *const fc);
+
+/**
+ *	Save found and added function codes, if they changed, and free allocated memory.
+ *	Cache is optional, so write errors are ignored.
+ *
+ *	@param	cache		Function cache
+ */
+void fc_close(function_cache *const cache);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
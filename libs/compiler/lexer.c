@@ -17,6 +17,7 @@
 #include "lexer.h"
 #include <math.h>
 #include "errors.h"
+#include "profiler.h"
 #include "uniscanner.h"
 
 
@@ -353,13 +354,9 @@ char32_t get_char(lexer *const lxr)
 	return lxr->curr_char;
 }
 
-token_t lex(lexer *const lxr)
+/** Lex next token, comments are skipped by recursion */
+static token_t lex_token(lexer *const lxr)
 {
-	if (lxr == NULL)
-	{
-		return eof;
-	}
-
 	skip_whitespace(lxr);
 	switch (lxr->curr_char)
 	{
@@ -378,7 +375,7 @@ token_t lex(lexer *const lxr)
 				lexer_error(lxr, bad_character, lxr->curr_char);
 				// Pretending the character didn't exist
 				get_char(lxr);
-				return lex(lxr);
+				return lex_token(lxr);
 			}
 
 		// Integer Constants [C99 6.4.4.1]
@@ -624,14 +621,33 @@ token_t lex(lexer *const lxr)
 				// Comments [C99 6.4.9]
 				case '/':
 					skip_line_comment(lxr);
-					return lex(lxr);
+					return lex_token(lxr);
 
 				case '*':
 					skip_block_comment(lxr);
-					return lex(lxr);
+					return lex_token(lxr);
 
 				default:
 					return slash;
 			}
 	}
 }
+
+token_t lex(lexer *const lxr)
+{
+	if (lxr == NULL)
+	{
+		return eof;
+	}
+
+	prof_count(COUNTER_TOKENS, 1);
+	if (!prof_sample_begin(PHASE_LEXER))
+	{
+		return lex_token(lxr);
+	}
+
+	// Замер времени каждого токена стоил бы больше самого лексера
+	const token_t token = lex_token(lxr);
+	prof_sample_end();
+	return token;
+}
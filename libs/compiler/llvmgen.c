@@ -0,0 +1,4066 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "llvmgen.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "defs.h"
+#include "errors.h"
+#include "tree.h"
+#include "uniprinter.h"
+#include "utf8.h"
+
+
+#define MAX_OPERAND_SIZE	32
+#define MAX_INLINE_WORDS	4
+
+#define STACK_SIZE			(1 << 22)
+#define STACK_RESERVE		256
+#define FRAME_SIZE			3
+
+
+/** Runtime support shared by all modules, mirrors virtual machine semantics */
+static const char *const RUNTIME[] =
+{
+	"@sp = internal global i32 0",
+	"@hp = internal global i32 0",
+	"",
+	"@ruc.format.int = private constant [3 x i8] c\"%i\\00\"",
+	"@ruc.format.float = private constant [3 x i8] c\"%f\\00\"",
+	"@ruc.format.string = private constant [3 x i8] c\"%s\\00\"",
+	"@ruc.format.double = private constant [4 x i8] c\"%lf\\00\"",
+	"@ruc.format.space = private constant [2 x i8] c\" \\00\"",
+	"@ruc.format.newline = private constant [2 x i8] c\"\\0A\\00\"",
+	"@ruc.format.begin = private constant [2 x i8] c\"{\\00\"",
+	"@ruc.format.end = private constant [2 x i8] c\"}\\00\"",
+	"@ruc.format.comma = private constant [3 x i8] c\", \\00\"",
+	"",
+	"declare i32 @printf(ptr, ...)",
+	"declare i32 @dprintf(i32, ptr, ...)",
+	"declare i32 @scanf(ptr, ...)",
+	"declare i32 @fflush(ptr)",
+	"declare i32 @rand()",
+	"declare i32 @getchar()",
+	"declare void @exit(i32) noreturn",
+	"declare double @asin(double)",
+	"declare double @llvm.fabs.f64(double)",
+	"declare double @llvm.sqrt.f64(double)",
+	"declare double @llvm.exp.f64(double)",
+	"declare double @llvm.sin.f64(double)",
+	"declare double @llvm.cos.f64(double)",
+	"declare double @llvm.log.f64(double)",
+	"declare double @llvm.log10.f64(double)",
+	"declare double @llvm.round.f64(double)",
+	"declare void @llvm.memmove.p0.p0.i32(ptr, ptr, i32, i1)",
+	"declare void @llvm.memcpy.p0.p0.i32(ptr, ptr, i32, i1)",
+	"declare void @llvm.memset.p0.i32(ptr, i8, i32, i1)",
+	"",
+	"define internal void @ruc.fail(ptr %format, i32 %fst, i32 %snd) noreturn {",
+	"entry:",
+	"\t%flush = call i32 @fflush(ptr null)",
+	"\t%prefix = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr @ruc.message.error)",
+	"\t%message = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr %format, i32 %fst, i32 %snd)",
+	"\t%newline = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr @ruc.format.newline)",
+	"\tcall void @exit(i32 1)",
+	"\tunreachable",
+	"}",
+	"",
+	"define internal void @ruc.fail.double(ptr %format, double %value) noreturn {",
+	"entry:",
+	"\t%flush = call i32 @fflush(ptr null)",
+	"\t%prefix = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr @ruc.message.error)",
+	"\t%message = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr %format, double %value)",
+	"\t%newline = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr @ruc.format.newline)",
+	"\tcall void @exit(i32 1)",
+	"\tunreachable",
+	"}",
+	"",
+	"define internal void @ruc.enter(i32 %top) {",
+	"entry:",
+	"\t%hp = load i32, ptr @hp",
+	"\t%guard = sub i32 %hp, 256",
+	"\t%overflow = icmp sge i32 %top, %guard",
+	"\tbr i1 %overflow, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.stack, i32 0, i32 0)",
+	"\tunreachable",
+	"done:",
+	"\tstore i32 %top, ptr @sp",
+	"\tret void",
+	"}",
+	"",
+	"define internal i32 @ruc.push(i32 %length) {",
+	"entry:",
+	"\t%sp = load i32, ptr @sp",
+	"\t%top = add i32 %sp, %length",
+	"\t%hp = load i32, ptr @hp",
+	"\t%guard = sub i32 %hp, 256",
+	"\t%overflow = icmp sge i32 %top, %guard",
+	"\tbr i1 %overflow, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.stack, i32 0, i32 0)",
+	"\tunreachable",
+	"done:",
+	"\tstore i32 %top, ptr @sp",
+	"\t%address = add i32 %sp, 1",
+	"\tret i32 %address",
+	"}",
+	"",
+	"define internal i32 @ruc.allocate(i32 %bound, i32 %cell) {",
+	"entry:",
+	"\t%negative = icmp slt i32 %bound, 0",
+	"\tbr i1 %negative, label %fail.negative, label %reserve",
+	"fail.negative:",
+	"\tcall void @ruc.fail(ptr @ruc.message.negative, i32 %bound, i32 0)",
+	"\tunreachable",
+	"reserve:",
+	"\t%bound.long = sext i32 %bound to i64",
+	"\t%cell.long = sext i32 %cell to i64",
+	"\t%cells = mul i64 %bound.long, %cell.long",
+	"\t%sp = load i32, ptr @sp",
+	"\t%sp.long = sext i32 %sp to i64",
+	"\t%data = add i64 %sp.long, %cells",
+	"\t%top.long = add i64 %data, 1",
+	"\t%hp = load i32, ptr @hp",
+	"\t%guard = sub i32 %hp, 256",
+	"\t%guard.long = sext i32 %guard to i64",
+	"\t%overflow = icmp sge i64 %top.long, %guard.long",
+	"\tbr i1 %overflow, label %fail.stack, label %done",
+	"fail.stack:",
+	"\tcall void @ruc.fail(ptr @ruc.message.stack, i32 0, i32 0)",
+	"\tunreachable",
+	"done:",
+	"\t%header = add i32 %sp, 1",
+	"\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header",
+	"\tstore i32 %bound, ptr %header.ptr",
+	"\t%address = add i32 %sp, 2",
+	"\t%address.ptr = getelementptr inbounds i32, ptr @mem, i32 %address",
+	"\t%cells.short = trunc i64 %cells to i32",
+	"\t%bytes = shl i32 %cells.short, 2",
+	"\tcall void @llvm.memset.p0.i32(ptr %address.ptr, i8 0, i32 %bytes, i1 false)",
+	"\t%top = trunc i64 %top.long to i32",
+	"\tstore i32 %top, ptr @sp",
+	"\tret i32 %address",
+	"}",
+	"",
+	"define internal i32 @ruc.initialize(i32 %count, i32 %declared, i32 %cell) {",
+	"entry:",
+	"\t%is_declared = icmp sge i32 %declared, 0",
+	"\t%bound = select i1 %is_declared, i32 %declared, i32 %count",
+	"\t%long = icmp sgt i32 %count, %bound",
+	"\tbr i1 %long, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.initializer, i32 %count, i32 %bound)",
+	"\tunreachable",
+	"done:",
+	"\t%address = call i32 @ruc.allocate(i32 %bound, i32 %cell)",
+	"\tret i32 %address",
+	"}",
+	"",
+	"define internal i32 @ruc.array(ptr %bounds, i32 %dimensions, i32 %length) {",
+	"entry:",
+	"\t%bound = load i32, ptr %bounds",
+	"\t%is_last = icmp sle i32 %dimensions, 1",
+	"\t%cell = select i1 %is_last, i32 %length, i32 1",
+	"\t%address = call i32 @ruc.allocate(i32 %bound, i32 %cell)",
+	"\tbr i1 %is_last, label %done, label %rows",
+	"rows:",
+	"\t%next = getelementptr inbounds i32, ptr %bounds, i32 1",
+	"\t%rest = sub i32 %dimensions, 1",
+	"\tcall void @ruc.array.rows(i32 %address, i32 0, i32 %bound, ptr %next, i32 %rest, i32 %length)",
+	"\tbr label %done",
+	"done:",
+	"\tret i32 %address",
+	"}",
+	"",
+	"define internal void @ruc.array.rows(i32 %address, i32 %from, i32 %to, ptr %bounds, i32 %dimensions, i32 %length) {",
+	"entry:",
+	"\t%empty = icmp sge i32 %from, %to",
+	"\tbr i1 %empty, label %done, label %loop",
+	"loop:",
+	"\t%i = phi i32 [ %from, %entry ], [ %next, %loop ]",
+	"\t%row = call i32 @ruc.array(ptr %bounds, i32 %dimensions, i32 %length)",
+	"\t%cell = add i32 %address, %i",
+	"\t%cell.ptr = getelementptr inbounds i32, ptr @mem, i32 %cell",
+	"\tstore i32 %row, ptr %cell.ptr",
+	"\t%next = add i32 %i, 1",
+	"\t%more = icmp slt i32 %next, %to",
+	"\tbr i1 %more, label %loop, label %done",
+	"done:",
+	"\tret void",
+	"}",
+	"",
+	"define internal void @ruc.array.each(i32 %array, i32 %dimensions, i32 %length, ptr %procedure, i32 %l) {",
+	"entry:",
+	"\t%header = sub i32 %array, 1",
+	"\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header",
+	"\t%bound = load i32, ptr %header.ptr",
+	"\t%is_last = icmp eq i32 %dimensions, 1",
+	"\t%rest = sub i32 %dimensions, 1",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 0, %entry ], [ %next, %step ]",
+	"\t%more = icmp slt i32 %i, %bound",
+	"\tbr i1 %more, label %body, label %done",
+	"body:",
+	"\tbr i1 %is_last, label %element, label %row",
+	"element:",
+	"\t%offset = mul i32 %i, %length",
+	"\t%address = add i32 %array, %offset",
+	"\tcall void %procedure(i32 %address, i32 %l)",
+	"\tbr label %step",
+	"row:",
+	"\t%cell = add i32 %array, %i",
+	"\t%cell.ptr = getelementptr inbounds i32, ptr @mem, i32 %cell",
+	"\t%nested = load i32, ptr %cell.ptr",
+	"\tcall void @ruc.array.each(i32 %nested, i32 %rest, i32 %length, ptr %procedure, i32 %l)",
+	"\tbr label %step",
+	"step:",
+	"\t%next = add i32 %i, 1",
+	"\tbr label %loop",
+	"done:",
+	"\tret void",
+	"}",
+	"",
+	"define internal i32 @ruc.heap(i32 %size) {",
+	"entry:",
+	"\t%hp = load i32, ptr @hp",
+	"\t%sp = load i32, ptr @sp",
+	"\t%block = sub i32 %hp, %size",
+	"\t%guard = sub i32 %block, 256",
+	"\t%overflow = icmp sle i32 %guard, %sp",
+	"\tbr i1 %overflow, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.stack, i32 0, i32 0)",
+	"\tunreachable",
+	"done:",
+	"\tstore i32 %block, ptr @hp",
+	"\t%block.ptr = getelementptr inbounds i32, ptr @mem, i32 %block",
+	"\t%bytes = shl i32 %size, 2",
+	"\tcall void @llvm.memset.p0.i32(ptr %block.ptr, i8 0, i32 %bytes, i1 false)",
+	"\tret i32 %block",
+	"}",
+	"",
+	"define internal i32 @ruc.index(i32 %array, i32 %index, i32 %size) {",
+	"entry:",
+	"\t%null = icmp sle i32 %array, 0",
+	"\tbr i1 %null, label %fail.null, label %check",
+	"fail.null:",
+	"\tcall void @ruc.fail(ptr @ruc.message.index, i32 %index, i32 0)",
+	"\tunreachable",
+	"check:",
+	"\t%header = sub i32 %array, 1",
+	"\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header",
+	"\t%bound = load i32, ptr %header.ptr",
+	"\t%outside = icmp uge i32 %index, %bound",
+	"\tbr i1 %outside, label %fail.range, label %done",
+	"fail.range:",
+	"\tcall void @ruc.fail(ptr @ruc.message.index, i32 %index, i32 %bound)",
+	"\tunreachable",
+	"done:",
+	"\t%offset = mul i32 %index, %size",
+	"\t%address = add i32 %array, %offset",
+	"\tret i32 %address",
+	"}",
+	"",
+	"define internal i32 @ruc.div(i32 %fst, i32 %snd) {",
+	"entry:",
+	"\t%zero = icmp eq i32 %snd, 0",
+	"\tbr i1 %zero, label %fail, label %check",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.zero, i32 0, i32 0)",
+	"\tunreachable",
+	"check:",
+	"\t%minus = icmp eq i32 %snd, -1",
+	"\tbr i1 %minus, label %negate, label %divide",
+	"negate:",
+	"\t%negated = sub i32 0, %fst",
+	"\tret i32 %negated",
+	"divide:",
+	"\t%result = sdiv i32 %fst, %snd",
+	"\tret i32 %result",
+	"}",
+	"",
+	"define internal i32 @ruc.rem(i32 %fst, i32 %snd) {",
+	"entry:",
+	"\t%zero = icmp eq i32 %snd, 0",
+	"\tbr i1 %zero, label %fail, label %check",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.zero, i32 0, i32 0)",
+	"\tunreachable",
+	"check:",
+	"\t%minus = icmp eq i32 %snd, -1",
+	"\tbr i1 %minus, label %done, label %divide",
+	"divide:",
+	"\t%result = srem i32 %fst, %snd",
+	"\tret i32 %result",
+	"done:",
+	"\tret i32 0",
+	"}",
+	"",
+	"define internal double @ruc.fdiv(double %fst, double %snd) {",
+	"entry:",
+	"\t%zero = fcmp oeq double %snd, 0.0",
+	"\tbr i1 %zero, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.zero, i32 0, i32 0)",
+	"\tunreachable",
+	"done:",
+	"\t%result = fdiv double %fst, %snd",
+	"\tret double %result",
+	"}",
+	"",
+	"define internal ptr @ruc.function(i32 %number) {",
+	"entry:",
+	"\t%size = load i32, ptr @ruc.functions.size",
+	"\t%outside = icmp uge i32 %number, %size",
+	"\tbr i1 %outside, label %fail, label %check",
+	"check:",
+	"\t%function.ptr = getelementptr inbounds ptr, ptr @ruc.functions, i32 %number",
+	"\t%function = load ptr, ptr %function.ptr",
+	"\t%null = icmp eq ptr %function, null",
+	"\tbr i1 %null, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.function, i32 %number, i32 0)",
+	"\tunreachable",
+	"done:",
+	"\tret ptr %function",
+	"}",
+	"",
+	"define internal void @ruc.utf8(i32 %symbol, ptr %buffer) {",
+	"entry:",
+	"\tstore i8 0, ptr %buffer",
+	"\t%high = and i32 %symbol, -2097152",
+	"\t%invalid = icmp ne i32 %high, 0",
+	"\tbr i1 %invalid, label %done, label %check",
+	"check:",
+	"\t%upper = and i32 %symbol, -128",
+	"\t%is_ascii = icmp eq i32 %upper, 0",
+	"\tbr i1 %is_ascii, label %ascii, label %multi",
+	"ascii:",
+	"\t%byte = trunc i32 %symbol to i8",
+	"\tstore i8 %byte, ptr %buffer",
+	"\t%ascii.end = getelementptr inbounds i8, ptr %buffer, i32 1",
+	"\tstore i8 0, ptr %ascii.end",
+	"\tbr label %done",
+	"multi:",
+	"\t%mask.four = and i32 %symbol, 16515072",
+	"\t%is_four = icmp ne i32 %mask.four, 0",
+	"\t%mask.three = and i32 %symbol, 258048",
+	"\t%is_three = icmp ne i32 %mask.three, 0",
+	"\t%octets.short = select i1 %is_three, i32 3, i32 2",
+	"\t%octets = select i1 %is_four, i32 4, i32 %octets.short",
+	"\t%prefix.short = select i1 %is_three, i32 224, i32 192",
+	"\t%prefix = select i1 %is_four, i32 240, i32 %prefix.short",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 0, %multi ], [ %next, %loop ]",
+	"\t%rest = sub i32 %octets, %i",
+	"\t%rest.less = sub i32 %rest, 1",
+	"\t%shift = mul i32 %rest.less, 6",
+	"\t%bits.all = lshr i32 %symbol, %shift",
+	"\t%bits = and i32 %bits.all, 63",
+	"\t%octet.tail = or i32 %bits, 128",
+	"\t%is_first = icmp eq i32 %i, 0",
+	"\t%octet.prefix = select i1 %is_first, i32 %prefix, i32 0",
+	"\t%octet = or i32 %octet.tail, %octet.prefix",
+	"\t%octet.byte = trunc i32 %octet to i8",
+	"\t%octet.ptr = getelementptr inbounds i8, ptr %buffer, i32 %i",
+	"\tstore i8 %octet.byte, ptr %octet.ptr",
+	"\t%next = add i32 %i, 1",
+	"\t%more = icmp ult i32 %next, %octets",
+	"\tbr i1 %more, label %loop, label %terminate",
+	"terminate:",
+	"\t%end = getelementptr inbounds i8, ptr %buffer, i32 %octets",
+	"\tstore i8 0, ptr %end",
+	"\tbr label %done",
+	"done:",
+	"\tret void",
+	"}",
+	"",
+	"define internal void @ruc.print_char(i32 %symbol) {",
+	"entry:",
+	"\t%buffer = alloca [8 x i8]",
+	"\tcall void @ruc.utf8(i32 %symbol, ptr %buffer)",
+	"\t%printed = call i32 (ptr, ...) @printf(ptr @ruc.format.string, ptr %buffer)",
+	"\tret void",
+	"}",
+	"",
+	"define internal i32 @ruc.string_length(i32 %string) {",
+	"entry:",
+	"\t%header = sub i32 %string, 1",
+	"\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header",
+	"\t%bound = load i32, ptr %header.ptr",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 0, %entry ], [ %next, %step ]",
+	"\t%inside = icmp slt i32 %i, %bound",
+	"\tbr i1 %inside, label %check, label %done",
+	"check:",
+	"\t%cell = add i32 %string, %i",
+	"\t%cell.ptr = getelementptr inbounds i32, ptr @mem, i32 %cell",
+	"\t%symbol = load i32, ptr %cell.ptr",
+	"\t%is_end = icmp eq i32 %symbol, 0",
+	"\tbr i1 %is_end, label %done, label %step",
+	"step:",
+	"\t%next = add i32 %i, 1",
+	"\tbr label %loop",
+	"done:",
+	"\tret i32 %i",
+	"}",
+	"",
+	"define internal void @ruc.print_string(i32 %string) {",
+	"entry:",
+	"\t%low = icmp sle i32 %string, 0",
+	"\t%size = load i32, ptr @ruc.size",
+	"\t%high = icmp sge i32 %string, %size",
+	"\t%invalid = or i1 %low, %high",
+	"\tbr i1 %invalid, label %done, label %start",
+	"start:",
+	"\t%length = call i32 @ruc.string_length(i32 %string)",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 0, %start ], [ %next, %body ]",
+	"\t%more = icmp slt i32 %i, %length",
+	"\tbr i1 %more, label %body, label %done",
+	"body:",
+	"\t%cell = add i32 %string, %i",
+	"\t%cell.ptr = getelementptr inbounds i32, ptr @mem, i32 %cell",
+	"\t%symbol = load i32, ptr %cell.ptr",
+	"\tcall void @ruc.print_char(i32 %symbol)",
+	"\t%next = add i32 %i, 1",
+	"\tbr label %loop",
+	"done:",
+	"\tret void",
+	"}",
+	"",
+	"define internal i32 @ruc.upb(i32 %dimension, i32 %array) {",
+	"entry:",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 0, %entry ], [ %next, %step ]",
+	"\t%current = phi i32 [ %array, %entry ], [ %row, %step ]",
+	"\t%inside = icmp slt i32 %i, %dimension",
+	"\tbr i1 %inside, label %check.array, label %check",
+	"check.array:",
+	"\t%positive = icmp sgt i32 %current, 0",
+	"\tbr i1 %positive, label %check.bound, label %check",
+	"check.bound:",
+	"\t%header = sub i32 %current, 1",
+	"\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header",
+	"\t%bound = load i32, ptr %header.ptr",
+	"\t%nonempty = icmp sgt i32 %bound, 0",
+	"\tbr i1 %nonempty, label %step, label %check",
+	"step:",
+	"\t%row.ptr = getelementptr inbounds i32, ptr @mem, i32 %current",
+	"\t%row = load i32, ptr %row.ptr",
+	"\t%next = add i32 %i, 1",
+	"\tbr label %loop",
+	"check:",
+	"\t%negative = icmp slt i32 %dimension, 0",
+	"\t%null = icmp sle i32 %current, 0",
+	"\t%invalid = or i1 %negative, %null",
+	"\tbr i1 %invalid, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.dimension, i32 %dimension, i32 0)",
+	"\tunreachable",
+	"done:",
+	"\t%result.cell = sub i32 %current, 1",
+	"\t%result.ptr = getelementptr inbounds i32, ptr @mem, i32 %result.cell",
+	"\t%result = load i32, ptr %result.ptr",
+	"\tret i32 %result",
+	"}",
+	"",
+	"define internal void @ruc.assert(i32 %condition, i32 %string) {",
+	"entry:",
+	"\t%buffer = alloca [8 x i8]",
+	"\t%holds = icmp ne i32 %condition, 0",
+	"\tbr i1 %holds, label %done, label %fail",
+	"fail:",
+	"\t%flush = call i32 @fflush(ptr null)",
+	"\t%prefix = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr @ruc.message.error)",
+	"\t%length = call i32 @ruc.string_length(i32 %string)",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 0, %fail ], [ %next, %body ]",
+	"\t%more = icmp slt i32 %i, %length",
+	"\tbr i1 %more, label %body, label %exit",
+	"body:",
+	"\t%cell = add i32 %string, %i",
+	"\t%cell.ptr = getelementptr inbounds i32, ptr @mem, i32 %cell",
+	"\t%symbol = load i32, ptr %cell.ptr",
+	"\tcall void @ruc.utf8(i32 %symbol, ptr %buffer)",
+	"\t%printed = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr @ruc.format.string, ptr %buffer)",
+	"\t%next = add i32 %i, 1",
+	"\tbr label %loop",
+	"exit:",
+	"\t%newline = call i32 (i32, ptr, ...) @dprintf(i32 2, ptr @ruc.format.newline)",
+	"\tcall void @exit(i32 1)",
+	"\tunreachable",
+	"done:",
+	"\tret void",
+	"}",
+	"",
+	"define internal double @ruc.sqrt(double %value) {",
+	"entry:",
+	"\t%invalid = fcmp olt double %value, 0.0",
+	"\tbr i1 %invalid, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail.double(ptr @ruc.message.sqrt, double %value)",
+	"\tunreachable",
+	"done:",
+	"\t%result = call double @llvm.sqrt.f64(double %value)",
+	"\tret double %result",
+	"}",
+	"",
+	"define internal double @ruc.log(double %value) {",
+	"entry:",
+	"\t%invalid = fcmp ole double %value, 0.0",
+	"\tbr i1 %invalid, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail.double(ptr @ruc.message.log, double %value)",
+	"\tunreachable",
+	"done:",
+	"\t%result = call double @llvm.log.f64(double %value)",
+	"\tret double %result",
+	"}",
+	"",
+	"define internal double @ruc.log10(double %value) {",
+	"entry:",
+	"\t%invalid = fcmp ole double %value, 0.0",
+	"\tbr i1 %invalid, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail.double(ptr @ruc.message.log10, double %value)",
+	"\tunreachable",
+	"done:",
+	"\t%result = call double @llvm.log10.f64(double %value)",
+	"\tret double %result",
+	"}",
+	"",
+	"define internal double @ruc.asin(double %value) {",
+	"entry:",
+	"\t%low = fcmp olt double %value, -1.0",
+	"\t%high = fcmp ogt double %value, 1.0",
+	"\t%invalid = or i1 %low, %high",
+	"\tbr i1 %invalid, label %fail, label %done",
+	"fail:",
+	"\tcall void @ruc.fail.double(ptr @ruc.message.asin, double %value)",
+	"\tunreachable",
+	"done:",
+	"\t%result = call double @asin(double %value)",
+	"\tret double %result",
+	"}",
+	"",
+	"define internal i32 @ruc.round(double %value) {",
+	"entry:",
+	"\t%rounded = call double @llvm.round.f64(double %value)",
+	"\t%low = fcmp oge double %rounded, -2147483648.0",
+	"\t%high = fcmp ole double %rounded, 2147483647.0",
+	"\t%inside = and i1 %low, %high",
+	"\tbr i1 %inside, label %done, label %fail",
+	"fail:",
+	"\tcall void @ruc.fail.double(ptr @ruc.message.round, double %rounded)",
+	"\tunreachable",
+	"done:",
+	"\t%result = fptosi double %rounded to i32",
+	"\tret i32 %result",
+	"}",
+	"",
+	"define internal double @ruc.rand() {",
+	"entry:",
+	"\t%value = call i32 @rand()",
+	"\t%widened = sitofp i32 %value to double",
+	"\t%result = fdiv double %widened, 2147483648.0",
+	"\tret double %result",
+	"}",
+	"",
+	"define internal void @ruc.strcpy(i32 %pointer, i32 %source, i32 %count, i32 %append) {",
+	"entry:",
+	"\t%pointer.ptr = getelementptr inbounds i32, ptr @mem, i32 %pointer",
+	"\t%destination = load i32, ptr %pointer.ptr",
+	"\t%is_append = icmp ne i32 %append, 0",
+	"\tbr i1 %is_append, label %prefix, label %length",
+	"prefix:",
+	"\t%prefix.value = call i32 @ruc.string_length(i32 %destination)",
+	"\tbr label %length",
+	"length:",
+	"\t%prefix.length = phi i32 [ 0, %entry ], [ %prefix.value, %prefix ]",
+	"\t%source.length = call i32 @ruc.string_length(i32 %source)",
+	"\t%is_limited = icmp sge i32 %count, 0",
+	"\t%is_shorter = icmp slt i32 %count, %source.length",
+	"\t%is_cut = and i1 %is_limited, %is_shorter",
+	"\t%copied = select i1 %is_cut, i32 %count, i32 %source.length",
+	"\t%total = add i32 %prefix.length, %copied",
+	"\t%header = sub i32 %destination, 1",
+	"\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header",
+	"\t%capacity = load i32, ptr %header.ptr",
+	"\t%is_small = icmp sgt i32 %total, %capacity",
+	"\tbr i1 %is_small, label %allocate, label %copy",
+	"allocate:",
+	"\t%block.size = add i32 %total, 1",
+	"\t%block = call i32 @ruc.heap(i32 %block.size)",
+	"\t%block.ptr = getelementptr inbounds i32, ptr @mem, i32 %block",
+	"\tstore i32 %total, ptr %block.ptr",
+	"\t%moved = add i32 %block, 1",
+	"\t%moved.ptr = getelementptr inbounds i32, ptr @mem, i32 %moved",
+	"\t%old.ptr = getelementptr inbounds i32, ptr @mem, i32 %destination",
+	"\t%prefix.bytes = shl i32 %prefix.length, 2",
+	"\tcall void @llvm.memmove.p0.p0.i32(ptr %moved.ptr, ptr %old.ptr, i32 %prefix.bytes, i1 false)",
+	"\tbr label %copy",
+	"copy:",
+	"\t%result = phi i32 [ %destination, %length ], [ %moved, %allocate ]",
+	"\t%target = add i32 %result, %prefix.length",
+	"\t%target.ptr = getelementptr inbounds i32, ptr @mem, i32 %target",
+	"\t%source.ptr = getelementptr inbounds i32, ptr @mem, i32 %source",
+	"\t%bytes = shl i32 %copied, 2",
+	"\tcall void @llvm.memmove.p0.p0.i32(ptr %target.ptr, ptr %source.ptr, i32 %bytes, i1 false)",
+	"\t%result.header = sub i32 %result, 1",
+	"\t%result.header.ptr = getelementptr inbounds i32, ptr @mem, i32 %result.header",
+	"\t%result.capacity = load i32, ptr %result.header.ptr",
+	"\t%has_room = icmp slt i32 %total, %result.capacity",
+	"\tbr i1 %has_room, label %terminate, label %done",
+	"terminate:",
+	"\t%end = add i32 %result, %total",
+	"\t%end.ptr = getelementptr inbounds i32, ptr @mem, i32 %end",
+	"\tstore i32 0, ptr %end.ptr",
+	"\tbr label %done",
+	"done:",
+	"\tstore i32 %result, ptr %pointer.ptr",
+	"\tret void",
+	"}",
+	"",
+	"define internal i32 @ruc.strcmp(i32 %fst, i32 %snd, i32 %count) {",
+	"entry:",
+	"\t%fst.length = call i32 @ruc.string_length(i32 %fst)",
+	"\t%snd.length = call i32 @ruc.string_length(i32 %snd)",
+	"\t%is_unlimited = icmp slt i32 %count, 0",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 0, %entry ], [ %next, %step ]",
+	"\t%is_inside = icmp slt i32 %i, %count",
+	"\t%more = or i1 %is_unlimited, %is_inside",
+	"\tbr i1 %more, label %body, label %equal",
+	"body:",
+	"\t%fst.cell = add i32 %fst, %i",
+	"\t%fst.ptr = getelementptr inbounds i32, ptr @mem, i32 %fst.cell",
+	"\t%fst.load = load i32, ptr %fst.ptr",
+	"\t%fst.in = icmp slt i32 %i, %fst.length",
+	"\t%fst.char = select i1 %fst.in, i32 %fst.load, i32 0",
+	"\t%snd.cell = add i32 %snd, %i",
+	"\t%snd.ptr = getelementptr inbounds i32, ptr @mem, i32 %snd.cell",
+	"\t%snd.load = load i32, ptr %snd.ptr",
+	"\t%snd.in = icmp slt i32 %i, %snd.length",
+	"\t%snd.char = select i1 %snd.in, i32 %snd.load, i32 0",
+	"\t%differ = icmp ne i32 %fst.char, %snd.char",
+	"\tbr i1 %differ, label %different, label %same",
+	"different:",
+	"\t%less = icmp slt i32 %fst.char, %snd.char",
+	"\t%result = select i1 %less, i32 -1, i32 1",
+	"\tret i32 %result",
+	"same:",
+	"\t%is_end = icmp eq i32 %fst.char, 0",
+	"\tbr i1 %is_end, label %equal, label %step",
+	"step:",
+	"\t%next = add i32 %i, 1",
+	"\tbr label %loop",
+	"equal:",
+	"\tret i32 0",
+	"}",
+	"",
+	"define internal i32 @ruc.strstr(i32 %string, i32 %substring) {",
+	"entry:",
+	"\t%length = call i32 @ruc.string_length(i32 %string)",
+	"\t%sublength = call i32 @ruc.string_length(i32 %substring)",
+	"\tbr label %outer",
+	"outer:",
+	"\t%i = phi i32 [ 0, %entry ], [ %i.next, %outer.step ]",
+	"\t%end = add i32 %i, %sublength",
+	"\t%fits = icmp sle i32 %end, %length",
+	"\tbr i1 %fits, label %inner, label %missing",
+	"inner:",
+	"\t%j = phi i32 [ 0, %outer ], [ %j.next, %inner.step ]",
+	"\t%more = icmp slt i32 %j, %sublength",
+	"\tbr i1 %more, label %inner.body, label %found",
+	"inner.body:",
+	"\t%position = add i32 %i, %j",
+	"\t%string.cell = add i32 %string, %position",
+	"\t%string.ptr = getelementptr inbounds i32, ptr @mem, i32 %string.cell",
+	"\t%string.char = load i32, ptr %string.ptr",
+	"\t%substring.cell = add i32 %substring, %j",
+	"\t%substring.ptr = getelementptr inbounds i32, ptr @mem, i32 %substring.cell",
+	"\t%substring.char = load i32, ptr %substring.ptr",
+	"\t%equal = icmp eq i32 %string.char, %substring.char",
+	"\tbr i1 %equal, label %inner.step, label %outer.step",
+	"inner.step:",
+	"\t%j.next = add i32 %j, 1",
+	"\tbr label %inner",
+	"outer.step:",
+	"\t%i.next = add i32 %i, 1",
+	"\tbr label %outer",
+	"found:",
+	"\tret i32 %i",
+	"missing:",
+	"\tret i32 -1",
+	"}",
+	"",
+	"define internal void @ruc.scan_char(ptr %value) {",
+	"entry:",
+	"\tbr label %skip",
+	"skip:",
+	"\t%symbol = call i32 @getchar()",
+	"\t%is_space = icmp eq i32 %symbol, 32",
+	"\t%is_tab = icmp eq i32 %symbol, 9",
+	"\t%is_return = icmp eq i32 %symbol, 13",
+	"\t%is_newline = icmp eq i32 %symbol, 10",
+	"\t%is_blank = or i1 %is_space, %is_tab",
+	"\t%is_break = or i1 %is_return, %is_newline",
+	"\t%is_whitespace = or i1 %is_blank, %is_break",
+	"\tbr i1 %is_whitespace, label %skip, label %check",
+	"check:",
+	"\t%is_end = icmp eq i32 %symbol, -1",
+	"\tbr i1 %is_end, label %fail, label %decode",
+	"fail:",
+	"\tcall void @ruc.fail(ptr @ruc.message.input, i32 0, i32 0)",
+	"\tunreachable",
+	"decode:",
+	"\t%mask.two = and i32 %symbol, 224",
+	"\t%is_two = icmp eq i32 %mask.two, 192",
+	"\t%mask.three = and i32 %symbol, 240",
+	"\t%is_three = icmp eq i32 %mask.three, 224",
+	"\t%mask.four = and i32 %symbol, 248",
+	"\t%is_four = icmp eq i32 %mask.four, 240",
+	"\t%size.two = select i1 %is_two, i32 2, i32 1",
+	"\t%size.three = select i1 %is_three, i32 3, i32 %size.two",
+	"\t%size = select i1 %is_four, i32 4, i32 %size.three",
+	"\t%bits.two = select i1 %is_two, i32 31, i32 255",
+	"\t%bits.three = select i1 %is_three, i32 15, i32 %bits.two",
+	"\t%bits = select i1 %is_four, i32 7, i32 %bits.three",
+	"\t%first = and i32 %symbol, %bits",
+	"\tbr label %loop",
+	"loop:",
+	"\t%i = phi i32 [ 1, %decode ], [ %next, %body ]",
+	"\t%result = phi i32 [ %first, %decode ], [ %joined, %body ]",
+	"\t%more = icmp slt i32 %i, %size",
+	"\tbr i1 %more, label %body, label %done",
+	"body:",
+	"\t%octet = call i32 @getchar()",
+	"\t%octet.bits = and i32 %octet, 63",
+	"\t%shifted = shl i32 %result, 6",
+	"\t%joined = or i32 %shifted, %octet.bits",
+	"\t%next = add i32 %i, 1",
+	"\tbr label %loop",
+	"done:",
+	"\tstore i32 %result, ptr %value",
+	"\tret void",
+	"}",
+};
+
+/** Runtime messages, same as in virtual machine */
+static const char *const MESSAGES[][2] =
+{
+	{ "error", "ruc: ошибка: " },
+	{ "stack", "переполнение стека" },
+	{ "function", "вызов неописанной функции с номером %i" },
+	{ "zero", "деление на ноль" },
+	{ "index", "индекс %i за пределами массива размера %i" },
+	{ "negative", "отрицательный размер массива %i" },
+	{ "initializer", "в инициализаторе %i элементов, а в массиве только %i" },
+	{ "dimension", "в upb указана несуществующая размерность %i" },
+	{ "sqrt", "аргумент %f функции sqrt вне области определения" },
+	{ "log", "аргумент %f функции log вне области определения" },
+	{ "log10", "аргумент %f функции log10 вне области определения" },
+	{ "asin", "аргумент %f функции asin вне области определения" },
+	{ "round", "результат округления %f не помещается в int" },
+	{ "input", "введённое значение не соответствует типу переменной" },
+};
+
+
+/** Usage flags of variable cells */
+typedef enum CELL
+{
+	cell_used = 0x01,				/**< Cell is referenced by name */
+	cell_int = 0x02,				/**< Cell is used as integer */
+	cell_double = 0x04,				/**< Cell is used as first word of double */
+	cell_shadow = 0x08,				/**< Cell is second word of double */
+	cell_address = 0x10,			/**< Address of variable is taken */
+	cell_memory = 0x20,				/**< Cell must stay in program memory */
+} cell_t;
+
+/** State of function in functions table */
+typedef enum STATE
+{
+	state_unknown,					/**< Function is not used */
+	state_referenced,				/**< Function is called directly */
+	state_defined,					/**< Function has a body */
+} state_t;
+
+/** Kind of compile time operand */
+typedef enum KIND
+{
+	kind_int,						/**< Integer word */
+	kind_double,					/**< Double of two words */
+	kind_block,						/**< Words on program stack */
+} kind_t;
+
+/** Compile time operand, one or more words of virtual machine stack */
+typedef struct operand
+{
+	kind_t kind;					/**< Operand kind */
+	int is_constant;				/**< Set if value is known */
+	int64_t value;					/**< Integer constant or register number */
+	uint64_t bits;					/**< Bits of double constant */
+	size_t length;					/**< Size in words */
+	size_t release;					/**< Register with stack pointer to restore, @c 0 if none */
+	size_t literal;					/**< Position of literal in data section plus one, @c 0 if none */
+} operand;
+
+/** Code unit, a function body or initialization of globals */
+typedef struct unit
+{
+	universal_io io;				/**< Code of unit */
+	vector temps;					/**< Temporary variables: register and type */
+	size_t entry;					/**< Label of first block */
+	int is_terminated;				/**< Set if last block is terminated */
+	int is_procedure;				/**< Set for struct initialization procedure */
+	int has_frame;					/**< Set if unit has frame pointer */
+	struct unit *parent;			/**< Enclosing unit of procedure */
+} unit;
+
+/** LLVM generator environment */
+typedef struct llvm
+{
+	syntax *sx;						/**< Syntax structure */
+
+	universal_io module;			/**< Definitions of module */
+	universal_io constants;			/**< String constants */
+	unit init;						/**< Initialization of globals */
+	unit function;					/**< Current function */
+	unit *current;					/**< Current code unit */
+
+	operand *stack;					/**< Compile time stack */
+	size_t stack_size;				/**< Size of compile time stack */
+	size_t stack_alloc;				/**< Allocated size of compile time stack */
+
+	vector logic;					/**< Stack for logic operations: temporary and end label */
+	vector calls;					/**< Stack of call frames */
+	vector data;					/**< Data section with literals */
+	vector labels;					/**< Labels by identifiers */
+	vector globals;					/**< Flags of global cells */
+	vector global_extents;			/**< Sizes of global variables */
+	vector locals;					/**< Flags of local cells */
+	vector local_extents;			/**< Sizes of local variables */
+	vector functions;				/**< Function states by numbers */
+	vector printers;				/**< Modes with print procedures */
+	vector scanners;				/**< Modes with scan procedures */
+
+	size_t registers;				/**< Number of used registers */
+	size_t blocks;					/**< Number of used labels */
+	size_t strings;					/**< Number of string constants */
+
+	size_t label_break;				/**< Label of break statement */
+	size_t label_continue;			/**< Label of continue statement */
+	size_t label_case;				/**< Label of next case check */
+	operand switch_value;			/**< Value of switch expression */
+
+	item_t function_mode;			/**< Mode of current function */
+	size_t param_words;				/**< Size of parameters of current function */
+
+	int was_error;					/**< Set if error occurred */
+} llvm;
+
+
+static void block(llvm *const gen, node *const nd);
+static void expression(llvm *const gen, node *const nd, const int mode);
+
+static void emit(llvm *const gen, const char *const format, ...)
+	__attribute__((format(printf, 2, 3)));
+
+
+static inline size_t reg(llvm *const gen)
+{
+	return ++gen->registers;
+}
+
+static inline size_t label(llvm *const gen)
+{
+	return ++gen->blocks;
+}
+
+static void unsupported(llvm *const gen, const item_t type)
+{
+	system_error(node_unsupported, (int)type);
+	gen->was_error = 1;
+}
+
+
+static void emit(llvm *const gen, const char *const format, ...)
+{
+	universal_io *const io = &gen->current->io;
+	if (gen->current->is_terminated)
+	{
+		// Недостижимый код получает собственный блок
+		uni_printf(io, "L%zu:\n", label(gen));
+		gen->current->is_terminated = 0;
+	}
+
+	va_list args;
+	va_start(args, format);
+
+	uni_print_string(io, "\t");
+	out_get_func(io)(io, format, args);
+	uni_print_string(io, "\n");
+
+	va_end(args);
+}
+
+static void emit_jump(llvm *const gen, const size_t target)
+{
+	emit(gen, "br label %%L%zu", target);
+	gen->current->is_terminated = 1;
+}
+
+static void emit_label(llvm *const gen, const size_t target)
+{
+	if (!gen->current->is_terminated)
+	{
+		emit_jump(gen, target);
+	}
+
+	uni_printf(&gen->current->io, "L%zu:\n", target);
+	gen->current->is_terminated = 0;
+}
+
+static void emit_terminator(llvm *const gen, const char *const text)
+{
+	emit(gen, "%s", text);
+	gen->current->is_terminated = 1;
+}
+
+static size_t emit_pointer(llvm *const gen, const char *const address)
+{
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = getelementptr inbounds i32, ptr @mem, i32 %s", result, address);
+	return result;
+}
+
+static size_t emit_offset(llvm *const gen, const size_t pointer, const size_t offset)
+{
+	if (offset == 0)
+	{
+		return pointer;
+	}
+
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = getelementptr inbounds i32, ptr %%r%zu, i32 %zu", result, pointer, offset);
+	return result;
+}
+
+static void emit_move(llvm *const gen, const char *const destination, const char *const source, const size_t length)
+{
+	emit(gen, "call void @llvm.memmove.p0.p0.i32(ptr %s, ptr %s, i32 %zu, i1 false)"
+		, destination, source, length * sizeof(int32_t));
+}
+
+/** Создать временную переменную: @c -1 для double, @c 1 для int, иначе массив */
+static size_t temp_create(llvm *const gen, const item_t type)
+{
+	const size_t result = reg(gen);
+	vector_add(&gen->current->temps, (item_t)result);
+	vector_add(&gen->current->temps, type);
+	return result;
+}
+
+
+static operand operand_register(const kind_t kind, const size_t number)
+{
+	operand op = { kind, 0, (int64_t)number, 0, kind == kind_double ? 2 : 1, 0, 0 };
+	return op;
+}
+
+static operand operand_constant(const int64_t value)
+{
+	operand op = { kind_int, 1, (int32_t)value, 0, 1, 0, 0 };
+	return op;
+}
+
+static operand operand_double(const uint64_t bits)
+{
+	operand op = { kind_double, 1, 0, bits, 2, 0, 0 };
+	return op;
+}
+
+static operand operand_block(const size_t address, const size_t length, const size_t release)
+{
+	operand op = { kind_block, 0, (int64_t)address, 0, length, release, 0 };
+	return op;
+}
+
+static const char *operand_text(const operand *const op, char *const buffer)
+{
+	if (!op->is_constant)
+	{
+		sprintf(buffer, "%%r%" PRIi64, op->value);
+	}
+	else if (op->kind == kind_double)
+	{
+		sprintf(buffer, "0x%016" PRIX64, op->bits);
+	}
+	else
+	{
+		sprintf(buffer, "%" PRIi64, op->value);
+	}
+
+	return buffer;
+}
+
+
+static void stack_push(llvm *const gen, const operand op)
+{
+	if (gen->stack_size == gen->stack_alloc)
+	{
+		operand *const stack = realloc(gen->stack, 2 * gen->stack_alloc * sizeof(operand));
+		if (stack == NULL)
+		{
+			gen->was_error = 1;
+			return;
+		}
+
+		gen->stack = stack;
+		gen->stack_alloc *= 2;
+	}
+
+	gen->stack[gen->stack_size++] = op;
+}
+
+static operand stack_pop(llvm *const gen)
+{
+	return gen->stack_size != 0 ? gen->stack[--gen->stack_size] : operand_constant(0);
+}
+
+/** Индекс операнда, с которого начинаются последние @c words слов стека */
+static size_t stack_words(llvm *const gen, const size_t words)
+{
+	size_t index = gen->stack_size;
+	size_t size = 0;
+	while (size < words && index > 0)
+	{
+		size += gen->stack[--index].length;
+	}
+
+	return index;
+}
+
+static void block_release(llvm *const gen, const operand *const op)
+{
+	if (op->kind == kind_block && op->release != 0)
+	{
+		emit(gen, "store i32 %%r%zu, ptr @sp", op->release);
+	}
+}
+
+/** Освободить нижний блок среди операндов, начиная с @c from, и снять их со стека */
+static void stack_release(llvm *const gen, const size_t from)
+{
+	for (size_t i = from; i < gen->stack_size; i++)
+	{
+		if (gen->stack[i].kind == kind_block && gen->stack[i].release != 0)
+		{
+			block_release(gen, &gen->stack[i]);
+			break;
+		}
+	}
+
+	gen->stack_size = from < gen->stack_size ? from : gen->stack_size;
+}
+
+static operand value_int(llvm *const gen, const operand *const op)
+{
+	if (op->kind != kind_block)
+	{
+		return *op;
+	}
+
+	char buffer[MAX_OPERAND_SIZE];
+	const size_t pointer = emit_pointer(gen, operand_text(op, buffer));
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = load i32, ptr %%r%zu", result, pointer);
+	return operand_register(kind_int, result);
+}
+
+static operand value_double(llvm *const gen, const operand *const op)
+{
+	if (op->kind != kind_block)
+	{
+		return *op;
+	}
+
+	char buffer[MAX_OPERAND_SIZE];
+	const size_t pointer = emit_pointer(gen, operand_text(op, buffer));
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = load double, ptr %%r%zu, align 4", result, pointer);
+	return operand_register(kind_double, result);
+}
+
+static operand pop_int(llvm *const gen)
+{
+	const operand op = stack_pop(gen);
+	const operand result = value_int(gen, &op);
+	block_release(gen, &op);
+	return result;
+}
+
+static operand pop_double(llvm *const gen)
+{
+	const operand op = stack_pop(gen);
+	const operand result = value_double(gen, &op);
+	block_release(gen, &op);
+	return result;
+}
+
+
+static inline item_t displ_shift(const item_t displ, const size_t offset)
+{
+	return displ < 0 ? displ - (item_t)offset : displ + (item_t)offset;
+}
+
+static inline size_t cell_index(const item_t displ)
+{
+	return (size_t)(displ < 0 ? -displ : displ);
+}
+
+static void cell_mark(vector *const cells, const size_t index, const item_t flags)
+{
+	if (index >= vector_size(cells))
+	{
+		vector_resize(cells, index + 1);
+	}
+
+	vector_set(cells, index, vector_get(cells, index) | flags);
+}
+
+static void cells_mark(llvm *const gen, const item_t displ, const size_t length, const item_t flags)
+{
+	vector *const cells = displ < 0 ? &gen->globals : &gen->locals;
+	for (size_t i = 0; i < length; i++)
+	{
+		cell_mark(cells, cell_index(displ) + i, flags);
+	}
+}
+
+static void extent_set(llvm *const gen, const item_t displ, const size_t size)
+{
+	vector *const extents = displ < 0 ? &gen->global_extents : &gen->local_extents;
+	const size_t index = cell_index(displ);
+	if (index >= vector_size(extents))
+	{
+		vector_resize(extents, index + 1);
+	}
+
+	vector_set(extents, index, (item_t)size);
+}
+
+/** Имя ячейки переменной: указатель на неё в памяти или на отдельную переменную */
+static const char *cell_name(llvm *const gen, const item_t displ, const item_t flags, char *const buffer)
+{
+	if (gen->current->is_procedure && displ > 0)
+	{
+		// Локальные переменные доступны процедуре только через память
+		cells_mark(gen, displ, (flags & cell_double) ? 2 : 1, cell_memory | cell_used);
+
+		const size_t address = reg(gen);
+		emit(gen, "%%r%zu = add i32 %%l, %" PRIitem, address, displ);
+		sprintf(buffer, "%%r%zu", address);
+		sprintf(buffer, "%%r%zu", emit_pointer(gen, buffer));
+		return buffer;
+	}
+
+	cells_mark(gen, displ, 1, flags | cell_used);
+	if (flags & cell_double)
+	{
+		cells_mark(gen, displ_shift(displ, 1), 1, cell_shadow);
+	}
+
+	sprintf(buffer, displ < 0 ? "@g%zu" : "%%v%zu", cell_index(displ));
+	return buffer;
+}
+
+static operand cell_location(llvm *const gen, const item_t displ)
+{
+	if (displ < 0)
+	{
+		return operand_constant((item_t)cell_index(displ));
+	}
+
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = add i32 %%l, %" PRIitem, result, displ);
+	return operand_register(kind_int, result);
+}
+
+static inline int cell_is_promoted(const item_t flags)
+{
+	return !(flags & cell_memory) && !(flags & cell_int) != !(flags & cell_double);
+}
+
+/** Ячейки, адрес которых не берётся и которые используются одним типом, становятся переменными */
+static void cells_resolve(vector *const cells, const vector *const extents)
+{
+	for (size_t i = 0; i < vector_size(cells); i++)
+	{
+		if (vector_get(cells, i) & cell_address)
+		{
+			const item_t extent = i < vector_size(extents) ? vector_get(extents, i) : 1;
+			for (item_t j = 0; j < extent || j == 0; j++)
+			{
+				cell_mark(cells, i + (size_t)j, cell_memory);
+			}
+		}
+	}
+
+	int was_changed = 1;
+	while (was_changed)
+	{
+		was_changed = 0;
+		for (size_t i = 0; i + 1 < vector_size(cells); i++)
+		{
+			const item_t flags = vector_get(cells, i);
+			const item_t next = vector_get(cells, i + 1);
+
+			if ((flags & cell_double) && ((flags & next & cell_memory) == 0)
+				&& ((flags & (cell_int | cell_shadow | cell_memory)) || (next & (cell_int | cell_double | cell_memory))))
+			{
+				cell_mark(cells, i, cell_memory);
+				cell_mark(cells, i + 1, cell_memory);
+				was_changed = 1;
+			}
+		}
+	}
+}
+
+static operand load_cell(llvm *const gen, const item_t displ, const kind_t kind)
+{
+	char buffer[MAX_OPERAND_SIZE];
+	const size_t result = reg(gen);
+
+	if (kind == kind_double)
+	{
+		emit(gen, "%%r%zu = load double, ptr %s, align 4", result, cell_name(gen, displ, cell_double, buffer));
+	}
+	else
+	{
+		emit(gen, "%%r%zu = load i32, ptr %s", result, cell_name(gen, displ, cell_int, buffer));
+	}
+
+	return operand_register(kind, result);
+}
+
+static void store_cell(llvm *const gen, const item_t displ, const operand *const value)
+{
+	char buffer[MAX_OPERAND_SIZE];
+	char text[MAX_OPERAND_SIZE];
+
+	if (value->kind == kind_double)
+	{
+		emit(gen, "store double %s, ptr %s, align 4", operand_text(value, text)
+			, cell_name(gen, displ, cell_double, buffer));
+	}
+	else
+	{
+		emit(gen, "store i32 %s, ptr %s", operand_text(value, text), cell_name(gen, displ, cell_int, buffer));
+	}
+}
+
+static size_t address_pointer(llvm *const gen, const operand *const address)
+{
+	char buffer[MAX_OPERAND_SIZE];
+	return emit_pointer(gen, operand_text(address, buffer));
+}
+
+/** Записать слова стека, начиная с @c from, в память по адресу */
+static void store_words(llvm *const gen, const size_t from, const operand *const address, const int is_release)
+{
+	const size_t pointer = address_pointer(gen, address);
+	size_t offset = 0;
+	for (size_t i = from; i < gen->stack_size; i++)
+	{
+		offset += gen->stack[i].length;
+	}
+
+	// Запись в обратном порядке не портит блоки, лежащие выше адреса назначения
+	for (size_t i = gen->stack_size; i > from; i--)
+	{
+		const operand *const op = &gen->stack[i - 1];
+		offset -= op->length;
+
+		char text[MAX_OPERAND_SIZE];
+		char target[MAX_OPERAND_SIZE];
+		sprintf(target, "%%r%zu", emit_offset(gen, pointer, offset));
+
+		if (op->kind == kind_block)
+		{
+			char source[MAX_OPERAND_SIZE];
+			sprintf(source, "%%r%zu", address_pointer(gen, op));
+			emit_move(gen, target, source, op->length);
+		}
+		else if (op->kind == kind_double)
+		{
+			emit(gen, "store double %s, ptr %s, align 4", operand_text(op, text), target);
+		}
+		else
+		{
+			emit(gen, "store i32 %s, ptr %s", operand_text(op, text), target);
+		}
+	}
+
+	if (is_release)
+	{
+		stack_release(gen, from);
+	}
+	else
+	{
+		gen->stack_size = from;
+	}
+}
+
+/** Записать слова стека, начиная с @c from, в переменную */
+static void store_cells(llvm *const gen, const size_t from, const item_t displ)
+{
+	size_t offset = 0;
+	for (size_t i = from; i < gen->stack_size; i++)
+	{
+		const operand *const op = &gen->stack[i];
+		const item_t cell = displ_shift(displ, offset);
+
+		if (op->kind == kind_block)
+		{
+			char target[MAX_OPERAND_SIZE];
+			char source[MAX_OPERAND_SIZE];
+			cells_mark(gen, cell, op->length, cell_memory);
+			cell_name(gen, cell, cell_memory, target);
+			sprintf(source, "%%r%zu", address_pointer(gen, op));
+			emit_move(gen, target, source, op->length);
+		}
+		else
+		{
+			store_cell(gen, cell, op);
+		}
+
+		offset += op->length;
+	}
+
+	stack_release(gen, from);
+}
+
+/** Собрать слова стека, начиная с @c from, в один блок на стеке программы */
+static void stack_materialize(llvm *const gen, const size_t from, const size_t words)
+{
+	if (from + 1 == gen->stack_size && gen->stack[from].kind == kind_block)
+	{
+		return;
+	}
+
+	size_t release = 0;
+	for (size_t i = from; i < gen->stack_size && release == 0; i++)
+	{
+		release = gen->stack[i].kind == kind_block ? gen->stack[i].release : 0;
+	}
+
+	const size_t address = reg(gen);
+	emit(gen, "%%r%zu = call i32 @ruc.push(i32 %zu)", address, words);
+	if (release == 0)
+	{
+		release = reg(gen);
+		emit(gen, "%%r%zu = sub i32 %%r%zu, 1", release, address);
+	}
+
+	const operand op = operand_register(kind_int, address);
+	store_words(gen, from, &op, 0);
+	stack_push(gen, operand_block(address, words, release));
+}
+
+/** Положить на стек копию слов памяти */
+static void push_words(llvm *const gen, const operand *const address, const size_t length)
+{
+	if (length <= MAX_INLINE_WORDS)
+	{
+		const size_t pointer = address_pointer(gen, address);
+		for (size_t i = 0; i < length; i++)
+		{
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = load i32, ptr %%r%zu", result, emit_offset(gen, pointer, i));
+			stack_push(gen, operand_register(kind_int, result));
+		}
+		return;
+	}
+
+	const size_t block_address = reg(gen);
+	emit(gen, "%%r%zu = call i32 @ruc.push(i32 %zu)", block_address, length);
+	const size_t release = reg(gen);
+	emit(gen, "%%r%zu = sub i32 %%r%zu, 1", release, block_address);
+
+	char target[MAX_OPERAND_SIZE];
+	char source[MAX_OPERAND_SIZE];
+	sprintf(target, "%%r%zu", emit_pointer(gen, (sprintf(source, "%%r%zu", block_address), source)));
+	sprintf(source, "%%r%zu", address_pointer(gen, address));
+	emit_move(gen, target, source, length);
+
+	stack_push(gen, operand_block(block_address, length, release));
+}
+
+
+static size_t string_constant(llvm *const gen, const char *const string, const size_t length)
+{
+	const size_t number = gen->strings++;
+	uni_printf(&gen->constants, "@ruc.string.%zu = private unnamed_addr constant [%zu x i8] c\"", number, length + 1);
+
+	for (size_t i = 0; i < length; i++)
+	{
+		const unsigned char symbol = (unsigned char)string[i];
+		if (symbol < ' ' || symbol == '"' || symbol == '\\' || symbol >= 0x7F)
+		{
+			uni_printf(&gen->constants, "\\%02X", symbol);
+		}
+		else
+		{
+			uni_printf(&gen->constants, "%c", symbol);
+		}
+	}
+
+	uni_print_string(&gen->constants, "\\00\"\n");
+	return number;
+}
+
+/** Разместить литерал в секции данных */
+static operand literal(llvm *const gen, node *const nd, const item_t type)
+{
+	const item_t N = node_get_arg(nd, 0);
+	vector_add(&gen->data, N);
+	const size_t position = vector_size(&gen->data);
+
+	for (item_t i = 0; i < N; i++)
+	{
+		if (type == TString)
+		{
+			vector_add(&gen->data, node_get_arg(nd, (size_t)i + 1));
+		}
+		else
+		{
+			vector_add(&gen->data, node_get_arg(nd, 2 * (size_t)i + 1));
+			vector_add(&gen->data, node_get_arg(nd, 2 * (size_t)i + 2));
+		}
+	}
+
+	operand op = operand_constant((item_t)((size_t)gen->sx->max_displg + position));
+	op.literal = position;
+	return op;
+}
+
+
+static void function_reference(llvm *const gen, const size_t number)
+{
+	if (number >= vector_size(&gen->functions))
+	{
+		vector_resize(&gen->functions, number + 1);
+	}
+
+	if (vector_get(&gen->functions, number) == state_unknown)
+	{
+		vector_set(&gen->functions, number, state_referenced);
+	}
+}
+
+static const char *return_type(const syntax *const sx, const item_t mode)
+{
+	const item_t type = mode_get(sx, (size_t)mode + 1);
+	if (type == LFLOAT)
+	{
+		return "double";
+	}
+
+	return type == LVOID || (type > 0 && mode_get(sx, (size_t)type) == mode_struct) ? "void" : "i32";
+}
+
+static void helper_request(vector *const helpers, const item_t mode)
+{
+	for (size_t i = 0; i < vector_size(helpers); i++)
+	{
+		if (vector_get(helpers, i) == mode)
+		{
+			return;
+		}
+	}
+
+	vector_add(helpers, mode);
+}
+
+
+static operand int_operation(llvm *const gen, const item_t code, const operand *const fst, const operand *const snd)
+{
+	if (code == ASS)
+	{
+		return *snd;
+	}
+
+	char a[MAX_OPERAND_SIZE];
+	char b[MAX_OPERAND_SIZE];
+	operand_text(fst, a);
+	operand_text(snd, b);
+
+	const char *instruction = NULL;
+	const char *comparison = NULL;
+	switch (code)
+	{
+		case LREM:
+		case LDIV:
+		{
+			const size_t result = reg(gen);
+			if (snd->is_constant && snd->value != 0 && snd->value != -1)
+			{
+				emit(gen, "%%r%zu = %s i32 %s, %s", result, code == LREM ? "srem" : "sdiv", a, b);
+			}
+			else
+			{
+				emit(gen, "%%r%zu = call i32 @ruc.%s(i32 %s, i32 %s)", result, code == LREM ? "rem" : "div", a, b);
+			}
+			return operand_register(kind_int, result);
+		}
+		case LSHL:
+		case LSHR:
+		{
+			const size_t shift = reg(gen);
+			emit(gen, "%%r%zu = and i32 %s, 31", shift, b);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = %s i32 %s, %%r%zu", result, code == LSHL ? "shl" : "ashr", a, shift);
+			return operand_register(kind_int, result);
+		}
+		case LOGAND:
+		case LOGOR:
+		{
+			const size_t lhs = reg(gen);
+			const size_t rhs = reg(gen);
+			const size_t logic = reg(gen);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = icmp ne i32 %s, 0", lhs, a);
+			emit(gen, "%%r%zu = icmp ne i32 %s, 0", rhs, b);
+			emit(gen, "%%r%zu = %s i1 %%r%zu, %%r%zu", logic, code == LOGAND ? "and" : "or", lhs, rhs);
+			emit(gen, "%%r%zu = zext i1 %%r%zu to i32", result, logic);
+			return operand_register(kind_int, result);
+		}
+
+		case LAND:
+			instruction = "and";
+			break;
+		case LEXOR:
+			instruction = "xor";
+			break;
+		case LOR:
+			instruction = "or";
+			break;
+		case LPLUS:
+			instruction = "add";
+			break;
+		case LMINUS:
+			instruction = "sub";
+			break;
+		case LMULT:
+			instruction = "mul";
+			break;
+
+		case EQEQ:
+			comparison = "eq";
+			break;
+		case NOTEQ:
+			comparison = "ne";
+			break;
+		case LLT:
+			comparison = "slt";
+			break;
+		case LGT:
+			comparison = "sgt";
+			break;
+		case LLE:
+			comparison = "sle";
+			break;
+		case LGE:
+			comparison = "sge";
+			break;
+	}
+
+	const size_t result = reg(gen);
+	if (instruction != NULL)
+	{
+		emit(gen, "%%r%zu = %s i32 %s, %s", result, instruction, a, b);
+		return operand_register(kind_int, result);
+	}
+
+	const size_t compared = reg(gen);
+	emit(gen, "%%r%zu = icmp %s i32 %s, %s", result, comparison != NULL ? comparison : "eq", a, b);
+	emit(gen, "%%r%zu = zext i1 %%r%zu to i32", compared, result);
+	return operand_register(kind_int, compared);
+}
+
+static operand double_operation(llvm *const gen, const item_t code, const operand *const fst, const operand *const snd)
+{
+	if (code == ASS)
+	{
+		return *snd;
+	}
+
+	char a[MAX_OPERAND_SIZE];
+	char b[MAX_OPERAND_SIZE];
+	operand_text(fst, a);
+	operand_text(snd, b);
+
+	const size_t result = reg(gen);
+	switch (code)
+	{
+		case LPLUS:
+		case LPLUSR:
+			emit(gen, "%%r%zu = fadd double %s, %s", result, a, b);
+			break;
+		case LMINUS:
+		case LMINUSR:
+			emit(gen, "%%r%zu = fsub double %s, %s", result, a, b);
+			break;
+		case LMULT:
+		case LMULTR:
+			emit(gen, "%%r%zu = fmul double %s, %s", result, a, b);
+			break;
+		case LDIV:
+		case LDIVR:
+			emit(gen, "%%r%zu = call double @ruc.fdiv(double %s, double %s)", result, a, b);
+			break;
+
+		default:
+		{
+			const char *comparison = "oeq";
+			switch (code)
+			{
+				case NOTEQR:
+					comparison = "une";
+					break;
+				case LLTR:
+					comparison = "olt";
+					break;
+				case LGTR:
+					comparison = "ogt";
+					break;
+				case LLER:
+					comparison = "ole";
+					break;
+				case LGER:
+					comparison = "oge";
+					break;
+			}
+
+			const size_t compared = reg(gen);
+			emit(gen, "%%r%zu = fcmp %s double %s, %s", result, comparison, a, b);
+			emit(gen, "%%r%zu = zext i1 %%r%zu to i32", compared, result);
+			return operand_register(kind_int, compared);
+		}
+	}
+
+	return operand_register(kind_double, result);
+}
+
+/** Указатель на изменяемую переменную: по смещению или по адресу со стека */
+static void target_pointer(llvm *const gen, node *const nd, const int is_address, const item_t flags
+	, char *const buffer)
+{
+	if (is_address)
+	{
+		const operand address = pop_int(gen);
+		sprintf(buffer, "%%r%zu", address_pointer(gen, &address));
+	}
+	else
+	{
+		cell_name(gen, node_get_arg(nd, 0), flags, buffer);
+	}
+}
+
+static void int_assignment(llvm *const gen, node *const nd, const item_t operation)
+{
+	static const item_t codes[] = { LREM, LSHL, LSHR, LAND, LEXOR, LOR, ASS, LPLUS, LMINUS, LMULT, LDIV };
+
+	const int is_void = operation >= REMASSV;
+	const item_t base = is_void ? operation - 200 : operation;
+	const int is_address = base >= REMASSAT;
+	const item_t code = codes[base - (is_address ? REMASSAT : REMASS)];
+
+	const operand value = pop_int(gen);
+	char pointer[MAX_OPERAND_SIZE];
+	target_pointer(gen, nd, is_address, cell_int, pointer);
+
+	operand result = value;
+	if (code != ASS)
+	{
+		const size_t old = reg(gen);
+		emit(gen, "%%r%zu = load i32, ptr %s", old, pointer);
+		const operand op = operand_register(kind_int, old);
+		result = int_operation(gen, code, &op, &value);
+	}
+
+	char text[MAX_OPERAND_SIZE];
+	emit(gen, "store i32 %s, ptr %s", operand_text(&result, text), pointer);
+	if (!is_void)
+	{
+		stack_push(gen, result);
+	}
+}
+
+static void double_assignment(llvm *const gen, node *const nd, const item_t operation)
+{
+	static const item_t codes[] = { ASS, LPLUS, LMINUS, LMULT, LDIV };
+
+	const int is_void = operation >= ASSRV;
+	const item_t base = is_void ? operation - 200 : operation;
+	const int is_address = base >= ASSATR;
+	const item_t code = codes[base - (is_address ? ASSATR : ASSR)];
+
+	const operand value = pop_double(gen);
+	char pointer[MAX_OPERAND_SIZE];
+	target_pointer(gen, nd, is_address, cell_double, pointer);
+
+	operand result = value;
+	if (code != ASS)
+	{
+		const size_t old = reg(gen);
+		emit(gen, "%%r%zu = load double, ptr %s, align 4", old, pointer);
+		const operand op = operand_register(kind_double, old);
+		result = double_operation(gen, code, &op, &value);
+	}
+
+	char text[MAX_OPERAND_SIZE];
+	emit(gen, "store double %s, ptr %s, align 4", operand_text(&result, text), pointer);
+	if (!is_void)
+	{
+		stack_push(gen, result);
+	}
+}
+
+static void increment(llvm *const gen, node *const nd, const item_t operation, const int is_double)
+{
+	const item_t first = is_double ? POSTINCR : POSTINC;
+	const int is_void = operation >= first + 200;
+	const item_t index = (is_void ? operation - 200 : operation) - first;
+	const int is_address = index >= 4;
+	const item_t kind = index % 4;
+	const int is_postfix = kind == 0 || kind == 1;
+	const int is_increment = kind == 0 || kind == 2;
+
+	char pointer[MAX_OPERAND_SIZE];
+	target_pointer(gen, nd, is_address, is_double ? cell_double : cell_int, pointer);
+
+	const size_t old = reg(gen);
+	const size_t result = reg(gen);
+	if (is_double)
+	{
+		emit(gen, "%%r%zu = load double, ptr %s, align 4", old, pointer);
+		emit(gen, "%%r%zu = fadd double %%r%zu, %s", result, old, is_increment ? "1.0" : "-1.0");
+		emit(gen, "store double %%r%zu, ptr %s, align 4", result, pointer);
+	}
+	else
+	{
+		emit(gen, "%%r%zu = load i32, ptr %s", old, pointer);
+		emit(gen, "%%r%zu = add i32 %%r%zu, %i", result, old, is_increment ? 1 : -1);
+		emit(gen, "store i32 %%r%zu, ptr %s", result, pointer);
+	}
+
+	if (!is_void)
+	{
+		stack_push(gen, operand_register(is_double ? kind_double : kind_int, is_postfix ? old : result));
+	}
+}
+
+static void copy(llvm *const gen, node *const nd, const item_t operation)
+{
+	char target[MAX_OPERAND_SIZE];
+	char source[MAX_OPERAND_SIZE];
+
+	switch (operation)
+	{
+		case COPY00:
+		{
+			const item_t length = node_get_arg(nd, 2);
+			cells_mark(gen, node_get_arg(nd, 0), (size_t)length, cell_memory);
+			cells_mark(gen, node_get_arg(nd, 1), (size_t)length, cell_memory);
+			emit_move(gen, cell_name(gen, node_get_arg(nd, 0), cell_memory, target)
+				, cell_name(gen, node_get_arg(nd, 1), cell_memory, source), (size_t)length);
+		}
+		break;
+		case COPY01:
+		case COPY10:
+		{
+			const item_t length = node_get_arg(nd, 1);
+			const operand address = pop_int(gen);
+			cells_mark(gen, node_get_arg(nd, 0), (size_t)length, cell_memory);
+			cell_name(gen, node_get_arg(nd, 0), cell_memory, operation == COPY01 ? target : source);
+			sprintf(operation == COPY01 ? source : target, "%%r%zu", address_pointer(gen, &address));
+			emit_move(gen, target, source, (size_t)length);
+		}
+		break;
+		case COPY11:
+		{
+			const item_t length = node_get_arg(nd, 0);
+			const operand from = pop_int(gen);
+			const operand to = pop_int(gen);
+			sprintf(source, "%%r%zu", address_pointer(gen, &from));
+			sprintf(target, "%%r%zu", address_pointer(gen, &to));
+			emit_move(gen, target, source, (size_t)length);
+		}
+		break;
+		case COPY0ST:
+		{
+			const item_t displ = node_get_arg(nd, 0);
+			const size_t length = (size_t)node_get_arg(nd, 1);
+			if (length <= MAX_INLINE_WORDS)
+			{
+				// Поля короткой структуры читаются по одному
+				for (size_t i = 0; i < length; i++)
+				{
+					stack_push(gen, load_cell(gen, displ_shift(displ, i), kind_int));
+				}
+			}
+			else
+			{
+				cells_mark(gen, displ, length, cell_memory);
+				cell_name(gen, displ, cell_memory, source);
+				const operand op = cell_location(gen, displ);
+				push_words(gen, &op, length);
+			}
+		}
+		break;
+		case COPY1ST:
+		{
+			const operand address = pop_int(gen);
+			push_words(gen, &address, (size_t)node_get_arg(nd, 0));
+		}
+		break;
+		case COPY0STASS:
+		{
+			const size_t from = stack_words(gen, (size_t)node_get_arg(nd, 1));
+			store_cells(gen, from, node_get_arg(nd, 0));
+		}
+		break;
+		case COPY1STASS:
+		{
+			const size_t from = stack_words(gen, (size_t)node_get_arg(nd, 0));
+			if (from == 0)
+			{
+				break;
+			}
+
+			const operand address = value_int(gen, &gen->stack[from - 1]);
+			store_words(gen, from, &address, 1);
+			stack_pop(gen);
+		}
+		break;
+		case COPYST:
+		{
+			const size_t displ = (size_t)node_get_arg(nd, 0);
+			const size_t length = (size_t)node_get_arg(nd, 1);
+			const size_t from = stack_words(gen, (size_t)node_get_arg(nd, 2));
+
+			// Слова вне выбранного поля просто отбрасываются
+			size_t offset = 0;
+			size_t kept = from;
+			int is_aligned = 1;
+			for (size_t i = from; i < gen->stack_size; i++)
+			{
+				const operand *const op = &gen->stack[i];
+				if (op->kind == kind_block
+					|| (offset < displ && offset + op->length > displ)
+					|| (offset < displ + length && offset + op->length > displ + length))
+				{
+					is_aligned = 0;
+				}
+				offset += op->length;
+			}
+
+			if (is_aligned)
+			{
+				offset = 0;
+				const size_t size = gen->stack_size;
+				for (size_t i = from; i < size; i++)
+				{
+					const operand op = gen->stack[i];
+					if (offset >= displ && offset < displ + length)
+					{
+						gen->stack[kept++] = op;
+					}
+					offset += op.length;
+				}
+
+				gen->stack_size = kept;
+				break;
+			}
+
+			stack_materialize(gen, from, (size_t)node_get_arg(nd, 2));
+			operand op = stack_pop(gen);
+			if (displ != 0)
+			{
+				const size_t field = reg(gen);
+				emit(gen, "%%r%zu = add i32 %%r%" PRIi64 ", %zu", field, op.value, displ);
+				op.value = (int64_t)field;
+			}
+
+			op.length = length;
+			stack_push(gen, op);
+		}
+		break;
+	}
+}
+
+static void standard_function(llvm *const gen, const item_t operation)
+{
+	char a[MAX_OPERAND_SIZE];
+	char b[MAX_OPERAND_SIZE];
+	char c[MAX_OPERAND_SIZE];
+
+	switch (operation)
+	{
+		case ABSIC:
+		{
+			const operand value = pop_int(gen);
+			const size_t negated = reg(gen);
+			const size_t is_negative = reg(gen);
+			const size_t result = reg(gen);
+			operand_text(&value, a);
+			emit(gen, "%%r%zu = sub i32 0, %s", negated, a);
+			emit(gen, "%%r%zu = icmp slt i32 %s, 0", is_negative, a);
+			emit(gen, "%%r%zu = select i1 %%r%zu, i32 %%r%zu, i32 %s", result, is_negative, negated, a);
+			stack_push(gen, operand_register(kind_int, result));
+		}
+		break;
+		case ABSC:
+		case SQRTC:
+		case EXPC:
+		case SINC:
+		case COSC:
+		case LOGC:
+		case LOG10C:
+		case ASINC:
+		{
+			const char *function = "llvm.fabs.f64";
+			switch (operation)
+			{
+				case SQRTC:
+					function = "ruc.sqrt";
+					break;
+				case EXPC:
+					function = "llvm.exp.f64";
+					break;
+				case SINC:
+					function = "llvm.sin.f64";
+					break;
+				case COSC:
+					function = "llvm.cos.f64";
+					break;
+				case LOGC:
+					function = "ruc.log";
+					break;
+				case LOG10C:
+					function = "ruc.log10";
+					break;
+				case ASINC:
+					function = "ruc.asin";
+					break;
+			}
+
+			const operand value = pop_double(gen);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = call double @%s(double %s)", result, function, operand_text(&value, a));
+			stack_push(gen, operand_register(kind_double, result));
+		}
+		break;
+		case RANDC:
+		{
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = call double @ruc.rand()", result);
+			stack_push(gen, operand_register(kind_double, result));
+		}
+		break;
+		case ROUNDC:
+		{
+			const operand value = pop_double(gen);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = call i32 @ruc.round(double %s)", result, operand_text(&value, a));
+			stack_push(gen, operand_register(kind_int, result));
+		}
+		break;
+		case STRCPYC:
+		case STRCATC:
+		case STRNCPYC:
+		case STRNCATC:
+		{
+			const int is_limited = operation == STRNCPYC || operation == STRNCATC;
+			const operand count = is_limited ? pop_int(gen) : operand_constant(-1);
+			const operand source = pop_int(gen);
+			const operand pointer = pop_int(gen);
+			emit(gen, "call void @ruc.strcpy(i32 %s, i32 %s, i32 %s, i32 %i)", operand_text(&pointer, a)
+				, operand_text(&source, b), operand_text(&count, c), operation == STRCATC || operation == STRNCATC);
+		}
+		break;
+		case STRCMPC:
+		case STRNCMPC:
+		{
+			const operand count = operation == STRNCMPC ? pop_int(gen) : operand_constant(-1);
+			const operand snd = pop_int(gen);
+			const operand fst = pop_int(gen);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = call i32 @ruc.strcmp(i32 %s, i32 %s, i32 %s)", result, operand_text(&fst, a)
+				, operand_text(&snd, b), operand_text(&count, c));
+			stack_push(gen, operand_register(kind_int, result));
+		}
+		break;
+		case STRSTRC:
+		case UPBC:
+		{
+			const operand snd = pop_int(gen);
+			const operand fst = pop_int(gen);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = call i32 @ruc.%s(i32 %s, i32 %s)", result, operation == UPBC ? "upb" : "strstr"
+				, operand_text(&fst, a), operand_text(&snd, b));
+			stack_push(gen, operand_register(kind_int, result));
+		}
+		break;
+		case STRLENC:
+		{
+			const operand string = pop_int(gen);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = call i32 @ruc.string_length(i32 %s)", result, operand_text(&string, a));
+			stack_push(gen, operand_register(kind_int, result));
+		}
+		break;
+		case ASSERTC:
+		{
+			const operand string = pop_int(gen);
+			const operand condition = pop_int(gen);
+			emit(gen, "call void @ruc.assert(i32 %s, i32 %s)", operand_text(&condition, a), operand_text(&string, b));
+		}
+		break;
+		case ROWING:
+		case ROWINGD:
+		{
+			const int is_double = operation == ROWINGD;
+			const operand value = is_double ? pop_double(gen) : pop_int(gen);
+			const size_t row = reg(gen);
+			const size_t pointer = reg(gen);
+			const size_t result = reg(gen);
+			emit(gen, "%%r%zu = call i32 @ruc.heap(i32 %i)", row, is_double ? 3 : 2);
+			emit(gen, "%%r%zu = getelementptr inbounds i32, ptr @mem, i32 %%r%zu", pointer, row);
+			emit(gen, "store i32 1, ptr %%r%zu", pointer);
+			emit(gen, "%%r%zu = add i32 %%r%zu, 1", result, row);
+			emit(gen, "store %s %s, ptr %%r%zu%s", is_double ? "double" : "i32", operand_text(&value, a)
+				, emit_offset(gen, pointer, 1), is_double ? ", align 4" : "");
+			stack_push(gen, operand_register(kind_int, result));
+		}
+		break;
+		default:
+			// Нити, роботы и прочие функции среды исполнения
+			unsupported(gen, operation);
+			break;
+	}
+}
+
+static void operation(llvm *const gen, node *const nd, const item_t op)
+{
+	char a[MAX_OPERAND_SIZE];
+
+	if ((op >= REMASS && op <= DIVASSAT) || (op >= REMASSV && op <= DIVASSATV))
+	{
+		int_assignment(gen, nd, op);
+	}
+	else if ((op >= ASSR && op <= DIVASSR) || (op >= ASSATR && op <= DIVASSATR)
+		|| (op >= ASSRV && op <= DIVASSRV) || (op >= ASSATRV && op <= DIVASSATRV))
+	{
+		double_assignment(gen, nd, op);
+	}
+	else if ((op >= POSTINC && op <= DECAT) || (op >= POSTINCV && op <= DECATV))
+	{
+		increment(gen, nd, op, 0);
+	}
+	else if ((op >= POSTINCR && op <= DECATR) || (op >= POSTINCRV && op <= DECATRV))
+	{
+		increment(gen, nd, op, 1);
+	}
+	else if (op >= LREM && op <= LDIV)
+	{
+		const operand snd = pop_int(gen);
+		const operand fst = pop_int(gen);
+		stack_push(gen, int_operation(gen, op, &fst, &snd));
+	}
+	else if (op >= EQEQR && op <= LDIVR)
+	{
+		const operand snd = pop_double(gen);
+		const operand fst = pop_double(gen);
+		stack_push(gen, double_operation(gen, op, &fst, &snd));
+	}
+	else if (op >= COPY00 && op <= COPYST)
+	{
+		copy(gen, nd, op);
+	}
+	else
+	{
+		switch (op)
+		{
+			case UNMINUS:
+			case LNOT:
+			{
+				const operand value = pop_int(gen);
+				const size_t result = reg(gen);
+				if (op == UNMINUS)
+				{
+					emit(gen, "%%r%zu = sub i32 0, %s", result, operand_text(&value, a));
+				}
+				else
+				{
+					emit(gen, "%%r%zu = xor i32 %s, -1", result, operand_text(&value, a));
+				}
+				stack_push(gen, operand_register(kind_int, result));
+			}
+			break;
+			case LOGNOT:
+			{
+				const operand value = pop_int(gen);
+				const size_t compared = reg(gen);
+				const size_t result = reg(gen);
+				emit(gen, "%%r%zu = icmp eq i32 %s, 0", compared, operand_text(&value, a));
+				emit(gen, "%%r%zu = zext i1 %%r%zu to i32", result, compared);
+				stack_push(gen, operand_register(kind_int, result));
+			}
+			break;
+			case UNMINUSR:
+			{
+				const operand value = pop_double(gen);
+				const size_t result = reg(gen);
+				emit(gen, "%%r%zu = fneg double %s", result, operand_text(&value, a));
+				stack_push(gen, operand_register(kind_double, result));
+			}
+			break;
+			case WIDEN:
+			{
+				const operand value = pop_int(gen);
+				const size_t result = reg(gen);
+				emit(gen, "%%r%zu = sitofp i32 %s to double", result, operand_text(&value, a));
+				stack_push(gen, operand_register(kind_double, result));
+			}
+			break;
+			case WIDEN1:
+			{
+				const operand top = pop_double(gen);
+				const operand value = pop_int(gen);
+				const size_t result = reg(gen);
+				emit(gen, "%%r%zu = sitofp i32 %s to double", result, operand_text(&value, a));
+				stack_push(gen, operand_register(kind_double, result));
+				stack_push(gen, top);
+			}
+			break;
+			default:
+				standard_function(gen, op);
+				break;
+		}
+	}
+}
+
+static void logic_begin(llvm *const gen, const item_t op)
+{
+	char a[MAX_OPERAND_SIZE];
+	const operand value = pop_int(gen);
+	const size_t temp = temp_create(gen, 1);
+	const size_t compared = reg(gen);
+	const size_t next = label(gen);
+	const size_t end = label(gen);
+
+	operand_text(&value, a);
+	emit(gen, "store i32 %s, ptr %%r%zu", a, temp);
+	emit(gen, "%%r%zu = icmp %s i32 %s, 0", compared, op == ADLOGOR ? "ne" : "eq", a);
+	emit(gen, "br i1 %%r%zu, label %%L%zu, label %%L%zu", compared, end, next);
+	gen->current->is_terminated = 1;
+	emit_label(gen, next);
+
+	stack_push(gen, value);
+	vector_add(&gen->logic, (item_t)temp);
+	vector_add(&gen->logic, (item_t)end);
+}
+
+static void logic_end(llvm *const gen, const item_t op)
+{
+	const operand snd = pop_int(gen);
+	const operand fst = pop_int(gen);
+	const operand result = int_operation(gen, op, &fst, &snd);
+
+	const size_t end = (size_t)vector_remove(&gen->logic);
+	const size_t temp = (size_t)vector_remove(&gen->logic);
+
+	char text[MAX_OPERAND_SIZE];
+	emit(gen, "store i32 %s, ptr %%r%zu", operand_text(&result, text), temp);
+	emit_label(gen, end);
+
+	const size_t value = reg(gen);
+	emit(gen, "%%r%zu = load i32, ptr %%r%zu", value, temp);
+	stack_push(gen, operand_register(kind_int, value));
+}
+
+static void final_operation(llvm *const gen, node *const nd)
+{
+	item_t op = node_get_type(nd);
+	while (op > 9000)
+	{
+		if (op != NOP)
+		{
+			if (op == ADLOGOR || op == ADLOGAND)
+			{
+				logic_begin(gen, op);
+			}
+			else if ((op == LOGOR || op == LOGAND) && vector_size(&gen->logic) != 0)
+			{
+				logic_end(gen, op);
+			}
+			else
+			{
+				operation(gen, nd, op);
+			}
+		}
+
+		node_set_next(nd);
+		op = node_get_type(nd);
+	}
+}
+
+static void emit_branch(llvm *const gen, const operand *const condition, const size_t then, const size_t other)
+{
+	if (condition->is_constant)
+	{
+		emit_jump(gen, condition->value ? then : other);
+		return;
+	}
+
+	const size_t compared = reg(gen);
+	emit(gen, "%%r%" PRIu64 " = icmp ne i32 %%r%" PRIi64 ", 0", (uint64_t)compared, condition->value);
+	emit(gen, "br i1 %%r%zu, label %%L%zu, label %%L%zu", compared, then, other);
+	gen->current->is_terminated = 1;
+}
+
+/** Сохранить результат ветви условного выражения во временную переменную */
+static void condition_result(llvm *const gen, const size_t depth, size_t *const temp, kind_t *const kind)
+{
+	if (gen->stack_size <= depth)
+	{
+		return;
+	}
+
+	if (gen->stack[gen->stack_size - 1].kind == kind_block)
+	{
+		unsupported(gen, TCondexpr);
+		stack_pop(gen);
+		return;
+	}
+
+	const kind_t value_kind = gen->stack[gen->stack_size - 1].kind;
+	const operand value = stack_pop(gen);
+	if (*temp == 0)
+	{
+		*kind = value_kind;
+		*temp = temp_create(gen, value_kind == kind_double ? -1 : 1);
+	}
+
+	char text[MAX_OPERAND_SIZE];
+	if (*kind == kind_double && value_kind == kind_double)
+	{
+		emit(gen, "store double %s, ptr %%r%zu", operand_text(&value, text), *temp);
+	}
+	else if (*kind == kind_int && value_kind == kind_int)
+	{
+		emit(gen, "store i32 %s, ptr %%r%zu", operand_text(&value, text), *temp);
+	}
+}
+
+static void condition(llvm *const gen, node *const nd)
+{
+	const size_t end = label(gen);
+	size_t temp = 0;
+	kind_t kind = kind_int;
+	size_t depth = 0;
+
+	do
+	{
+		const operand value = pop_int(gen);
+		const size_t then = label(gen);
+		const size_t other = label(gen);
+		emit_branch(gen, &value, then, other);
+
+		emit_label(gen, then);
+		depth = gen->stack_size;
+		expression(gen, nd, 0); // then
+		condition_result(gen, depth, &temp, &kind);
+		emit_jump(gen, end);
+
+		emit_label(gen, other);
+		depth = gen->stack_size;
+		expression(gen, nd, 1); // else или cond
+	} while (node_get_type(nd) == TCondexpr);
+
+	condition_result(gen, depth, &temp, &kind);
+	emit_label(gen, end);
+
+	if (temp != 0)
+	{
+		const size_t result = reg(gen);
+		emit(gen, "%%r%zu = load %s, ptr %%r%zu", result, kind == kind_double ? "double" : "i32", temp);
+		stack_push(gen, operand_register(kind, result));
+	}
+
+	final_operation(gen, nd);
+}
+
+static void slice(llvm *const gen, node *const nd, const item_t type)
+{
+	expression(gen, nd, 0);
+
+	char a[MAX_OPERAND_SIZE];
+	char b[MAX_OPERAND_SIZE];
+	const operand index = pop_int(gen);
+	const operand array = pop_int(gen);
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = call i32 @ruc.index(i32 %s, i32 %s, i32 %zu)", result
+		, operand_text(&array, a), operand_text(&index, b), size_of(gen->sx, type));
+
+	if (type > 0 && mode_get(gen->sx, (size_t)type) == mode_array)
+	{
+		const size_t pointer = emit_pointer(gen, (sprintf(a, "%%r%zu", result), a));
+		const size_t row = reg(gen);
+		emit(gen, "%%r%zu = load i32, ptr %%r%zu", row, pointer);
+		stack_push(gen, operand_register(kind_int, row));
+	}
+	else
+	{
+		stack_push(gen, operand_register(kind_int, result));
+	}
+}
+
+static void print_value(llvm *const gen, const item_t mode)
+{
+	char text[MAX_OPERAND_SIZE];
+
+	if (mode == LINT || mode == LCHAR)
+	{
+		const operand value = pop_int(gen);
+		if (mode == LINT)
+		{
+			emit(gen, "call i32 (ptr, ...) @printf(ptr @ruc.format.int, i32 %s)", operand_text(&value, text));
+		}
+		else
+		{
+			emit(gen, "call void @ruc.print_char(i32 %s)", operand_text(&value, text));
+		}
+		return;
+	}
+
+	if (mode == LFLOAT)
+	{
+		const operand value = pop_double(gen);
+		emit(gen, "call i32 (ptr, ...) @printf(ptr @ruc.format.float, double %s)", operand_text(&value, text));
+		return;
+	}
+
+	helper_request(&gen->printers, mode);
+	const size_t size = size_of(gen->sx, mode);
+	if (size == 1)
+	{
+		const operand value = pop_int(gen);
+		const size_t temp = temp_create(gen, 1);
+		emit(gen, "store i32 %s, ptr %%r%zu", operand_text(&value, text), temp);
+		emit(gen, "call void @ruc.print.%i(ptr %%r%zu)", (int)mode, temp);
+		return;
+	}
+
+	stack_materialize(gen, stack_words(gen, size), size);
+	const operand value = stack_pop(gen);
+	emit(gen, "call void @ruc.print.%i(ptr %%r%zu)", (int)mode, address_pointer(gen, &value));
+	block_release(gen, &value);
+}
+
+static void call_begin(llvm *const gen)
+{
+	const size_t sp = reg(gen);
+	const size_t frame = reg(gen);
+	const size_t top = reg(gen);
+	emit(gen, "%%r%zu = load i32, ptr @sp", sp);
+	emit(gen, "%%r%zu = add i32 %%r%zu, 1", frame, sp);
+	emit(gen, "%%r%zu = add i32 %%r%zu, %i", top, sp, FRAME_SIZE);
+	emit(gen, "store i32 %%r%zu, ptr @sp", top);
+	vector_add(&gen->calls, (item_t)frame);
+}
+
+static void call_end(llvm *const gen, node *const nd)
+{
+	syntax *const sx = gen->sx;
+	const size_t id = (size_t)node_get_arg(nd, 0);
+	const item_t displ = ident_get_displ(sx, id);
+	const item_t mode = ident_get_mode(sx, id);
+	const size_t frame = (size_t)vector_remove(&gen->calls);
+
+	size_t words = 0;
+	const item_t params = mode_get(sx, (size_t)mode + 2);
+	for (item_t i = 0; i < params; i++)
+	{
+		words += size_of(sx, mode_get(sx, (size_t)(mode + 3 + i)));
+	}
+
+	if (words != 0)
+	{
+		const size_t args = reg(gen);
+		emit(gen, "%%r%zu = add i32 %%r%zu, %i", args, frame, FRAME_SIZE);
+		const operand address = operand_register(kind_int, args);
+		store_words(gen, stack_words(gen, words), &address, 0);
+	}
+
+	char target[MAX_OPERAND_SIZE];
+	if (displ > 0)
+	{
+		sprintf(target, "@f%" PRIitem, displ);
+		function_reference(gen, (size_t)displ);
+	}
+	else
+	{
+		char text[MAX_OPERAND_SIZE];
+		const operand number = load_cell(gen, -displ, kind_int);
+		const size_t function = reg(gen);
+		emit(gen, "%%r%zu = call ptr @ruc.function(i32 %s)", function, operand_text(&number, text));
+		sprintf(target, "%%r%zu", function);
+	}
+
+	const char *const type = return_type(sx, mode);
+	if (strcmp(type, "void") == 0)
+	{
+		emit(gen, "call void %s(i32 %%r%zu)", target, frame);
+
+		const item_t value = mode_get(sx, (size_t)mode + 1);
+		if (value != LVOID)
+		{
+			const size_t release = reg(gen);
+			emit(gen, "%%r%zu = sub i32 %%r%zu, 1", release, frame);
+			stack_push(gen, operand_block(frame, size_of(sx, value), release));
+		}
+	}
+	else
+	{
+		const size_t result = reg(gen);
+		emit(gen, "%%r%zu = call %s %s(i32 %%r%zu)", result, type, target, frame);
+		stack_push(gen, operand_register(strcmp(type, "double") == 0 ? kind_double : kind_int, result));
+	}
+}
+
+static void expression(llvm *const gen, node *const nd, const int mode)
+{
+	if (mode != -1)
+	{
+		node_set_next(nd);
+	}
+
+	while (node_get_type(nd) != TExprend)
+	{
+		const item_t operation = node_get_type(nd);
+		int was_operation = 1;
+
+		switch (operation)
+		{
+			case TIdent:
+				break;
+			case TIdenttoaddr:
+			{
+				const item_t displ = node_get_arg(nd, 0);
+				cells_mark(gen, displ, 1, cell_address);
+				stack_push(gen, cell_location(gen, displ));
+			}
+			break;
+			case TIdenttoval:
+				stack_push(gen, load_cell(gen, node_get_arg(nd, 0), kind_int));
+				break;
+			case TIdenttovald:
+				stack_push(gen, load_cell(gen, node_get_arg(nd, 0), kind_double));
+				break;
+			case TAddrtoval:
+			case TAddrtovald:
+			{
+				const operand address = pop_int(gen);
+				const size_t pointer = address_pointer(gen, &address);
+				const size_t result = reg(gen);
+				if (operation == TAddrtovald)
+				{
+					emit(gen, "%%r%zu = load double, ptr %%r%zu, align 4", result, pointer);
+				}
+				else
+				{
+					emit(gen, "%%r%zu = load i32, ptr %%r%zu", result, pointer);
+				}
+				stack_push(gen, operand_register(operation == TAddrtovald ? kind_double : kind_int, result));
+			}
+			break;
+			case TConst:
+				stack_push(gen, operand_constant(node_get_arg(nd, 0)));
+				break;
+			case TConstd:
+			{
+				const uint64_t low = (uint32_t)node_get_arg(nd, 0);
+				const uint64_t high = (uint32_t)node_get_arg(nd, 1);
+				stack_push(gen, operand_double(low | high << 32));
+			}
+			break;
+			case TString:
+			case TStringd:
+				stack_push(gen, literal(gen, nd, operation));
+				break;
+			case TBeginit:
+			{
+				// Инициализатор массива вне объявления
+				unsupported(gen, operation);
+
+				const item_t N = node_get_arg(nd, 0);
+				for (item_t i = 0; i < N; i++)
+				{
+					expression(gen, nd, 0);
+				}
+			}
+			break;
+			case TStructinit:
+			{
+				const item_t N = node_get_arg(nd, 0);
+				for (item_t i = 0; i < N; i++)
+				{
+					expression(gen, nd, 0);
+				}
+			}
+			break;
+			case TSliceident:
+				stack_push(gen, load_cell(gen, node_get_arg(nd, 0), kind_int));
+				slice(gen, nd, node_get_arg(nd, 1));
+				break;
+			case TSlice:
+				slice(gen, nd, node_get_arg(nd, 0));
+				break;
+			case TSelect:
+			{
+				char text[MAX_OPERAND_SIZE];
+				const operand address = pop_int(gen);
+				const size_t result = reg(gen);
+				emit(gen, "%%r%zu = add i32 %s, %" PRIitem, result, operand_text(&address, text), node_get_arg(nd, 0));
+				stack_push(gen, operand_register(kind_int, result));
+			}
+			break;
+			case TPrint:
+				print_value(gen, node_get_arg(nd, 0));
+				break;
+			case TCall1:
+			{
+				call_begin(gen);
+
+				const item_t N = node_get_arg(nd, 0);
+				for (item_t i = 0; i < N; i++)
+				{
+					expression(gen, nd, 0);
+				}
+			}
+			break;
+			case TCall2:
+				call_end(gen, nd);
+				break;
+			default:
+				was_operation = 0;
+				break;
+		}
+
+		if (was_operation)
+		{
+			node_set_next(nd);
+		}
+
+		final_operation(gen, nd);
+
+		if (node_get_type(nd) == TCondexpr)
+		{
+			if (mode == 1)
+			{
+				return;
+			}
+
+			condition(gen, nd);
+		}
+	}
+}
+
+static void structure(llvm *const gen, node *const nd)
+{
+	if (node_get_type(nd) == TStructinit)
+	{
+		const item_t N = node_get_arg(nd, 0);
+		node_set_next(nd);
+
+		for (item_t i = 0; i < N; i++)
+		{
+			structure(gen, nd);
+			node_set_next(nd); // TExprend
+		}
+	}
+	else
+	{
+		expression(gen, nd, -1);
+	}
+}
+
+
+/** Границы и размеры инициализируемого массива */
+typedef struct initializer
+{
+	operand bounds[MAXBOUNDS];		/**< Declared bounds */
+	size_t bounds_number;			/**< Number of declared bounds */
+	size_t dimensions;				/**< Number of dimensions */
+	size_t length;					/**< Size of element */
+} initializer;
+
+static void array_bounds(llvm *const gen, const operand *const bounds, const size_t number, size_t *const temp)
+{
+	*temp = temp_create(gen, (item_t)number);
+	for (size_t i = 0; i < number; i++)
+	{
+		char text[MAX_OPERAND_SIZE];
+		const size_t pointer = reg(gen);
+		emit(gen, "%%r%zu = getelementptr inbounds [%zu x i32], ptr %%r%zu, i32 0, i32 %zu", pointer, number, *temp, i);
+		emit(gen, "store i32 %s, ptr %%r%zu", operand_text(&bounds[i], text), pointer);
+	}
+}
+
+static operand array_declare(llvm *const gen, const size_t dimensions, const size_t length)
+{
+	operand bounds[MAXBOUNDS];
+	for (size_t i = dimensions; i > 0; i--)
+	{
+		bounds[i - 1] = pop_int(gen);
+	}
+
+	char text[MAX_OPERAND_SIZE];
+	const size_t result = reg(gen);
+	if (dimensions == 1)
+	{
+		emit(gen, "%%r%zu = call i32 @ruc.allocate(i32 %s, i32 %zu)", result, operand_text(&bounds[0], text), length);
+	}
+	else
+	{
+		size_t temp;
+		array_bounds(gen, bounds, dimensions, &temp);
+		emit(gen, "%%r%zu = call i32 @ruc.array(ptr %%r%zu, i32 %zu, i32 %zu)", result, temp, dimensions, length);
+	}
+
+	return operand_register(kind_int, result);
+}
+
+static operand array_build(llvm *const gen, node *const nd, const initializer *const init, const size_t level)
+{
+	const int is_last = level + 1 == init->dimensions;
+	const operand declared = level < init->bounds_number ? init->bounds[level] : operand_constant(-1);
+
+	char a[MAX_OPERAND_SIZE];
+	char b[MAX_OPERAND_SIZE];
+	operand_text(&declared, b);
+	node_set_next(nd);
+
+	if (node_get_type(nd) != TBeginit)
+	{
+		// Строка в последнем измерении копируется целиком
+		expression(gen, nd, -1);
+		const operand string = pop_int(gen);
+		operand_text(&string, a);
+
+		const size_t header = reg(gen);
+		const size_t count = reg(gen);
+		const size_t result = reg(gen);
+		const size_t bytes = reg(gen);
+		emit(gen, "%%r%zu = sub i32 %s, 1", header, a);
+		const size_t header_pointer = emit_pointer(gen, (sprintf(a, "%%r%zu", header), a));
+		emit(gen, "%%r%zu = load i32, ptr %%r%zu", count, header_pointer);
+		emit(gen, "%%r%zu = call i32 @ruc.initialize(i32 %%r%zu, i32 %s, i32 %zu)", result, count, b, init->length);
+		emit(gen, "%%r%zu = shl i32 %%r%zu, 2", bytes, count);
+
+		const size_t target = emit_pointer(gen, (sprintf(a, "%%r%zu", result), a));
+		const size_t source = address_pointer(gen, &string);
+		emit(gen, "call void @llvm.memcpy.p0.p0.i32(ptr %%r%zu, ptr %%r%zu, i32 %%r%zu, i1 false)"
+			, target, source, bytes);
+		return operand_register(kind_int, result);
+	}
+
+	const item_t count = node_get_arg(nd, 0);
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = call i32 @ruc.initialize(i32 %" PRIitem ", i32 %s, i32 %zu)"
+		, result, count, b, is_last ? init->length : 1);
+
+	for (item_t i = 0; i < count; i++)
+	{
+		const size_t element = reg(gen);
+		emit(gen, "%%r%zu = add i32 %%r%zu, %zu", element, result, (size_t)i * (is_last ? init->length : 1));
+		const operand address = operand_register(kind_int, element);
+
+		if (is_last)
+		{
+			expression(gen, nd, 0);
+			store_words(gen, stack_words(gen, init->length), &address, 1);
+		}
+		else
+		{
+			const operand row = array_build(gen, nd, init, level + 1);
+			stack_push(gen, row);
+			store_words(gen, gen->stack_size - 1, &address, 1);
+		}
+	}
+	node_set_next(nd); // TExprend
+
+	if (!is_last && init->bounds_number == init->dimensions)
+	{
+		// Оставшиеся строки создаются по объявленным границам
+		size_t temp;
+		const size_t rest = init->dimensions - level - 1;
+		array_bounds(gen, &init->bounds[level + 1], rest, &temp);
+		emit(gen, "call void @ruc.array.rows(i32 %%r%zu, i32 %" PRIitem ", i32 %s, ptr %%r%zu, i32 %zu, i32 %zu)"
+			, result, count, b, temp, rest, init->length);
+	}
+
+	return operand_register(kind_int, result);
+}
+
+static void unit_begin(llvm *const gen, unit *const un)
+{
+	out_set_buffer(&un->io, BUFSIZ);
+	vector_resize(&un->temps, 0);
+	un->entry = label(gen);
+	un->is_terminated = 0;
+	uni_printf(&un->io, "L%zu:\n", un->entry);
+}
+
+static void unit_temps(llvm *const gen, const unit *const un)
+{
+	for (size_t i = 0; i < vector_size(&un->temps); i += 2)
+	{
+		const size_t number = (size_t)vector_get(&un->temps, i);
+		const item_t type = vector_get(&un->temps, i + 1);
+
+		if (type == -1)
+		{
+			uni_printf(&gen->module, "\t%%r%zu = alloca double\n", number);
+		}
+		else if (type == 1)
+		{
+			uni_printf(&gen->module, "\t%%r%zu = alloca i32\n", number);
+		}
+		else
+		{
+			uni_printf(&gen->module, "\t%%r%zu = alloca [%" PRIitem " x i32]\n", number, type);
+		}
+	}
+}
+
+static void unit_end(llvm *const gen, unit *const un)
+{
+	uni_printf(&gen->module, "\tbr label %%L%zu\n", un->entry);
+
+	char *const buffer = out_extract_buffer(&un->io);
+	if (buffer != NULL)
+	{
+		out_write(&gen->module, buffer, strlen(buffer));
+		free(buffer);
+	}
+
+	uni_print_string(&gen->module, "}\n\n");
+}
+
+static void procedure_begin(llvm *const gen)
+{
+	unit *const un = malloc(sizeof(unit));
+	if (un == NULL)
+	{
+		gen->was_error = 1;
+		return;
+	}
+
+	un->io = io_create();
+	un->temps = vector_create(MAX_OPERAND_SIZE);
+	un->is_procedure = 1;
+	un->has_frame = 1;
+	un->parent = gen->current;
+
+	unit_begin(gen, un);
+	gen->current = un;
+}
+
+static void procedure_end(llvm *const gen, const item_t number)
+{
+	unit *const un = gen->current;
+	if (!un->is_procedure)
+	{
+		return;
+	}
+
+	if (!un->is_terminated)
+	{
+		emit_terminator(gen, "ret void");
+	}
+
+	uni_printf(&gen->module, "define internal void @ruc.proc.%" PRIitem "(i32 %%base, i32 %%l) {\nentry:\n", number);
+	unit_temps(gen, un);
+	unit_end(gen, un);
+
+	gen->current = un->parent;
+	vector_clear(&un->temps);
+	free(un);
+}
+
+/** Адрес поля экземпляра структуры в процедуре инициализации */
+static operand procedure_field(llvm *const gen, const item_t displ)
+{
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = add i32 %%base, %" PRIitem, result, displ);
+	return operand_register(kind_int, result);
+}
+
+static void procedure_call(llvm *const gen, const item_t number, const operand *const base)
+{
+	char text[MAX_OPERAND_SIZE];
+	emit(gen, "call void @ruc.proc.%" PRIitem "(i32 %s, i32 %s)", number, operand_text(base, text)
+		, gen->current->has_frame ? "%l" : "0");
+}
+
+static void identifier(llvm *const gen, node *const nd)
+{
+	syntax *const sx = gen->sx;
+	const item_t displ = node_get_arg(nd, 0);
+	const item_t type = node_get_arg(nd, 1);
+	const item_t N = node_get_arg(nd, 2);
+	const item_t all = node_get_arg(nd, 3);
+	const item_t process = node_get_arg(nd, 4);
+	const item_t usual = node_get_arg(nd, 5);
+	const item_t instruction = node_get_arg(nd, 6);
+
+	if (N == 0)
+	{
+		extent_set(gen, displ, size_of(sx, type));
+		if (process)
+		{
+			// Массивы в полях структуры создаются процедурой инициализации
+			cells_mark(gen, displ, 1, cell_address);
+			const operand base = gen->current->is_procedure
+				? procedure_field(gen, displ)
+				: cell_location(gen, displ);
+			procedure_call(gen, process, &base);
+		}
+
+		if (!all)
+		{
+			return;
+		}
+
+		if (type > 0 && mode_get(sx, (size_t)type) == mode_struct)
+		{
+			node_set_next(nd);
+			structure(gen, nd);
+			store_cells(gen, stack_words(gen, (size_t)all), displ);
+		}
+		else
+		{
+			expression(gen, nd, 0);
+			const operand value = type == LFLOAT ? pop_double(gen) : pop_int(gen);
+			store_cell(gen, displ, &value);
+		}
+		return;
+	}
+
+	const size_t length = size_of(sx, type);
+	const size_t dimensions = (size_t)abs((int)N);
+	operand address;
+	if (!all)
+	{
+		address = array_declare(gen, dimensions, length);
+		if (process)
+		{
+			char text[MAX_OPERAND_SIZE];
+			emit(gen, "call void @ruc.array.each(i32 %s, i32 %zu, i32 %zu, ptr @ruc.proc.%" PRIitem ", i32 %s)"
+				, operand_text(&address, text), dimensions, length, process, gen->current->has_frame ? "%l" : "0");
+		}
+	}
+	else
+	{
+		initializer init;
+		init.dimensions = dimensions;
+		init.length = length;
+		init.bounds_number = usual & 1 ? dimensions : dimensions - 1;
+		for (size_t i = init.bounds_number; i > 0; i--)
+		{
+			init.bounds[i - 1] = pop_int(gen);
+		}
+
+		address = array_build(gen, nd, &init, 0);
+	}
+
+	if (instruction)
+	{
+		// Массив в структуре записывается в поле инициализируемого экземпляра
+		char text[MAX_OPERAND_SIZE];
+		const operand field = procedure_field(gen, displ);
+		emit(gen, "store i32 %s, ptr %%r%zu", operand_text(&address, text), address_pointer(gen, &field));
+	}
+	else
+	{
+		extent_set(gen, displ, 1);
+		store_cell(gen, displ, &address);
+	}
+}
+
+static int declaration(llvm *const gen, node *const nd)
+{
+	switch (node_get_type(nd))
+	{
+		case TDeclarr:
+		{
+			const item_t N = node_get_arg(nd, 0);
+			for (item_t i = 0; i < N; i++)
+			{
+				expression(gen, nd, 0);
+			}
+		}
+		break;
+		case TDeclid:
+			identifier(gen, nd);
+			break;
+
+		case TStructbeg:
+			procedure_begin(gen);
+			break;
+		case TStructend:
+			procedure_end(gen, node_get_arg(nd, 0));
+			break;
+
+		default:
+			return -1;
+	}
+
+	return 0;
+}
+
+
+static void printf_flush(llvm *const gen, char *const format, size_t *const length
+	, const char *const args, const int has_args)
+{
+	if (*length == 0 && !has_args)
+	{
+		return;
+	}
+
+	const size_t number = string_constant(gen, format, *length);
+	emit(gen, "call i32 (ptr, ...) @printf(ptr @ruc.string.%zu%s)", number, args);
+	*length = 0;
+}
+
+static inline int placeholder_kind(const char32_t placeholder)
+{
+	switch (placeholder)
+	{
+		case 'f':
+		case U'в':
+			return kind_double;
+		case 'i':
+		case U'ц':
+		case 'c':
+		case U'л':
+		case 's':
+		case U'с':
+			return kind_int;
+		default:
+			return -1;
+	}
+}
+
+/** Аргумент printf: операнд стека или слова блока, если типы не совпали с форматом */
+static operand printf_argument(llvm *const gen, const int is_double, size_t *const arg
+	, const size_t pointer, size_t *const offset)
+{
+	if (pointer == 0)
+	{
+		const size_t index = (*arg)++;
+		if (index >= gen->stack_size)
+		{
+			return is_double ? operand_double(0) : operand_constant(0);
+		}
+
+		return is_double ? value_double(gen, &gen->stack[index]) : value_int(gen, &gen->stack[index]);
+	}
+
+	const size_t cell = emit_offset(gen, pointer, *offset);
+	const size_t result = reg(gen);
+	emit(gen, "%%r%zu = load %s, ptr %%r%zu, align 4", result, is_double ? "double" : "i32", cell);
+	*offset += is_double ? 2 : 1;
+	return operand_register(is_double ? kind_double : kind_int, result);
+}
+
+static void print_format(llvm *const gen, const size_t args_number)
+{
+	const operand format = stack_pop(gen);
+	const size_t from = stack_words(gen, args_number);
+	if (format.literal == 0)
+	{
+		unsupported(gen, TPrintf);
+		stack_release(gen, from);
+		return;
+	}
+
+	const size_t size = (size_t)vector_get(&gen->data, format.literal - 1);
+	size_t placeholders = 0;
+	int is_words = 0;
+	for (size_t i = 0; i + 1 < size; i++)
+	{
+		if (vector_get(&gen->data, format.literal + i) != '%')
+		{
+			continue;
+		}
+
+		const int kind = placeholder_kind((char32_t)vector_get(&gen->data, format.literal + ++i));
+		if (kind != -1)
+		{
+			const size_t arg = from + placeholders++;
+			is_words |= arg >= gen->stack_size || (int)gen->stack[arg].kind != kind;
+		}
+	}
+	is_words |= from + placeholders != gen->stack_size;
+
+	size_t pointer = 0;
+	size_t offset = 0;
+	if (is_words && args_number != 0)
+	{
+		// Аргументы читаются по словам, как в виртуальной машине
+		stack_materialize(gen, from, args_number);
+		pointer = address_pointer(gen, &gen->stack[from]);
+	}
+
+	char *const buffer = malloc(4 * size + 1);
+	char *const args = malloc((MAX_OPERAND_SIZE + 16) * (placeholders + 1));
+	if (buffer == NULL || args == NULL)
+	{
+		free(buffer);
+		free(args);
+		gen->was_error = 1;
+		return;
+	}
+
+	size_t length = 0;
+	size_t args_length = 0;
+	size_t arg = from;
+	args[0] = '\0';
+
+	for (size_t i = 0; i < size; i++)
+	{
+		const char32_t symbol = (char32_t)vector_get(&gen->data, format.literal + i);
+		if (symbol != '%' || i + 1 == size)
+		{
+			if (symbol == '%')
+			{
+				buffer[length++] = '%';
+				buffer[length++] = '%';
+			}
+			else if (symbol != 0)
+			{
+				length += utf8_to_string(&buffer[length], symbol);
+			}
+			continue;
+		}
+
+		const char32_t placeholder = (char32_t)vector_get(&gen->data, format.literal + ++i);
+		char text[MAX_OPERAND_SIZE];
+		switch (placeholder)
+		{
+			case 'i':
+			case U'ц':
+			case 'f':
+			case U'в':
+			{
+				const int is_double = placeholder_kind(placeholder) == kind_double;
+				const operand value = printf_argument(gen, is_double, &arg, pointer, &offset);
+
+				buffer[length++] = '%';
+				buffer[length++] = is_double ? 'f' : 'i';
+				args_length += (size_t)sprintf(&args[args_length], ", %s %s", is_double ? "double" : "i32"
+					, operand_text(&value, text));
+			}
+			break;
+			case 'c':
+			case U'л':
+			case 's':
+			case U'с':
+			{
+				const operand value = printf_argument(gen, 0, &arg, pointer, &offset);
+
+				printf_flush(gen, buffer, &length, args, args_length != 0);
+				args_length = 0;
+				args[0] = '\0';
+
+				const int is_char = placeholder == 'c' || placeholder == U'л';
+				emit(gen, "call void @ruc.print_%s(i32 %s)", is_char ? "char" : "string", operand_text(&value, text));
+			}
+			break;
+			default:
+				// Неизвестный спецификатор печатается как есть
+				buffer[length++] = '%';
+				buffer[length++] = '%';
+				if (placeholder != '%' && placeholder != 0)
+				{
+					length += utf8_to_string(&buffer[length], placeholder);
+				}
+				break;
+		}
+	}
+
+	printf_flush(gen, buffer, &length, args, args_length != 0);
+	stack_release(gen, from);
+
+	free(buffer);
+	free(args);
+}
+
+static void print_identifier(llvm *const gen, const size_t id, const int is_scan)
+{
+	syntax *const sx = gen->sx;
+	const item_t displ = ident_get_displ(sx, id);
+	const item_t mode = ident_get_mode(sx, id);
+
+	char pointer[MAX_OPERAND_SIZE];
+	cells_mark(gen, displ, size_of(sx, mode), cell_memory);
+	cell_name(gen, displ, cell_memory, pointer);
+
+	if (is_scan)
+	{
+		helper_request(&gen->scanners, mode);
+		emit(gen, "call void @ruc.scan.%i(ptr %s)", (int)mode, pointer);
+		return;
+	}
+
+	const char *const name = repr_get_name(sx, (size_t)ident_get_repr(sx, id));
+	const size_t length = strlen(name);
+	char *const buffer = malloc(length + 4);
+	if (buffer == NULL)
+	{
+		gen->was_error = 1;
+		return;
+	}
+
+	sprintf(buffer, "%s = ", name);
+	const size_t number = string_constant(gen, buffer, length + 3);
+	free(buffer);
+
+	helper_request(&gen->printers, mode);
+	emit(gen, "call i32 (ptr, ...) @printf(ptr @ruc.string.%zu)", number);
+	emit(gen, "call void @ruc.print.%i(ptr %s)", (int)mode, pointer);
+	emit(gen, "call i32 (ptr, ...) @printf(ptr @ruc.format.newline)");
+}
+
+
+static void function_return(llvm *const gen)
+{
+	const size_t below = reg(gen);
+	emit(gen, "%%r%zu = sub i32 %%l, 1", below);
+	emit(gen, "store i32 %%r%zu, ptr @sp", below);
+
+	const char *const type = return_type(gen->sx, gen->function_mode);
+	if (strcmp(type, "void") == 0)
+	{
+		emit_terminator(gen, "ret void");
+	}
+	else
+	{
+		emit_terminator(gen, strcmp(type, "double") == 0 ? "ret double 0.0" : "ret i32 0");
+	}
+}
+
+static void return_value(llvm *const gen, const size_t size)
+{
+	syntax *const sx = gen->sx;
+	const item_t type = mode_get(sx, (size_t)gen->function_mode + 1);
+	char text[MAX_OPERAND_SIZE];
+
+	if (type > 0 && mode_get(sx, (size_t)type) == mode_struct)
+	{
+		const size_t frame = reg(gen);
+		emit(gen, "%%r%zu = add i32 %%l, 0", frame);
+		const operand address = operand_register(kind_int, frame);
+		store_words(gen, stack_words(gen, size), &address, 0);
+
+		const size_t top = reg(gen);
+		emit(gen, "%%r%zu = add i32 %%l, %zu", top, size - 1);
+		emit(gen, "store i32 %%r%zu, ptr @sp", top);
+		emit_terminator(gen, "ret void");
+		return;
+	}
+
+	const int is_double = type == LFLOAT;
+	const operand value = is_double ? pop_double(gen) : pop_int(gen);
+	const size_t below = reg(gen);
+	emit(gen, "%%r%zu = sub i32 %%l, 1", below);
+	emit(gen, "store i32 %%r%zu, ptr @sp", below);
+	emit(gen, "ret %s %s", is_double ? "double" : "i32", operand_text(&value, text));
+	gen->current->is_terminated = 1;
+}
+
+static size_t label_of(llvm *const gen, const size_t id)
+{
+	if (id >= vector_size(&gen->labels))
+	{
+		vector_resize(&gen->labels, id + 1);
+	}
+
+	if (vector_get(&gen->labels, id) == 0)
+	{
+		vector_set(&gen->labels, id, (item_t)label(gen));
+	}
+
+	return (size_t)vector_get(&gen->labels, id);
+}
+
+static void statement(llvm *const gen, node *const nd)
+{
+	switch (node_get_type(nd))
+	{
+		case NOP:
+			break;
+		case CREATEDIRECTC:
+		case EXITDIRECTC:
+		case EXITC:
+			unsupported(gen, node_get_type(nd));
+			break;
+		case TBegin:
+			block(gen, nd);
+			break;
+		case TIf:
+		{
+			const item_t ref_else = node_get_arg(nd, 0);
+
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			const operand value = pop_int(gen);
+			const size_t then = label(gen);
+			const size_t other = label(gen);
+			emit_branch(gen, &value, then, other);
+
+			emit_label(gen, then);
+			statement(gen, nd);
+
+			if (ref_else)
+			{
+				const size_t end = label(gen);
+				node_set_next(nd);
+				emit_jump(gen, end);
+				emit_label(gen, other);
+				statement(gen, nd);
+				emit_label(gen, end);
+			}
+			else
+			{
+				emit_label(gen, other);
+			}
+		}
+		break;
+		case TWhile:
+		{
+			const size_t old_break = gen->label_break;
+			const size_t old_continue = gen->label_continue;
+			const size_t begin = label(gen);
+			const size_t body = label(gen);
+			const size_t end = label(gen);
+
+			emit_label(gen, begin);
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			const operand value = pop_int(gen);
+			emit_branch(gen, &value, body, end);
+			emit_label(gen, body);
+
+			gen->label_break = end;
+			gen->label_continue = begin;
+			statement(gen, nd);
+
+			emit_jump(gen, begin);
+			emit_label(gen, end);
+
+			gen->label_break = old_break;
+			gen->label_continue = old_continue;
+		}
+		break;
+		case TDo:
+		{
+			const size_t old_break = gen->label_break;
+			const size_t old_continue = gen->label_continue;
+			const size_t body = label(gen);
+			const size_t check = label(gen);
+			const size_t end = label(gen);
+
+			emit_label(gen, body);
+			gen->label_break = end;
+			gen->label_continue = check;
+
+			node_set_next(nd);
+			statement(gen, nd);
+			emit_label(gen, check);
+
+			expression(gen, nd, 0);
+			const operand value = pop_int(gen);
+			emit_branch(gen, &value, body, end);
+			emit_label(gen, end);
+
+			gen->label_break = old_break;
+			gen->label_continue = old_continue;
+		}
+		break;
+		case TFor:
+		{
+			const item_t ref_from = node_get_arg(nd, 0);
+			const item_t ref_cond = node_get_arg(nd, 1);
+			const item_t ref_incr = node_get_arg(nd, 2);
+
+			node incr;
+			node_copy(&incr, nd);
+			size_t child_stmt = 0;
+
+			if (ref_from)
+			{
+				expression(gen, &incr, 0); // initialization
+				child_stmt++;
+			}
+
+			const size_t old_break = gen->label_break;
+			const size_t old_continue = gen->label_continue;
+			const size_t begin = label(gen);
+			const size_t body = label(gen);
+			const size_t step = label(gen);
+			const size_t end = label(gen);
+
+			emit_label(gen, begin);
+			if (ref_cond)
+			{
+				expression(gen, &incr, 0); // condition
+				const operand value = pop_int(gen);
+				emit_branch(gen, &value, body, end);
+				child_stmt++;
+			}
+
+			if (ref_incr)
+			{
+				child_stmt++;
+			}
+
+			emit_label(gen, body);
+			gen->label_break = end;
+			gen->label_continue = step;
+
+			node stmt = node_get_child(nd, child_stmt);
+			statement(gen, &stmt);
+			emit_label(gen, step);
+
+			if (ref_incr)
+			{
+				expression(gen, &incr, 0); // increment
+			}
+			node_copy(nd, &stmt);
+
+			emit_jump(gen, begin);
+			emit_label(gen, end);
+
+			gen->label_break = old_break;
+			gen->label_continue = old_continue;
+		}
+		break;
+		case TGoto:
+			emit_jump(gen, label_of(gen, (size_t)abs((int)node_get_arg(nd, 0))));
+			break;
+		case TLabel:
+			emit_label(gen, label_of(gen, (size_t)node_get_arg(nd, 0)));
+			break;
+		case TSwitch:
+		{
+			const size_t old_break = gen->label_break;
+			const size_t old_case = gen->label_case;
+			const operand old_value = gen->switch_value;
+
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			gen->switch_value = pop_int(gen);
+			gen->label_case = 0;
+			gen->label_break = label(gen);
+			const size_t end = gen->label_break;
+
+			statement(gen, nd);
+			if (gen->label_case)
+			{
+				emit_label(gen, gen->label_case);
+			}
+			emit_label(gen, end);
+
+			gen->label_case = old_case;
+			gen->label_break = old_break;
+			gen->switch_value = old_value;
+		}
+		break;
+		case TCase:
+		{
+			if (gen->label_case)
+			{
+				emit_label(gen, gen->label_case);
+			}
+
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			const operand value = pop_int(gen);
+			const operand compared = int_operation(gen, EQEQ, &gen->switch_value, &value);
+			const size_t body = label(gen);
+			gen->label_case = label(gen);
+
+			emit_branch(gen, &compared, body, gen->label_case);
+			emit_label(gen, body);
+			statement(gen, nd);
+		}
+		break;
+		case TDefault:
+		{
+			if (gen->label_case)
+			{
+				emit_label(gen, gen->label_case);
+			}
+			gen->label_case = 0;
+
+			node_set_next(nd);
+			statement(gen, nd);
+		}
+		break;
+		case TBreak:
+			emit_jump(gen, gen->label_break);
+			break;
+		case TContinue:
+			emit_jump(gen, gen->label_continue);
+			break;
+		case TReturnvoid:
+			function_return(gen);
+			break;
+		case TReturnval:
+		{
+			const item_t size = node_get_arg(nd, 0);
+			expression(gen, nd, 0);
+			return_value(gen, (size_t)size);
+		}
+		break;
+		case TPrintid:
+			print_identifier(gen, (size_t)node_get_arg(nd, 0), 0);
+			break;
+		case TPrintf:
+			print_format(gen, (size_t)node_get_arg(nd, 0));
+			break;
+		case TGetid:
+			print_identifier(gen, (size_t)node_get_arg(nd, 0), 1);
+			break;
+		case SETMOTOR:
+		{
+			unsupported(gen, SETMOTOR);
+			expression(gen, nd, 0);
+			expression(gen, nd, 0);
+		}
+		break;
+		default:
+			if (declaration(gen, nd))
+			{
+				expression(gen, nd, -1);
+			}
+			break;
+	}
+}
+
+static void block(llvm *const gen, node *const nd)
+{
+	node_set_next(nd); // TBegin
+	while (node_get_type(nd) != TEnd)
+	{
+		statement(gen, nd);
+		node_set_next(nd);
+	}
+}
+
+
+static void function_definition(llvm *const gen, node *const nd)
+{
+	syntax *const sx = gen->sx;
+	const size_t id = (size_t)node_get_arg(nd, 0);
+	const item_t max_displ = node_get_arg(nd, 1);
+	const size_t number = (size_t)ident_get_displ(sx, id);
+	const item_t mode = ident_get_mode(sx, id);
+
+	function_reference(gen, number);
+	vector_set(&gen->functions, number, state_defined);
+
+	gen->function_mode = mode;
+	gen->current = &gen->function;
+	gen->stack_size = 0;
+	vector_resize(&gen->locals, 0);
+	vector_resize(&gen->locals, (size_t)max_displ + 1);
+	vector_resize(&gen->local_extents, 0);
+
+	gen->param_words = 0;
+	const item_t params = mode_get(sx, (size_t)mode + 2);
+	for (item_t i = 0; i < params; i++)
+	{
+		const size_t size = size_of(sx, mode_get(sx, (size_t)(mode + 3 + i)));
+		extent_set(gen, FRAME_SIZE + (item_t)gen->param_words, size);
+		gen->param_words += size;
+	}
+
+	unit_begin(gen, &gen->function);
+	node_set_next(nd);
+	block(gen, nd);
+
+	if (!gen->function.is_terminated)
+	{
+		function_return(gen);
+	}
+
+	cells_resolve(&gen->locals, &gen->local_extents);
+
+	universal_io *const io = &gen->module;
+	uni_printf(io, "define internal %s @f%zu(i32 %%l) {\nentry:\n", return_type(sx, mode), number);
+	uni_printf(io, "\t%%top = add i32 %%l, %" PRIitem "\n", max_displ - 1);
+	uni_print_string(io, "\tcall void @ruc.enter(i32 %top)\n");
+
+	const size_t first = FRAME_SIZE + gen->param_words;
+	int has_memory = 0;
+	for (size_t i = first; i < vector_size(&gen->locals) && i < (size_t)max_displ; i++)
+	{
+		has_memory |= (vector_get(&gen->locals, i) & cell_memory) != 0;
+	}
+
+	if (has_memory && (item_t)first < max_displ)
+	{
+		// Локальные переменные в памяти обнуляются, как в виртуальной машине
+		uni_printf(io, "\t%%zero.a = add i32 %%l, %zu\n", first);
+		uni_print_string(io, "\t%zero = getelementptr inbounds i32, ptr @mem, i32 %zero.a\n");
+		uni_printf(io, "\tcall void @llvm.memset.p0.i32(ptr %%zero, i8 0, i32 %zu, i1 false)\n"
+			, ((size_t)max_displ - first) * sizeof(int32_t));
+	}
+
+	for (size_t i = 0; i < vector_size(&gen->locals); i++)
+	{
+		const item_t flags = vector_get(&gen->locals, i);
+		if (!(flags & cell_used))
+		{
+			continue;
+		}
+
+		uni_printf(io, "\t%%v%zu.a = add i32 %%l, %zu\n", i, i);
+		if (!cell_is_promoted(flags))
+		{
+			uni_printf(io, "\t%%v%zu = getelementptr inbounds i32, ptr @mem, i32 %%v%zu.a\n", i, i);
+			continue;
+		}
+
+		const char *const type = flags & cell_double ? "double" : "i32";
+		uni_printf(io, "\t%%v%zu = alloca %s\n", i, type);
+		if (i >= FRAME_SIZE && i < first)
+		{
+			uni_printf(io, "\t%%v%zu.p = getelementptr inbounds i32, ptr @mem, i32 %%v%zu.a\n", i, i);
+			uni_printf(io, "\t%%v%zu.i = load %s, ptr %%v%zu.p, align 4\n", i, type, i);
+			uni_printf(io, "\tstore %s %%v%zu.i, ptr %%v%zu\n", type, i, i);
+		}
+		else
+		{
+			uni_printf(io, "\tstore %s %s, ptr %%v%zu\n", type, flags & cell_double ? "0.0" : "0", i);
+		}
+	}
+
+	unit_temps(gen, &gen->function);
+	unit_end(gen, &gen->function);
+	gen->current = &gen->init;
+}
+
+static int generate(llvm *const gen)
+{
+	unit_begin(gen, &gen->init);
+	gen->current = &gen->init;
+
+	node root = arena_get_root(&gen->sx->arena);
+	while (node_set_next(&root) == 0)
+	{
+		switch (node_get_type(&root))
+		{
+			case TFuncdef:
+				function_definition(gen, &root);
+				break;
+
+			case NOP:
+			case TEnd:
+				break;
+
+			default:
+				if (declaration(gen, &root))
+				{
+					system_error(node_unexpected, node_get_type(&root));
+					return -1;
+				}
+				break;
+		}
+	}
+
+	return gen->was_error ? -1 : 0;
+}
+
+
+static void printer_define(llvm *const gen, const item_t mode)
+{
+	syntax *const sx = gen->sx;
+	universal_io *const io = &gen->module;
+	uni_printf(io, "define internal void @ruc.print.%i(ptr %%value) {\nentry:\n", (int)mode);
+
+	const item_t type = mode > 0 ? mode_get(sx, (size_t)mode) : mode;
+	if (mode == LINT || mode == LCHAR)
+	{
+		uni_print_string(io, "\t%integer = load i32, ptr %value\n");
+		uni_print_string(io, mode == LINT
+			? "\tcall i32 (ptr, ...) @printf(ptr @ruc.format.int, i32 %integer)\n"
+			: "\tcall void @ruc.print_char(i32 %integer)\n");
+	}
+	else if (mode == LFLOAT)
+	{
+		uni_print_string(io, "\t%number = load double, ptr %value, align 4\n");
+		uni_print_string(io, "\tcall i32 (ptr, ...) @printf(ptr @ruc.format.float, double %number)\n");
+	}
+	else if (type == mode_array)
+	{
+		const item_t element = mode_get(sx, (size_t)mode + 1);
+		const int is_matrix = element > 0 && mode_get(sx, (size_t)element) == mode_array;
+		helper_request(&gen->printers, element);
+
+		uni_print_string(io, "\t%array = load i32, ptr %value\n");
+		uni_print_string(io, "\t%low = icmp sle i32 %array, 0\n");
+		uni_print_string(io, "\t%size = load i32, ptr @ruc.size\n");
+		uni_print_string(io, "\t%high = icmp sge i32 %array, %size\n");
+		uni_print_string(io, "\t%invalid = or i1 %low, %high\n");
+		uni_print_string(io, "\tbr i1 %invalid, label %done, label %start\n");
+		uni_print_string(io, "start:\n");
+
+		if (element == LCHAR)
+		{
+			uni_print_string(io, "\tcall void @ruc.print_string(i32 %array)\n");
+			uni_print_string(io, "\tbr label %done\n");
+		}
+		else
+		{
+			uni_print_string(io, "\t%header = sub i32 %array, 1\n");
+			uni_print_string(io, "\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header\n");
+			uni_print_string(io, "\t%bound = load i32, ptr %header.ptr\n");
+			uni_print_string(io, "\tbr label %loop\n");
+			uni_print_string(io, "loop:\n");
+			uni_print_string(io, "\t%i = phi i32 [ 0, %start ], [ %next, %body ]\n");
+			uni_print_string(io, "\t%more = icmp slt i32 %i, %bound\n");
+			uni_print_string(io, "\tbr i1 %more, label %separate, label %done\n");
+			uni_print_string(io, "separate:\n");
+			uni_print_string(io, "\t%is_first = icmp eq i32 %i, 0\n");
+			uni_print_string(io, "\tbr i1 %is_first, label %body, label %separator\n");
+			uni_print_string(io, "separator:\n");
+			uni_printf(io, "\tcall i32 (ptr, ...) @printf(ptr @ruc.format.%s)\n", is_matrix ? "newline" : "space");
+			uni_print_string(io, "\tbr label %body\n");
+			uni_print_string(io, "body:\n");
+			uni_printf(io, "\t%%offset = mul i32 %%i, %zu\n", size_of(sx, element));
+			uni_print_string(io, "\t%cell = add i32 %array, %offset\n");
+			uni_print_string(io, "\t%cell.ptr = getelementptr inbounds i32, ptr @mem, i32 %cell\n");
+			uni_printf(io, "\tcall void @ruc.print.%i(ptr %%cell.ptr)\n", (int)element);
+			uni_print_string(io, "\t%next = add i32 %i, 1\n");
+			uni_print_string(io, "\tbr label %loop\n");
+		}
+
+		uni_print_string(io, "done:\n");
+	}
+	else if (type == mode_struct)
+	{
+		const item_t fields = mode_get(sx, (size_t)mode + 2) / 2;
+		size_t displ = 0;
+
+		uni_print_string(io, "\tcall i32 (ptr, ...) @printf(ptr @ruc.format.begin)\n");
+		for (item_t i = 0; i < fields; i++)
+		{
+			const item_t field = mode_get(sx, (size_t)(mode + 3 + 2 * i));
+			helper_request(&gen->printers, field);
+
+			if (i != 0)
+			{
+				uni_print_string(io, "\tcall i32 (ptr, ...) @printf(ptr @ruc.format.comma)\n");
+			}
+			uni_printf(io, "\t%%field%" PRIitem " = getelementptr inbounds i32, ptr %%value, i32 %zu\n", i, displ);
+			uni_printf(io, "\tcall void @ruc.print.%i(ptr %%field%" PRIitem ")\n", (int)field, i);
+			displ += size_of(sx, field);
+		}
+		uni_print_string(io, "\tcall i32 (ptr, ...) @printf(ptr @ruc.format.end)\n");
+	}
+	else
+	{
+		uni_print_string(io, "\t%integer = load i32, ptr %value\n");
+		uni_print_string(io, "\tcall i32 (ptr, ...) @printf(ptr @ruc.format.int, i32 %integer)\n");
+	}
+
+	uni_print_string(io, "\tret void\n}\n\n");
+}
+
+static void scanner_define(llvm *const gen, const item_t mode)
+{
+	syntax *const sx = gen->sx;
+	universal_io *const io = &gen->module;
+	uni_printf(io, "define internal void @ruc.scan.%i(ptr %%value) {\nentry:\n", (int)mode);
+
+	const item_t type = mode > 0 ? mode_get(sx, (size_t)mode) : mode;
+	if (mode == LINT || mode == LFLOAT)
+	{
+		if (mode == LINT)
+		{
+			uni_print_string(io, "\t%count = call i32 (ptr, ...) @scanf(ptr @ruc.format.int, ptr %value)\n");
+		}
+		else
+		{
+			uni_print_string(io, "\t%number = alloca double\n");
+			uni_print_string(io, "\t%count = call i32 (ptr, ...) @scanf(ptr @ruc.format.double, ptr %number)\n");
+		}
+
+		uni_print_string(io, "\t%is_read = icmp eq i32 %count, 1\n");
+		uni_print_string(io, "\tbr i1 %is_read, label %done, label %fail\n");
+		uni_print_string(io, "fail:\n");
+		uni_print_string(io, "\tcall void @ruc.fail(ptr @ruc.message.input, i32 0, i32 0)\n");
+		uni_print_string(io, "\tunreachable\n");
+		uni_print_string(io, "done:\n");
+
+		if (mode == LFLOAT)
+		{
+			uni_print_string(io, "\t%read = load double, ptr %number\n");
+			uni_print_string(io, "\tstore double %read, ptr %value, align 4\n");
+		}
+	}
+	else if (mode == LCHAR)
+	{
+		uni_print_string(io, "\tcall void @ruc.scan_char(ptr %value)\n");
+	}
+	else if (type == mode_array)
+	{
+		const item_t element = mode_get(sx, (size_t)mode + 1);
+		helper_request(&gen->scanners, element);
+
+		uni_print_string(io, "\t%array = load i32, ptr %value\n");
+		uni_print_string(io, "\t%low = icmp sle i32 %array, 0\n");
+		uni_print_string(io, "\t%size = load i32, ptr @ruc.size\n");
+		uni_print_string(io, "\t%high = icmp sge i32 %array, %size\n");
+		uni_print_string(io, "\t%invalid = or i1 %low, %high\n");
+		uni_print_string(io, "\tbr i1 %invalid, label %fail, label %start\n");
+		uni_print_string(io, "fail:\n");
+		uni_print_string(io, "\tcall void @ruc.fail(ptr @ruc.message.input, i32 0, i32 0)\n");
+		uni_print_string(io, "\tunreachable\n");
+		uni_print_string(io, "start:\n");
+		uni_print_string(io, "\t%header = sub i32 %array, 1\n");
+		uni_print_string(io, "\t%header.ptr = getelementptr inbounds i32, ptr @mem, i32 %header\n");
+		uni_print_string(io, "\t%bound = load i32, ptr %header.ptr\n");
+		uni_print_string(io, "\tbr label %loop\n");
+		uni_print_string(io, "loop:\n");
+		uni_print_string(io, "\t%i = phi i32 [ 0, %start ], [ %next, %body ]\n");
+		uni_print_string(io, "\t%more = icmp slt i32 %i, %bound\n");
+		uni_print_string(io, "\tbr i1 %more, label %body, label %done\n");
+		uni_print_string(io, "body:\n");
+		uni_printf(io, "\t%%offset = mul i32 %%i, %zu\n", size_of(sx, element));
+		uni_print_string(io, "\t%cell = add i32 %array, %offset\n");
+		uni_print_string(io, "\t%cell.ptr = getelementptr inbounds i32, ptr @mem, i32 %cell\n");
+		uni_printf(io, "\tcall void @ruc.scan.%i(ptr %%cell.ptr)\n", (int)element);
+		uni_print_string(io, "\t%next = add i32 %i, 1\n");
+		uni_print_string(io, "\tbr label %loop\n");
+		uni_print_string(io, "done:\n");
+	}
+	else if (type == mode_struct)
+	{
+		const item_t fields = mode_get(sx, (size_t)mode + 2) / 2;
+		size_t displ = 0;
+
+		for (item_t i = 0; i < fields; i++)
+		{
+			const item_t field = mode_get(sx, (size_t)(mode + 3 + 2 * i));
+			helper_request(&gen->scanners, field);
+
+			uni_printf(io, "\t%%field%" PRIitem " = getelementptr inbounds i32, ptr %%value, i32 %zu\n", i, displ);
+			uni_printf(io, "\tcall void @ruc.scan.%i(ptr %%field%" PRIitem ")\n", (int)field, i);
+			displ += size_of(sx, field);
+		}
+	}
+
+	uni_print_string(io, "\tret void\n}\n\n");
+}
+
+static void module_output(llvm *const gen)
+{
+	syntax *const sx = gen->sx;
+	universal_io *const io = &gen->module;
+	const size_t globals = (size_t)sx->max_displg;
+	const size_t data = vector_size(&gen->data);
+	const size_t total = globals + data + STACK_SIZE + STACK_RESERVE;
+
+	// Инициализация глобальных переменных и вызов main
+	if (!gen->init.is_terminated)
+	{
+		gen->current = &gen->init;
+		emit_terminator(gen, "ret void");
+	}
+
+	uni_print_string(io, "define internal void @ruc.init() {\nentry:\n");
+	uni_printf(io, "\tstore i32 %zu, ptr @hp\n", total);
+	uni_printf(io, "\tstore i32 %zu, ptr @sp\n", globals + data - 1);
+	if (data != 0)
+	{
+		uni_printf(io, "\t%%data = getelementptr inbounds i32, ptr @mem, i32 %zu\n", globals);
+		uni_printf(io, "\tcall void @llvm.memcpy.p0.p0.i32(ptr %%data, ptr @ruc.data, i32 %zu, i1 false)\n"
+			, data * sizeof(int32_t));
+	}
+	unit_temps(gen, &gen->init);
+	unit_end(gen, &gen->init);
+
+	const size_t main_number = (size_t)ident_get_displ(sx, sx->ref_main);
+	function_reference(gen, main_number);
+	const char *const main_type = return_type(sx, ident_get_mode(sx, sx->ref_main));
+
+	uni_print_string(io, "define i32 @main() {\nentry:\n");
+	uni_print_string(io, "\tcall void @ruc.init()\n");
+	uni_print_string(io, "\t%sp = load i32, ptr @sp\n");
+	uni_print_string(io, "\t%frame = add i32 %sp, 1\n");
+	uni_printf(io, "\tcall %s @f%zu(i32 %%frame)\n", main_type, main_number);
+	uni_print_string(io, "\tret i32 0\n}\n\n");
+
+	// Процедуры печати и ввода могут запрашивать новые
+	for (size_t i = 0; i < vector_size(&gen->printers); i++)
+	{
+		printer_define(gen, vector_get(&gen->printers, i));
+	}
+	for (size_t i = 0; i < vector_size(&gen->scanners); i++)
+	{
+		scanner_define(gen, vector_get(&gen->scanners, i));
+	}
+
+	// Вызовы неописанных функций завершаются ошибкой, как в виртуальной машине
+	const size_t functions = vector_size(&gen->functions);
+	for (size_t i = 0; i < functions; i++)
+	{
+		if (vector_get(&gen->functions, i) == state_referenced)
+		{
+			uni_printf(io, "define internal %s @f%zu(i32 %%l) {\nentry:\n", return_type(sx, func_get(sx, i) > 0
+				? ident_get_mode(sx, (size_t)func_get(sx, i)) : LVOID), i);
+			uni_printf(io, "\tcall void @ruc.fail(ptr @ruc.message.function, i32 %zu, i32 0)\n", i);
+			uni_print_string(io, "\tunreachable\n}\n\n");
+		}
+	}
+
+	uni_printf(io, "@ruc.functions = internal constant [%zu x ptr] [", functions != 0 ? functions : 1);
+	for (size_t i = 0; i < functions; i++)
+	{
+		if (vector_get(&gen->functions, i) == state_defined)
+		{
+			uni_printf(io, "%sptr @f%zu", i == 0 ? "" : ", ", i);
+		}
+		else
+		{
+			uni_printf(io, "%sptr null", i == 0 ? "" : ", ");
+		}
+	}
+	uni_printf(io, "%s]\n", functions != 0 ? "" : "ptr null");
+	uni_printf(io, "@ruc.functions.size = internal constant i32 %zu\n\n", functions);
+
+	// Глобальные переменные и память программы
+	cells_resolve(&gen->globals, &gen->global_extents);
+	for (size_t i = 0; i < vector_size(&gen->globals); i++)
+	{
+		const item_t flags = vector_get(&gen->globals, i);
+		if (!(flags & cell_used))
+		{
+			continue;
+		}
+
+		if (cell_is_promoted(flags))
+		{
+			uni_printf(io, "@g%zu = internal global %s\n", i, flags & cell_double ? "double 0.0" : "i32 0");
+		}
+		else
+		{
+			uni_printf(io, "@g%zu = internal alias i32, getelementptr inbounds ([%zu x i32], ptr @mem, i64 0, i64 %zu)\n"
+				, i, total, i);
+		}
+	}
+
+	uni_printf(io, "\n@mem = internal global [%zu x i32] zeroinitializer\n", total);
+	uni_printf(io, "@ruc.size = internal constant i32 %zu\n", total);
+	if (data != 0)
+	{
+		uni_printf(io, "@ruc.data = private constant [%zu x i32] [", data);
+		for (size_t i = 0; i < data; i++)
+		{
+			uni_printf(io, "%si32 %i", i == 0 ? "" : ", ", (int)vector_get(&gen->data, i));
+		}
+		uni_print_string(io, "]\n");
+	}
+	uni_print_string(io, "\n");
+}
+
+static void module_header(universal_io *const io)
+{
+	for (size_t i = 0; i < sizeof(RUNTIME) / sizeof(RUNTIME[0]); i++)
+	{
+		uni_print_string(io, RUNTIME[i]);
+		uni_print_string(io, "\n");
+	}
+	uni_print_string(io, "\n");
+}
+
+static void module_messages(universal_io *const io)
+{
+	for (size_t i = 0; i < sizeof(MESSAGES) / sizeof(MESSAGES[0]); i++)
+	{
+		const char *const text = MESSAGES[i][1];
+		const size_t length = strlen(text);
+
+		uni_printf(io, "@ruc.message.%s = private constant [%zu x i8] c\"", MESSAGES[i][0], length + 1);
+		for (size_t j = 0; j < length; j++)
+		{
+			const unsigned char symbol = (unsigned char)text[j];
+			if (symbol < ' ' || symbol == '"' || symbol == '\\' || symbol >= 0x7F)
+			{
+				uni_printf(io, "\\%02X", symbol);
+			}
+			else
+			{
+				uni_printf(io, "%c", symbol);
+			}
+		}
+		uni_print_string(io, "\\00\"\n");
+	}
+
+	uni_print_string(io, "\n");
+}
+
+
+static llvm llvm_create(syntax *const sx)
+{
+	llvm gen;
+	memset(&gen, 0, sizeof(llvm));
+
+	gen.sx = sx;
+	gen.module = io_create();
+	gen.constants = io_create();
+	gen.init.io = io_create();
+	gen.function.io = io_create();
+	out_set_buffer(&gen.module, BUFSIZ);
+	out_set_buffer(&gen.constants, BUFSIZ);
+
+	gen.init.temps = vector_create(MAX_OPERAND_SIZE);
+	gen.function.temps = vector_create(MAX_OPERAND_SIZE);
+	gen.function.has_frame = 1;
+
+	gen.stack_alloc = MAX_OPERAND_SIZE;
+	gen.stack = malloc(gen.stack_alloc * sizeof(operand));
+
+	gen.logic = vector_create(MAX_OPERAND_SIZE);
+	gen.calls = vector_create(MAX_OPERAND_SIZE);
+	gen.data = vector_create(MAX_OPERAND_SIZE);
+	gen.labels = vector_create(MAX_OPERAND_SIZE);
+	gen.globals = vector_create((size_t)sx->max_displg + 1);
+	gen.global_extents = vector_create((size_t)sx->max_displg + 1);
+	gen.locals = vector_create(MAX_OPERAND_SIZE);
+	gen.local_extents = vector_create(MAX_OPERAND_SIZE);
+	gen.functions = vector_create(vector_size(&sx->functions));
+	gen.printers = vector_create(MAX_OPERAND_SIZE);
+	gen.scanners = vector_create(MAX_OPERAND_SIZE);
+
+	vector_resize(&gen.functions, vector_size(&sx->functions));
+	return gen;
+}
+
+static void llvm_clear(llvm *const gen)
+{
+	free(out_extract_buffer(&gen->module));
+	free(out_extract_buffer(&gen->constants));
+	free(out_extract_buffer(&gen->init.io));
+	free(out_extract_buffer(&gen->function.io));
+
+	vector_clear(&gen->init.temps);
+	vector_clear(&gen->function.temps);
+	free(gen->stack);
+
+	vector_clear(&gen->logic);
+	vector_clear(&gen->calls);
+	vector_clear(&gen->data);
+	vector_clear(&gen->labels);
+	vector_clear(&gen->globals);
+	vector_clear(&gen->global_extents);
+	vector_clear(&gen->locals);
+	vector_clear(&gen->local_extents);
+	vector_clear(&gen->functions);
+	vector_clear(&gen->printers);
+	vector_clear(&gen->scanners);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int encode_to_llvm(const workspace *const ws, universal_io *const io, syntax *const sx)
+{
+	if (!ws_is_correct(ws) || !out_is_correct(io) || sx == NULL)
+	{
+		return -1;
+	}
+
+	llvm gen = llvm_create(sx);
+	if (gen.stack == NULL)
+	{
+		llvm_clear(&gen);
+		return -1;
+	}
+
+	int ret = generate(&gen);
+	if (!ret)
+	{
+		module_output(&gen);
+
+		module_header(io);
+		module_messages(io);
+
+		char *const constants = out_extract_buffer(&gen.constants);
+		char *const module = out_extract_buffer(&gen.module);
+		ret = constants == NULL || module == NULL
+			|| out_write(io, constants, strlen(constants)) == -1
+			|| uni_print_string(io, "\n") == -1
+			|| out_write(io, module, strlen(module)) == -1 ? -1 : 0;
+
+		free(constants);
+		free(module);
+	}
+
+	llvm_clear(&gen);
+	return ret;
+}
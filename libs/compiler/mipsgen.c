@@ -0,0 +1,5061 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "mipsgen.h"
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include "defs.h"
+#include "errors.h"
+#include "tree.h"
+#include "uniprinter.h"
+#include "utf8.h"
+
+
+#define MAX_OPERAND_SIZE	32
+#define MAX_INLINE_WORDS	4
+
+#define STACK_SIZE			(1 << 20)
+#define STACK_RESERVE		256
+#define FRAME_SIZE			3
+
+#define SAVED_AREA			16
+#define ARGUMENT_WORDS		4
+
+
+/** Runtime support shared by all modules, mirrors virtual machine semantics */
+static const char *const RUNTIME[] =
+{
+	"\t.text",
+	"",
+	"ruc_fail:",
+	"\taddiu\t$sp, $sp, -32",
+	"\tsw\t$a0, 16($sp)",
+	"\tsw\t$a1, 20($sp)",
+	"\tsw\t$a2, 24($sp)",
+	"\tmove\t$a0, $zero",
+	"\tjal\tfflush",
+	"\tli\t$a0, 2",
+	"\tla\t$a1, ruc_message_error",
+	"\tjal\tdprintf",
+	"\tli\t$a0, 2",
+	"\tlw\t$a1, 16($sp)",
+	"\tlw\t$a2, 20($sp)",
+	"\tlw\t$a3, 24($sp)",
+	"\tjal\tdprintf",
+	"\tli\t$a0, 2",
+	"\tla\t$a1, ruc_format_newline",
+	"\tjal\tdprintf",
+	"\tli\t$a0, 1",
+	"\tjal\texit",
+	"",
+	"ruc_fail_double:",
+	"\taddiu\t$sp, $sp, -32",
+	"\tsw\t$a0, 16($sp)",
+	"\tswc1\t$f12, 24($sp)",
+	"\tswc1\t$f13, 28($sp)",
+	"\tmove\t$a0, $zero",
+	"\tjal\tfflush",
+	"\tli\t$a0, 2",
+	"\tla\t$a1, ruc_message_error",
+	"\tjal\tdprintf",
+	"\tli\t$a0, 2",
+	"\tlw\t$a1, 16($sp)",
+	"\tlw\t$a2, 24($sp)",
+	"\tlw\t$a3, 28($sp)",
+	"\tjal\tdprintf",
+	"\tli\t$a0, 2",
+	"\tla\t$a1, ruc_format_newline",
+	"\tjal\tdprintf",
+	"\tli\t$a0, 1",
+	"\tjal\texit",
+	"",
+	"ruc_fail_stack:",
+	"\tla\t$a0, ruc_message_stack",
+	"\tmove\t$a1, $zero",
+	"\tmove\t$a2, $zero",
+	"\tj\truc_fail",
+	"",
+	"ruc_fail_zero:",
+	"\tla\t$a0, ruc_message_zero",
+	"\tmove\t$a1, $zero",
+	"\tmove\t$a2, $zero",
+	"\tj\truc_fail",
+	"",
+	"ruc_fail_input:",
+	"\tla\t$a0, ruc_message_input",
+	"\tmove\t$a1, $zero",
+	"\tmove\t$a2, $zero",
+	"\tj\truc_fail",
+	"",
+	"ruc_enter:",
+	"\tla\t$v0, ruc_hp",
+	"\tlw\t$v0, 0($v0)",
+	"\taddiu\t$v0, $v0, -256",
+	"\tslt\t$v1, $a1, $v0",
+	"\tbeqz\t$v1, ruc_fail_stack",
+	"\tmove\t$s5, $a1",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tsll\t$a1, $a1, 2",
+	"\taddu\t$a1, $a1, $s7",
+	".Lenter_loop:",
+	"\tsltu\t$v0, $a1, $a0",
+	"\tbnez\t$v0, .Lenter_done",
+	"\tsw\t$zero, 0($a0)",
+	"\taddiu\t$a0, $a0, 4",
+	"\tb\t.Lenter_loop",
+	".Lenter_done:",
+	"\tjr\t$ra",
+	"",
+	"ruc_push:",
+	"\tla\t$v0, ruc_hp",
+	"\tlw\t$v0, 0($v0)",
+	"\taddiu\t$v0, $v0, -256",
+	"\taddu\t$v1, $s5, $a0",
+	"\tslt\t$v0, $v1, $v0",
+	"\tbeqz\t$v0, ruc_fail_stack",
+	"\taddiu\t$v0, $s5, 1",
+	"\tmove\t$s5, $v1",
+	"\tjr\t$ra",
+	"",
+	"ruc_move:",
+	"\tbeqz\t$a2, .Lmove_done",
+	"\tsltu\t$v0, $a1, $a0",
+	"\tbnez\t$v0, .Lmove_backward",
+	".Lmove_forward:",
+	"\tlw\t$v0, 0($a1)",
+	"\tsw\t$v0, 0($a0)",
+	"\taddiu\t$a0, $a0, 4",
+	"\taddiu\t$a1, $a1, 4",
+	"\taddiu\t$a2, $a2, -1",
+	"\tbnez\t$a2, .Lmove_forward",
+	"\tjr\t$ra",
+	".Lmove_backward:",
+	"\tsll\t$v0, $a2, 2",
+	"\taddu\t$a0, $a0, $v0",
+	"\taddu\t$a1, $a1, $v0",
+	".Lmove_backward_loop:",
+	"\taddiu\t$a0, $a0, -4",
+	"\taddiu\t$a1, $a1, -4",
+	"\tlw\t$v0, 0($a1)",
+	"\tsw\t$v0, 0($a0)",
+	"\taddiu\t$a2, $a2, -1",
+	"\tbnez\t$a2, .Lmove_backward_loop",
+	".Lmove_done:",
+	"\tjr\t$ra",
+	"",
+	"ruc_allocate:",
+	"\tbltz\t$a0, .Lallocate_negative",
+	"\tmultu\t$a0, $a1",
+	"\tmfhi\t$v0",
+	"\tmflo\t$v1",
+	"\tbnez\t$v0, ruc_fail_stack",
+	"\tbltz\t$v1, ruc_fail_stack",
+	"\taddu\t$a2, $s5, $v1",
+	"\taddiu\t$a2, $a2, 1",
+	"\tla\t$v0, ruc_hp",
+	"\tlw\t$v0, 0($v0)",
+	"\taddiu\t$v0, $v0, -256",
+	"\tsltu\t$v0, $a2, $v0",
+	"\tbeqz\t$v0, ruc_fail_stack",
+	"\taddiu\t$v0, $s5, 1",
+	"\tsll\t$v0, $v0, 2",
+	"\taddu\t$v0, $v0, $s7",
+	"\tsw\t$a0, 0($v0)",
+	".Lallocate_loop:",
+	"\tbeqz\t$v1, .Lallocate_done",
+	"\taddiu\t$v0, $v0, 4",
+	"\tsw\t$zero, 0($v0)",
+	"\taddiu\t$v1, $v1, -1",
+	"\tb\t.Lallocate_loop",
+	".Lallocate_done:",
+	"\taddiu\t$v0, $s5, 2",
+	"\tmove\t$s5, $a2",
+	"\tjr\t$ra",
+	".Lallocate_negative:",
+	"\tmove\t$a1, $a0",
+	"\tla\t$a0, ruc_message_negative",
+	"\tmove\t$a2, $zero",
+	"\tj\truc_fail",
+	"",
+	"ruc_initialize:",
+	"\tmove\t$v0, $a1",
+	"\tbgez\t$a1, .Linitialize_check",
+	"\tmove\t$v0, $a0",
+	".Linitialize_check:",
+	"\tslt\t$v1, $v0, $a0",
+	"\tbnez\t$v1, .Linitialize_fail",
+	"\tmove\t$a0, $v0",
+	"\tmove\t$a1, $a2",
+	"\tj\truc_allocate",
+	".Linitialize_fail:",
+	"\tmove\t$a1, $a0",
+	"\tmove\t$a2, $v0",
+	"\tla\t$a0, ruc_message_initializer",
+	"\tj\truc_fail",
+	"",
+	"ruc_array:",
+	"\taddiu\t$sp, $sp, -40",
+	"\tsw\t$ra, 36($sp)",
+	"\tsw\t$s0, 32($sp)",
+	"\tsw\t$s1, 28($sp)",
+	"\tsw\t$s2, 24($sp)",
+	"\tsw\t$s3, 20($sp)",
+	"\tmove\t$s0, $a0",
+	"\tmove\t$s1, $a1",
+	"\tmove\t$s2, $a2",
+	"\tlw\t$a0, 0($s0)",
+	"\tmove\t$a1, $s2",
+	"\tslti\t$v0, $s1, 2",
+	"\tbnez\t$v0, .Larray_allocate",
+	"\tli\t$a1, 1",
+	".Larray_allocate:",
+	"\tjal\truc_allocate",
+	"\tmove\t$s3, $v0",
+	"\tslti\t$v0, $s1, 2",
+	"\tbnez\t$v0, .Larray_done",
+	"\tmove\t$a0, $s3",
+	"\tmove\t$a1, $zero",
+	"\tlw\t$a2, 0($s0)",
+	"\taddiu\t$a3, $s0, 4",
+	"\taddiu\t$v0, $s1, -1",
+	"\tmove\t$v1, $s2",
+	"\tjal\truc_array_rows",
+	".Larray_done:",
+	"\tmove\t$v0, $s3",
+	"\tlw\t$s3, 20($sp)",
+	"\tlw\t$s2, 24($sp)",
+	"\tlw\t$s1, 28($sp)",
+	"\tlw\t$s0, 32($sp)",
+	"\tlw\t$ra, 36($sp)",
+	"\taddiu\t$sp, $sp, 40",
+	"\tjr\t$ra",
+	"",
+	"ruc_array_rows:",
+	"\taddiu\t$sp, $sp, -48",
+	"\tsw\t$ra, 40($sp)",
+	"\tsw\t$s3, 36($sp)",
+	"\tsw\t$s2, 32($sp)",
+	"\tsw\t$s1, 28($sp)",
+	"\tsw\t$s0, 24($sp)",
+	"\tsw\t$v0, 16($sp)",
+	"\tsw\t$v1, 20($sp)",
+	"\tmove\t$s0, $a0",
+	"\tmove\t$s1, $a1",
+	"\tmove\t$s2, $a2",
+	"\tmove\t$s3, $a3",
+	".Lrows_loop:",
+	"\tslt\t$v0, $s1, $s2",
+	"\tbeqz\t$v0, .Lrows_done",
+	"\tmove\t$a0, $s3",
+	"\tlw\t$a1, 16($sp)",
+	"\tlw\t$a2, 20($sp)",
+	"\tjal\truc_array",
+	"\taddu\t$v1, $s0, $s1",
+	"\tsll\t$v1, $v1, 2",
+	"\taddu\t$v1, $v1, $s7",
+	"\tsw\t$v0, 0($v1)",
+	"\taddiu\t$s1, $s1, 1",
+	"\tb\t.Lrows_loop",
+	".Lrows_done:",
+	"\tlw\t$s0, 24($sp)",
+	"\tlw\t$s1, 28($sp)",
+	"\tlw\t$s2, 32($sp)",
+	"\tlw\t$s3, 36($sp)",
+	"\tlw\t$ra, 40($sp)",
+	"\taddiu\t$sp, $sp, 48",
+	"\tjr\t$ra",
+	"",
+	"ruc_array_each:",
+	"\taddiu\t$sp, $sp, -48",
+	"\tsw\t$ra, 40($sp)",
+	"\tsw\t$s3, 36($sp)",
+	"\tsw\t$s2, 32($sp)",
+	"\tsw\t$s1, 28($sp)",
+	"\tsw\t$s0, 24($sp)",
+	"\tsw\t$a3, 20($sp)",
+	"\tmove\t$s0, $a0",
+	"\tmove\t$s1, $a1",
+	"\tmove\t$s2, $a2",
+	"\tmove\t$s3, $zero",
+	".Leach_loop:",
+	"\taddiu\t$v0, $s0, -1",
+	"\tsll\t$v0, $v0, 2",
+	"\taddu\t$v0, $v0, $s7",
+	"\tlw\t$v0, 0($v0)",
+	"\tslt\t$v0, $s3, $v0",
+	"\tbeqz\t$v0, .Leach_done",
+	"\tli\t$v0, 1",
+	"\tbne\t$s1, $v0, .Leach_row",
+	"\tmul\t$a0, $s3, $s2",
+	"\taddu\t$a0, $a0, $s0",
+	"\tlw\t$t9, 20($sp)",
+	"\tjalr\t$t9",
+	"\tb\t.Leach_step",
+	".Leach_row:",
+	"\taddu\t$a0, $s0, $s3",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tlw\t$a0, 0($a0)",
+	"\taddiu\t$a1, $s1, -1",
+	"\tmove\t$a2, $s2",
+	"\tlw\t$a3, 20($sp)",
+	"\tjal\truc_array_each",
+	".Leach_step:",
+	"\taddiu\t$s3, $s3, 1",
+	"\tb\t.Leach_loop",
+	".Leach_done:",
+	"\tlw\t$s0, 24($sp)",
+	"\tlw\t$s1, 28($sp)",
+	"\tlw\t$s2, 32($sp)",
+	"\tlw\t$s3, 36($sp)",
+	"\tlw\t$ra, 40($sp)",
+	"\taddiu\t$sp, $sp, 48",
+	"\tjr\t$ra",
+	"",
+	"ruc_heap:",
+	"\tla\t$v1, ruc_hp",
+	"\tlw\t$v0, 0($v1)",
+	"\tsubu\t$v0, $v0, $a0",
+	"\taddiu\t$a1, $v0, -256",
+	"\tslt\t$a1, $s5, $a1",
+	"\tbeqz\t$a1, ruc_fail_stack",
+	"\tsw\t$v0, 0($v1)",
+	"\tsll\t$v1, $v0, 2",
+	"\taddu\t$v1, $v1, $s7",
+	".Lheap_loop:",
+	"\tbeqz\t$a0, .Lheap_done",
+	"\tsw\t$zero, 0($v1)",
+	"\taddiu\t$v1, $v1, 4",
+	"\taddiu\t$a0, $a0, -1",
+	"\tb\t.Lheap_loop",
+	".Lheap_done:",
+	"\tjr\t$ra",
+	"",
+	"ruc_index:",
+	"\tblez\t$a0, .Lindex_null",
+	"\taddiu\t$v0, $a0, -1",
+	"\tsll\t$v0, $v0, 2",
+	"\taddu\t$v0, $v0, $s7",
+	"\tlw\t$v1, 0($v0)",
+	"\tsltu\t$v0, $a1, $v1",
+	"\tbeqz\t$v0, .Lindex_range",
+	"\tmul\t$v0, $a1, $a2",
+	"\taddu\t$v0, $v0, $a0",
+	"\tjr\t$ra",
+	".Lindex_null:",
+	"\tmove\t$v1, $zero",
+	".Lindex_range:",
+	"\tla\t$a0, ruc_message_index",
+	"\tmove\t$a2, $v1",
+	"\tj\truc_fail",
+	"",
+	"ruc_div:",
+	"\tbeqz\t$a1, ruc_fail_zero",
+	"\tli\t$v0, -1",
+	"\tbeq\t$a1, $v0, .Ldiv_negate",
+	"\tdiv\t$zero, $a0, $a1",
+	"\tmflo\t$v0",
+	"\tjr\t$ra",
+	".Ldiv_negate:",
+	"\tsubu\t$v0, $zero, $a0",
+	"\tjr\t$ra",
+	"",
+	"ruc_rem:",
+	"\tbeqz\t$a1, ruc_fail_zero",
+	"\tli\t$v0, -1",
+	"\tbeq\t$a1, $v0, .Lrem_zero",
+	"\tdiv\t$zero, $a0, $a1",
+	"\tmfhi\t$v0",
+	"\tjr\t$ra",
+	".Lrem_zero:",
+	"\tmove\t$v0, $zero",
+	"\tjr\t$ra",
+	"",
+	"ruc_fdiv:",
+	"\tmtc1\t$zero, $f0",
+	"\tmtc1\t$zero, $f1",
+	"\tc.eq.d\t$f14, $f0",
+	"\tbc1t\truc_fail_zero",
+	"\tdiv.d\t$f0, $f12, $f14",
+	"\tjr\t$ra",
+	"",
+	"ruc_function:",
+	"\tla\t$v1, ruc_functions_size",
+	"\tlw\t$v1, 0($v1)",
+	"\tsltu\t$v0, $a0, $v1",
+	"\tbeqz\t$v0, .Lfunction_fail",
+	"\tla\t$v1, ruc_functions",
+	"\tsll\t$v0, $a0, 2",
+	"\taddu\t$v0, $v0, $v1",
+	"\tlw\t$v0, 0($v0)",
+	"\tbeqz\t$v0, .Lfunction_fail",
+	"\tjr\t$ra",
+	".Lfunction_fail:",
+	"\tmove\t$a1, $a0",
+	"\tla\t$a0, ruc_message_function",
+	"\tmove\t$a2, $zero",
+	"\tj\truc_fail",
+	"",
+	"ruc_print_int:",
+	"\taddiu\t$sp, $sp, -24",
+	"\tsw\t$ra, 20($sp)",
+	"\tmove\t$a1, $a0",
+	"\tla\t$a0, ruc_format_int",
+	"\tjal\tprintf",
+	"\tlw\t$ra, 20($sp)",
+	"\taddiu\t$sp, $sp, 24",
+	"\tjr\t$ra",
+	"",
+	"ruc_print_float:",
+	"\taddiu\t$sp, $sp, -24",
+	"\tsw\t$ra, 20($sp)",
+	"\tmfc1\t$a2, $f12",
+	"\tmfc1\t$a3, $f13",
+	"\tla\t$a0, ruc_format_float",
+	"\tjal\tprintf",
+	"\tlw\t$ra, 20($sp)",
+	"\taddiu\t$sp, $sp, 24",
+	"\tjr\t$ra",
+	"",
+	"ruc_print_text:",
+	"\taddiu\t$sp, $sp, -24",
+	"\tsw\t$ra, 20($sp)",
+	"\tmove\t$a1, $a0",
+	"\tla\t$a0, ruc_format_string",
+	"\tjal\tprintf",
+	"\tlw\t$ra, 20($sp)",
+	"\taddiu\t$sp, $sp, 24",
+	"\tjr\t$ra",
+	"",
+	"ruc_utf8:",
+	"\tsb\t$zero, 0($a1)",
+	"\tlui\t$v0, 0xFFE0",
+	"\tand\t$v0, $a0, $v0",
+	"\tbnez\t$v0, .Lutf8_done",
+	"\tsltiu\t$v0, $a0, 128",
+	"\tbeqz\t$v0, .Lutf8_multi",
+	"\tsb\t$a0, 0($a1)",
+	"\tsb\t$zero, 1($a1)",
+	"\tjr\t$ra",
+	".Lutf8_multi:",
+	"\tli\t$v0, 2",
+	"\tli\t$a2, 0xC0",
+	"\tli\t$v1, 0x3F000",
+	"\tand\t$v1, $a0, $v1",
+	"\tbeqz\t$v1, .Lutf8_four",
+	"\tli\t$v0, 3",
+	"\tli\t$a2, 0xE0",
+	".Lutf8_four:",
+	"\tli\t$v1, 0xFC0000",
+	"\tand\t$v1, $a0, $v1",
+	"\tbeqz\t$v1, .Lutf8_encode",
+	"\tli\t$v0, 4",
+	"\tli\t$a2, 0xF0",
+	".Lutf8_encode:",
+	"\tmove\t$v1, $zero",
+	".Lutf8_loop:",
+	"\tsubu\t$a3, $v0, $v1",
+	"\taddiu\t$a3, $a3, -1",
+	"\tsll\t$t9, $a3, 1",
+	"\taddu\t$a3, $a3, $t9",
+	"\tsll\t$a3, $a3, 1",
+	"\tsrlv\t$t9, $a0, $a3",
+	"\tandi\t$t9, $t9, 0x3F",
+	"\tori\t$t9, $t9, 0x80",
+	"\tor\t$t9, $t9, $a2",
+	"\tmove\t$a2, $zero",
+	"\taddu\t$a3, $a1, $v1",
+	"\tsb\t$t9, 0($a3)",
+	"\taddiu\t$v1, $v1, 1",
+	"\tbne\t$v1, $v0, .Lutf8_loop",
+	"\taddu\t$a3, $a1, $v0",
+	"\tsb\t$zero, 0($a3)",
+	".Lutf8_done:",
+	"\tjr\t$ra",
+	"",
+	"ruc_print_char:",
+	"\taddiu\t$sp, $sp, -32",
+	"\tsw\t$ra, 28($sp)",
+	"\taddiu\t$a1, $sp, 16",
+	"\tjal\truc_utf8",
+	"\tla\t$a0, ruc_format_string",
+	"\taddiu\t$a1, $sp, 16",
+	"\tjal\tprintf",
+	"\tlw\t$ra, 28($sp)",
+	"\taddiu\t$sp, $sp, 32",
+	"\tjr\t$ra",
+	"",
+	"ruc_string_length:",
+	"\taddiu\t$v1, $a0, -1",
+	"\tsll\t$v1, $v1, 2",
+	"\taddu\t$v1, $v1, $s7",
+	"\tlw\t$a1, 0($v1)",
+	"\tmove\t$v0, $zero",
+	".Llength_loop:",
+	"\tslt\t$a2, $v0, $a1",
+	"\tbeqz\t$a2, .Llength_done",
+	"\taddiu\t$v1, $v1, 4",
+	"\tlw\t$a2, 0($v1)",
+	"\tbeqz\t$a2, .Llength_done",
+	"\taddiu\t$v0, $v0, 1",
+	"\tb\t.Llength_loop",
+	".Llength_done:",
+	"\tjr\t$ra",
+	"",
+	"ruc_print_string:",
+	"\tblez\t$a0, .Lprint_string_return",
+	"\tla\t$v0, ruc_size",
+	"\tlw\t$v0, 0($v0)",
+	"\tslt\t$v0, $a0, $v0",
+	"\tbeqz\t$v0, .Lprint_string_return",
+	"\taddiu\t$sp, $sp, -32",
+	"\tsw\t$ra, 28($sp)",
+	"\tsw\t$s0, 24($sp)",
+	"\tsw\t$s1, 20($sp)",
+	"\tsw\t$s2, 16($sp)",
+	"\tmove\t$s0, $a0",
+	"\tjal\truc_string_length",
+	"\tmove\t$s1, $v0",
+	"\tmove\t$s2, $zero",
+	".Lprint_string_loop:",
+	"\tslt\t$v0, $s2, $s1",
+	"\tbeqz\t$v0, .Lprint_string_done",
+	"\taddu\t$a0, $s0, $s2",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tlw\t$a0, 0($a0)",
+	"\tjal\truc_print_char",
+	"\taddiu\t$s2, $s2, 1",
+	"\tb\t.Lprint_string_loop",
+	".Lprint_string_done:",
+	"\tlw\t$s2, 16($sp)",
+	"\tlw\t$s1, 20($sp)",
+	"\tlw\t$s0, 24($sp)",
+	"\tlw\t$ra, 28($sp)",
+	"\taddiu\t$sp, $sp, 32",
+	".Lprint_string_return:",
+	"\tjr\t$ra",
+	"",
+	"ruc_print_int_p:",
+	"\tlw\t$a0, 0($a0)",
+	"\tj\truc_print_int",
+	"",
+	"ruc_print_char_p:",
+	"\tlw\t$a0, 0($a0)",
+	"\tj\truc_print_char",
+	"",
+	"ruc_print_float_p:",
+	"\tlwc1\t$f12, 0($a0)",
+	"\tlwc1\t$f13, 4($a0)",
+	"\tj\truc_print_float",
+	"",
+	"ruc_upb:",
+	"\tmove\t$v0, $zero",
+	".Lupb_loop:",
+	"\tslt\t$v1, $v0, $a0",
+	"\tbeqz\t$v1, .Lupb_check",
+	"\tblez\t$a1, .Lupb_check",
+	"\taddiu\t$v1, $a1, -1",
+	"\tsll\t$v1, $v1, 2",
+	"\taddu\t$v1, $v1, $s7",
+	"\tlw\t$v1, 0($v1)",
+	"\tblez\t$v1, .Lupb_check",
+	"\tsll\t$v1, $a1, 2",
+	"\taddu\t$v1, $v1, $s7",
+	"\tlw\t$a1, 0($v1)",
+	"\taddiu\t$v0, $v0, 1",
+	"\tb\t.Lupb_loop",
+	".Lupb_check:",
+	"\tbltz\t$a0, .Lupb_fail",
+	"\tblez\t$a1, .Lupb_fail",
+	"\taddiu\t$v1, $a1, -1",
+	"\tsll\t$v1, $v1, 2",
+	"\taddu\t$v1, $v1, $s7",
+	"\tlw\t$v0, 0($v1)",
+	"\tjr\t$ra",
+	".Lupb_fail:",
+	"\tmove\t$a1, $a0",
+	"\tla\t$a0, ruc_message_dimension",
+	"\tmove\t$a2, $zero",
+	"\tj\truc_fail",
+	"",
+	"ruc_assert:",
+	"\tbeqz\t$a0, .Lassert_fail",
+	"\tjr\t$ra",
+	".Lassert_fail:",
+	"\taddiu\t$sp, $sp, -40",
+	"\tmove\t$s0, $a1",
+	"\tmove\t$a0, $zero",
+	"\tjal\tfflush",
+	"\tli\t$a0, 2",
+	"\tla\t$a1, ruc_message_error",
+	"\tjal\tdprintf",
+	"\tmove\t$a0, $s0",
+	"\tjal\truc_string_length",
+	"\tmove\t$s1, $v0",
+	"\tmove\t$s2, $zero",
+	".Lassert_loop:",
+	"\tslt\t$v0, $s2, $s1",
+	"\tbeqz\t$v0, .Lassert_exit",
+	"\taddu\t$a0, $s0, $s2",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tlw\t$a0, 0($a0)",
+	"\taddiu\t$a1, $sp, 24",
+	"\tjal\truc_utf8",
+	"\tli\t$a0, 2",
+	"\tla\t$a1, ruc_format_string",
+	"\taddiu\t$a2, $sp, 24",
+	"\tjal\tdprintf",
+	"\taddiu\t$s2, $s2, 1",
+	"\tb\t.Lassert_loop",
+	".Lassert_exit:",
+	"\tli\t$a0, 2",
+	"\tla\t$a1, ruc_format_newline",
+	"\tjal\tdprintf",
+	"\tli\t$a0, 1",
+	"\tjal\texit",
+	"",
+	"ruc_sqrt:",
+	"\tmtc1\t$zero, $f0",
+	"\tmtc1\t$zero, $f1",
+	"\tc.lt.d\t$f12, $f0",
+	"\tbc1t\t.Lsqrt_fail",
+	"\tsqrt.d\t$f0, $f12",
+	"\tjr\t$ra",
+	".Lsqrt_fail:",
+	"\tla\t$a0, ruc_message_sqrt",
+	"\tj\truc_fail_double",
+	"",
+	"ruc_log:",
+	"\tmtc1\t$zero, $f0",
+	"\tmtc1\t$zero, $f1",
+	"\tc.le.d\t$f12, $f0",
+	"\tbc1t\t.Llog_fail",
+	"\tj\tlog",
+	".Llog_fail:",
+	"\tla\t$a0, ruc_message_log",
+	"\tj\truc_fail_double",
+	"",
+	"ruc_log10:",
+	"\tmtc1\t$zero, $f0",
+	"\tmtc1\t$zero, $f1",
+	"\tc.le.d\t$f12, $f0",
+	"\tbc1t\t.Llog10_fail",
+	"\tj\tlog10",
+	".Llog10_fail:",
+	"\tla\t$a0, ruc_message_log10",
+	"\tj\truc_fail_double",
+	"",
+	"ruc_asin:",
+	"\tla\t$v0, ruc_double_one",
+	"\tlwc1\t$f0, 0($v0)",
+	"\tlwc1\t$f1, 4($v0)",
+	"\tc.lt.d\t$f0, $f12",
+	"\tbc1t\t.Lasin_fail",
+	"\tneg.d\t$f0, $f0",
+	"\tc.lt.d\t$f12, $f0",
+	"\tbc1t\t.Lasin_fail",
+	"\tj\tasin",
+	".Lasin_fail:",
+	"\tla\t$a0, ruc_message_asin",
+	"\tj\truc_fail_double",
+	"",
+	"ruc_round:",
+	"\taddiu\t$sp, $sp, -24",
+	"\tsw\t$ra, 20($sp)",
+	"\tjal\tround",
+	"\tla\t$v0, ruc_double_int_min",
+	"\tlwc1\t$f2, 0($v0)",
+	"\tlwc1\t$f3, 4($v0)",
+	"\tc.lt.d\t$f0, $f2",
+	"\tbc1t\t.Lround_fail",
+	"\tla\t$v0, ruc_double_int_max",
+	"\tlwc1\t$f2, 0($v0)",
+	"\tlwc1\t$f3, 4($v0)",
+	"\tc.lt.d\t$f2, $f0",
+	"\tbc1t\t.Lround_fail",
+	"\ttrunc.w.d\t$f2, $f0",
+	"\tmfc1\t$v0, $f2",
+	"\tlw\t$ra, 20($sp)",
+	"\taddiu\t$sp, $sp, 24",
+	"\tjr\t$ra",
+	".Lround_fail:",
+	"\tmov.d\t$f12, $f0",
+	"\tla\t$a0, ruc_message_round",
+	"\tj\truc_fail_double",
+	"",
+	"ruc_rand:",
+	"\taddiu\t$sp, $sp, -24",
+	"\tsw\t$ra, 20($sp)",
+	"\tjal\trand",
+	"\tmtc1\t$v0, $f0",
+	"\tcvt.d.w\t$f0, $f0",
+	"\tla\t$v0, ruc_double_rand_max",
+	"\tlwc1\t$f2, 0($v0)",
+	"\tlwc1\t$f3, 4($v0)",
+	"\tdiv.d\t$f0, $f0, $f2",
+	"\tlw\t$ra, 20($sp)",
+	"\taddiu\t$sp, $sp, 24",
+	"\tjr\t$ra",
+	"",
+	"ruc_strcpy:",
+	"\taddiu\t$sp, $sp, -48",
+	"\tsw\t$ra, 44($sp)",
+	"\tsw\t$s0, 40($sp)",
+	"\tsw\t$s1, 36($sp)",
+	"\tsw\t$s2, 32($sp)",
+	"\tsw\t$s3, 28($sp)",
+	"\tsw\t$a2, 16($sp)",
+	"\tsll\t$s0, $a0, 2",
+	"\taddu\t$s0, $s0, $s7",
+	"\tmove\t$s1, $a1",
+	"\tlw\t$s2, 0($s0)",
+	"\tmove\t$s3, $zero",
+	"\tbeqz\t$a3, .Lstrcpy_length",
+	"\tmove\t$a0, $s2",
+	"\tjal\truc_string_length",
+	"\tmove\t$s3, $v0",
+	".Lstrcpy_length:",
+	"\tmove\t$a0, $s1",
+	"\tjal\truc_string_length",
+	"\tlw\t$a2, 16($sp)",
+	"\tbltz\t$a2, .Lstrcpy_total",
+	"\tslt\t$v1, $a2, $v0",
+	"\tbeqz\t$v1, .Lstrcpy_total",
+	"\tmove\t$v0, $a2",
+	".Lstrcpy_total:",
+	"\tsw\t$v0, 20($sp)",
+	"\taddu\t$v1, $s3, $v0",
+	"\tsw\t$v1, 24($sp)",
+	"\taddiu\t$a0, $s2, -1",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tlw\t$a0, 0($a0)",
+	"\tslt\t$a0, $a0, $v1",
+	"\tbeqz\t$a0, .Lstrcpy_copy",
+	"\taddiu\t$a0, $v1, 1",
+	"\tjal\truc_heap",
+	"\tlw\t$v1, 24($sp)",
+	"\tsll\t$a0, $v0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tsw\t$v1, 0($a0)",
+	"\taddiu\t$a0, $a0, 4",
+	"\tsll\t$a1, $s2, 2",
+	"\taddu\t$a1, $a1, $s7",
+	"\taddiu\t$s2, $v0, 1",
+	"\tmove\t$a2, $s3",
+	"\tjal\truc_move",
+	".Lstrcpy_copy:",
+	"\taddu\t$a0, $s2, $s3",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tsll\t$a1, $s1, 2",
+	"\taddu\t$a1, $a1, $s7",
+	"\tlw\t$a2, 20($sp)",
+	"\tjal\truc_move",
+	"\taddiu\t$a0, $s2, -1",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tlw\t$a0, 0($a0)",
+	"\tlw\t$v1, 24($sp)",
+	"\tslt\t$a0, $v1, $a0",
+	"\tbeqz\t$a0, .Lstrcpy_done",
+	"\taddu\t$a0, $s2, $v1",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tsw\t$zero, 0($a0)",
+	".Lstrcpy_done:",
+	"\tsw\t$s2, 0($s0)",
+	"\tlw\t$s3, 28($sp)",
+	"\tlw\t$s2, 32($sp)",
+	"\tlw\t$s1, 36($sp)",
+	"\tlw\t$s0, 40($sp)",
+	"\tlw\t$ra, 44($sp)",
+	"\taddiu\t$sp, $sp, 48",
+	"\tjr\t$ra",
+	"",
+	"ruc_strcmp:",
+	"\taddiu\t$sp, $sp, -48",
+	"\tsw\t$ra, 44($sp)",
+	"\tsw\t$s0, 40($sp)",
+	"\tsw\t$s1, 36($sp)",
+	"\tsw\t$s2, 32($sp)",
+	"\tsw\t$s3, 28($sp)",
+	"\tsw\t$a2, 16($sp)",
+	"\tmove\t$s0, $a0",
+	"\tmove\t$s1, $a1",
+	"\tjal\truc_string_length",
+	"\tmove\t$s2, $v0",
+	"\tmove\t$a0, $s1",
+	"\tjal\truc_string_length",
+	"\tmove\t$s3, $v0",
+	"\tlw\t$a2, 16($sp)",
+	"\tmove\t$v0, $zero",
+	".Lstrcmp_loop:",
+	"\tbltz\t$a2, .Lstrcmp_body",
+	"\tslt\t$v1, $v0, $a2",
+	"\tbeqz\t$v1, .Lstrcmp_equal",
+	".Lstrcmp_body:",
+	"\tmove\t$a0, $zero",
+	"\tslt\t$v1, $v0, $s2",
+	"\tbeqz\t$v1, .Lstrcmp_second",
+	"\taddu\t$a0, $s0, $v0",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tlw\t$a0, 0($a0)",
+	".Lstrcmp_second:",
+	"\tmove\t$a1, $zero",
+	"\tslt\t$v1, $v0, $s3",
+	"\tbeqz\t$v1, .Lstrcmp_compare",
+	"\taddu\t$a1, $s1, $v0",
+	"\tsll\t$a1, $a1, 2",
+	"\taddu\t$a1, $a1, $s7",
+	"\tlw\t$a1, 0($a1)",
+	".Lstrcmp_compare:",
+	"\tbeq\t$a0, $a1, .Lstrcmp_same",
+	"\tslt\t$v1, $a0, $a1",
+	"\tli\t$v0, 1",
+	"\tbeqz\t$v1, .Lstrcmp_done",
+	"\tli\t$v0, -1",
+	"\tb\t.Lstrcmp_done",
+	".Lstrcmp_same:",
+	"\tbeqz\t$a0, .Lstrcmp_equal",
+	"\taddiu\t$v0, $v0, 1",
+	"\tb\t.Lstrcmp_loop",
+	".Lstrcmp_equal:",
+	"\tmove\t$v0, $zero",
+	".Lstrcmp_done:",
+	"\tlw\t$s3, 28($sp)",
+	"\tlw\t$s2, 32($sp)",
+	"\tlw\t$s1, 36($sp)",
+	"\tlw\t$s0, 40($sp)",
+	"\tlw\t$ra, 44($sp)",
+	"\taddiu\t$sp, $sp, 48",
+	"\tjr\t$ra",
+	"",
+	"ruc_strstr:",
+	"\taddiu\t$sp, $sp, -40",
+	"\tsw\t$ra, 36($sp)",
+	"\tsw\t$s0, 32($sp)",
+	"\tsw\t$s1, 28($sp)",
+	"\tsw\t$s2, 24($sp)",
+	"\tsw\t$s3, 20($sp)",
+	"\tmove\t$s0, $a0",
+	"\tmove\t$s1, $a1",
+	"\tjal\truc_string_length",
+	"\tmove\t$s2, $v0",
+	"\tmove\t$a0, $s1",
+	"\tjal\truc_string_length",
+	"\tmove\t$s3, $v0",
+	"\tmove\t$v0, $zero",
+	".Lstrstr_outer:",
+	"\taddu\t$v1, $v0, $s3",
+	"\tslt\t$v1, $s2, $v1",
+	"\tbnez\t$v1, .Lstrstr_missing",
+	"\tmove\t$a2, $zero",
+	".Lstrstr_inner:",
+	"\tslt\t$v1, $a2, $s3",
+	"\tbeqz\t$v1, .Lstrstr_done",
+	"\taddu\t$a0, $s0, $v0",
+	"\taddu\t$a0, $a0, $a2",
+	"\tsll\t$a0, $a0, 2",
+	"\taddu\t$a0, $a0, $s7",
+	"\tlw\t$a0, 0($a0)",
+	"\taddu\t$a1, $s1, $a2",
+	"\tsll\t$a1, $a1, 2",
+	"\taddu\t$a1, $a1, $s7",
+	"\tlw\t$a1, 0($a1)",
+	"\tbne\t$a0, $a1, .Lstrstr_step",
+	"\taddiu\t$a2, $a2, 1",
+	"\tb\t.Lstrstr_inner",
+	".Lstrstr_step:",
+	"\taddiu\t$v0, $v0, 1",
+	"\tb\t.Lstrstr_outer",
+	".Lstrstr_missing:",
+	"\tli\t$v0, -1",
+	".Lstrstr_done:",
+	"\tlw\t$s3, 20($sp)",
+	"\tlw\t$s2, 24($sp)",
+	"\tlw\t$s1, 28($sp)",
+	"\tlw\t$s0, 32($sp)",
+	"\tlw\t$ra, 36($sp)",
+	"\taddiu\t$sp, $sp, 40",
+	"\tjr\t$ra",
+	"",
+	"ruc_scan_int_p:",
+	"\taddiu\t$sp, $sp, -24",
+	"\tsw\t$ra, 20($sp)",
+	"\tmove\t$a1, $a0",
+	"\tla\t$a0, ruc_format_int",
+	"\tjal\tscanf",
+	"\tli\t$v1, 1",
+	"\tbne\t$v0, $v1, ruc_fail_input",
+	"\tlw\t$ra, 20($sp)",
+	"\taddiu\t$sp, $sp, 24",
+	"\tjr\t$ra",
+	"",
+	"ruc_scan_float_p:",
+	"\taddiu\t$sp, $sp, -32",
+	"\tsw\t$ra, 28($sp)",
+	"\tsw\t$a0, 24($sp)",
+	"\tla\t$a0, ruc_format_double",
+	"\taddiu\t$a1, $sp, 16",
+	"\tjal\tscanf",
+	"\tli\t$v1, 1",
+	"\tbne\t$v0, $v1, ruc_fail_input",
+	"\tlw\t$a0, 24($sp)",
+	"\tlw\t$v0, 16($sp)",
+	"\tsw\t$v0, 0($a0)",
+	"\tlw\t$v0, 20($sp)",
+	"\tsw\t$v0, 4($a0)",
+	"\tlw\t$ra, 28($sp)",
+	"\taddiu\t$sp, $sp, 32",
+	"\tjr\t$ra",
+	"",
+	"ruc_scan_char_p:",
+	"\taddiu\t$sp, $sp, -32",
+	"\tsw\t$ra, 28($sp)",
+	"\tsw\t$s0, 24($sp)",
+	"\tsw\t$s1, 20($sp)",
+	"\tsw\t$a0, 16($sp)",
+	".Lscan_skip:",
+	"\tjal\tgetchar",
+	"\tli\t$v1, 32",
+	"\tbeq\t$v0, $v1, .Lscan_skip",
+	"\tli\t$v1, 9",
+	"\tbeq\t$v0, $v1, .Lscan_skip",
+	"\tli\t$v1, 13",
+	"\tbeq\t$v0, $v1, .Lscan_skip",
+	"\tli\t$v1, 10",
+	"\tbeq\t$v0, $v1, .Lscan_skip",
+	"\tli\t$v1, -1",
+	"\tbeq\t$v0, $v1, ruc_fail_input",
+	"\tli\t$s1, 1",
+	"\tandi\t$s0, $v0, 0xFF",
+	"\tandi\t$v1, $v0, 0xE0",
+	"\tli\t$a0, 0xC0",
+	"\tbne\t$v1, $a0, .Lscan_three",
+	"\tli\t$s1, 2",
+	"\tandi\t$s0, $v0, 0x1F",
+	".Lscan_three:",
+	"\tandi\t$v1, $v0, 0xF0",
+	"\tli\t$a0, 0xE0",
+	"\tbne\t$v1, $a0, .Lscan_four",
+	"\tli\t$s1, 3",
+	"\tandi\t$s0, $v0, 0x0F",
+	".Lscan_four:",
+	"\tandi\t$v1, $v0, 0xF8",
+	"\tli\t$a0, 0xF0",
+	"\tbne\t$v1, $a0, .Lscan_loop",
+	"\tli\t$s1, 4",
+	"\tandi\t$s0, $v0, 0x07",
+	".Lscan_loop:",
+	"\taddiu\t$s1, $s1, -1",
+	"\tblez\t$s1, .Lscan_done",
+	"\tjal\tgetchar",
+	"\tandi\t$v0, $v0, 0x3F",
+	"\tsll\t$s0, $s0, 6",
+	"\tor\t$s0, $s0, $v0",
+	"\tb\t.Lscan_loop",
+	".Lscan_done:",
+	"\tlw\t$a0, 16($sp)",
+	"\tsw\t$s0, 0($a0)",
+	"\tlw\t$s1, 20($sp)",
+	"\tlw\t$s0, 24($sp)",
+	"\tlw\t$ra, 28($sp)",
+	"\taddiu\t$sp, $sp, 32",
+	"\tjr\t$ra",
+	"",
+	"\t.rdata",
+	"\t.align\t3",
+	"ruc_double_one:",
+	"\t.word\t0x00000000, 0x3FF00000",
+	"ruc_double_int_min:",
+	"\t.word\t0x00000000, 0xC1E00000",
+	"ruc_double_int_max:",
+	"\t.word\t0xFFC00000, 0x41DFFFFF",
+	"ruc_double_rand_max:",
+	"\t.word\t0x00000000, 0x41E00000",
+	"ruc_format_int:",
+	"\t.asciz\t\"%i\"",
+	"ruc_format_float:",
+	"\t.asciz\t\"%f\"",
+	"ruc_format_string:",
+	"\t.asciz\t\"%s\"",
+	"ruc_format_double:",
+	"\t.asciz\t\"%lf\"",
+	"ruc_format_space:",
+	"\t.asciz\t\" \"",
+	"ruc_format_newline:",
+	"\t.asciz\t\"\\n\"",
+	"ruc_format_begin:",
+	"\t.asciz\t\"{\"",
+	"ruc_format_end:",
+	"\t.asciz\t\"}\"",
+	"ruc_format_comma:",
+	"\t.asciz\t\", \"",
+};
+
+/** Runtime messages, same as in virtual machine */
+static const char *const MESSAGES[][2] =
+{
+	{ "error", "ruc: ошибка: " },
+	{ "stack", "переполнение стека" },
+	{ "function", "вызов неописанной функции с номером %i" },
+	{ "zero", "деление на ноль" },
+	{ "index", "индекс %i за пределами массива размера %i" },
+	{ "negative", "отрицательный размер массива %i" },
+	{ "initializer", "в инициализаторе %i элементов, а в массиве только %i" },
+	{ "dimension", "в upb указана несуществующая размерность %i" },
+	{ "sqrt", "аргумент %f функции sqrt вне области определения" },
+	{ "log", "аргумент %f функции log вне области определения" },
+	{ "log10", "аргумент %f функции log10 вне области определения" },
+	{ "asin", "аргумент %f функции asin вне области определения" },
+	{ "round", "результат округления %f не помещается в int" },
+	{ "input", "введённое значение не соответствует типу переменной" },
+};
+
+
+/** General purpose registers */
+typedef enum GPR
+{
+	r_zero, r_at, r_v0, r_v1,
+	r_a0, r_a1, r_a2, r_a3,
+	r_t0, r_t1, r_t2, r_t3, r_t4, r_t5, r_t6, r_t7,
+	r_s0, r_s1, r_s2, r_s3, r_s4, r_s5, r_s6, r_s7,
+	r_t8, r_t9, r_k0, r_k1, r_gp, r_sp, r_fp, r_ra,
+} gpr_t;
+
+static const char *const GPR_NAMES[] =
+{
+	"$zero", "$at", "$v0", "$v1",
+	"$a0", "$a1", "$a2", "$a3",
+	"$t0", "$t1", "$t2", "$t3", "$t4", "$t5", "$t6", "$t7",
+	"$s0", "$s1", "$s2", "$s3", "$s4", "$s5", "$s6", "$s7",
+	"$t8", "$t9", "$k0", "$k1", "$gp", "$sp", "$fp", "$ra",
+};
+
+static const char *const FPR_NAMES[] =
+{
+	"$f0", "$f1", "$f2", "$f3", "$f4", "$f5", "$f6", "$f7",
+	"$f8", "$f9", "$f10", "$f11", "$f12", "$f13", "$f14", "$f15",
+	"$f16", "$f17", "$f18", "$f19", "$f20", "$f21", "$f22", "$f23",
+	"$f24", "$f25", "$f26", "$f27", "$f28", "$f29", "$f30", "$f31",
+};
+
+/** Registers for integer temporaries, not preserved by calls */
+static const gpr_t INT_POOL[] = { r_t0, r_t1, r_t2, r_t3, r_t4, r_t5, r_t6, r_t7 };
+
+/** Even halves of registers for double temporaries, not preserved by calls */
+static const size_t DOUBLE_POOL[] = { 4, 6, 8, 10, 16, 18 };
+
+#define INT_REGISTERS		(sizeof(INT_POOL) / sizeof(INT_POOL[0]))
+#define DOUBLE_REGISTERS	(sizeof(DOUBLE_POOL) / sizeof(DOUBLE_POOL[0]))
+
+
+/** State of function in functions table */
+typedef enum STATE
+{
+	state_unknown,					/**< Function is not used */
+	state_referenced,				/**< Function is called directly */
+	state_defined,					/**< Function has a body */
+} state_t;
+
+/** Kind of compile time operand */
+typedef enum KIND
+{
+	kind_int,						/**< Integer word */
+	kind_double,					/**< Double of two words */
+	kind_block,						/**< Words on program stack */
+} kind_t;
+
+/** Place of operand value */
+typedef enum PLACE
+{
+	place_constant,					/**< Value is known */
+	place_register,					/**< Value is kept in register of pool */
+	place_slot,						/**< Value is spilled to frame */
+} place_t;
+
+/** Compile time operand, one or more words of virtual machine stack */
+typedef struct operand
+{
+	kind_t kind;					/**< Operand kind */
+	place_t place;					/**< Place of value or address of block */
+	int64_t value;					/**< Integer constant, register in pool or slot number */
+	uint64_t bits;					/**< Bits of double constant */
+	size_t length;					/**< Size in words */
+	size_t release;					/**< Slot with stack pointer to restore plus one, @c 0 if none */
+	size_t literal;					/**< Position of literal in data section plus one, @c 0 if none */
+} operand;
+
+/** Argument of printf call: operand of stack or word of arguments block */
+typedef struct argument
+{
+	operand value;					/**< Operand, if arguments are not read by words */
+	size_t offset;					/**< Offset in block of arguments */
+	int is_double;					/**< Set for double argument */
+} argument;
+
+/** Code unit, a function body, struct initialization procedure or initialization of globals */
+typedef struct unit
+{
+	universal_io io;				/**< Code of unit */
+	vector slots;					/**< Spill slots of frame: non-zero if used */
+	unsigned int_used;				/**< Busy integer registers of pool */
+	unsigned double_used;			/**< Busy double registers of pool */
+	size_t arguments;				/**< Maximum size of outgoing arguments in words */
+	size_t exit;					/**< Label of epilogue */
+	int is_procedure;				/**< Set for struct initialization procedure */
+	struct unit *parent;			/**< Enclosing unit of procedure */
+} unit;
+
+/** MIPS generator environment */
+typedef struct mipsgen
+{
+	syntax *sx;						/**< Syntax structure */
+
+	universal_io module;			/**< Definitions of module */
+	universal_io constants;			/**< String constants */
+	unit init;						/**< Initialization of globals */
+	unit function;					/**< Current function */
+	unit *current;					/**< Current code unit */
+
+	operand *stack;					/**< Compile time stack */
+	size_t stack_size;				/**< Size of compile time stack */
+	size_t stack_alloc;				/**< Allocated size of compile time stack */
+
+	vector logic;					/**< Stack for logic operations: temporary slot and end label */
+	vector calls;					/**< Stack of call frames slots */
+	vector data;					/**< Data section with literals */
+	vector labels;					/**< Labels by identifiers */
+	vector functions;				/**< Function states by numbers */
+	vector printers;				/**< Modes with print procedures */
+	vector scanners;				/**< Modes with scan procedures */
+
+	size_t blocks;					/**< Number of used labels */
+	size_t strings;					/**< Number of string constants */
+
+	size_t label_break;				/**< Label of break statement */
+	size_t label_continue;			/**< Label of continue statement */
+	size_t label_case;				/**< Label of next case check */
+	operand switch_value;			/**< Value of switch expression */
+
+	item_t function_mode;			/**< Mode of current function */
+	size_t param_words;				/**< Size of parameters of current function */
+
+	int was_error;					/**< Set if error occurred */
+} mipsgen;
+
+
+static void block(mipsgen *const gen, node *const nd);
+static void expression(mipsgen *const gen, node *const nd, const int mode);
+
+static void emit(mipsgen *const gen, const char *const format, ...)
+	__attribute__((format(printf, 2, 3)));
+
+
+static inline size_t label(mipsgen *const gen)
+{
+	return ++gen->blocks;
+}
+
+static void unsupported(mipsgen *const gen, const item_t type)
+{
+	system_error(node_unsupported, (int)type);
+	gen->was_error = 1;
+}
+
+
+static const char *mnemonic(const int code)
+{
+	switch (code)
+	{
+		case bltz:
+			return "bltz";
+		case jump:
+			return "j";
+		case jal:
+			return "jal";
+		case beq:
+			return "beq";
+		case bne:
+			return "bne";
+		case blez:
+			return "blez";
+		case bgtz:
+			return "bgtz";
+		case addiu:
+			return "addiu";
+		case slti:
+			return "slti";
+		case sltiu:
+			return "sltiu";
+		case andi:
+			return "andi";
+		case ori:
+			return "ori";
+		case xori:
+			return "xori";
+		case li:
+			return "li";
+		case la:
+			return "la";
+		case move:
+			return "move";
+		case mul:
+			return "mul";
+		case lw:
+			return "lw";
+		case sw:
+			return "sw";
+		case lwc1:
+			return "lwc1";
+		case swc1:
+			return "swc1";
+		case movf:
+			return "movf";
+		case sll:
+			return "sll";
+		case sra:
+			return "sra";
+		case sllv:
+			return "sllv";
+		case srav:
+			return "srav";
+		case jalr:
+			return "jalr";
+		case addu:
+			return "addu";
+		case subu:
+			return "subu";
+		case and:
+			return "and";
+		case or:
+			return "or";
+		case xor:
+			return "xor";
+		case nor:
+			return "nor";
+		case slt:
+			return "slt";
+		case sltu:
+			return "sltu";
+
+		case add_d:
+			return "add.d";
+		case sub_d:
+			return "sub.d";
+		case mul_d:
+			return "mul.d";
+		case div_d:
+			return "div.d";
+		case sqrt_d:
+			return "sqrt.d";
+		case abs_d:
+			return "abs.d";
+		case mov_d:
+			return "mov.d";
+		case neg_d:
+			return "neg.d";
+		case trunc_w_d:
+			return "trunc.w.d";
+		case cvt_d_w:
+			return "cvt.d.w";
+		case c_eq_d:
+			return "c.eq.d";
+		case c_lt_d:
+			return "c.lt.d";
+		case c_le_d:
+			return "c.le.d";
+		case mfc1:
+			return "mfc1";
+		case mtc1:
+			return "mtc1";
+		case bc1f:
+			return "bc1f";
+		case bc1t:
+			return "bc1t";
+
+		default:
+			return "nop";
+	}
+}
+
+/** Команда с регистрами вместо непосредственного значения */
+static int register_form(const int code)
+{
+	switch (code)
+	{
+		case slti:
+			return slt;
+		case sltiu:
+			return sltu;
+		case andi:
+			return and;
+		case ori:
+			return or;
+		case xori:
+			return xor;
+		default:
+			return addu;
+	}
+}
+
+
+static void emit(mipsgen *const gen, const char *const format, ...)
+{
+	universal_io *const io = &gen->current->io;
+
+	va_list args;
+	va_start(args, format);
+
+	uni_print_string(io, "\t");
+	out_get_func(io)(io, format, args);
+	uni_print_string(io, "\n");
+
+	va_end(args);
+}
+
+static void emit_register(mipsgen *const gen, const int code, const gpr_t target, const gpr_t fst, const gpr_t snd)
+{
+	emit(gen, "%s\t%s, %s, %s", mnemonic(code), GPR_NAMES[target], GPR_NAMES[fst], GPR_NAMES[snd]);
+}
+
+static void emit_li(mipsgen *const gen, const gpr_t target, const int64_t value)
+{
+	emit(gen, "li\t%s, %" PRIi32, GPR_NAMES[target], (int32_t)value);
+}
+
+static void emit_la(mipsgen *const gen, const gpr_t target, const char *const symbol)
+{
+	emit(gen, "la\t%s, %s", GPR_NAMES[target], symbol);
+}
+
+static void emit_move(mipsgen *const gen, const gpr_t target, const gpr_t source)
+{
+	if (target != source)
+	{
+		emit(gen, "move\t%s, %s", GPR_NAMES[target], GPR_NAMES[source]);
+	}
+}
+
+static void emit_immediate(mipsgen *const gen, const int code, const gpr_t target, const gpr_t source
+	, const int64_t value)
+{
+	const int32_t number = (int32_t)value;
+	const int is_unsigned = code == andi || code == ori || code == xori;
+	if (is_unsigned ? number >= 0 && number <= 0xFFFF : number >= -0x8000 && number <= 0x7FFF)
+	{
+		emit(gen, "%s\t%s, %s, %" PRIi32, mnemonic(code), GPR_NAMES[target], GPR_NAMES[source], number);
+		return;
+	}
+
+	// Значение не помещается в команду и собирается во временном регистре
+	emit_li(gen, r_at, number);
+	emit_register(gen, register_form(code), target, source, r_at);
+}
+
+static void emit_shift(mipsgen *const gen, const int code, const gpr_t target, const gpr_t source, const int64_t shift)
+{
+	emit(gen, "%s\t%s, %s, %i", mnemonic(code), GPR_NAMES[target], GPR_NAMES[source], (int)(shift & 31));
+}
+
+static void emit_access(mipsgen *const gen, const int code, const char *const target, const gpr_t base
+	, const int64_t offset)
+{
+	if (offset >= -0x8000 && offset <= 0x7FFF)
+	{
+		emit(gen, "%s\t%s, %i(%s)", mnemonic(code), target, (int)offset, GPR_NAMES[base]);
+		return;
+	}
+
+	emit_li(gen, r_at, offset);
+	emit_register(gen, addu, r_at, r_at, base);
+	emit(gen, "%s\t%s, 0($at)", mnemonic(code), target);
+}
+
+static void emit_memory(mipsgen *const gen, const int code, const gpr_t target, const gpr_t base
+	, const int64_t offset)
+{
+	emit_access(gen, code, GPR_NAMES[target], base, offset);
+}
+
+/** Загрузить или записать double парой команд, младшее слово по меньшему адресу */
+static void emit_memory_double(mipsgen *const gen, const int code, const size_t target, const gpr_t base
+	, const int64_t offset)
+{
+	emit_access(gen, code, FPR_NAMES[target], base, offset);
+	emit_access(gen, code, FPR_NAMES[target + 1], base, offset + 4);
+}
+
+static void emit_float(mipsgen *const gen, const int code, const size_t target, const size_t fst, const size_t snd)
+{
+	emit(gen, "%s\t%s, %s, %s", mnemonic(code), FPR_NAMES[target], FPR_NAMES[fst], FPR_NAMES[snd]);
+}
+
+static void emit_float_unary(mipsgen *const gen, const int code, const size_t target, const size_t source)
+{
+	if (code != mov_d || target != source)
+	{
+		emit(gen, "%s\t%s, %s", mnemonic(code), FPR_NAMES[target], FPR_NAMES[source]);
+	}
+}
+
+static void emit_transfer(mipsgen *const gen, const int code, const gpr_t gpr, const size_t fpr)
+{
+	emit(gen, "%s\t%s, %s", mnemonic(code), GPR_NAMES[gpr], FPR_NAMES[fpr]);
+}
+
+static void emit_call(mipsgen *const gen, const char *const function)
+{
+	emit(gen, "jal\t%s", function);
+}
+
+static void emit_jump(mipsgen *const gen, const size_t target)
+{
+	emit(gen, "j\t.L%zu", target);
+}
+
+static void emit_branch(mipsgen *const gen, const int code, const gpr_t fst, const gpr_t snd, const size_t target)
+{
+	emit(gen, "%s\t%s, %s, .L%zu", mnemonic(code), GPR_NAMES[fst], GPR_NAMES[snd], target);
+}
+
+static void emit_label(mipsgen *const gen, const size_t target)
+{
+	uni_printf(&gen->current->io, ".L%zu:\n", target);
+}
+
+
+/** Смещение относительно $fp младшего слова из @c words слотов, начиная с @c slot */
+static inline int64_t slot_offset(const size_t slot, const size_t words)
+{
+	return -(int64_t)(SAVED_AREA + 4 * (slot + words));
+}
+
+/** Занять @c words подряд идущих слотов кадра */
+static size_t slot_take(mipsgen *const gen, const size_t words)
+{
+	vector *const slots = &gen->current->slots;
+	const size_t size = vector_size(slots);
+
+	size_t run = 0;
+	size_t slot = size;
+	for (size_t i = 0; i < size; i++)
+	{
+		run = vector_get(slots, i) ? 0 : run + 1;
+		if (run == words)
+		{
+			slot = i + 1 - words;
+			break;
+		}
+	}
+
+	if (slot == size)
+	{
+		// Свободные слоты в конце кадра продолжаются новыми
+		slot = size - run;
+		vector_resize(slots, slot + words);
+	}
+
+	for (size_t i = 0; i < words; i++)
+	{
+		vector_set(slots, slot + i, 1);
+	}
+
+	return slot;
+}
+
+static void slot_free(mipsgen *const gen, const size_t slot, const size_t words)
+{
+	for (size_t i = 0; i < words; i++)
+	{
+		vector_set(&gen->current->slots, slot + i, 0);
+	}
+}
+
+
+static operand operand_register(const kind_t kind, const size_t number)
+{
+	operand op = { kind, place_register, (int64_t)number, 0, kind == kind_double ? 2 : 1, 0, 0 };
+	return op;
+}
+
+static operand operand_slot(const kind_t kind, const size_t slot)
+{
+	operand op = { kind, place_slot, (int64_t)slot, 0, kind == kind_double ? 2 : 1, 0, 0 };
+	return op;
+}
+
+static operand operand_constant(const int64_t value)
+{
+	operand op = { kind_int, place_constant, (int32_t)value, 0, 1, 0, 0 };
+	return op;
+}
+
+static operand operand_double(const uint64_t bits)
+{
+	operand op = { kind_double, place_constant, 0, bits, 2, 0, 0 };
+	return op;
+}
+
+static inline size_t operand_words(const operand *const op)
+{
+	return op->kind == kind_double ? 2 : 1;
+}
+
+static inline gpr_t int_register(const operand *const op)
+{
+	return INT_POOL[op->value];
+}
+
+static inline size_t double_register(const operand *const op)
+{
+	return DOUBLE_POOL[op->value];
+}
+
+/** Освободить регистр или слоты значения операнда */
+static void place_free(mipsgen *const gen, const operand *const op)
+{
+	unit *const un = gen->current;
+	if (op->place == place_register)
+	{
+		if (op->kind == kind_double)
+		{
+			un->double_used &= ~(1u << op->value);
+		}
+		else
+		{
+			un->int_used &= ~(1u << op->value);
+		}
+	}
+	else if (op->place == place_slot)
+	{
+		slot_free(gen, (size_t)op->value, operand_words(op));
+	}
+}
+
+static void operand_free(mipsgen *const gen, const operand *const op)
+{
+	place_free(gen, op);
+	if (op->kind == kind_block && op->release != 0)
+	{
+		slot_free(gen, op->release - 1, 1);
+	}
+}
+
+/** Перенести значение операнда из регистра в слоты кадра */
+static void operand_spill(mipsgen *const gen, operand *const op)
+{
+	if (op->place != place_register)
+	{
+		return;
+	}
+
+	const size_t words = operand_words(op);
+	const size_t slot = slot_take(gen, words);
+	if (op->kind == kind_double)
+	{
+		emit_memory_double(gen, swc1, double_register(op), r_fp, slot_offset(slot, words));
+	}
+	else
+	{
+		emit_memory(gen, sw, int_register(op), r_fp, slot_offset(slot, words));
+	}
+
+	place_free(gen, op);
+	op->place = place_slot;
+	op->value = (int64_t)slot;
+}
+
+/** Сохранить в кадре все значения стека перед вызовом или переходом */
+static void spill_all(mipsgen *const gen)
+{
+	for (size_t i = 0; i < gen->stack_size; i++)
+	{
+		operand_spill(gen, &gen->stack[i]);
+	}
+}
+
+/** Занять регистр пула, при нехватке вытесняется самый старый операнд стека */
+static size_t register_take(mipsgen *const gen, const kind_t kind)
+{
+	unit *const un = gen->current;
+	const int is_double = kind == kind_double;
+	unsigned *const used = is_double ? &un->double_used : &un->int_used;
+	const size_t count = is_double ? DOUBLE_REGISTERS : INT_REGISTERS;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		if (!(*used & (1u << i)))
+		{
+			*used |= 1u << i;
+			return i;
+		}
+	}
+
+	for (size_t i = 0; i < gen->stack_size; i++)
+	{
+		operand *const op = &gen->stack[i];
+		if (op->place == place_register && (op->kind == kind_double) == is_double)
+		{
+			const size_t number = (size_t)op->value;
+			operand_spill(gen, op);
+			*used |= 1u << number;
+			return number;
+		}
+	}
+
+	gen->was_error = 1;
+	return 0;
+}
+
+static operand int_take(mipsgen *const gen)
+{
+	return operand_register(kind_int, register_take(gen, kind_int));
+}
+
+static operand double_take(mipsgen *const gen)
+{
+	return operand_register(kind_double, register_take(gen, kind_double));
+}
+
+/** Регистр со значением операнда, при необходимости загруженным в @c scratch */
+static gpr_t int_source(mipsgen *const gen, const operand *const op, const gpr_t scratch)
+{
+	switch (op->place)
+	{
+		case place_constant:
+			if (op->value == 0)
+			{
+				return r_zero;
+			}
+			emit_li(gen, scratch, op->value);
+			return scratch;
+		case place_register:
+			return int_register(op);
+		default:
+			emit_memory(gen, lw, scratch, r_fp, slot_offset((size_t)op->value, 1));
+			return scratch;
+	}
+}
+
+static void double_load(mipsgen *const gen, const size_t target, const operand *const op)
+{
+	switch (op->place)
+	{
+		case place_constant:
+		{
+			const int64_t low = (int32_t)(op->bits & 0xFFFFFFFF);
+			const int64_t high = (int32_t)(op->bits >> 32);
+			const gpr_t source_low = low == 0 ? r_zero : r_t8;
+			if (low != 0)
+			{
+				emit_li(gen, r_t8, low);
+			}
+			emit_transfer(gen, mtc1, source_low, target);
+
+			if (high != low)
+			{
+				emit_li(gen, r_t8, high);
+			}
+			emit_transfer(gen, mtc1, high == 0 ? r_zero : r_t8, target + 1);
+		}
+		break;
+		case place_register:
+			emit_float_unary(gen, mov_d, target, double_register(op));
+			break;
+		default:
+			emit_memory_double(gen, lwc1, target, r_fp, slot_offset((size_t)op->value, 2));
+			break;
+	}
+}
+
+static size_t double_source(mipsgen *const gen, const operand *const op, const size_t scratch)
+{
+	if (op->place == place_register)
+	{
+		return double_register(op);
+	}
+
+	double_load(gen, scratch, op);
+	return scratch;
+}
+
+static void operand_load(mipsgen *const gen, const gpr_t target, const operand *const op)
+{
+	switch (op->place)
+	{
+		case place_constant:
+			emit_li(gen, target, op->value);
+			break;
+		case place_register:
+			emit_move(gen, target, int_register(op));
+			break;
+		default:
+			emit_memory(gen, lw, target, r_fp, slot_offset((size_t)op->value, 1));
+			break;
+	}
+}
+
+/** Загрузить операнд в регистр аргумента и освободить его */
+static void operand_argument(mipsgen *const gen, const gpr_t target, const operand *const op)
+{
+	operand_load(gen, target, op);
+	operand_free(gen, op);
+}
+
+static void double_argument(mipsgen *const gen, const size_t target, const operand *const op)
+{
+	double_load(gen, target, op);
+	operand_free(gen, op);
+}
+
+static operand int_from(mipsgen *const gen, const gpr_t source)
+{
+	const operand result = int_take(gen);
+	emit_move(gen, int_register(&result), source);
+	return result;
+}
+
+static operand double_from(mipsgen *const gen, const size_t source)
+{
+	const operand result = double_take(gen);
+	emit_float_unary(gen, mov_d, double_register(&result), source);
+	return result;
+}
+
+/** Базовый регистр и смещение в байтах для адреса виртуальной машины */
+static gpr_t address_base(mipsgen *const gen, const operand *const address, int64_t *const offset)
+{
+	if (address->place == place_constant)
+	{
+		*offset = 4 * address->value;
+		return r_s7;
+	}
+
+	const gpr_t source = int_source(gen, address, r_t9);
+	emit_shift(gen, sll, r_t9, source, 2);
+	emit_register(gen, addu, r_t9, r_t9, r_s7);
+	*offset = 0;
+	return r_t9;
+}
+
+/** Записать в регистр байтовый адрес слова памяти со сдвигом @c displ слов */
+static void byte_address(mipsgen *const gen, const gpr_t target, const operand *const address, const size_t displ)
+{
+	int64_t offset;
+	const gpr_t base = address_base(gen, address, &offset);
+	offset += 4 * (int64_t)displ;
+
+	if (offset == 0)
+	{
+		emit_move(gen, target, base);
+	}
+	else
+	{
+		emit_immediate(gen, addiu, target, base, offset);
+	}
+}
+
+
+static void stack_push(mipsgen *const gen, const operand op)
+{
+	if (gen->stack_size == gen->stack_alloc)
+	{
+		operand *const stack = realloc(gen->stack, 2 * gen->stack_alloc * sizeof(operand));
+		if (stack == NULL)
+		{
+			gen->was_error = 1;
+			return;
+		}
+
+		gen->stack = stack;
+		gen->stack_alloc *= 2;
+	}
+
+	gen->stack[gen->stack_size++] = op;
+}
+
+static operand stack_pop(mipsgen *const gen)
+{
+	return gen->stack_size != 0 ? gen->stack[--gen->stack_size] : operand_constant(0);
+}
+
+/** Индекс операнда, с которого начинаются последние @c words слов стека */
+static size_t stack_words(mipsgen *const gen, const size_t words)
+{
+	size_t index = gen->stack_size;
+	size_t size = 0;
+	while (size < words && index > 0)
+	{
+		size += gen->stack[--index].length;
+	}
+
+	return index;
+}
+
+static void block_release(mipsgen *const gen, const operand *const op)
+{
+	if (op->kind == kind_block && op->release != 0)
+	{
+		emit_memory(gen, lw, r_s5, r_fp, slot_offset(op->release - 1, 1));
+	}
+}
+
+/** Снять со стека операнды, начиная с @c from, освободив их регистры и слоты */
+static void stack_drop(mipsgen *const gen, const size_t from)
+{
+	while (gen->stack_size > from)
+	{
+		operand_free(gen, &gen->stack[--gen->stack_size]);
+	}
+}
+
+/** Освободить нижний блок среди операндов, начиная с @c from, и снять их со стека */
+static void stack_release(mipsgen *const gen, const size_t from)
+{
+	for (size_t i = from; i < gen->stack_size; i++)
+	{
+		if (gen->stack[i].kind == kind_block && gen->stack[i].release != 0)
+		{
+			block_release(gen, &gen->stack[i]);
+			break;
+		}
+	}
+
+	stack_drop(gen, from);
+}
+
+static operand value_int(mipsgen *const gen, const operand *const op)
+{
+	if (op->kind != kind_block)
+	{
+		return *op;
+	}
+
+	const operand result = int_take(gen);
+	int64_t offset;
+	const gpr_t base = address_base(gen, op, &offset);
+	emit_memory(gen, lw, int_register(&result), base, offset);
+	return result;
+}
+
+static operand value_double(mipsgen *const gen, const operand *const op)
+{
+	if (op->kind != kind_block)
+	{
+		return *op;
+	}
+
+	const operand result = double_take(gen);
+	int64_t offset;
+	const gpr_t base = address_base(gen, op, &offset);
+	emit_memory_double(gen, lwc1, double_register(&result), base, offset);
+	return result;
+}
+
+static operand pop_int(mipsgen *const gen)
+{
+	const operand op = stack_pop(gen);
+	if (op.kind != kind_block)
+	{
+		return op;
+	}
+
+	const operand result = value_int(gen, &op);
+	block_release(gen, &op);
+	operand_free(gen, &op);
+	return result;
+}
+
+static operand pop_double(mipsgen *const gen)
+{
+	const operand op = stack_pop(gen);
+	if (op.kind != kind_block)
+	{
+		return op;
+	}
+
+	const operand result = value_double(gen, &op);
+	block_release(gen, &op);
+	operand_free(gen, &op);
+	return result;
+}
+
+
+static inline item_t displ_shift(const item_t displ, const size_t offset)
+{
+	return displ < 0 ? displ - (item_t)offset : displ + (item_t)offset;
+}
+
+/** Базовый регистр и смещение в байтах ячейки переменной */
+static gpr_t cell_base(const item_t displ, int64_t *const offset)
+{
+	*offset = 4 * (int64_t)(displ < 0 ? -displ : displ);
+	return displ < 0 ? r_s7 : r_s6;
+}
+
+/** Байтовый адрес ячейки переменной */
+static void cell_address(mipsgen *const gen, const gpr_t target, const item_t displ)
+{
+	int64_t offset;
+	const gpr_t base = cell_base(displ, &offset);
+	emit_immediate(gen, addiu, target, base, offset);
+}
+
+/** Адрес ячейки переменной в памяти виртуальной машины */
+static operand cell_location(mipsgen *const gen, const item_t displ)
+{
+	if (displ < 0)
+	{
+		return operand_constant(-displ);
+	}
+
+	const operand result = int_take(gen);
+	emit_immediate(gen, addiu, int_register(&result), r_s4, displ);
+	return result;
+}
+
+static operand load_cell(mipsgen *const gen, const item_t displ, const kind_t kind)
+{
+	int64_t offset;
+	const gpr_t base = cell_base(displ, &offset);
+
+	if (kind == kind_double)
+	{
+		const operand result = double_take(gen);
+		emit_memory_double(gen, lwc1, double_register(&result), base, offset);
+		return result;
+	}
+
+	const operand result = int_take(gen);
+	emit_memory(gen, lw, int_register(&result), base, offset);
+	return result;
+}
+
+/** Записать значение по базовому регистру, не освобождая операнд */
+static void store_value(mipsgen *const gen, const operand *const value, const gpr_t base, const int64_t offset)
+{
+	if (value->kind == kind_double)
+	{
+		emit_memory_double(gen, swc1, double_source(gen, value, 0), base, offset);
+	}
+	else
+	{
+		emit_memory(gen, sw, int_source(gen, value, r_t8), base, offset);
+	}
+}
+
+static void store_cell(mipsgen *const gen, const item_t displ, const operand *const value)
+{
+	int64_t offset;
+	const gpr_t base = cell_base(displ, &offset);
+	store_value(gen, value, base, offset);
+}
+
+/** Скопировать блок слов памяти функцией среды исполнения */
+static void copy_words(mipsgen *const gen, const operand *const source, const size_t length)
+{
+	byte_address(gen, r_a1, source, 0);
+	emit_li(gen, r_a2, (int64_t)length);
+	emit_call(gen, "ruc_move");
+}
+
+/** Записать слова стека, начиная с @c from, в память по адресу со сдвигом @c displ слов */
+static void store_words(mipsgen *const gen, const size_t from, const operand *const address, const size_t displ
+	, const int is_release)
+{
+	size_t offset = displ;
+	for (size_t i = from; i < gen->stack_size; i++)
+	{
+		offset += gen->stack[i].length;
+	}
+
+	// Запись в обратном порядке не портит блоки, лежащие выше адреса назначения
+	for (size_t i = gen->stack_size; i > from; i--)
+	{
+		const operand *const op = &gen->stack[i - 1];
+		offset -= op->length;
+
+		if (op->kind == kind_block)
+		{
+			byte_address(gen, r_a0, address, offset);
+			copy_words(gen, op, op->length);
+		}
+		else
+		{
+			// Значение загружается до вычисления адреса, который занимает $t9
+			if (op->kind == kind_double)
+			{
+				const size_t source = double_source(gen, op, 0);
+				int64_t base_offset;
+				const gpr_t base = address_base(gen, address, &base_offset);
+				emit_memory_double(gen, swc1, source, base, base_offset + 4 * (int64_t)offset);
+			}
+			else
+			{
+				const gpr_t source = int_source(gen, op, r_t8);
+				int64_t base_offset;
+				const gpr_t base = address_base(gen, address, &base_offset);
+				emit_memory(gen, sw, source, base, base_offset + 4 * (int64_t)offset);
+			}
+		}
+	}
+
+	if (is_release)
+	{
+		stack_release(gen, from);
+	}
+	else
+	{
+		stack_drop(gen, from);
+	}
+}
+
+/** Записать слова стека, начиная с @c from, в переменную */
+static void store_cells(mipsgen *const gen, const size_t from, const item_t displ)
+{
+	size_t offset = 0;
+	for (size_t i = from; i < gen->stack_size; i++)
+	{
+		const operand *const op = &gen->stack[i];
+		const item_t cell = displ_shift(displ, offset);
+
+		if (op->kind == kind_block)
+		{
+			cell_address(gen, r_a0, cell);
+			copy_words(gen, op, op->length);
+		}
+		else
+		{
+			store_cell(gen, cell, op);
+		}
+
+		offset += op->length;
+	}
+
+	stack_release(gen, from);
+}
+
+/** Сохранить в новом слоте указатель стека программы, который нужно восстановить после блока */
+static size_t release_take(mipsgen *const gen, const gpr_t address)
+{
+	const size_t slot = slot_take(gen, 1);
+	emit_immediate(gen, addiu, r_t8, address, -1);
+	emit_memory(gen, sw, r_t8, r_fp, slot_offset(slot, 1));
+	return slot + 1;
+}
+
+/** Собрать слова стека, начиная с @c from, в один блок на стеке программы */
+static void stack_materialize(mipsgen *const gen, const size_t from, const size_t words)
+{
+	if (from + 1 == gen->stack_size && gen->stack[from].kind == kind_block)
+	{
+		return;
+	}
+
+	size_t inner = 0;
+	for (size_t i = from; i < gen->stack_size && inner == 0; i++)
+	{
+		inner = gen->stack[i].kind == kind_block ? gen->stack[i].release : 0;
+	}
+
+	emit_li(gen, r_a0, (int64_t)words);
+	emit_call(gen, "ruc_push");
+
+	size_t release;
+	if (inner == 0)
+	{
+		release = release_take(gen, r_v0);
+	}
+	else
+	{
+		// Восстанавливается указатель стека, сохранённый для нижнего блока
+		release = slot_take(gen, 1) + 1;
+		emit_memory(gen, lw, r_t8, r_fp, slot_offset(inner - 1, 1));
+		emit_memory(gen, sw, r_t8, r_fp, slot_offset(release - 1, 1));
+	}
+
+	operand address = int_from(gen, r_v0);
+	store_words(gen, from, &address, 0, 0);
+
+	address.kind = kind_block;
+	address.length = words;
+	address.release = release;
+	stack_push(gen, address);
+}
+
+/** Положить на стек копию слов памяти */
+static void push_words(mipsgen *const gen, const operand *const address, const size_t length)
+{
+	if (length <= MAX_INLINE_WORDS)
+	{
+		for (size_t i = 0; i < length; i++)
+		{
+			const operand result = int_take(gen);
+			int64_t offset;
+			const gpr_t base = address_base(gen, address, &offset);
+			emit_memory(gen, lw, int_register(&result), base, offset + 4 * (int64_t)i);
+			stack_push(gen, result);
+		}
+		return;
+	}
+
+	emit_li(gen, r_a0, (int64_t)length);
+	emit_call(gen, "ruc_push");
+	const size_t release = release_take(gen, r_v0);
+
+	operand block_address = int_from(gen, r_v0);
+	byte_address(gen, r_a0, &block_address, 0);
+	copy_words(gen, address, length);
+
+	block_address.kind = kind_block;
+	block_address.length = length;
+	block_address.release = release;
+	stack_push(gen, block_address);
+}
+
+
+static void string_escape(universal_io *const io, const char *const string, const size_t length)
+{
+	uni_print_string(io, "\t.asciz\t\"");
+	for (size_t i = 0; i < length; i++)
+	{
+		const unsigned char symbol = (unsigned char)string[i];
+		if (symbol < ' ' || symbol == '"' || symbol == '\\' || symbol >= 0x7F)
+		{
+			uni_printf(io, "\\%03o", symbol);
+		}
+		else
+		{
+			uni_printf(io, "%c", symbol);
+		}
+	}
+	uni_print_string(io, "\"\n");
+}
+
+static size_t string_constant(mipsgen *const gen, const char *const string, const size_t length)
+{
+	const size_t number = gen->strings++;
+	uni_printf(&gen->constants, ".LS%zu:\n", number);
+	string_escape(&gen->constants, string, length);
+	return number;
+}
+
+/** Разместить литерал в секции данных */
+static operand literal(mipsgen *const gen, node *const nd, const item_t type)
+{
+	const item_t N = node_get_arg(nd, 0);
+	vector_add(&gen->data, N);
+	const size_t position = vector_size(&gen->data);
+
+	for (item_t i = 0; i < N; i++)
+	{
+		if (type == TString)
+		{
+			vector_add(&gen->data, node_get_arg(nd, (size_t)i + 1));
+		}
+		else
+		{
+			vector_add(&gen->data, node_get_arg(nd, 2 * (size_t)i + 1));
+			vector_add(&gen->data, node_get_arg(nd, 2 * (size_t)i + 2));
+		}
+	}
+
+	operand op = operand_constant((item_t)((size_t)gen->sx->max_displg + position));
+	op.literal = position;
+	return op;
+}
+
+
+static void function_reference(mipsgen *const gen, const size_t number)
+{
+	if (number >= vector_size(&gen->functions))
+	{
+		vector_resize(&gen->functions, number + 1);
+	}
+
+	if (vector_get(&gen->functions, number) == state_unknown)
+	{
+		vector_set(&gen->functions, number, state_referenced);
+	}
+}
+
+/** Вид возвращаемого значения, @c kind_block для void и структур */
+static kind_t return_kind(const syntax *const sx, const item_t mode)
+{
+	const item_t type = mode_get(sx, (size_t)mode + 1);
+	if (type == LFLOAT)
+	{
+		return kind_double;
+	}
+
+	return type == LVOID || (type > 0 && mode_get(sx, (size_t)type) == mode_struct) ? kind_block : kind_int;
+}
+
+static void helper_request(vector *const helpers, const item_t mode)
+{
+	for (size_t i = 0; i < vector_size(helpers); i++)
+	{
+		if (vector_get(helpers, i) == mode)
+		{
+			return;
+		}
+	}
+
+	vector_add(helpers, mode);
+}
+
+static inline int is_compound(const syntax *const sx, const item_t mode)
+{
+	const item_t type = mode > 0 ? mode_get(sx, (size_t)mode) : mode;
+	return type == mode_array || type == mode_struct;
+}
+
+/** Имя процедуры печати значения по байтовому адресу в @c $a0 */
+static const char *printer_name(mipsgen *const gen, const item_t mode, char *const buffer)
+{
+	if (mode == LCHAR)
+	{
+		return "ruc_print_char_p";
+	}
+	else if (mode == LFLOAT)
+	{
+		return "ruc_print_float_p";
+	}
+	else if (!is_compound(gen->sx, mode))
+	{
+		return "ruc_print_int_p";
+	}
+
+	helper_request(&gen->printers, mode);
+	sprintf(buffer, "ruc_print_%" PRIitem, mode);
+	return buffer;
+}
+
+/** Имя процедуры ввода значения по байтовому адресу в @c $a0 */
+static const char *scanner_name(mipsgen *const gen, const item_t mode, char *const buffer)
+{
+	if (mode == LCHAR)
+	{
+		return "ruc_scan_char_p";
+	}
+	else if (mode == LFLOAT)
+	{
+		return "ruc_scan_float_p";
+	}
+	else if (!is_compound(gen->sx, mode))
+	{
+		return "ruc_scan_int_p";
+	}
+
+	helper_request(&gen->scanners, mode);
+	sprintf(buffer, "ruc_scan_%" PRIitem, mode);
+	return buffer;
+}
+
+
+static operand int_operation(mipsgen *const gen, const item_t code, const operand *const fst
+	, const operand *const snd)
+{
+	if (code == ASS)
+	{
+		operand_free(gen, fst);
+		return *snd;
+	}
+
+	if (code == LDIV || code == LREM)
+	{
+		operand_argument(gen, r_a0, fst);
+		operand_argument(gen, r_a1, snd);
+		emit_call(gen, code == LDIV ? "ruc_div" : "ruc_rem");
+		return int_from(gen, r_v0);
+	}
+
+	if (snd->place == place_constant)
+	{
+		// Второй операнд подставляется в команду непосредственным значением
+		const int64_t value = snd->value;
+		int is_immediate = 1;
+		switch (code)
+		{
+			case LPLUS:
+			case LMINUS:
+			case LAND:
+			case LOR:
+			case LEXOR:
+			case LSHL:
+			case LSHR:
+			case LLT:
+			case LGE:
+			case EQEQ:
+			case NOTEQ:
+				break;
+			default:
+				is_immediate = 0;
+				break;
+		}
+
+		if (is_immediate)
+		{
+			const gpr_t a = int_source(gen, fst, r_t8);
+			operand_free(gen, fst);
+			const operand result = int_take(gen);
+			const gpr_t r = int_register(&result);
+
+			switch (code)
+			{
+				case LPLUS:
+					emit_immediate(gen, addiu, r, a, value);
+					break;
+				case LMINUS:
+					emit_immediate(gen, addiu, r, a, -value);
+					break;
+				case LAND:
+					emit_immediate(gen, andi, r, a, value);
+					break;
+				case LOR:
+					emit_immediate(gen, ori, r, a, value);
+					break;
+				case LEXOR:
+					emit_immediate(gen, xori, r, a, value);
+					break;
+				case LSHL:
+					emit_shift(gen, sll, r, a, value);
+					break;
+				case LSHR:
+					emit_shift(gen, sra, r, a, value);
+					break;
+				case LLT:
+				case LGE:
+					emit_immediate(gen, slti, r, a, value);
+					if (code == LGE)
+					{
+						emit_immediate(gen, xori, r, r, 1);
+					}
+					break;
+				default:
+				{
+					gpr_t difference = a;
+					if (value != 0)
+					{
+						emit_immediate(gen, xori, r, a, value);
+						difference = r;
+					}
+
+					if (code == EQEQ)
+					{
+						emit_immediate(gen, sltiu, r, difference, 1);
+					}
+					else
+					{
+						emit_register(gen, sltu, r, r_zero, difference);
+					}
+				}
+				break;
+			}
+
+			return result;
+		}
+	}
+
+	const gpr_t a = int_source(gen, fst, r_t8);
+	const gpr_t b = int_source(gen, snd, r_v1);
+	operand_free(gen, fst);
+	operand_free(gen, snd);
+	const operand result = int_take(gen);
+	const gpr_t r = int_register(&result);
+
+	switch (code)
+	{
+		case LSHL:
+			emit_register(gen, sllv, r, a, b);
+			break;
+		case LSHR:
+			emit_register(gen, srav, r, a, b);
+			break;
+		case LOGAND:
+			emit_register(gen, sltu, r_t8, r_zero, a);
+			emit_register(gen, sltu, r, r_zero, b);
+			emit_register(gen, and, r, r, r_t8);
+			break;
+		case LOGOR:
+			emit_register(gen, or, r, a, b);
+			emit_register(gen, sltu, r, r_zero, r);
+			break;
+		case LAND:
+			emit_register(gen, and, r, a, b);
+			break;
+		case LEXOR:
+			emit_register(gen, xor, r, a, b);
+			break;
+		case LOR:
+			emit_register(gen, or, r, a, b);
+			break;
+		case LPLUS:
+			emit_register(gen, addu, r, a, b);
+			break;
+		case LMINUS:
+			emit_register(gen, subu, r, a, b);
+			break;
+		case LMULT:
+			emit_register(gen, mul, r, a, b);
+			break;
+		case NOTEQ:
+			emit_register(gen, xor, r, a, b);
+			emit_register(gen, sltu, r, r_zero, r);
+			break;
+		case LLT:
+			emit_register(gen, slt, r, a, b);
+			break;
+		case LGT:
+			emit_register(gen, slt, r, b, a);
+			break;
+		case LLE:
+			emit_register(gen, slt, r, b, a);
+			emit_immediate(gen, xori, r, r, 1);
+			break;
+		case LGE:
+			emit_register(gen, slt, r, a, b);
+			emit_immediate(gen, xori, r, r, 1);
+			break;
+		default:
+			emit_register(gen, xor, r, a, b);
+			emit_immediate(gen, sltiu, r, r, 1);
+			break;
+	}
+
+	return result;
+}
+
+static operand double_operation(mipsgen *const gen, const item_t code, const operand *const fst
+	, const operand *const snd)
+{
+	if (code == ASS)
+	{
+		operand_free(gen, fst);
+		return *snd;
+	}
+
+	if (code == LDIV || code == LDIVR)
+	{
+		double_argument(gen, 12, fst);
+		double_argument(gen, 14, snd);
+		emit_call(gen, "ruc_fdiv");
+		return double_from(gen, 0);
+	}
+
+	const size_t a = double_source(gen, fst, 0);
+	const size_t b = double_source(gen, snd, 2);
+	operand_free(gen, fst);
+	operand_free(gen, snd);
+
+	switch (code)
+	{
+		case LPLUS:
+		case LPLUSR:
+		case LMINUS:
+		case LMINUSR:
+		case LMULT:
+		case LMULTR:
+		{
+			const operand result = double_take(gen);
+			const int instruction = code == LPLUS || code == LPLUSR
+				? add_d
+				: code == LMINUS || code == LMINUSR ? sub_d : mul_d;
+			emit_float(gen, instruction, double_register(&result), a, b);
+			return result;
+		}
+
+		default:
+		{
+			const operand result = int_take(gen);
+			const gpr_t r = int_register(&result);
+			switch (code)
+			{
+				case LLTR:
+					emit(gen, "%s\t%s, %s", mnemonic(c_lt_d), FPR_NAMES[a], FPR_NAMES[b]);
+					break;
+				case LGTR:
+					emit(gen, "%s\t%s, %s", mnemonic(c_lt_d), FPR_NAMES[b], FPR_NAMES[a]);
+					break;
+				case LLER:
+					emit(gen, "%s\t%s, %s", mnemonic(c_le_d), FPR_NAMES[a], FPR_NAMES[b]);
+					break;
+				case LGER:
+					emit(gen, "%s\t%s, %s", mnemonic(c_le_d), FPR_NAMES[b], FPR_NAMES[a]);
+					break;
+				default:
+					emit(gen, "%s\t%s, %s", mnemonic(c_eq_d), FPR_NAMES[a], FPR_NAMES[b]);
+					break;
+			}
+
+			// Флаг сравнения переносится в регистр условной пересылкой
+			if (code == NOTEQR)
+			{
+				emit_move(gen, r, r_zero);
+				emit_li(gen, r_t8, 1);
+				emit(gen, "movf\t%s, $t8, $fcc0", GPR_NAMES[r]);
+			}
+			else
+			{
+				emit_li(gen, r, 1);
+				emit(gen, "movf\t%s, $zero, $fcc0", GPR_NAMES[r]);
+			}
+			return result;
+		}
+	}
+}
+
+/** Базовый регистр изменяемой переменной: по смещению или по адресу со стека */
+static gpr_t target_base(mipsgen *const gen, node *const nd, const operand *const address, int64_t *const offset)
+{
+	return address != NULL ? address_base(gen, address, offset) : cell_base(node_get_arg(nd, 0), offset);
+}
+
+static void int_assignment(mipsgen *const gen, node *const nd, const item_t operation)
+{
+	static const item_t codes[] = { LREM, LSHL, LSHR, LAND, LEXOR, LOR, ASS, LPLUS, LMINUS, LMULT, LDIV };
+
+	const int is_void = operation >= REMASSV;
+	const item_t base_operation = is_void ? operation - 200 : operation;
+	const int is_address = base_operation >= REMASSAT;
+	const item_t code = codes[base_operation - (is_address ? REMASSAT : REMASS)];
+
+	const operand value = pop_int(gen);
+	const operand address = is_address ? pop_int(gen) : operand_constant(0);
+
+	// Вызовы деления не портят $t9 с адресом переменной
+	int64_t offset;
+	const gpr_t base = target_base(gen, nd, is_address ? &address : NULL, &offset);
+
+	operand result = value;
+	if (code != ASS)
+	{
+		const operand old = int_take(gen);
+		emit_memory(gen, lw, int_register(&old), base, offset);
+		result = int_operation(gen, code, &old, &value);
+	}
+
+	store_value(gen, &result, base, offset);
+	operand_free(gen, &address);
+
+	if (is_void)
+	{
+		operand_free(gen, &result);
+	}
+	else
+	{
+		stack_push(gen, result);
+	}
+}
+
+static void double_assignment(mipsgen *const gen, node *const nd, const item_t operation)
+{
+	static const item_t codes[] = { ASS, LPLUS, LMINUS, LMULT, LDIV };
+
+	const int is_void = operation >= ASSRV;
+	const item_t base_operation = is_void ? operation - 200 : operation;
+	const int is_address = base_operation >= ASSATR;
+	const item_t code = codes[base_operation - (is_address ? ASSATR : ASSR)];
+
+	const operand value = pop_double(gen);
+	const operand address = is_address ? pop_int(gen) : operand_constant(0);
+
+	int64_t offset;
+	const gpr_t base = target_base(gen, nd, is_address ? &address : NULL, &offset);
+
+	operand result = value;
+	if (code != ASS)
+	{
+		const operand old = double_take(gen);
+		emit_memory_double(gen, lwc1, double_register(&old), base, offset);
+		result = double_operation(gen, code, &old, &value);
+	}
+
+	store_value(gen, &result, base, offset);
+	operand_free(gen, &address);
+
+	if (is_void)
+	{
+		operand_free(gen, &result);
+	}
+	else
+	{
+		stack_push(gen, result);
+	}
+}
+
+static void increment(mipsgen *const gen, node *const nd, const item_t operation, const int is_double)
+{
+	const item_t first = is_double ? POSTINCR : POSTINC;
+	const int is_void = operation >= first + 200;
+	const item_t index = (is_void ? operation - 200 : operation) - first;
+	const int is_address = index >= 4;
+	const item_t kind = index % 4;
+	const int is_postfix = kind == 0 || kind == 1;
+	const int is_increment = kind == 0 || kind == 2;
+
+	const operand address = is_address ? pop_int(gen) : operand_constant(0);
+	int64_t offset;
+	const gpr_t base = target_base(gen, nd, is_address ? &address : NULL, &offset);
+
+	operand old;
+	operand result;
+	if (is_double)
+	{
+		old = double_take(gen);
+		result = double_take(gen);
+		emit_memory_double(gen, lwc1, double_register(&old), base, offset);
+
+		const operand one = operand_double(is_increment ? 0x3FF0000000000000 : 0xBFF0000000000000);
+		emit_float(gen, add_d, double_register(&result), double_register(&old), double_source(gen, &one, 2));
+		emit_memory_double(gen, swc1, double_register(&result), base, offset);
+	}
+	else
+	{
+		old = int_take(gen);
+		result = int_take(gen);
+		emit_memory(gen, lw, int_register(&old), base, offset);
+		emit_immediate(gen, addiu, int_register(&result), int_register(&old), is_increment ? 1 : -1);
+		emit_memory(gen, sw, int_register(&result), base, offset);
+	}
+
+	operand_free(gen, &address);
+	if (is_void)
+	{
+		operand_free(gen, &old);
+		operand_free(gen, &result);
+	}
+	else
+	{
+		operand_free(gen, is_postfix ? &result : &old);
+		stack_push(gen, is_postfix ? old : result);
+	}
+}
+
+static void copy(mipsgen *const gen, node *const nd, const item_t operation)
+{
+	switch (operation)
+	{
+		case COPY00:
+		{
+			cell_address(gen, r_a0, node_get_arg(nd, 0));
+			cell_address(gen, r_a1, node_get_arg(nd, 1));
+			emit_li(gen, r_a2, node_get_arg(nd, 2));
+			emit_call(gen, "ruc_move");
+		}
+		break;
+		case COPY01:
+		case COPY10:
+		{
+			const item_t length = node_get_arg(nd, 1);
+			const operand address = pop_int(gen);
+			byte_address(gen, operation == COPY01 ? r_a1 : r_a0, &address, 0);
+			cell_address(gen, operation == COPY01 ? r_a0 : r_a1, node_get_arg(nd, 0));
+			emit_li(gen, r_a2, length);
+			emit_call(gen, "ruc_move");
+			operand_free(gen, &address);
+		}
+		break;
+		case COPY11:
+		{
+			const item_t length = node_get_arg(nd, 0);
+			const operand from = pop_int(gen);
+			const operand to = pop_int(gen);
+			byte_address(gen, r_a0, &to, 0);
+			copy_words(gen, &from, (size_t)length);
+			operand_free(gen, &from);
+			operand_free(gen, &to);
+		}
+		break;
+		case COPY0ST:
+		{
+			const item_t displ = node_get_arg(nd, 0);
+			const size_t length = (size_t)node_get_arg(nd, 1);
+			if (length <= MAX_INLINE_WORDS)
+			{
+				// Поля короткой структуры читаются по одному
+				for (size_t i = 0; i < length; i++)
+				{
+					stack_push(gen, load_cell(gen, displ_shift(displ, i), kind_int));
+				}
+			}
+			else
+			{
+				const operand op = cell_location(gen, displ);
+				push_words(gen, &op, length);
+				operand_free(gen, &op);
+			}
+		}
+		break;
+		case COPY1ST:
+		{
+			const operand address = pop_int(gen);
+			push_words(gen, &address, (size_t)node_get_arg(nd, 0));
+			operand_free(gen, &address);
+		}
+		break;
+		case COPY0STASS:
+		{
+			const size_t from = stack_words(gen, (size_t)node_get_arg(nd, 1));
+			store_cells(gen, from, node_get_arg(nd, 0));
+		}
+		break;
+		case COPY1STASS:
+		{
+			const size_t from = stack_words(gen, (size_t)node_get_arg(nd, 0));
+			if (from == 0)
+			{
+				break;
+			}
+
+			const operand *const target = &gen->stack[from - 1];
+			const int is_block = target->kind == kind_block;
+			const operand address = value_int(gen, target);
+			store_words(gen, from, &address, 0, 1);
+			if (is_block)
+			{
+				operand_free(gen, &address);
+			}
+
+			const operand op = stack_pop(gen);
+			block_release(gen, &op);
+			operand_free(gen, &op);
+		}
+		break;
+		case COPYST:
+		{
+			const size_t displ = (size_t)node_get_arg(nd, 0);
+			const size_t length = (size_t)node_get_arg(nd, 1);
+			const size_t from = stack_words(gen, (size_t)node_get_arg(nd, 2));
+
+			// Слова вне выбранного поля просто отбрасываются
+			size_t offset = 0;
+			size_t kept = from;
+			int is_aligned = 1;
+			for (size_t i = from; i < gen->stack_size; i++)
+			{
+				const operand *const op = &gen->stack[i];
+				if (op->kind == kind_block
+					|| (offset < displ && offset + op->length > displ)
+					|| (offset < displ + length && offset + op->length > displ + length))
+				{
+					is_aligned = 0;
+				}
+				offset += op->length;
+			}
+
+			if (is_aligned)
+			{
+				offset = 0;
+				const size_t size = gen->stack_size;
+				for (size_t i = from; i < size; i++)
+				{
+					const operand op = gen->stack[i];
+					if (offset >= displ && offset < displ + length)
+					{
+						gen->stack[kept++] = op;
+					}
+					else
+					{
+						operand_free(gen, &op);
+					}
+					offset += op.length;
+				}
+
+				gen->stack_size = kept;
+				break;
+			}
+
+			stack_materialize(gen, from, (size_t)node_get_arg(nd, 2));
+			operand op = stack_pop(gen);
+			if (displ != 0)
+			{
+				const gpr_t source = int_source(gen, &op, r_t8);
+				place_free(gen, &op);
+				const operand field = int_take(gen);
+				emit_immediate(gen, addiu, int_register(&field), source, (int64_t)displ);
+				op.place = field.place;
+				op.value = field.value;
+			}
+
+			op.length = length;
+			stack_push(gen, op);
+		}
+		break;
+	}
+}
+
+/** Вызвать функцию от double с результатом double */
+static void double_function(mipsgen *const gen, const char *const function, const int is_heavy)
+{
+	const operand value = pop_double(gen);
+	if (is_heavy)
+	{
+		spill_all(gen);
+	}
+
+	double_argument(gen, 12, &value);
+	emit_call(gen, function);
+	stack_push(gen, double_from(gen, 0));
+}
+
+static void standard_function(mipsgen *const gen, const item_t operation)
+{
+	switch (operation)
+	{
+		case ABSIC:
+		{
+			const operand value = pop_int(gen);
+			const gpr_t a = int_source(gen, &value, r_t8);
+			operand_free(gen, &value);
+			const operand result = int_take(gen);
+			const gpr_t r = int_register(&result);
+			emit_shift(gen, sra, r_v1, a, 31);
+			emit_register(gen, xor, r, a, r_v1);
+			emit_register(gen, subu, r, r, r_v1);
+			stack_push(gen, result);
+		}
+		break;
+		case ABSC:
+		{
+			const operand value = pop_double(gen);
+			const size_t a = double_source(gen, &value, 0);
+			operand_free(gen, &value);
+			const operand result = double_take(gen);
+			emit_float_unary(gen, abs_d, double_register(&result), a);
+			stack_push(gen, result);
+		}
+		break;
+		case SQRTC:
+			double_function(gen, "ruc_sqrt", 0);
+			break;
+		case EXPC:
+			double_function(gen, "exp", 1);
+			break;
+		case SINC:
+			double_function(gen, "sin", 1);
+			break;
+		case COSC:
+			double_function(gen, "cos", 1);
+			break;
+		case LOGC:
+			double_function(gen, "ruc_log", 1);
+			break;
+		case LOG10C:
+			double_function(gen, "ruc_log10", 1);
+			break;
+		case ASINC:
+			double_function(gen, "ruc_asin", 1);
+			break;
+		case RANDC:
+		{
+			spill_all(gen);
+			emit_call(gen, "ruc_rand");
+			stack_push(gen, double_from(gen, 0));
+		}
+		break;
+		case ROUNDC:
+		{
+			const operand value = pop_double(gen);
+			spill_all(gen);
+			double_argument(gen, 12, &value);
+			emit_call(gen, "ruc_round");
+			stack_push(gen, int_from(gen, r_v0));
+		}
+		break;
+		case STRCPYC:
+		case STRCATC:
+		case STRNCPYC:
+		case STRNCATC:
+		{
+			const int is_limited = operation == STRNCPYC || operation == STRNCATC;
+			const operand count = is_limited ? pop_int(gen) : operand_constant(-1);
+			const operand source = pop_int(gen);
+			const operand pointer = pop_int(gen);
+			spill_all(gen);
+
+			operand_argument(gen, r_a0, &pointer);
+			operand_argument(gen, r_a1, &source);
+			operand_argument(gen, r_a2, &count);
+			emit_li(gen, r_a3, operation == STRCATC || operation == STRNCATC);
+			emit_call(gen, "ruc_strcpy");
+		}
+		break;
+		case STRCMPC:
+		case STRNCMPC:
+		{
+			const operand count = operation == STRNCMPC ? pop_int(gen) : operand_constant(-1);
+			const operand snd = pop_int(gen);
+			const operand fst = pop_int(gen);
+			spill_all(gen);
+
+			operand_argument(gen, r_a0, &fst);
+			operand_argument(gen, r_a1, &snd);
+			operand_argument(gen, r_a2, &count);
+			emit_call(gen, "ruc_strcmp");
+			stack_push(gen, int_from(gen, r_v0));
+		}
+		break;
+		case STRSTRC:
+		case UPBC:
+		{
+			const operand snd = pop_int(gen);
+			const operand fst = pop_int(gen);
+			if (operation == STRSTRC)
+			{
+				spill_all(gen);
+			}
+
+			operand_argument(gen, r_a0, &fst);
+			operand_argument(gen, r_a1, &snd);
+			emit_call(gen, operation == UPBC ? "ruc_upb" : "ruc_strstr");
+			stack_push(gen, int_from(gen, r_v0));
+		}
+		break;
+		case STRLENC:
+		{
+			const operand string = pop_int(gen);
+			operand_argument(gen, r_a0, &string);
+			emit_call(gen, "ruc_string_length");
+			stack_push(gen, int_from(gen, r_v0));
+		}
+		break;
+		case ASSERTC:
+		{
+			const operand string = pop_int(gen);
+			const operand condition = pop_int(gen);
+			operand_argument(gen, r_a0, &condition);
+			operand_argument(gen, r_a1, &string);
+			emit_call(gen, "ruc_assert");
+		}
+		break;
+		case ROWING:
+		case ROWINGD:
+		{
+			const int is_double = operation == ROWINGD;
+			const operand value = is_double ? pop_double(gen) : pop_int(gen);
+			emit_li(gen, r_a0, is_double ? 3 : 2);
+			emit_call(gen, "ruc_heap");
+
+			const operand result = int_take(gen);
+			emit_immediate(gen, addiu, int_register(&result), r_v0, 1);
+			emit_shift(gen, sll, r_t9, r_v0, 2);
+			emit_register(gen, addu, r_t9, r_t9, r_s7);
+			emit_li(gen, r_t8, 1);
+			emit_memory(gen, sw, r_t8, r_t9, 0);
+			store_value(gen, &value, r_t9, 4);
+
+			operand_free(gen, &value);
+			stack_push(gen, result);
+		}
+		break;
+		default:
+			// Нити, роботы и прочие функции среды исполнения
+			unsupported(gen, operation);
+			break;
+	}
+}
+
+static void operation(mipsgen *const gen, node *const nd, const item_t op)
+{
+	if ((op >= REMASS && op <= DIVASSAT) || (op >= REMASSV && op <= DIVASSATV))
+	{
+		int_assignment(gen, nd, op);
+	}
+	else if ((op >= ASSR && op <= DIVASSR) || (op >= ASSATR && op <= DIVASSATR)
+		|| (op >= ASSRV && op <= DIVASSRV) || (op >= ASSATRV && op <= DIVASSATRV))
+	{
+		double_assignment(gen, nd, op);
+	}
+	else if ((op >= POSTINC && op <= DECAT) || (op >= POSTINCV && op <= DECATV))
+	{
+		increment(gen, nd, op, 0);
+	}
+	else if ((op >= POSTINCR && op <= DECATR) || (op >= POSTINCRV && op <= DECATRV))
+	{
+		increment(gen, nd, op, 1);
+	}
+	else if (op >= LREM && op <= LDIV)
+	{
+		const operand snd = pop_int(gen);
+		const operand fst = pop_int(gen);
+		stack_push(gen, int_operation(gen, op, &fst, &snd));
+	}
+	else if (op >= EQEQR && op <= LDIVR)
+	{
+		const operand snd = pop_double(gen);
+		const operand fst = pop_double(gen);
+		stack_push(gen, double_operation(gen, op, &fst, &snd));
+	}
+	else if (op >= COPY00 && op <= COPYST)
+	{
+		copy(gen, nd, op);
+	}
+	else
+	{
+		switch (op)
+		{
+			case UNMINUS:
+			case LNOT:
+			case LOGNOT:
+			{
+				const operand value = pop_int(gen);
+				const gpr_t a = int_source(gen, &value, r_t8);
+				operand_free(gen, &value);
+				const operand result = int_take(gen);
+				const gpr_t r = int_register(&result);
+
+				if (op == UNMINUS)
+				{
+					emit_register(gen, subu, r, r_zero, a);
+				}
+				else if (op == LNOT)
+				{
+					emit_register(gen, nor, r, a, r_zero);
+				}
+				else
+				{
+					emit_immediate(gen, sltiu, r, a, 1);
+				}
+				stack_push(gen, result);
+			}
+			break;
+			case UNMINUSR:
+			{
+				const operand value = pop_double(gen);
+				const size_t a = double_source(gen, &value, 0);
+				operand_free(gen, &value);
+				const operand result = double_take(gen);
+				emit_float_unary(gen, neg_d, double_register(&result), a);
+				stack_push(gen, result);
+			}
+			break;
+			case WIDEN:
+			case WIDEN1:
+			{
+				const operand top = op == WIDEN1 ? pop_double(gen) : operand_constant(0);
+				const operand value = pop_int(gen);
+				emit_transfer(gen, mtc1, int_source(gen, &value, r_t8), 0);
+				operand_free(gen, &value);
+				const operand result = double_take(gen);
+				emit_float_unary(gen, cvt_d_w, double_register(&result), 0);
+				stack_push(gen, result);
+
+				if (op == WIDEN1)
+				{
+					stack_push(gen, top);
+				}
+			}
+			break;
+			default:
+				standard_function(gen, op);
+				break;
+		}
+	}
+}
+
+static void logic_begin(mipsgen *const gen, const item_t op)
+{
+	const operand value = pop_int(gen);
+	const size_t temp = slot_take(gen, 1);
+	const size_t end = label(gen);
+
+	// Перед ветвлением все значения стека должны лежать в кадре
+	spill_all(gen);
+	const gpr_t a = int_source(gen, &value, r_t8);
+	emit_memory(gen, sw, a, r_fp, slot_offset(temp, 1));
+	emit_branch(gen, op == ADLOGOR ? bne : beq, a, r_zero, end);
+
+	stack_push(gen, value);
+	vector_add(&gen->logic, (item_t)temp);
+	vector_add(&gen->logic, (item_t)end);
+}
+
+static void logic_end(mipsgen *const gen, const item_t op)
+{
+	const operand snd = pop_int(gen);
+	const operand fst = pop_int(gen);
+	const operand result = int_operation(gen, op, &fst, &snd);
+
+	const size_t end = (size_t)vector_remove(&gen->logic);
+	const size_t temp = (size_t)vector_remove(&gen->logic);
+
+	emit_memory(gen, sw, int_source(gen, &result, r_t8), r_fp, slot_offset(temp, 1));
+	operand_free(gen, &result);
+	emit_label(gen, end);
+
+	const operand value = int_take(gen);
+	emit_memory(gen, lw, int_register(&value), r_fp, slot_offset(temp, 1));
+	slot_free(gen, temp, 1);
+	stack_push(gen, value);
+}
+
+static void final_operation(mipsgen *const gen, node *const nd)
+{
+	item_t op = node_get_type(nd);
+	while (op > 9000)
+	{
+		if (op != NOP)
+		{
+			if (op == ADLOGOR || op == ADLOGAND)
+			{
+				logic_begin(gen, op);
+			}
+			else if ((op == LOGOR || op == LOGAND) && vector_size(&gen->logic) != 0)
+			{
+				logic_end(gen, op);
+			}
+			else
+			{
+				operation(gen, nd, op);
+			}
+		}
+
+		node_set_next(nd);
+		op = node_get_type(nd);
+	}
+}
+
+/** Перейти на метку, если значение условия совпадает с @c is_true */
+static void branch_if(mipsgen *const gen, const operand *const condition, const int is_true, const size_t target)
+{
+	if (condition->place == place_constant)
+	{
+		if ((condition->value != 0) == is_true)
+		{
+			emit_jump(gen, target);
+		}
+		return;
+	}
+
+	spill_all(gen);
+	const gpr_t a = int_source(gen, condition, r_t8);
+	operand_free(gen, condition);
+	emit_branch(gen, is_true ? bne : beq, a, r_zero, target);
+}
+
+/** Сохранить результат ветви условного выражения во временные слоты */
+static void condition_result(mipsgen *const gen, const size_t depth, size_t *const temp, kind_t *const kind)
+{
+	if (gen->stack_size <= depth)
+	{
+		return;
+	}
+
+	if (gen->stack[gen->stack_size - 1].kind == kind_block)
+	{
+		unsupported(gen, TCondexpr);
+		stack_release(gen, gen->stack_size - 1);
+		return;
+	}
+
+	const kind_t value_kind = gen->stack[gen->stack_size - 1].kind;
+	const operand value = stack_pop(gen);
+	if (*temp == 0)
+	{
+		*kind = value_kind;
+		*temp = slot_take(gen, value_kind == kind_double ? 2 : 1) + 1;
+	}
+
+	if (*kind == value_kind)
+	{
+		store_value(gen, &value, r_fp, slot_offset(*temp - 1, operand_words(&value)));
+	}
+	operand_free(gen, &value);
+}
+
+static void condition(mipsgen *const gen, node *const nd)
+{
+	const size_t end = label(gen);
+	size_t temp = 0;
+	kind_t kind = kind_int;
+	size_t depth = 0;
+
+	do
+	{
+		const operand value = pop_int(gen);
+		const size_t other = label(gen);
+		branch_if(gen, &value, 0, other);
+
+		depth = gen->stack_size;
+		expression(gen, nd, 0); // then
+		condition_result(gen, depth, &temp, &kind);
+		emit_jump(gen, end);
+
+		emit_label(gen, other);
+		depth = gen->stack_size;
+		expression(gen, nd, 1); // else или cond
+	} while (node_get_type(nd) == TCondexpr);
+
+	condition_result(gen, depth, &temp, &kind);
+	emit_label(gen, end);
+
+	if (temp != 0)
+	{
+		const size_t words = kind == kind_double ? 2 : 1;
+		if (kind == kind_double)
+		{
+			const operand result = double_take(gen);
+			emit_memory_double(gen, lwc1, double_register(&result), r_fp, slot_offset(temp - 1, words));
+			stack_push(gen, result);
+		}
+		else
+		{
+			const operand result = int_take(gen);
+			emit_memory(gen, lw, int_register(&result), r_fp, slot_offset(temp - 1, words));
+			stack_push(gen, result);
+		}
+		slot_free(gen, temp - 1, words);
+	}
+
+	final_operation(gen, nd);
+}
+
+static void slice(mipsgen *const gen, node *const nd, const item_t type)
+{
+	expression(gen, nd, 0);
+
+	const operand index = pop_int(gen);
+	const operand array = pop_int(gen);
+	operand_argument(gen, r_a0, &array);
+	operand_argument(gen, r_a1, &index);
+	emit_li(gen, r_a2, (int64_t)size_of(gen->sx, type));
+	emit_call(gen, "ruc_index");
+
+	if (type > 0 && mode_get(gen->sx, (size_t)type) == mode_array)
+	{
+		const operand row = int_take(gen);
+		emit_shift(gen, sll, r_t9, r_v0, 2);
+		emit_register(gen, addu, r_t9, r_t9, r_s7);
+		emit_memory(gen, lw, int_register(&row), r_t9, 0);
+		stack_push(gen, row);
+	}
+	else
+	{
+		stack_push(gen, int_from(gen, r_v0));
+	}
+}
+
+static void print_value(mipsgen *const gen, const item_t mode)
+{
+	if (mode == LINT || mode == LCHAR)
+	{
+		const operand value = pop_int(gen);
+		spill_all(gen);
+		operand_argument(gen, r_a0, &value);
+		emit_call(gen, mode == LINT ? "ruc_print_int" : "ruc_print_char");
+		return;
+	}
+
+	if (mode == LFLOAT)
+	{
+		const operand value = pop_double(gen);
+		spill_all(gen);
+		double_argument(gen, 12, &value);
+		emit_call(gen, "ruc_print_float");
+		return;
+	}
+
+	char buffer[MAX_OPERAND_SIZE];
+	const char *const printer = printer_name(gen, mode, buffer);
+	const size_t size = size_of(gen->sx, mode);
+	if (size == 1)
+	{
+		// Процедура печати получает адрес копии значения в кадре
+		const operand value = pop_int(gen);
+		spill_all(gen);
+		const size_t temp = slot_take(gen, 1);
+		emit_memory(gen, sw, int_source(gen, &value, r_t8), r_fp, slot_offset(temp, 1));
+		operand_free(gen, &value);
+
+		emit_immediate(gen, addiu, r_a0, r_fp, slot_offset(temp, 1));
+		emit_call(gen, printer);
+		slot_free(gen, temp, 1);
+		return;
+	}
+
+	stack_materialize(gen, stack_words(gen, size), size);
+	const operand value = stack_pop(gen);
+	spill_all(gen);
+	byte_address(gen, r_a0, &value, 0);
+	emit_call(gen, printer);
+	block_release(gen, &value);
+	operand_free(gen, &value);
+}
+
+static void call_begin(mipsgen *const gen)
+{
+	const size_t frame = slot_take(gen, 1);
+	emit_immediate(gen, addiu, r_t8, r_s5, 1);
+	emit_memory(gen, sw, r_t8, r_fp, slot_offset(frame, 1));
+	emit_immediate(gen, addiu, r_s5, r_s5, FRAME_SIZE);
+	vector_add(&gen->calls, (item_t)frame);
+}
+
+static void call_end(mipsgen *const gen, node *const nd)
+{
+	syntax *const sx = gen->sx;
+	const size_t id = (size_t)node_get_arg(nd, 0);
+	const item_t displ = ident_get_displ(sx, id);
+	const item_t mode = ident_get_mode(sx, id);
+	const size_t frame_slot = (size_t)vector_remove(&gen->calls);
+	const operand frame = operand_slot(kind_int, frame_slot);
+
+	size_t words = 0;
+	const item_t params = mode_get(sx, (size_t)mode + 2);
+	for (item_t i = 0; i < params; i++)
+	{
+		words += size_of(sx, mode_get(sx, (size_t)(mode + 3 + i)));
+	}
+
+	if (words != 0)
+	{
+		store_words(gen, stack_words(gen, words), &frame, FRAME_SIZE, 0);
+	}
+
+	spill_all(gen);
+	if (displ > 0)
+	{
+		char target[MAX_OPERAND_SIZE];
+		sprintf(target, "ruc_f%" PRIitem, displ);
+		function_reference(gen, (size_t)displ);
+
+		operand_load(gen, r_a0, &frame);
+		emit_call(gen, target);
+	}
+	else
+	{
+		int64_t offset;
+		const gpr_t base = cell_base(-displ, &offset);
+		emit_memory(gen, lw, r_a0, base, offset);
+		emit_call(gen, "ruc_function");
+		emit_move(gen, r_t9, r_v0);
+
+		operand_load(gen, r_a0, &frame);
+		emit(gen, "jalr\t$t9");
+	}
+
+	const kind_t kind = return_kind(sx, mode);
+	if (kind == kind_block)
+	{
+		const item_t value = mode_get(sx, (size_t)mode + 1);
+		if (value == LVOID)
+		{
+			slot_free(gen, frame_slot, 1);
+			return;
+		}
+
+		// Структура возвращается в кадре вызванной функции
+		operand op = frame;
+		operand_load(gen, r_t8, &frame);
+		op.kind = kind_block;
+		op.length = size_of(sx, value);
+		op.release = release_take(gen, r_t8);
+		stack_push(gen, op);
+	}
+	else
+	{
+		slot_free(gen, frame_slot, 1);
+		stack_push(gen, kind == kind_double ? double_from(gen, 0) : int_from(gen, r_v0));
+	}
+}
+
+static void expression(mipsgen *const gen, node *const nd, const int mode)
+{
+	if (mode != -1)
+	{
+		node_set_next(nd);
+	}
+
+	while (node_get_type(nd) != TExprend)
+	{
+		const item_t operation = node_get_type(nd);
+		int was_operation = 1;
+
+		switch (operation)
+		{
+			case TIdent:
+				break;
+			case TIdenttoaddr:
+				stack_push(gen, cell_location(gen, node_get_arg(nd, 0)));
+				break;
+			case TIdenttoval:
+				stack_push(gen, load_cell(gen, node_get_arg(nd, 0), kind_int));
+				break;
+			case TIdenttovald:
+				stack_push(gen, load_cell(gen, node_get_arg(nd, 0), kind_double));
+				break;
+			case TAddrtoval:
+			case TAddrtovald:
+			{
+				const operand address = pop_int(gen);
+				const operand result = operation == TAddrtovald ? double_take(gen) : int_take(gen);
+				int64_t offset;
+				const gpr_t base = address_base(gen, &address, &offset);
+				if (operation == TAddrtovald)
+				{
+					emit_memory_double(gen, lwc1, double_register(&result), base, offset);
+				}
+				else
+				{
+					emit_memory(gen, lw, int_register(&result), base, offset);
+				}
+
+				operand_free(gen, &address);
+				stack_push(gen, result);
+			}
+			break;
+			case TConst:
+				stack_push(gen, operand_constant(node_get_arg(nd, 0)));
+				break;
+			case TConstd:
+			{
+				const uint64_t low = (uint32_t)node_get_arg(nd, 0);
+				const uint64_t high = (uint32_t)node_get_arg(nd, 1);
+				stack_push(gen, operand_double(low | high << 32));
+			}
+			break;
+			case TString:
+			case TStringd:
+				stack_push(gen, literal(gen, nd, operation));
+				break;
+			case TBeginit:
+			{
+				// Инициализатор массива вне объявления
+				unsupported(gen, operation);
+
+				const item_t N = node_get_arg(nd, 0);
+				for (item_t i = 0; i < N; i++)
+				{
+					expression(gen, nd, 0);
+				}
+			}
+			break;
+			case TStructinit:
+			{
+				const item_t N = node_get_arg(nd, 0);
+				for (item_t i = 0; i < N; i++)
+				{
+					expression(gen, nd, 0);
+				}
+			}
+			break;
+			case TSliceident:
+				stack_push(gen, load_cell(gen, node_get_arg(nd, 0), kind_int));
+				slice(gen, nd, node_get_arg(nd, 1));
+				break;
+			case TSlice:
+				slice(gen, nd, node_get_arg(nd, 0));
+				break;
+			case TSelect:
+			{
+				const operand address = pop_int(gen);
+				if (address.place == place_constant)
+				{
+					stack_push(gen, operand_constant(address.value + node_get_arg(nd, 0)));
+					break;
+				}
+
+				const gpr_t a = int_source(gen, &address, r_t8);
+				operand_free(gen, &address);
+				const operand result = int_take(gen);
+				emit_immediate(gen, addiu, int_register(&result), a, node_get_arg(nd, 0));
+				stack_push(gen, result);
+			}
+			break;
+			case TPrint:
+				print_value(gen, node_get_arg(nd, 0));
+				break;
+			case TCall1:
+			{
+				call_begin(gen);
+
+				const item_t N = node_get_arg(nd, 0);
+				for (item_t i = 0; i < N; i++)
+				{
+					expression(gen, nd, 0);
+				}
+			}
+			break;
+			case TCall2:
+				call_end(gen, nd);
+				break;
+			default:
+				was_operation = 0;
+				break;
+		}
+
+		if (was_operation)
+		{
+			node_set_next(nd);
+		}
+
+		final_operation(gen, nd);
+
+		if (node_get_type(nd) == TCondexpr)
+		{
+			if (mode == 1)
+			{
+				return;
+			}
+
+			condition(gen, nd);
+		}
+	}
+}
+
+static void structure(mipsgen *const gen, node *const nd)
+{
+	if (node_get_type(nd) == TStructinit)
+	{
+		const item_t N = node_get_arg(nd, 0);
+		node_set_next(nd);
+
+		for (item_t i = 0; i < N; i++)
+		{
+			structure(gen, nd);
+			node_set_next(nd); // TExprend
+		}
+	}
+	else
+	{
+		expression(gen, nd, -1);
+	}
+}
+
+
+/** Границы и размеры инициализируемого массива */
+typedef struct initializer
+{
+	operand bounds[MAXBOUNDS];		/**< Declared bounds */
+	size_t bounds_number;			/**< Number of declared bounds */
+	size_t dimensions;				/**< Number of dimensions */
+	size_t length;					/**< Size of element */
+} initializer;
+
+/** Записать границы в слоты кадра, возвращает первый слот */
+static size_t array_bounds(mipsgen *const gen, const operand *const bounds, const size_t number)
+{
+	const size_t temp = slot_take(gen, number);
+	for (size_t i = 0; i < number; i++)
+	{
+		emit_memory(gen, sw, int_source(gen, &bounds[i], r_t8), r_fp, slot_offset(temp, number) + 4 * (int64_t)i);
+	}
+
+	return temp;
+}
+
+static operand array_declare(mipsgen *const gen, const size_t dimensions, const size_t length)
+{
+	if (dimensions == 1)
+	{
+		const operand bound = pop_int(gen);
+		operand_argument(gen, r_a0, &bound);
+		emit_li(gen, r_a1, (int64_t)length);
+		emit_call(gen, "ruc_allocate");
+		return int_from(gen, r_v0);
+	}
+
+	// Границы записываются в кадр по мере снятия со стека
+	const size_t temp = slot_take(gen, dimensions);
+	for (size_t i = dimensions; i > 0; i--)
+	{
+		const operand bound = pop_int(gen);
+		emit_memory(gen, sw, int_source(gen, &bound, r_t8), r_fp, slot_offset(temp, dimensions) + 4 * (int64_t)(i - 1));
+		operand_free(gen, &bound);
+	}
+
+	emit_immediate(gen, addiu, r_a0, r_fp, slot_offset(temp, dimensions));
+	emit_li(gen, r_a1, (int64_t)dimensions);
+	emit_li(gen, r_a2, (int64_t)length);
+	emit_call(gen, "ruc_array");
+	slot_free(gen, temp, dimensions);
+
+	return int_from(gen, r_v0);
+}
+
+static operand array_build(mipsgen *const gen, node *const nd, const initializer *const init, const size_t level)
+{
+	const int is_last = level + 1 == init->dimensions;
+	const operand declared = level < init->bounds_number ? init->bounds[level] : operand_constant(-1);
+	node_set_next(nd);
+
+	if (node_get_type(nd) != TBeginit)
+	{
+		// Строка в последнем измерении копируется целиком
+		expression(gen, nd, -1);
+		const operand string = pop_int(gen);
+
+		byte_address(gen, r_t9, &string, 0);
+		emit_memory(gen, lw, r_a0, r_t9, -4);
+		operand_load(gen, r_a1, &declared);
+		emit_li(gen, r_a2, (int64_t)init->length);
+		emit_call(gen, "ruc_initialize");
+
+		const operand result = int_from(gen, r_v0);
+		emit_shift(gen, sll, r_a0, r_v0, 2);
+		emit_register(gen, addu, r_a0, r_a0, r_s7);
+		emit_move(gen, r_a1, r_t9);
+		emit_memory(gen, lw, r_a2, r_t9, -4);
+		emit_call(gen, "ruc_move");
+
+		operand_free(gen, &string);
+		return result;
+	}
+
+	const item_t count = node_get_arg(nd, 0);
+	emit_li(gen, r_a0, count);
+	operand_load(gen, r_a1, &declared);
+	emit_li(gen, r_a2, is_last ? (int64_t)init->length : 1);
+	emit_call(gen, "ruc_initialize");
+
+	// Адрес массива нужен после вычисления элементов, поэтому хранится в кадре
+	const operand result = operand_slot(kind_int, slot_take(gen, 1));
+	emit_memory(gen, sw, r_v0, r_fp, slot_offset((size_t)result.value, 1));
+
+	for (item_t i = 0; i < count; i++)
+	{
+		const size_t displ = (size_t)i * (is_last ? init->length : 1);
+		if (is_last)
+		{
+			expression(gen, nd, 0);
+			store_words(gen, stack_words(gen, init->length), &result, displ, 1);
+		}
+		else
+		{
+			const operand row = array_build(gen, nd, init, level + 1);
+			stack_push(gen, row);
+			store_words(gen, gen->stack_size - 1, &result, displ, 1);
+		}
+	}
+	node_set_next(nd); // TExprend
+
+	if (!is_last && init->bounds_number == init->dimensions)
+	{
+		// Оставшиеся строки создаются по объявленным границам
+		const size_t rest = init->dimensions - level - 1;
+		const size_t temp = array_bounds(gen, &init->bounds[level + 1], rest);
+
+		operand_load(gen, r_a0, &result);
+		emit_li(gen, r_a1, count);
+		operand_load(gen, r_a2, &declared);
+		emit_immediate(gen, addiu, r_a3, r_fp, slot_offset(temp, rest));
+		emit_li(gen, r_v0, (int64_t)rest);
+		emit_li(gen, r_v1, (int64_t)init->length);
+		emit_call(gen, "ruc_array_rows");
+		slot_free(gen, temp, rest);
+	}
+
+	return result;
+}
+
+
+static void unit_begin(mipsgen *const gen, unit *const un)
+{
+	out_set_buffer(&un->io, BUFSIZ);
+	vector_resize(&un->slots, 0);
+	un->int_used = 0;
+	un->double_used = 0;
+	un->arguments = 0;
+	un->exit = label(gen);
+}
+
+/** Размер кадра: исходящие аргументы, слоты и сохранённые регистры */
+static size_t unit_frame(const unit *const un)
+{
+	const size_t arguments = un->arguments > ARGUMENT_WORDS ? un->arguments : ARGUMENT_WORDS;
+	const size_t size = (arguments + vector_size(&un->slots)) * 4 + SAVED_AREA;
+	return (size + 7) & ~(size_t)7;
+}
+
+static void unit_prologue(mipsgen *const gen, const unit *const un, const char *const name)
+{
+	universal_io *const io = &gen->module;
+	const size_t frame = unit_frame(un);
+
+	uni_printf(io, "%s:\n", name);
+	uni_printf(io, "\taddiu\t$sp, $sp, -%zu\n", frame);
+	uni_printf(io, "\tsw\t$ra, %zu($sp)\n", frame - 4);
+	uni_printf(io, "\tsw\t$fp, %zu($sp)\n", frame - 8);
+	uni_printf(io, "\tsw\t$s6, %zu($sp)\n", frame - 12);
+	uni_printf(io, "\tsw\t$s4, %zu($sp)\n", frame - 16);
+	uni_printf(io, "\taddiu\t$fp, $sp, %zu\n", frame);
+}
+
+static void unit_end(mipsgen *const gen, unit *const un)
+{
+	universal_io *const io = &gen->module;
+
+	char *const buffer = out_extract_buffer(&un->io);
+	if (buffer != NULL)
+	{
+		out_write(io, buffer, strlen(buffer));
+		free(buffer);
+	}
+
+	uni_printf(io, ".L%zu:\n", un->exit);
+	uni_print_string(io, "\tlw\t$ra, -4($fp)\n");
+	uni_print_string(io, "\tlw\t$s6, -12($fp)\n");
+	uni_print_string(io, "\tlw\t$s4, -16($fp)\n");
+	uni_print_string(io, "\tmove\t$sp, $fp\n");
+	uni_print_string(io, "\tlw\t$fp, -8($sp)\n");
+	uni_print_string(io, "\tjr\t$ra\n\n");
+}
+
+static void procedure_begin(mipsgen *const gen)
+{
+	unit *const un = malloc(sizeof(unit));
+	if (un == NULL)
+	{
+		gen->was_error = 1;
+		return;
+	}
+
+	un->io = io_create();
+	un->slots = vector_create(MAX_OPERAND_SIZE);
+	un->is_procedure = 1;
+	un->parent = gen->current;
+
+	unit_begin(gen, un);
+	gen->current = un;
+
+	// Адрес экземпляра структуры всегда лежит в первом слоте
+	emit_memory(gen, sw, r_a0, r_fp, slot_offset(slot_take(gen, 1), 1));
+}
+
+static void procedure_end(mipsgen *const gen, const item_t number)
+{
+	unit *const un = gen->current;
+	if (!un->is_procedure)
+	{
+		return;
+	}
+
+	char name[MAX_OPERAND_SIZE];
+	sprintf(name, "ruc_proc_%" PRIitem, number);
+	unit_prologue(gen, un, name);
+	unit_end(gen, un);
+
+	gen->current = un->parent;
+	vector_clear(&un->slots);
+	free(un);
+}
+
+/** Адрес поля экземпляра структуры в процедуре инициализации */
+static operand procedure_field(mipsgen *const gen, const item_t displ)
+{
+	const operand result = int_take(gen);
+	emit_memory(gen, lw, r_t8, r_fp, slot_offset(0, 1));
+	emit_immediate(gen, addiu, int_register(&result), r_t8, displ);
+	return result;
+}
+
+static void procedure_call(mipsgen *const gen, const item_t number, const operand *const base)
+{
+	char name[MAX_OPERAND_SIZE];
+	sprintf(name, "ruc_proc_%" PRIitem, number);
+
+	spill_all(gen);
+	operand_argument(gen, r_a0, base);
+	emit_call(gen, name);
+}
+
+static void identifier(mipsgen *const gen, node *const nd)
+{
+	syntax *const sx = gen->sx;
+	const item_t displ = node_get_arg(nd, 0);
+	const item_t type = node_get_arg(nd, 1);
+	const item_t N = node_get_arg(nd, 2);
+	const item_t all = node_get_arg(nd, 3);
+	const item_t process = node_get_arg(nd, 4);
+	const item_t usual = node_get_arg(nd, 5);
+	const item_t instruction = node_get_arg(nd, 6);
+
+	if (N == 0)
+	{
+		if (process)
+		{
+			// Массивы в полях структуры создаются процедурой инициализации
+			const operand base = gen->current->is_procedure
+				? procedure_field(gen, displ)
+				: cell_location(gen, displ);
+			procedure_call(gen, process, &base);
+		}
+
+		if (!all)
+		{
+			return;
+		}
+
+		if (type > 0 && mode_get(sx, (size_t)type) == mode_struct)
+		{
+			node_set_next(nd);
+			structure(gen, nd);
+			store_cells(gen, stack_words(gen, (size_t)all), displ);
+		}
+		else
+		{
+			expression(gen, nd, 0);
+			const operand value = type == LFLOAT ? pop_double(gen) : pop_int(gen);
+			store_cell(gen, displ, &value);
+			operand_free(gen, &value);
+		}
+		return;
+	}
+
+	const size_t length = size_of(sx, type);
+	const size_t dimensions = (size_t)abs((int)N);
+	operand address;
+	if (!all)
+	{
+		address = array_declare(gen, dimensions, length);
+		if (process)
+		{
+			char name[MAX_OPERAND_SIZE];
+			sprintf(name, "ruc_proc_%" PRIitem, process);
+
+			spill_all(gen);
+			operand_spill(gen, &address);
+			operand_load(gen, r_a0, &address);
+			emit_li(gen, r_a1, (int64_t)dimensions);
+			emit_li(gen, r_a2, (int64_t)length);
+			emit_la(gen, r_a3, name);
+			emit_call(gen, "ruc_array_each");
+		}
+	}
+	else
+	{
+		initializer init;
+		init.dimensions = dimensions;
+		init.length = length;
+		init.bounds_number = usual & 1 ? dimensions : dimensions - 1;
+		for (size_t i = init.bounds_number; i > 0; i--)
+		{
+			init.bounds[i - 1] = pop_int(gen);
+			operand_spill(gen, &init.bounds[i - 1]);
+		}
+
+		address = array_build(gen, nd, &init, 0);
+		for (size_t i = 0; i < init.bounds_number; i++)
+		{
+			operand_free(gen, &init.bounds[i]);
+		}
+	}
+
+	if (instruction)
+	{
+		// Массив в структуре записывается в поле инициализируемого экземпляра
+		const operand field = procedure_field(gen, displ);
+		int64_t offset;
+		const gpr_t source = int_source(gen, &address, r_t8);
+		const gpr_t base = address_base(gen, &field, &offset);
+		emit_memory(gen, sw, source, base, offset);
+		operand_free(gen, &field);
+	}
+	else
+	{
+		store_cell(gen, displ, &address);
+	}
+
+	operand_free(gen, &address);
+}
+
+static int declaration(mipsgen *const gen, node *const nd)
+{
+	switch (node_get_type(nd))
+	{
+		case TDeclarr:
+		{
+			const item_t N = node_get_arg(nd, 0);
+			for (item_t i = 0; i < N; i++)
+			{
+				expression(gen, nd, 0);
+			}
+		}
+		break;
+		case TDeclid:
+			identifier(gen, nd);
+			break;
+
+		case TStructbeg:
+			procedure_begin(gen);
+			break;
+		case TStructend:
+			procedure_end(gen, node_get_arg(nd, 0));
+			break;
+
+		default:
+			return -1;
+	}
+
+	return 0;
+}
+
+
+/** Загрузить целый аргумент printf из операнда или из блока аргументов */
+static void argument_load(mipsgen *const gen, const gpr_t target, const argument *const arg
+	, const operand *const words)
+{
+	if (words == NULL)
+	{
+		operand_load(gen, target, &arg->value);
+		return;
+	}
+
+	int64_t offset;
+	const gpr_t base = address_base(gen, words, &offset);
+	emit_memory(gen, lw, target, base, offset + 4 * (int64_t)arg->offset);
+}
+
+static void printf_flush(mipsgen *const gen, char *const format, size_t *const length
+	, const argument *const args, size_t *const count, const operand *const words)
+{
+	if (*length == 0 && *count == 0)
+	{
+		return;
+	}
+
+	// Аргументы раскладываются по соглашению o32: три слова в регистрах, остальные в стеке
+	size_t position = 1;
+	for (size_t i = 0; i < *count; i++)
+	{
+		const argument *const arg = &args[i];
+		if (arg->is_double)
+		{
+			position = (position + 1) & ~(size_t)1;
+			if (words != NULL)
+			{
+				int64_t offset;
+				const gpr_t base = address_base(gen, words, &offset);
+				offset += 4 * (int64_t)arg->offset;
+				for (size_t j = 0; j < 2; j++)
+				{
+					if (position + j < ARGUMENT_WORDS)
+					{
+						emit_memory(gen, lw, r_a0 + position + j, base, offset + 4 * (int64_t)j);
+					}
+					else
+					{
+						emit_memory(gen, lw, r_t8, base, offset + 4 * (int64_t)j);
+						emit_memory(gen, sw, r_t8, r_sp, 4 * (int64_t)(position + j));
+					}
+				}
+			}
+			else
+			{
+				const size_t source = double_source(gen, &arg->value, 0);
+				if (position < ARGUMENT_WORDS)
+				{
+					emit_transfer(gen, mfc1, r_a0 + position, source);
+					emit_transfer(gen, mfc1, r_a0 + position + 1, source + 1);
+				}
+				else
+				{
+					emit_memory_double(gen, swc1, source, r_sp, 4 * (int64_t)position);
+				}
+			}
+			position += 2;
+		}
+		else
+		{
+			if (position < ARGUMENT_WORDS)
+			{
+				argument_load(gen, r_a0 + position, arg, words);
+			}
+			else
+			{
+				argument_load(gen, r_t8, arg, words);
+				emit_memory(gen, sw, r_t8, r_sp, 4 * (int64_t)position);
+			}
+			position++;
+		}
+	}
+
+	unit *const un = gen->current;
+	un->arguments = position > un->arguments ? position : un->arguments;
+
+	char name[MAX_OPERAND_SIZE];
+	sprintf(name, ".LS%zu", string_constant(gen, format, *length));
+	emit_la(gen, r_a0, name);
+	emit_call(gen, "printf");
+
+	*length = 0;
+	*count = 0;
+}
+
+static inline int placeholder_kind(const char32_t placeholder)
+{
+	switch (placeholder)
+	{
+		case 'f':
+		case U'в':
+			return kind_double;
+		case 'i':
+		case U'ц':
+		case 'c':
+		case U'л':
+		case 's':
+		case U'с':
+			return kind_int;
+		default:
+			return -1;
+	}
+}
+
+/** Аргумент printf: операнд стека или слова блока, если типы не совпали с форматом */
+static argument printf_argument(mipsgen *const gen, const int is_double, size_t *const arg
+	, const int is_words, size_t *const offset)
+{
+	argument result = { operand_constant(0), *offset, is_double };
+	if (!is_words)
+	{
+		const size_t index = (*arg)++;
+		if (index >= gen->stack_size)
+		{
+			result.value = is_double ? operand_double(0) : operand_constant(0);
+		}
+		else
+		{
+			result.value = gen->stack[index];
+		}
+		return result;
+	}
+
+	*offset += is_double ? 2 : 1;
+	return result;
+}
+
+static void print_format(mipsgen *const gen, const size_t args_number)
+{
+	const operand format = stack_pop(gen);
+	const size_t from = stack_words(gen, args_number);
+	if (format.literal == 0)
+	{
+		unsupported(gen, TPrintf);
+		operand_free(gen, &format);
+		stack_release(gen, from);
+		return;
+	}
+
+	const size_t size = (size_t)vector_get(&gen->data, format.literal - 1);
+	size_t placeholders = 0;
+	int is_words = 0;
+	for (size_t i = 0; i + 1 < size; i++)
+	{
+		if (vector_get(&gen->data, format.literal + i) != '%')
+		{
+			continue;
+		}
+
+		const int kind = placeholder_kind((char32_t)vector_get(&gen->data, format.literal + ++i));
+		if (kind != -1)
+		{
+			const size_t arg = from + placeholders++;
+			is_words |= arg >= gen->stack_size || (int)gen->stack[arg].kind != kind;
+		}
+	}
+	is_words |= from + placeholders != gen->stack_size;
+	is_words = is_words && args_number != 0;
+
+	if (is_words)
+	{
+		// Аргументы читаются по словам, как в виртуальной машине
+		stack_materialize(gen, from, args_number);
+	}
+	spill_all(gen);
+	const operand *const words = is_words ? &gen->stack[from] : NULL;
+
+	char *const buffer = malloc(4 * size + 1);
+	argument *const args = malloc(sizeof(argument) * (placeholders + 1));
+	if (buffer == NULL || args == NULL)
+	{
+		free(buffer);
+		free(args);
+		gen->was_error = 1;
+		return;
+	}
+
+	size_t length = 0;
+	size_t count = 0;
+	size_t arg = from;
+	size_t offset = 0;
+
+	for (size_t i = 0; i < size; i++)
+	{
+		const char32_t symbol = (char32_t)vector_get(&gen->data, format.literal + i);
+		if (symbol != '%' || i + 1 == size)
+		{
+			if (symbol == '%')
+			{
+				buffer[length++] = '%';
+				buffer[length++] = '%';
+			}
+			else if (symbol != 0)
+			{
+				length += utf8_to_string(&buffer[length], symbol);
+			}
+			continue;
+		}
+
+		const char32_t placeholder = (char32_t)vector_get(&gen->data, format.literal + ++i);
+		switch (placeholder)
+		{
+			case 'i':
+			case U'ц':
+			case 'f':
+			case U'в':
+			{
+				const int is_double = placeholder_kind(placeholder) == kind_double;
+				args[count++] = printf_argument(gen, is_double, &arg, is_words, &offset);
+
+				buffer[length++] = '%';
+				buffer[length++] = is_double ? 'f' : 'i';
+			}
+			break;
+			case 'c':
+			case U'л':
+			case 's':
+			case U'с':
+			{
+				const argument value = printf_argument(gen, 0, &arg, is_words, &offset);
+				printf_flush(gen, buffer, &length, args, &count, words);
+
+				const int is_char = placeholder == 'c' || placeholder == U'л';
+				argument_load(gen, r_a0, &value, words);
+				emit_call(gen, is_char ? "ruc_print_char" : "ruc_print_string");
+			}
+			break;
+			default:
+				// Неизвестный спецификатор печатается как есть
+				buffer[length++] = '%';
+				buffer[length++] = '%';
+				if (placeholder != '%' && placeholder != 0)
+				{
+					length += utf8_to_string(&buffer[length], placeholder);
+				}
+				break;
+		}
+	}
+
+	printf_flush(gen, buffer, &length, args, &count, words);
+	stack_release(gen, from);
+
+	free(buffer);
+	free(args);
+}
+
+static void print_identifier(mipsgen *const gen, const size_t id, const int is_scan)
+{
+	syntax *const sx = gen->sx;
+	const item_t displ = ident_get_displ(sx, id);
+	const item_t mode = ident_get_mode(sx, id);
+	char name[MAX_OPERAND_SIZE];
+
+	spill_all(gen);
+	if (is_scan)
+	{
+		const char *const scanner = scanner_name(gen, mode, name);
+		cell_address(gen, r_a0, displ);
+		emit_call(gen, scanner);
+		return;
+	}
+
+	const char *const identifier_name = repr_get_name(sx, (size_t)ident_get_repr(sx, id));
+	const size_t length = strlen(identifier_name);
+	char *const buffer = malloc(length + 4);
+	if (buffer == NULL)
+	{
+		gen->was_error = 1;
+		return;
+	}
+
+	sprintf(buffer, "%s = ", identifier_name);
+	sprintf(name, ".LS%zu", string_constant(gen, buffer, length + 3));
+	free(buffer);
+
+	emit_la(gen, r_a0, name);
+	emit_call(gen, "printf");
+
+	const char *const printer = printer_name(gen, mode, name);
+	cell_address(gen, r_a0, displ);
+	emit_call(gen, printer);
+
+	emit_la(gen, r_a0, "ruc_format_newline");
+	emit_call(gen, "printf");
+}
+
+
+static void function_return(mipsgen *const gen)
+{
+	emit_immediate(gen, addiu, r_s5, r_s4, -1);
+
+	const kind_t kind = return_kind(gen->sx, gen->function_mode);
+	if (kind == kind_double)
+	{
+		emit_transfer(gen, mtc1, r_zero, 0);
+		emit_transfer(gen, mtc1, r_zero, 1);
+	}
+	else if (kind == kind_int)
+	{
+		emit_move(gen, r_v0, r_zero);
+	}
+
+	emit_jump(gen, gen->current->exit);
+}
+
+static void return_value(mipsgen *const gen, const size_t size)
+{
+	syntax *const sx = gen->sx;
+	const item_t type = mode_get(sx, (size_t)gen->function_mode + 1);
+
+	if (type > 0 && mode_get(sx, (size_t)type) == mode_struct)
+	{
+		const size_t from = stack_words(gen, size);
+		const operand frame = cell_location(gen, 0);
+		store_words(gen, from, &frame, 0, 0);
+		operand_free(gen, &frame);
+
+		emit_immediate(gen, addiu, r_s5, r_s4, (int64_t)size - 1);
+		emit_jump(gen, gen->current->exit);
+		return;
+	}
+
+	if (type == LFLOAT)
+	{
+		const operand value = pop_double(gen);
+		double_argument(gen, 0, &value);
+	}
+	else
+	{
+		const operand value = pop_int(gen);
+		operand_argument(gen, r_v0, &value);
+	}
+
+	emit_immediate(gen, addiu, r_s5, r_s4, -1);
+	emit_jump(gen, gen->current->exit);
+}
+
+static size_t label_of(mipsgen *const gen, const size_t id)
+{
+	if (id >= vector_size(&gen->labels))
+	{
+		vector_resize(&gen->labels, id + 1);
+	}
+
+	if (vector_get(&gen->labels, id) == 0)
+	{
+		vector_set(&gen->labels, id, (item_t)label(gen));
+	}
+
+	return (size_t)vector_get(&gen->labels, id);
+}
+
+/** Вычислить выражение ради побочных эффектов и отбросить его значение */
+static void expression_statement(mipsgen *const gen, node *const nd, const int mode)
+{
+	const size_t depth = gen->stack_size;
+	expression(gen, nd, mode);
+	stack_release(gen, depth);
+}
+
+/**
+ *	Значения выражений-операторов остаются на стеке для следующего printf,
+ *	остальные операторы их сбрасывают, кроме объявления массива с границами на стеке
+ */
+static int is_statement(const item_t type)
+{
+	switch (type)
+	{
+		case NOP:
+		case CREATEDIRECTC:
+		case EXITDIRECTC:
+		case EXITC:
+		case TBegin:
+		case TIf:
+		case TWhile:
+		case TDo:
+		case TFor:
+		case TGoto:
+		case TLabel:
+		case TSwitch:
+		case TCase:
+		case TDefault:
+		case TBreak:
+		case TContinue:
+		case TReturnvoid:
+		case TReturnval:
+		case TPrintid:
+		case TGetid:
+		case SETMOTOR:
+		case TDeclarr:
+		case TStructbeg:
+		case TStructend:
+			return 1;
+		default:
+			return 0;
+	}
+}
+
+static void statement(mipsgen *const gen, node *const nd);
+
+/** Вложенный оператор не оставляет значений на стеке после себя */
+static void substatement(mipsgen *const gen, node *const nd)
+{
+	const size_t depth = gen->stack_size;
+	statement(gen, nd);
+	stack_release(gen, depth);
+}
+
+static void statement(mipsgen *const gen, node *const nd)
+{
+	switch (node_get_type(nd))
+	{
+		case NOP:
+			break;
+		case CREATEDIRECTC:
+		case EXITDIRECTC:
+		case EXITC:
+			unsupported(gen, node_get_type(nd));
+			break;
+		case TBegin:
+			block(gen, nd);
+			break;
+		case TIf:
+		{
+			const item_t ref_else = node_get_arg(nd, 0);
+
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			const operand value = pop_int(gen);
+			const size_t other = label(gen);
+			branch_if(gen, &value, 0, other);
+			substatement(gen, nd);
+
+			if (ref_else)
+			{
+				const size_t end = label(gen);
+				node_set_next(nd);
+				emit_jump(gen, end);
+				emit_label(gen, other);
+				substatement(gen, nd);
+				emit_label(gen, end);
+			}
+			else
+			{
+				emit_label(gen, other);
+			}
+		}
+		break;
+		case TWhile:
+		{
+			const size_t old_break = gen->label_break;
+			const size_t old_continue = gen->label_continue;
+			const size_t begin = label(gen);
+			const size_t end = label(gen);
+
+			emit_label(gen, begin);
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			const operand value = pop_int(gen);
+			branch_if(gen, &value, 0, end);
+
+			gen->label_break = end;
+			gen->label_continue = begin;
+			substatement(gen, nd);
+
+			emit_jump(gen, begin);
+			emit_label(gen, end);
+
+			gen->label_break = old_break;
+			gen->label_continue = old_continue;
+		}
+		break;
+		case TDo:
+		{
+			const size_t old_break = gen->label_break;
+			const size_t old_continue = gen->label_continue;
+			const size_t body = label(gen);
+			const size_t check = label(gen);
+			const size_t end = label(gen);
+
+			emit_label(gen, body);
+			gen->label_break = end;
+			gen->label_continue = check;
+
+			node_set_next(nd);
+			substatement(gen, nd);
+			emit_label(gen, check);
+
+			expression(gen, nd, 0);
+			const operand value = pop_int(gen);
+			branch_if(gen, &value, 1, body);
+			emit_label(gen, end);
+
+			gen->label_break = old_break;
+			gen->label_continue = old_continue;
+		}
+		break;
+		case TFor:
+		{
+			const item_t ref_from = node_get_arg(nd, 0);
+			const item_t ref_cond = node_get_arg(nd, 1);
+			const item_t ref_incr = node_get_arg(nd, 2);
+
+			node incr;
+			node_copy(&incr, nd);
+			size_t child_stmt = 0;
+
+			if (ref_from)
+			{
+				expression_statement(gen, &incr, 0); // initialization
+				child_stmt++;
+			}
+
+			const size_t old_break = gen->label_break;
+			const size_t old_continue = gen->label_continue;
+			const size_t begin = label(gen);
+			const size_t step = label(gen);
+			const size_t end = label(gen);
+
+			emit_label(gen, begin);
+			if (ref_cond)
+			{
+				expression(gen, &incr, 0); // condition
+				const operand value = pop_int(gen);
+				branch_if(gen, &value, 0, end);
+				child_stmt++;
+			}
+
+			if (ref_incr)
+			{
+				child_stmt++;
+			}
+
+			gen->label_break = end;
+			gen->label_continue = step;
+
+			node stmt = node_get_child(nd, child_stmt);
+			substatement(gen, &stmt);
+			emit_label(gen, step);
+
+			if (ref_incr)
+			{
+				expression_statement(gen, &incr, 0); // increment
+			}
+			node_copy(nd, &stmt);
+
+			emit_jump(gen, begin);
+			emit_label(gen, end);
+
+			gen->label_break = old_break;
+			gen->label_continue = old_continue;
+		}
+		break;
+		case TGoto:
+			emit_jump(gen, label_of(gen, (size_t)abs((int)node_get_arg(nd, 0))));
+			break;
+		case TLabel:
+			emit_label(gen, label_of(gen, (size_t)node_get_arg(nd, 0)));
+			break;
+		case TSwitch:
+		{
+			const size_t old_break = gen->label_break;
+			const size_t old_case = gen->label_case;
+			const operand old_value = gen->switch_value;
+
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			// Значение сравнивается в каждой ветви, поэтому хранится в кадре
+			gen->switch_value = pop_int(gen);
+			operand_spill(gen, &gen->switch_value);
+			gen->label_case = 0;
+			gen->label_break = label(gen);
+			const size_t end = gen->label_break;
+
+			substatement(gen, nd);
+			if (gen->label_case)
+			{
+				emit_label(gen, gen->label_case);
+			}
+			emit_label(gen, end);
+			operand_free(gen, &gen->switch_value);
+
+			gen->label_case = old_case;
+			gen->label_break = old_break;
+			gen->switch_value = old_value;
+		}
+		break;
+		case TCase:
+		{
+			if (gen->label_case)
+			{
+				emit_label(gen, gen->label_case);
+			}
+
+			expression(gen, nd, 0);
+			node_set_next(nd); // TExprend
+
+			const operand value = pop_int(gen);
+			const gpr_t a = int_source(gen, &gen->switch_value, r_t8);
+			const gpr_t b = int_source(gen, &value, r_v1);
+			operand_free(gen, &value);
+
+			gen->label_case = label(gen);
+			emit_branch(gen, bne, a, b, gen->label_case);
+			substatement(gen, nd);
+		}
+		break;
+		case TDefault:
+		{
+			if (gen->label_case)
+			{
+				emit_label(gen, gen->label_case);
+			}
+			gen->label_case = 0;
+
+			node_set_next(nd);
+			substatement(gen, nd);
+		}
+		break;
+		case TBreak:
+			emit_jump(gen, gen->label_break);
+			break;
+		case TContinue:
+			emit_jump(gen, gen->label_continue);
+			break;
+		case TReturnvoid:
+			function_return(gen);
+			break;
+		case TReturnval:
+		{
+			const item_t size = node_get_arg(nd, 0);
+			expression(gen, nd, 0);
+			return_value(gen, (size_t)size);
+		}
+		break;
+		case TPrintid:
+			print_identifier(gen, (size_t)node_get_arg(nd, 0), 0);
+			break;
+		case TPrintf:
+			print_format(gen, (size_t)node_get_arg(nd, 0));
+			break;
+		case TGetid:
+			print_identifier(gen, (size_t)node_get_arg(nd, 0), 1);
+			break;
+		case SETMOTOR:
+		{
+			unsupported(gen, SETMOTOR);
+			expression_statement(gen, nd, 0);
+			expression_statement(gen, nd, 0);
+		}
+		break;
+		default:
+			if (declaration(gen, nd))
+			{
+				expression(gen, nd, -1);
+			}
+			break;
+	}
+}
+
+static void block(mipsgen *const gen, node *const nd)
+{
+	node_set_next(nd); // TBegin
+	while (node_get_type(nd) != TEnd)
+	{
+		if (is_statement(node_get_type(nd)))
+		{
+			stack_release(gen, 0);
+		}
+
+		statement(gen, nd);
+		node_set_next(nd);
+	}
+
+	stack_release(gen, 0);
+}
+
+
+static void function_definition(mipsgen *const gen, node *const nd)
+{
+	syntax *const sx = gen->sx;
+	const size_t id = (size_t)node_get_arg(nd, 0);
+	const item_t max_displ = node_get_arg(nd, 1);
+	const size_t number = (size_t)ident_get_displ(sx, id);
+	const item_t mode = ident_get_mode(sx, id);
+
+	function_reference(gen, number);
+	vector_set(&gen->functions, number, state_defined);
+
+	gen->function_mode = mode;
+	gen->current = &gen->function;
+	gen->stack_size = 0;
+
+	gen->param_words = 0;
+	const item_t params = mode_get(sx, (size_t)mode + 2);
+	for (item_t i = 0; i < params; i++)
+	{
+		gen->param_words += size_of(sx, mode_get(sx, (size_t)(mode + 3 + i)));
+	}
+
+	unit_begin(gen, &gen->function);
+	node_set_next(nd);
+	block(gen, nd);
+	function_return(gen);
+
+	char name[MAX_OPERAND_SIZE];
+	sprintf(name, "ruc_f%zu", number);
+	unit_prologue(gen, &gen->function, name);
+
+	// Кадр виртуальной машины: $s4 - его начало, $s6 - байтовый адрес, локальные переменные обнуляются
+	universal_io *const io = &gen->module;
+	uni_print_string(io, "\tmove\t$s4, $a0\n");
+	uni_print_string(io, "\tsll\t$s6, $a0, 2\n");
+	uni_print_string(io, "\taddu\t$s6, $s6, $s7\n");
+	uni_printf(io, "\taddiu\t$a0, $s4, %zu\n", FRAME_SIZE + gen->param_words);
+	uni_printf(io, "\taddiu\t$a1, $s4, %" PRIitem "\n", max_displ - 1);
+	uni_print_string(io, "\tjal\truc_enter\n");
+
+	unit_end(gen, &gen->function);
+	gen->current = &gen->init;
+}
+
+static int generate(mipsgen *const gen)
+{
+	unit_begin(gen, &gen->init);
+	gen->current = &gen->init;
+
+	node root = arena_get_root(&gen->sx->arena);
+	while (node_set_next(&root) == 0)
+	{
+		switch (node_get_type(&root))
+		{
+			case TFuncdef:
+				function_definition(gen, &root);
+				break;
+
+			case NOP:
+			case TEnd:
+				break;
+
+			default:
+				if (declaration(gen, &root))
+				{
+					system_error(node_unexpected, node_get_type(&root));
+					return -1;
+				}
+				break;
+		}
+	}
+
+	return gen->was_error ? -1 : 0;
+}
+
+
+static void procedure_prologue(universal_io *const io, const char *const name)
+{
+	uni_printf(io, "%s:\n", name);
+	uni_print_string(io, "\taddiu\t$sp, $sp, -32\n");
+	uni_print_string(io, "\tsw\t$ra, 28($sp)\n");
+	uni_print_string(io, "\tsw\t$s0, 24($sp)\n");
+	uni_print_string(io, "\tsw\t$s1, 20($sp)\n");
+	uni_print_string(io, "\tsw\t$s2, 16($sp)\n");
+}
+
+static void procedure_epilogue(universal_io *const io)
+{
+	uni_print_string(io, "\tlw\t$s2, 16($sp)\n");
+	uni_print_string(io, "\tlw\t$s1, 20($sp)\n");
+	uni_print_string(io, "\tlw\t$s0, 24($sp)\n");
+	uni_print_string(io, "\tlw\t$ra, 28($sp)\n");
+	uni_print_string(io, "\taddiu\t$sp, $sp, 32\n");
+	uni_print_string(io, "\tjr\t$ra\n\n");
+}
+
+/** Начало обхода массива: $s0 - адрес, $s1 - граница, $s2 - индекс */
+static void array_loop_begin(universal_io *const io, const size_t loop, const size_t done, const char *const fail)
+{
+	uni_print_string(io, "\tlw\t$s0, 0($a0)\n");
+	uni_printf(io, "\tblez\t$s0, %s\n", fail);
+	uni_print_string(io, "\tla\t$v0, ruc_size\n");
+	uni_print_string(io, "\tlw\t$v0, 0($v0)\n");
+	uni_print_string(io, "\tslt\t$v0, $s0, $v0\n");
+	uni_printf(io, "\tbeqz\t$v0, %s\n", fail);
+	uni_print_string(io, "\taddiu\t$v0, $s0, -1\n");
+	uni_print_string(io, "\tsll\t$v0, $v0, 2\n");
+	uni_print_string(io, "\taddu\t$v0, $v0, $s7\n");
+	uni_print_string(io, "\tlw\t$s1, 0($v0)\n");
+	uni_print_string(io, "\tmove\t$s2, $zero\n");
+	uni_printf(io, ".L%zu:\n", loop);
+	uni_print_string(io, "\tslt\t$v0, $s2, $s1\n");
+	uni_printf(io, "\tbeqz\t$v0, .L%zu\n", done);
+}
+
+/** Шаг обхода массива: вызов процедуры для элемента по байтовому адресу */
+static void array_loop_end(universal_io *const io, const size_t loop, const size_t size, const char *const name)
+{
+	uni_printf(io, "\tli\t$v0, %zu\n", size);
+	uni_print_string(io, "\tmul\t$a0, $s2, $v0\n");
+	uni_print_string(io, "\taddu\t$a0, $a0, $s0\n");
+	uni_print_string(io, "\tsll\t$a0, $a0, 2\n");
+	uni_print_string(io, "\taddu\t$a0, $a0, $s7\n");
+	uni_printf(io, "\tjal\t%s\n", name);
+	uni_print_string(io, "\taddiu\t$s2, $s2, 1\n");
+	uni_printf(io, "\tb\t.L%zu\n", loop);
+}
+
+static void printer_define(mipsgen *const gen, const item_t mode)
+{
+	syntax *const sx = gen->sx;
+	universal_io *const io = &gen->module;
+	char name[MAX_OPERAND_SIZE];
+	char element_name[MAX_OPERAND_SIZE];
+
+	sprintf(name, "ruc_print_%" PRIitem, mode);
+	procedure_prologue(io, name);
+
+	if (mode_get(sx, (size_t)mode) == mode_array)
+	{
+		const item_t element = mode_get(sx, (size_t)mode + 1);
+		const int is_matrix = element > 0 && mode_get(sx, (size_t)element) == mode_array;
+		const size_t done = label(gen);
+		char fail[MAX_OPERAND_SIZE];
+		sprintf(fail, ".L%zu", done);
+
+		if (element == LCHAR)
+		{
+			uni_print_string(io, "\tlw\t$s0, 0($a0)\n");
+			uni_printf(io, "\tblez\t$s0, %s\n", fail);
+			uni_print_string(io, "\tmove\t$a0, $s0\n");
+			uni_print_string(io, "\tjal\truc_print_string\n");
+		}
+		else
+		{
+			const size_t loop = label(gen);
+			const size_t body = label(gen);
+			array_loop_begin(io, loop, done, fail);
+			uni_printf(io, "\tbeqz\t$s2, .L%zu\n", body);
+			uni_printf(io, "\tla\t$a0, ruc_format_%s\n", is_matrix ? "newline" : "space");
+			uni_print_string(io, "\tjal\tprintf\n");
+			uni_printf(io, ".L%zu:\n", body);
+			array_loop_end(io, loop, size_of(sx, element), printer_name(gen, element, element_name));
+		}
+
+		uni_printf(io, ".L%zu:\n", done);
+	}
+	else
+	{
+		const item_t fields = mode_get(sx, (size_t)mode + 2) / 2;
+		size_t displ = 0;
+
+		uni_print_string(io, "\tmove\t$s0, $a0\n");
+		uni_print_string(io, "\tla\t$a0, ruc_format_begin\n");
+		uni_print_string(io, "\tjal\tprintf\n");
+		for (item_t i = 0; i < fields; i++)
+		{
+			const item_t field = mode_get(sx, (size_t)(mode + 3 + 2 * i));
+			if (i != 0)
+			{
+				uni_print_string(io, "\tla\t$a0, ruc_format_comma\n");
+				uni_print_string(io, "\tjal\tprintf\n");
+			}
+
+			uni_printf(io, "\taddiu\t$a0, $s0, %zu\n", 4 * displ);
+			uni_printf(io, "\tjal\t%s\n", printer_name(gen, field, element_name));
+			displ += size_of(sx, field);
+		}
+		uni_print_string(io, "\tla\t$a0, ruc_format_end\n");
+		uni_print_string(io, "\tjal\tprintf\n");
+	}
+
+	procedure_epilogue(io);
+}
+
+static void scanner_define(mipsgen *const gen, const item_t mode)
+{
+	syntax *const sx = gen->sx;
+	universal_io *const io = &gen->module;
+	char name[MAX_OPERAND_SIZE];
+	char element_name[MAX_OPERAND_SIZE];
+
+	sprintf(name, "ruc_scan_%" PRIitem, mode);
+	procedure_prologue(io, name);
+
+	if (mode_get(sx, (size_t)mode) == mode_array)
+	{
+		const item_t element = mode_get(sx, (size_t)mode + 1);
+		const size_t loop = label(gen);
+		const size_t done = label(gen);
+
+		array_loop_begin(io, loop, done, "ruc_fail_input");
+		array_loop_end(io, loop, size_of(sx, element), scanner_name(gen, element, element_name));
+		uni_printf(io, ".L%zu:\n", done);
+	}
+	else
+	{
+		const item_t fields = mode_get(sx, (size_t)mode + 2) / 2;
+		size_t displ = 0;
+
+		uni_print_string(io, "\tmove\t$s0, $a0\n");
+		for (item_t i = 0; i < fields; i++)
+		{
+			const item_t field = mode_get(sx, (size_t)(mode + 3 + 2 * i));
+			uni_printf(io, "\taddiu\t$a0, $s0, %zu\n", 4 * displ);
+			uni_printf(io, "\tjal\t%s\n", scanner_name(gen, field, element_name));
+			displ += size_of(sx, field);
+		}
+	}
+
+	procedure_epilogue(io);
+}
+
+static void module_output(mipsgen *const gen)
+{
+	syntax *const sx = gen->sx;
+	universal_io *const io = &gen->module;
+	const size_t globals = (size_t)sx->max_displg;
+	const size_t data = vector_size(&gen->data);
+	const size_t total = globals + data + STACK_SIZE + STACK_RESERVE;
+
+	// Инициализация глобальных переменных в кадре с $s4 = 0
+	gen->current = &gen->init;
+	unit_prologue(gen, &gen->init, "ruc_init");
+	uni_print_string(io, "\tla\t$v0, ruc_hp\n");
+	uni_printf(io, "\tli\t$v1, %zu\n", total);
+	uni_print_string(io, "\tsw\t$v1, 0($v0)\n");
+	uni_printf(io, "\tli\t$s5, %zu\n", globals + data - 1);
+	uni_print_string(io, "\tmove\t$s4, $zero\n");
+	uni_print_string(io, "\tmove\t$s6, $s7\n");
+	if (data != 0)
+	{
+		uni_printf(io, "\tli\t$a0, %zu\n", globals * sizeof(int32_t));
+		uni_print_string(io, "\taddu\t$a0, $a0, $s7\n");
+		uni_print_string(io, "\tla\t$a1, ruc_data\n");
+		uni_printf(io, "\tli\t$a2, %zu\n", data);
+		uni_print_string(io, "\tjal\truc_move\n");
+	}
+	unit_end(gen, &gen->init);
+
+	const size_t main_number = (size_t)ident_get_displ(sx, sx->ref_main);
+	function_reference(gen, main_number);
+
+	// Регистры $s4-$s7 закреплены за памятью и стеком программы
+	uni_print_string(io, "\t.globl\tmain\n");
+	uni_print_string(io, "main:\n");
+	uni_print_string(io, "\taddiu\t$sp, $sp, -40\n");
+	uni_print_string(io, "\tsw\t$ra, 36($sp)\n");
+	uni_print_string(io, "\tsw\t$s7, 32($sp)\n");
+	uni_print_string(io, "\tsw\t$s6, 28($sp)\n");
+	uni_print_string(io, "\tsw\t$s5, 24($sp)\n");
+	uni_print_string(io, "\tsw\t$s4, 20($sp)\n");
+	uni_print_string(io, "\tla\t$s7, ruc_mem\n");
+	uni_print_string(io, "\tjal\truc_init\n");
+	uni_print_string(io, "\taddiu\t$a0, $s5, 1\n");
+	uni_printf(io, "\tjal\truc_f%zu\n", main_number);
+	uni_print_string(io, "\tlw\t$s4, 20($sp)\n");
+	uni_print_string(io, "\tlw\t$s5, 24($sp)\n");
+	uni_print_string(io, "\tlw\t$s6, 28($sp)\n");
+	uni_print_string(io, "\tlw\t$s7, 32($sp)\n");
+	uni_print_string(io, "\tlw\t$ra, 36($sp)\n");
+	uni_print_string(io, "\taddiu\t$sp, $sp, 40\n");
+	uni_print_string(io, "\tmove\t$v0, $zero\n");
+	uni_print_string(io, "\tjr\t$ra\n\n");
+
+	// Процедуры печати и ввода могут запрашивать новые
+	for (size_t i = 0; i < vector_size(&gen->printers); i++)
+	{
+		printer_define(gen, vector_get(&gen->printers, i));
+	}
+	for (size_t i = 0; i < vector_size(&gen->scanners); i++)
+	{
+		scanner_define(gen, vector_get(&gen->scanners, i));
+	}
+
+	// Вызовы неописанных функций завершаются ошибкой, как в виртуальной машине
+	const size_t functions = vector_size(&gen->functions);
+	for (size_t i = 0; i < functions; i++)
+	{
+		if (vector_get(&gen->functions, i) == state_referenced)
+		{
+			uni_printf(io, "ruc_f%zu:\n", i);
+			uni_print_string(io, "\tla\t$a0, ruc_message_function\n");
+			uni_printf(io, "\tli\t$a1, %zu\n", i);
+			uni_print_string(io, "\tmove\t$a2, $zero\n");
+			uni_print_string(io, "\tj\truc_fail\n\n");
+		}
+	}
+
+	uni_print_string(io, "\t.rdata\n\t.align\t2\nruc_functions:\n");
+	for (size_t i = 0; i < functions; i++)
+	{
+		if (vector_get(&gen->functions, i) == state_defined)
+		{
+			uni_printf(io, "\t.word\truc_f%zu\n", i);
+		}
+		else
+		{
+			uni_print_string(io, "\t.word\t0\n");
+		}
+	}
+	uni_printf(io, "%sruc_functions_size:\n\t.word\t%zu\n", functions != 0 ? "" : "\t.word\t0\n", functions);
+	uni_printf(io, "ruc_size:\n\t.word\t%zu\n", total);
+
+	if (data != 0)
+	{
+		uni_print_string(io, "ruc_data:");
+		for (size_t i = 0; i < data; i++)
+		{
+			uni_printf(io, "%s%i", i % 8 == 0 ? "\n\t.word\t" : ", ", (int)vector_get(&gen->data, i));
+		}
+		uni_print_string(io, "\n");
+	}
+
+	uni_print_string(io, "\n\t.data\n\t.align\t2\nruc_hp:\n\t.word\t0\n");
+	uni_printf(io, "\n\t.bss\n\t.align\t3\nruc_mem:\n\t.space\t%zu\n\n", total * sizeof(int32_t));
+}
+
+static void module_header(universal_io *const io)
+{
+	uni_print_string(io, "\t.set\tnoat\n");
+	for (size_t i = 0; i < sizeof(RUNTIME) / sizeof(RUNTIME[0]); i++)
+	{
+		uni_print_string(io, RUNTIME[i]);
+		uni_print_string(io, "\n");
+	}
+	uni_print_string(io, "\n");
+}
+
+static void module_messages(universal_io *const io)
+{
+	uni_print_string(io, "\t.rdata\n");
+	for (size_t i = 0; i < sizeof(MESSAGES) / sizeof(MESSAGES[0]); i++)
+	{
+		uni_printf(io, "ruc_message_%s:\n", MESSAGES[i][0]);
+		string_escape(io, MESSAGES[i][1], strlen(MESSAGES[i][1]));
+	}
+}
+
+
+static mipsgen mips_create(syntax *const sx)
+{
+	mipsgen gen;
+	memset(&gen, 0, sizeof(mipsgen));
+
+	gen.sx = sx;
+	gen.module = io_create();
+	gen.constants = io_create();
+	gen.init.io = io_create();
+	gen.function.io = io_create();
+	out_set_buffer(&gen.module, BUFSIZ);
+	out_set_buffer(&gen.constants, BUFSIZ);
+	uni_print_string(&gen.module, "\t.text\n");
+
+	gen.init.slots = vector_create(MAX_OPERAND_SIZE);
+	gen.function.slots = vector_create(MAX_OPERAND_SIZE);
+
+	gen.stack_alloc = MAX_OPERAND_SIZE;
+	gen.stack = malloc(gen.stack_alloc * sizeof(operand));
+
+	gen.logic = vector_create(MAX_OPERAND_SIZE);
+	gen.calls = vector_create(MAX_OPERAND_SIZE);
+	gen.data = vector_create(MAX_OPERAND_SIZE);
+	gen.labels = vector_create(MAX_OPERAND_SIZE);
+	gen.functions = vector_create(vector_size(&sx->functions));
+	gen.printers = vector_create(MAX_OPERAND_SIZE);
+	gen.scanners = vector_create(MAX_OPERAND_SIZE);
+
+	vector_resize(&gen.functions, vector_size(&sx->functions));
+	return gen;
+}
+
+static void mips_clear(mipsgen *const gen)
+{
+	free(out_extract_buffer(&gen->module));
+	free(out_extract_buffer(&gen->constants));
+	free(out_extract_buffer(&gen->init.io));
+	free(out_extract_buffer(&gen->function.io));
+
+	vector_clear(&gen->init.slots);
+	vector_clear(&gen->function.slots);
+	free(gen->stack);
+
+	vector_clear(&gen->logic);
+	vector_clear(&gen->calls);
+	vector_clear(&gen->data);
+	vector_clear(&gen->labels);
+	vector_clear(&gen->functions);
+	vector_clear(&gen->printers);
+	vector_clear(&gen->scanners);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int encode_to_mips(const workspace *const ws, universal_io *const io, syntax *const sx)
+{
+	if (!ws_is_correct(ws) || !out_is_correct(io) || sx == NULL)
+	{
+		return -1;
+	}
+
+	mipsgen gen = mips_create(sx);
+	if (gen.stack == NULL)
+	{
+		mips_clear(&gen);
+		return -1;
+	}
+
+	int ret = generate(&gen);
+	if (!ret)
+	{
+		module_output(&gen);
+
+		module_header(io);
+
+		char *const module = out_extract_buffer(&gen.module);
+		char *const constants = out_extract_buffer(&gen.constants);
+		ret = module == NULL || constants == NULL
+			|| out_write(io, module, strlen(module)) == -1 ? -1 : 0;
+		if (!ret)
+		{
+			module_messages(io);
+			ret = out_write(io, constants, strlen(constants)) == -1 ? -1 : 0;
+		}
+
+		free(module);
+		free(constants);
+	}
+
+	mips_clear(&gen);
+	return ret;
+}
@@ -0,0 +1,197 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include "defs.h"
+#include "item.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Check that value fits item type
+ *
+ *	@param	value		Value
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static inline int is_item(const int64_t value)
+{
+	return value >= (int64_t)ITEM_MIN && (ITEM_MAX > INT64_MAX || value <= (int64_t)ITEM_MAX);
+}
+
+/**
+ *	Check that operation with constant right operand does not change value
+ *
+ *	@param	code		Operation code
+ *	@param	value		Right operand
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static inline int is_right_identity(const item_t code, const item_t value)
+{
+	switch (code)
+	{
+		case LPLUS:
+		case LMINUS:
+		case LOR:
+		case LEXOR:
+		case LSHL:
+		case LSHR:
+			return value == 0;
+		case LMULT:
+		case LDIV:
+			return value == 1;
+		default:
+			return 0;
+	}
+}
+
+/**
+ *	Check that operation with constant left operand does not change value
+ *
+ *	@param	code		Operation code
+ *	@param	value		Left operand
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static inline int is_left_identity(const item_t code, const item_t value)
+{
+	switch (code)
+	{
+		case LPLUS:
+		case LOR:
+		case LEXOR:
+			return value == 0;
+		case LMULT:
+			return value == 1;
+		default:
+			return 0;
+	}
+}
+
+/**
+ *	Perform binary integer operation with virtual machine semantics.
+ *	Unknown operation returns second operand, as plain assignment does.
+ *	Divisor must be checked by caller.
+ *
+ *	@param	code		Operation code
+ *	@param	fst			First operand
+ *	@param	snd			Second operand
+ *
+ *	@return	Operation result
+ */
+static inline int32_t int_operation(const item_t code, const int32_t fst, const int32_t snd)
+{
+	switch (code)
+	{
+		case LREM:
+			return snd == -1 ? 0 : fst % snd;
+		case LSHL:
+			return (int32_t)((uint32_t)fst << (snd & 31));
+		case LSHR:
+			return fst >> (snd & 31);
+		case LAND:
+			return fst & snd;
+		case LEXOR:
+			return fst ^ snd;
+		case LOR:
+			return fst | snd;
+		case LOGAND:
+			return fst && snd;
+		case LOGOR:
+			return fst || snd;
+		case EQEQ:
+			return fst == snd;
+		case NOTEQ:
+			return fst != snd;
+		case LLT:
+			return fst < snd;
+		case LGT:
+			return fst > snd;
+		case LLE:
+			return fst <= snd;
+		case LGE:
+			return fst >= snd;
+		case LPLUS:
+			return (int32_t)((uint32_t)fst + (uint32_t)snd);
+		case LMINUS:
+			return (int32_t)((uint32_t)fst - (uint32_t)snd);
+		case LMULT:
+			return (int32_t)((uint32_t)fst * (uint32_t)snd);
+		case LDIV:
+			return snd == -1 ? (int32_t)(0u - (uint32_t)fst) : fst / snd;
+		default:
+			return snd;
+	}
+}
+
+/**
+ *	Fold binary integer operation with virtual machine semantics
+ *
+ *	@param	code		Operation code
+ *	@param	fst			First operand
+ *	@param	snd			Second operand
+ *	@param	result		Operation result
+ *
+ *	@return	@c 0 on success, @c -1 if operation can not be folded
+ */
+static inline int fold_int_binary(const item_t code, const int32_t fst, const int32_t snd, int32_t *const result)
+{
+	// Целочисленные операции идут подряд от LREM до LDIV
+	if (code < LREM || code > LDIV || ((code == LREM || code == LDIV) && snd == 0))
+	{
+		return -1;
+	}
+
+	*result = int_operation(code, fst, snd);
+	return 0;
+}
+
+/**
+ *	Fold unary integer operation with virtual machine semantics
+ *
+ *	@param	code		Operation code
+ *	@param	value		Operand
+ *	@param	result		Operation result
+ *
+ *	@return	@c 0 on success, @c -1 if operation can not be folded
+ */
+static inline int fold_int_unary(const item_t code, const int32_t value, int32_t *const result)
+{
+	switch (code)
+	{
+		case UNMINUS:
+			*result = (int32_t)(0u - (uint32_t)value);
+			return 0;
+		case LNOT:
+			*result = ~value;
+			return 0;
+		case LOGNOT:
+			*result = !value;
+			return 0;
+		default:
+			return -1;
+	}
+}
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -14,6 +14,7 @@
  *	limitations under the License.
  */
 
+#include <stdlib.h>
 #include "codes.h"
 #include "parser.h"
 #include "tree.h"
@@ -43,6 +44,18 @@ parser parser_create(syntax *const sx, lexer *const lxr)
 	prs.sx = sx;
 	prs.lxr = lxr;
 
+	prs.gotost = vector_create(MAXLABELS);
+	prs.labels = vector_create(MAXLABELS);
+	label_reset(&prs);
+
+	// Обычные выражения помещаются в выделенный размер, стеки растут только для длинных
+	prs.stack = malloc(MAXSTACK * sizeof(int));
+	prs.stackop = malloc(MAXSTACK * sizeof(int));
+	prs.stacklog = malloc(MAXSTACK * sizeof(int));
+	prs.stack_alloc = MAXSTACK;
+	prs.stackoperands = malloc(MAXSTACK * sizeof(int));
+	prs.stackoperands_alloc = MAXSTACK;
+
 	prs.sp = 0;
 	prs.sopnd = -1;
 	prs.leftansttype = -1;
@@ -57,6 +70,38 @@ parser parser_create(syntax *const sx, lexer *const lxr)
 	return prs;
 }
 
+/**
+ *	Free allocated memory
+ *
+ *	@param	prs		Parser structure
+ */
+void parser_clear(parser *const prs)
+{
+	vector_clear(&prs->gotost);
+	vector_clear(&prs->labels);
+
+	free(prs->stack);
+	free(prs->stackop);
+	free(prs->stacklog);
+	free(prs->stackoperands);
+}
+
+/**	Put label record to hash table, table has free slots */
+void label_index_put(parser *const prs, const size_t index)
+{
+	const size_t repr = (size_t)ident_get_repr(prs->sx, (size_t)vector_get(&prs->gotost, index));
+	const size_t mask = vector_size(&prs->labels) - 1;
+
+	size_t slot = (repr * 2654435761U) & mask;
+	while (vector_get(&prs->labels, slot) != 0)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	// Хранится индекс записи плюс один, ноль означает свободную ячейку
+	vector_set(&prs->labels, slot, (item_t)index + 1);
+}
+
 
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
@@ -76,6 +121,11 @@ int parse(universal_io *const io, syntax *const sx)
 
 	lexer lxr = create_lexer(io, sx);
 	parser prs = parser_create(sx, &lxr);
+	if (prs.stack == NULL || prs.stackop == NULL || prs.stacklog == NULL || prs.stackoperands == NULL)
+	{
+		parser_clear(&prs);
+		return -1;
+	}
 
 	get_char(prs.lxr);
 	get_char(prs.lxr);
@@ -87,15 +137,17 @@ int parse(universal_io *const io, syntax *const sx)
 	} while (prs.next_token != eof);
 
 	tree_add(prs.sx, TEnd);
+	parser_clear(&prs);
 
 #ifndef GENERATE_TREE
-	return prs.was_error || prs.lxr->was_error || !sx_is_correct(sx);
+	const int ret = prs.was_error || prs.lxr->was_error || !sx_is_correct(sx);
 #else
 	const int ret = prs.was_error || prs.lxr->was_error || !sx_is_correct(sx)
 		|| tree_test(&sx->tree)
 		|| tree_test_next(&sx->tree)
 		|| tree_test_recursive(&sx->tree)
-		|| tree_test_copy(&sx->tree);
+		|| tree_test_copy(&sx->tree)
+		|| tree_test_arena(&sx->tree);
 
 	tables_and_tree(DEFAULT_TREE, &sx->identifiers, &sx->modes, &sx->tree);
 
@@ -103,8 +155,14 @@ int parse(universal_io *const io, syntax *const sx)
 	{
 		tree_print(DEFAULT_NEW, &sx->tree);
 	}
-	return ret;
 #endif
+
+	if (!ret)
+	{
+		arena_clear(&sx->arena);
+		sx->arena = arena_create(&sx->tree);
+	}
+	return ret;
 }
 
 
@@ -268,3 +326,54 @@ item_t to_modetab(parser *const prs, const item_t mode, const item_t element)
 	temp[1] = element;
 	return (item_t)mode_add(prs->sx, temp, 2);
 }
+
+
+void label_reset(parser *const prs)
+{
+	vector_resize(&prs->gotost, 0);
+	vector_resize(&prs->labels, 0);
+	vector_resize(&prs->labels, 64);
+}
+
+size_t label_find(parser *const prs, const size_t repr)
+{
+	const size_t mask = vector_size(&prs->labels) - 1;
+	for (size_t slot = (repr * 2654435761U) & mask; vector_get(&prs->labels, slot) != 0; slot = (slot + 1) & mask)
+	{
+		const size_t index = (size_t)vector_get(&prs->labels, slot) - 1;
+		if (repr == (size_t)ident_get_repr(prs->sx, (size_t)vector_get(&prs->gotost, index)))
+		{
+			return index;
+		}
+	}
+
+	return SIZE_MAX;
+}
+
+void label_add(parser *const prs, const item_t id, const item_t line)
+{
+	vector_add(&prs->gotost, id);
+	vector_add(&prs->gotost, line);
+
+	// Таблица больше таблицы меток, поэтому заполнена не более чем наполовину
+	if (vector_size(&prs->gotost) > vector_size(&prs->labels))
+	{
+		const size_t size = 2 * vector_size(&prs->labels);
+		vector_resize(&prs->labels, 0);
+		vector_resize(&prs->labels, size);
+
+		// Повторные записи переходов в таблицу не попадают
+		for (size_t i = 0; i < vector_size(&prs->gotost); i += 2)
+		{
+			const size_t repr = (size_t)ident_get_repr(prs->sx, (size_t)vector_get(&prs->gotost, i));
+			if (label_find(prs, repr) == SIZE_MAX)
+			{
+				label_index_put(prs, i);
+			}
+		}
+	}
+	else
+	{
+		label_index_put(prs, vector_size(&prs->gotost) - 2);
+	}
+}
@@ -46,13 +46,17 @@ typedef struct parser
 
 	size_t function_mode;		/**< Mode of currenty parsed function */
 	size_t array_dimensions;	/**< Array dimensions counter */
-	item_t gotost[1000];		/**< Labels table */
-	size_t pgotost;				/**< Labels counter */
+	vector gotost;				/**< Labels table */
+	vector labels;				/**< Hash table of labels by representation */
+
+	int *stack;					/**< Operators priorities stack */
+	int *stackop;				/**< Operators stack */
+	int *stacklog;				/**< Logical operators addresses stack */
+	size_t stack_alloc;			/**< Allocated size of operators stacks */
+
+	int *stackoperands;			/**< Operands types stack */
+	size_t stackoperands_alloc;	/**< Allocated size of operands stack */
 
-	int stack[100];
-	int stackop[100];
-	int stackoperands[100];
-	int stacklog[100];
 	int sp;
 	int sopnd;
 	int anst;
@@ -414,6 +418,33 @@ size_t to_identab(parser *const prs, const size_t repr, const item_t type, const
  */
 item_t to_modetab(parser *const prs, const item_t mode, const item_t element);
 
+
+/**
+ *	Clear labels table before parsing function body
+ *
+ *	@param	prs			Parser structure
+ */
+void label_reset(parser *const prs);
+
+/**
+ *	Find the first record of label in labels table
+ *
+ *	@param	prs			Parser structure
+ *	@param	repr		Label index in representations table
+ *
+ *	@return	Index of the record in labels table, @c SIZE_MAX if label is absent
+ */
+size_t label_find(parser *const prs, const size_t repr);
+
+/**
+ *	Add the first record of label to labels table
+ *
+ *	@param	prs			Parser structure
+ *	@param	id			Label index in identifiers table
+ *	@param	line		@c -1 for label definition, line of goto otherwise
+ */
+void label_add(parser *const prs, const item_t id, const item_t line);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
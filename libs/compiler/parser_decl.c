@@ -682,7 +682,7 @@ void parse_function_body(parser *const prs, const size_t function_id)
 	const size_t function_number = (size_t)ident_get_displ(prs->sx, function_id);
 	const size_t param_number = (size_t)mode_get(prs->sx, prs->function_mode + 2);
 
-	prs->pgotost = 0;
+	label_reset(prs);
 	prs->flag_was_return = 0;
 
 	const item_t prev = ident_get_prev(prs->sx, function_id);
@@ -727,11 +727,11 @@ void parse_function_body(parser *const prs, const size_t function_id)
 
 	scope_func_exit(prs->sx, ref_maxdispl, old_displ);
 
-	for (size_t i = 0; i < prs->pgotost; i += 2)
+	for (size_t i = 0; i < vector_size(&prs->gotost); i += 2)
 	{
-		const size_t repr = (size_t)ident_get_repr(prs->sx, (size_t)prs->gotost[i]);
-		const size_t line_number = (size_t)llabs(prs->gotost[i + 1]);
-		if (!ident_get_mode(prs->sx, (size_t)prs->gotost[i]))
+		const size_t repr = (size_t)ident_get_repr(prs->sx, (size_t)vector_get(&prs->gotost, i));
+		const size_t line_number = (size_t)llabs(vector_get(&prs->gotost, i + 1));
+		if (!ident_get_mode(prs->sx, (size_t)vector_get(&prs->gotost, i)))
 		{
 			parser_error(prs, label_not_declared, line_number, repr_get_name(prs->sx, repr));
 		}
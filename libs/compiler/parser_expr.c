@@ -15,6 +15,7 @@
  */
 
 #include "parser.h"
+#include <stdlib.h>
 #include <string.h>
 
 
@@ -23,6 +24,94 @@ void exprassn(parser *const prs, int level);
 void expr(parser *const prs, int level);
 
 
+/** Double allocated size of stack, @c -1 on failure */
+static int stack_grow(int **const stack, const size_t alloc)
+{
+	int *const stack_new = realloc(*stack, 2 * alloc * sizeof(int));
+	if (stack_new == NULL)
+	{
+		return -1;
+	}
+
+	*stack = stack_new;
+	return 0;
+}
+
+/** Push operator, stacks grow only for expressions longer than preallocated size */
+static inline void operator_push(parser *const prs, const int priority, const int op, const int address)
+{
+	if ((size_t)prs->sp == prs->stack_alloc)
+	{
+		if (stack_grow(&prs->stack, prs->stack_alloc) || stack_grow(&prs->stackop, prs->stack_alloc)
+			|| stack_grow(&prs->stacklog, prs->stack_alloc))
+		{
+			prs->was_error = 1;
+			return;
+		}
+
+		prs->stack_alloc *= 2;
+	}
+
+	prs->stack[prs->sp] = priority;
+	prs->stacklog[prs->sp] = address;
+	prs->stackop[prs->sp++] = op;
+}
+
+/** Push operand type */
+static inline void operand_push(parser *const prs, const int type)
+{
+	if ((size_t)(prs->sopnd + 1) == prs->stackoperands_alloc)
+	{
+		if (stack_grow(&prs->stackoperands, prs->stackoperands_alloc))
+		{
+			prs->was_error = 1;
+			return;
+		}
+
+		prs->stackoperands_alloc *= 2;
+	}
+
+	prs->stackoperands[++prs->sopnd] = type;
+}
+
+/** Check that operands stack is not empty, underflow is reported unless parsing has already failed */
+static inline int operand_check(parser *const prs)
+{
+	if (prs->sopnd >= 0)
+	{
+		return 1;
+	}
+
+	// После ошибки разбор выражения прерывается и может не оставить операнд
+	if (!prs->was_error)
+	{
+		parser_error(prs, operand_stack_underflow);
+	}
+	return 0;
+}
+
+/** Pop operand type, @c mode_undefined if stack is empty */
+static inline int operand_pop(parser *const prs)
+{
+	return operand_check(prs) ? prs->stackoperands[prs->sopnd--] : mode_undefined;
+}
+
+/** Get top operand type, @c mode_undefined if stack is empty */
+static inline int operand_top(parser *const prs)
+{
+	return operand_check(prs) ? prs->stackoperands[prs->sopnd] : mode_undefined;
+}
+
+/** Replace top operand type */
+static inline void operand_set(parser *const prs, const int type)
+{
+	if (operand_check(prs))
+	{
+		prs->stackoperands[prs->sopnd] = type;
+	}
+}
+
+
 int scanner(parser *const prs)
 {
 	prs->curr_token = prs->next_token;
@@ -122,8 +211,8 @@ double double_from_tree(vector *const tree)
 void binop(parser *const prs, int sp)
 {
 	int op = prs->stackop[sp];
-	int right = prs->stackoperands[prs->sopnd--];
-	int left = prs->stackoperands[prs->sopnd];
+	int right = operand_pop(prs);
+	int left = operand_top(prs);
 
 	if (mode_is_pointer(prs->sx, left) || mode_is_pointer(prs->sx, right))
 	{
@@ -169,7 +258,7 @@ void binop(parser *const prs, int sp)
 		prs->ansttype = LINT;
 	}
 
-	prs->stackoperands[prs->sopnd] = prs->ansttype;
+	operand_set(prs, prs->ansttype);
 	prs->anst = VAL;
 }
 
@@ -272,7 +361,7 @@ void mustbestring(parser *const prs)
 		return; // 1
 	}
 	toval(prs);
-	prs->sopnd--;
+	operand_pop(prs);
 	if (!(mode_is_string(prs->sx, prs->ansttype)))
 	{
 		parser_error(prs, not_string_in_stanfunc);
@@ -290,7 +379,7 @@ void mustbepointstring(parser *const prs)
 		return; // 1
 	}
 	toval(prs);
-	prs->sopnd--;
+	operand_pop(prs);
 	if (!(mode_is_pointer(prs->sx, prs->ansttype) &&
 		  mode_is_string(prs->sx, mode_get(prs->sx, prs->ansttype + 1))))
 	{
@@ -310,7 +399,7 @@ void mustberow(parser *const prs)
 		return; // 1
 	}
 	toval(prs);
-	prs->sopnd--;
+	operand_pop(prs);
 
 	if (!mode_is_array(prs->sx, prs->ansttype))
 	{
@@ -329,7 +418,7 @@ void mustbeint(parser *const prs)
 		return; // 1
 	}
 	toval(prs);
-	prs->sopnd--;
+	operand_pop(prs);
 	if (prs->ansttype != LINT && prs->ansttype != LCHAR)
 	{
 		parser_error(prs, not_int_in_stanfunc);
@@ -357,7 +446,7 @@ void mustberowofint(parser *const prs)
 			return; // 1
 		}
 		toval(prs);
-		prs->sopnd--;
+		operand_pop(prs);
 		if (prs->ansttype == LINT || prs->ansttype == LCHAR)
 		{
 			totree(prs, ROWING);
@@ -392,7 +481,7 @@ void mustberowoffloat(parser *const prs)
 			return; // 1
 		}
 		toval(prs);
-		prs->sopnd--;
+		operand_pop(prs);
 		if (prs->ansttype == LFLOAT)
 		{
 			totree(prs, ROWINGD);
@@ -414,21 +503,21 @@ void primaryexpr(parser *const prs)
 	{
 		totree(prs, TConst);
 		totree(prs, prs->lxr->num);
-		prs->stackoperands[++prs->sopnd] = prs->ansttype = LCHAR;
+		operand_push(prs, prs->ansttype = LCHAR);
 		prs->anst = NUMBER;
 	}
 	else if (prs->curr_token == INT_CONST)
 	{
 		totree(prs, TConst);
 		totree(prs, prs->lxr->num);
-		prs->stackoperands[++prs->sopnd] = prs->ansttype = LINT;
+		operand_push(prs, prs->ansttype = LINT);
 		prs->anst = NUMBER;
 	}
 	else if (prs->curr_token == FLOAT_CONST)
 	{
 		totree(prs, TConstd);
 		double_to_tree(&TREE, prs->lxr->num_double);
-		prs->stackoperands[++prs->sopnd] = prs->ansttype = LFLOAT;
+		operand_push(prs, prs->ansttype = LFLOAT);
 		prs->anst = NUMBER;
 	}
 	else if (prs->curr_token == STRING)
@@ -448,7 +537,7 @@ void primaryexpr(parser *const prs)
 		prs->anstdispl = (int)ident_get_displ(prs->sx, prs->lastid);
 		totree(prs, prs->anstdispl);
 		prs->ansttype = (int)ident_get_mode(prs->sx, prs->lastid);
-		prs->stackoperands[++prs->sopnd] = prs->ansttype;
+		operand_push(prs, prs->ansttype);
 		prs->anst = IDENT;
 	}
 	else if (prs->curr_token == LEFTBR)
@@ -494,6 +583,7 @@ void primaryexpr(parser *const prs)
 	else if (prs->curr_token <= STANDARD_FUNC_START) // стандартная функция
 	{
 		int func = prs->curr_token;
+		const int sopnd = prs->sopnd;
 
 		if (scanner(prs) != LEFTBR)
 		{
@@ -551,7 +641,7 @@ void primaryexpr(parser *const prs)
 			}
 			if (func < STRNCAT)
 			{
-				prs->stackoperands[++prs->sopnd] = prs->ansttype = LINT;
+				operand_push(prs, prs->ansttype = LINT);
 			}
 		}
 		else if (func >= RECEIVE_STRING && func <= SEND_INT)
@@ -577,8 +667,8 @@ void primaryexpr(parser *const prs)
 			}
 			else
 			{
-				prs->stackoperands[++prs->sopnd] = prs->ansttype =
-				func == RECEIVE_INT ? LINT : func == RECEIVE_FLOAT ? LFLOAT : (int)to_modetab(prs, mode_array, LCHAR);
+				operand_push(prs, prs->ansttype =
+				func == RECEIVE_INT ? LINT : func == RECEIVE_FLOAT ? LFLOAT : (int)to_modetab(prs, mode_array, LCHAR));
 			}
 		}
 		else if (func >= ICON && func <= WIFI_CONNECT) // функции Фадеева
@@ -684,7 +774,7 @@ void primaryexpr(parser *const prs)
 							return; // 1
 						}
 						toval(prs);
-						prs->sopnd--;
+						operand_pop(prs);
 						if (mode_is_int(prs->ansttype))
 						{
 							totree(prs, WIDEN);
@@ -781,7 +871,7 @@ void primaryexpr(parser *const prs)
 				}
 				else
 				{
-					prs->stackoperands[++prs->sopnd] = prs->ansttype = LINT;
+					operand_push(prs, prs->ansttype = LINT);
 				}
 			}
 		}
@@ -800,7 +890,7 @@ void primaryexpr(parser *const prs)
 				prs->was_error = 4;
 				return; // 1
 			}
-			prs->stackoperands[++prs->sopnd] = prs->ansttype = LINT;
+			operand_push(prs, prs->ansttype = LINT);
 		}
 		else if (func <= TMSGSEND && func >= TGETNUM) // процедуры управления параллельными нитями
 		{
@@ -811,8 +901,8 @@ void primaryexpr(parser *const prs)
 			else if (func == TMSGRECEIVE || func == TGETNUM) // getnum int()   msgreceive msg_info()
 			{
 				prs->anst = VAL;
-				prs->ansttype = prs->stackoperands[++prs->sopnd] =
-				func == TGETNUM ? LINT : 2; // 2 - это ссылка на msg_info
+				operand_push(prs, prs->ansttype =
+				func == TGETNUM ? LINT : 2); // 2 - это ссылка на msg_info
 											//не было параметра,  выдали 1 результат
 			}
 			else
@@ -846,7 +936,7 @@ void primaryexpr(parser *const prs)
 						return; // 1
 					}
 
-					prs->stackoperands[prs->sopnd] = prs->ansttype = LINT;
+					operand_push(prs, prs->ansttype = LINT);
 					dn = ident_get_displ(prs->sx, prs->lastid);
 					if (dn < 0)
 					{
@@ -879,7 +969,7 @@ void primaryexpr(parser *const prs)
 							prs->was_error = 4;
 							return; // 1
 						}
-						--prs->sopnd;
+						operand_pop(prs);
 					}
 					else
 					{
@@ -892,12 +982,11 @@ void primaryexpr(parser *const prs)
 						if (func == TSEMCREATE)
 						{
 							prs->anst = VAL,
-							prs->ansttype = prs->stackoperands[prs->sopnd] =
-							LINT; // съели 1 параметр, выдали int
+							operand_set(prs, prs->ansttype = LINT); // съели 1 параметр, выдали int
 						}
 						else
 						{
-							--prs->sopnd; // съели 1 параметр, не выдали
+							operand_pop(prs); // съели 1 параметр, не выдали
 						}
 						// результата
 					}
@@ -906,7 +995,7 @@ void primaryexpr(parser *const prs)
 		}
 		else if (func == RAND)
 		{
-			prs->ansttype = prs->stackoperands[++prs->sopnd] = LFLOAT;
+			operand_push(prs, prs->ansttype = LFLOAT);
 		}
 		else if (func == ROUND)
 		{
@@ -918,7 +1007,7 @@ void primaryexpr(parser *const prs)
 				return; // 1
 			}
 			toval(prs);
-			prs->ansttype = prs->stackoperands[prs->sopnd] = LINT;
+			operand_set(prs, prs->ansttype = LINT);
 		}
 		else
 		{
@@ -951,7 +1040,7 @@ void primaryexpr(parser *const prs)
 						prs->was_error = 4;
 						return; // 1
 					}
-					prs->ansttype = prs->stackoperands[++prs->sopnd] = LINT;
+					operand_set(prs, prs->ansttype = LINT);
 				}
 				else
 				{
@@ -971,11 +1060,13 @@ void primaryexpr(parser *const prs)
 					}
 					if (func == SETMOTOR || func == VOLTAGE)
 					{
-						prs->sopnd -= 2;
+						operand_pop(prs);
+						operand_pop(prs);
 					}
 					else
 					{
-						--prs->sopnd, prs->anst = VAL;
+						operand_pop(prs);
+						prs->anst = VAL;
 					}
 				}
 			}
@@ -988,7 +1079,7 @@ void primaryexpr(parser *const prs)
 				if (mode_is_int(prs->ansttype))
 				{
 					totree(prs, WIDEN);
-					prs->ansttype = prs->stackoperands[prs->sopnd] = LFLOAT;
+					operand_set(prs, prs->ansttype = LFLOAT);
 				}
 				if (!mode_is_float(prs->ansttype))
 				{
@@ -1005,6 +1096,12 @@ void primaryexpr(parser *const prs)
 		}
 		totree(prs, 9500 - func);
 		must_be(prs, RIGHTBR, no_rightbr_in_stand_func);
+
+		// Процедура не выдает значения, но, как и любое выражение, оставляет операнд
+		if (prs->sopnd == sopnd)
+		{
+			operand_push(prs, prs->ansttype = LVOID);
+		}
 	}
 	else
 	{
@@ -1046,7 +1143,7 @@ int find_field(parser *const prs, int stype)
 
 		if ((size_t)mode_get(prs->sx, stype + 4 + (int)i) == REPRTAB_POS)
 		{
-			prs->stackoperands[prs->sopnd] = prs->ansttype = field_type;
+			operand_set(prs, prs->ansttype = field_type);
 			flag = 0;
 			break;
 		}
@@ -1196,7 +1293,7 @@ void postexpr(parser *const prs)
 					{
 						parse_insert_widen(prs);
 					}
-					--prs->sopnd;
+					operand_pop(prs);
 				}
 			}
 			if (i < n - 1 && scanner(prs) != COMMA)
@@ -1211,7 +1308,7 @@ void postexpr(parser *const prs)
 		must_be(prs, RIGHTBR, wrong_number_of_params);
 		totree(prs, TCall2);
 		totree(prs, lid);
-		prs->stackoperands[prs->sopnd] = prs->ansttype = (int)mode_get(prs->sx, leftansttyp + 1);
+		operand_set(prs, prs->ansttype = (int)mode_get(prs->sx, leftansttyp + 1));
 		prs->anst = VAL;
 	}
 
@@ -1262,7 +1359,7 @@ void postexpr(parser *const prs)
 
 			must_be(prs, RIGHTSQBR, no_rightsqbr_in_slice);
 
-			prs->stackoperands[prs->sopnd] = prs->ansttype = (int)elem_type;
+			operand_set(prs, prs->ansttype = (int)elem_type);
 			prs->anst = ADDR;
 		}
 
@@ -1443,8 +1540,7 @@ void unarexpr(parser *const prs)
 					vector_set(&TREE, vector_size(&TREE) - 2, TIdenttoaddr); // &a
 				}
 
-				prs->stackoperands[prs->sopnd] = prs->ansttype =
-				(int)to_modetab(prs, mode_pointer, prs->ansttype);
+				operand_set(prs, prs->ansttype = (int)to_modetab(prs, mode_pointer, prs->ansttype));
 				prs->anst = VAL;
 			}
 			else if (op == LMULT)
@@ -1461,7 +1557,7 @@ void unarexpr(parser *const prs)
 					vector_set(&TREE, vector_size(&TREE) - 2, TIdenttoval); // *p
 				}
 
-				prs->stackoperands[prs->sopnd] = prs->ansttype = (int)mode_get(prs->sx, prs->ansttype + 1);
+				operand_set(prs, prs->ansttype = (int)mode_get(prs->sx, prs->ansttype + 1));
 				prs->anst = ADDR;
 			}
 			else
@@ -1512,7 +1608,7 @@ void unarexpr(parser *const prs)
 	}
 
 	postexpr(prs); // 0
-	prs->stackoperands[prs->sopnd] = prs->ansttype;
+	operand_set(prs, prs->ansttype);
 	if (prs->was_error == 4)
 	{
 		prs->was_error = 7;
@@ -1594,9 +1690,7 @@ void subexpr(parser *const prs)
 			vector_increase(&TREE, 1);
 		}
 
-		prs->stack[prs->sp] = p;
-		prs->stacklog[prs->sp] = (int)ad;
-		prs->stackop[prs->sp++] = prs->next_token;
+		operator_push(prs, p, prs->next_token, (int)ad);
 		scanner(prs);
 		scanner(prs);
 		unarexpr(prs);
@@ -1667,7 +1761,7 @@ void condexpr(parser *const prs)
 			{
 				globtype = prs->ansttype;
 			}
-			prs->sopnd--;
+			operand_pop(prs);
 			if (mode_is_float(prs->ansttype))
 			{
 				globtype = LFLOAT;
@@ -1712,11 +1806,11 @@ void condexpr(parser *const prs)
 			adif = (size_t)r;
 		}
 
-		prs->stackoperands[prs->sopnd] = prs->ansttype = globtype;
+		operand_set(prs, prs->ansttype = globtype);
 	}
 	else
 	{
-		prs->stackoperands[prs->sopnd] = prs->ansttype;
+		operand_set(prs, prs->ansttype);
 	}
 }
 
@@ -1730,7 +1824,7 @@ void exprassnvoid(parser *const prs)
 	{
 		vector_set(&TREE, t, vector_get(&TREE, t) + 200);
 	}
-	--prs->sopnd;
+	operand_pop(prs);
 }
 
 void exprassn(parser *const prs, int level)
@@ -1755,7 +1849,7 @@ void exprassn(parser *const prs, int level)
 			prs->was_error = 6;
 			return; // 1
 		}
-		prs->stackoperands[++prs->sopnd] = prs->ansttype = type;
+		operand_push(prs, prs->ansttype = type);
 		prs->anst = VAL;
 	}
 	else
@@ -1791,9 +1885,8 @@ void exprassn(parser *const prs, int level)
 			prs->was_error = 6;
 			return; // 1
 		}
-		rtype = prs->stackoperands[prs->sopnd--]; // снимаем типы
-														  // операндов со стека
-		ltype = prs->stackoperands[prs->sopnd];
+		rtype = operand_pop(prs); // снимаем типы операндов со стека
+		ltype = operand_top(prs);
 
 		if (intopassn(lnext) && (mode_is_float(ltype) || mode_is_float(rtype)))
 		{
@@ -1889,7 +1982,7 @@ void exprassn(parser *const prs, int level)
 			prs->anst = VAL;
 		}
 		prs->ansttype = ltype;
-		prs->stackoperands[prs->sopnd] = ltype; // тип результата - на стек
+		operand_set(prs, ltype); // тип результата - на стек
 	}
 	else
 	{
@@ -1914,7 +2007,6 @@ void expr(parser *const prs, int level)
 	while (prs->next_token == COMMA)
 	{
 		exprassnvoid(prs);
-		prs->sopnd--;
 		scanner(prs);
 		scanner(prs);
 		exprassn(prs, level);
@@ -1952,7 +2044,7 @@ item_t parse_assignment_expression(parser *const prs)
 	exprassn(prs, 1);
 	toval(prs);
 	totree(prs, TExprend);
-	prs->sopnd--;
+	operand_pop(prs);
 	return (item_t)prs->ansttype;
 }
 
@@ -1971,7 +2063,7 @@ item_t parse_constant_expression(parser *const prs)
 	condexpr(prs);
 	toval(prs);
 	totree(prs, TExprend);
-	prs->sopnd--;
+	operand_pop(prs);
 	return (item_t)prs->ansttype;
 }
 
@@ -1981,7 +2073,7 @@ item_t parse_condition(parser *const prs)
 	expr(prs, 1);
 	toval(prs);
 	totree(prs, TExprend);
-	prs->sopnd--;
+	operand_pop(prs);
 	return (item_t)prs->ansttype;
 }
 
@@ -1996,7 +2088,7 @@ void parse_string_literal(parser *const prs)
 	}
 
 	prs->ansttype = (int)to_modetab(prs, mode_array, LCHAR);
-	prs->stackoperands[++prs->sopnd] = prs->ansttype;
+	operand_push(prs, prs->ansttype);
 	prs->anst = VAL;
 }
 
@@ -32,33 +32,30 @@ void parse_labeled_statement(parser *const prs)
 	const size_t repr = prs->lxr->repr;
 	// Не проверяем, что это ':', так как по нему узнали, что это labeled statement
 	token_consume(prs);
-	for (size_t i = 0; i < prs->pgotost; i += 2)
+	const size_t i = label_find(prs, repr);
+	if (i != SIZE_MAX)
 	{
-		if (repr == (size_t)ident_get_repr(prs->sx, (size_t)prs->gotost[i]))
-		{
-			const item_t id = prs->gotost[i];
-			tree_add(prs->sx, id);
+		const item_t id = vector_get(&prs->gotost, i);
+		tree_add(prs->sx, id);
 
-			if (prs->gotost[i + 1] < 0)
-			{
-				parser_error(prs, repeated_label, repr_get_name(prs->sx, repr));
-			}
-			else
-			{
-				prs->gotost[i + 1] = -1;	// TODO: здесь должен быть номер строки
-			}
-
-			ident_set_mode(prs->sx, (size_t)id, 1);
-			parse_statement(prs);
-			return;
+		if (vector_get(&prs->gotost, i + 1) < 0)
+		{
+			parser_error(prs, repeated_label, repr_get_name(prs->sx, repr));
 		}
+		else
+		{
+			vector_set(&prs->gotost, i + 1, -1);	// TODO: здесь должен быть номер строки
+		}
+
+		ident_set_mode(prs->sx, (size_t)id, 1);
+		parse_statement(prs);
+		return;
 	}
 
 	// Это определение метки, если она встретилась до переходов на нее
 	const item_t id = (size_t)to_identab(prs, repr, 1, 0);
 	tree_add(prs->sx, id);
-	prs->gotost[prs->pgotost++] = id;
-	prs->gotost[prs->pgotost++] = -1;	// TODO: здесь должен быть номер строки
+	label_add(prs, id, -1);	// TODO: здесь должен быть номер строки
 
 	ident_set_mode(prs->sx, (size_t)id, 1);
 	parse_statement(prs);
@@ -285,21 +282,20 @@ void parse_goto_statement(parser *const prs)
 	token_expect_and_consume(prs, identifier, no_ident_after_goto);
 	const size_t repr = prs->lxr->repr;
 
-	for (size_t i = 0; i < prs->pgotost; i += 2)
+	const size_t i = label_find(prs, repr);
+	if (i != SIZE_MAX)
 	{
-		if (repr == (size_t)ident_get_repr(prs->sx, (size_t)prs->gotost[i]))
+		const item_t id = vector_get(&prs->gotost, i);
+		tree_add(prs->sx, id);
+		if (vector_get(&prs->gotost, i + 1) >= 0) // Метка еще не была определена
 		{
-			const item_t id = prs->gotost[i];
-			tree_add(prs->sx, id);
-			if (prs->gotost[id + 1] >= 0) // Перехода на метку еще не было
-			{
-				prs->gotost[prs->pgotost++] = id;
-				prs->gotost[prs->pgotost++] = 1; // TODO: здесь должен быть номер строки
-			}
-
-			token_expect_and_consume(prs, semicolon, expected_semi_after_stmt);
-			return;
+			// Переход запоминается, чтобы сообщить о нем, если метка так и не появится
+			vector_add(&prs->gotost, id);
+			vector_add(&prs->gotost, 1); // TODO: здесь должен быть номер строки
 		}
+
+		token_expect_and_consume(prs, semicolon, expected_semi_after_stmt);
+		return;
 	}
 
 	// Первый раз встретился переход на метку, которой не было,
@@ -307,8 +303,7 @@ void parse_goto_statement(parser *const prs)
 	// будет отрицательной
 	const item_t id = (item_t)to_identab(prs, repr, 1, 0);
 	tree_add(prs->sx, -id);
-	prs->gotost[prs->pgotost++] = id;
-	prs->gotost[prs->pgotost++] = 1;	// TODO: здесь должен быть номер строки
+	label_add(prs, id, 1);	// TODO: здесь должен быть номер строки
 	token_expect_and_consume(prs, semicolon, expected_semi_after_stmt);
 }
 
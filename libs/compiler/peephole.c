@@ -0,0 +1,758 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "peephole.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "defs.h"
+#include "operations.h"
+
+
+#define CODE_BEGIN		4
+#define MAX_OPERANDS	7
+#define MAX_PASSES		16
+
+#define NONE			SIZE_MAX
+
+
+/** Decoded instruction */
+typedef struct instruction
+{
+	size_t address;					/**< Address in source code */
+	size_t size;					/**< Size in source code */
+
+	item_t code;					/**< Instruction code */
+	item_t operands[MAX_OPERANDS];	/**< Instruction operands */
+
+	int is_string;					/**< Set if instruction is string literal with its data */
+	int is_label;					/**< Set if instruction may be reached not from previous one */
+	int is_removed;					/**< Set if instruction was removed */
+} instruction;
+
+/** Program for optimization */
+typedef struct program
+{
+	vector *memory;					/**< Memory table */
+
+	instruction *code;				/**< Decoded instructions */
+	size_t size;					/**< Number of instructions */
+
+	size_t *index;					/**< Instruction number by source address */
+	size_t *address;				/**< New addresses of instructions */
+} program;
+
+
+/** Количество операндов команды */
+static size_t operands_number(const item_t code)
+{
+	switch (code)
+	{
+		case DEFARR:
+			return 7;
+		case ARRINIT:
+			return 4;
+		case COPY00:
+		case COPYST:
+			return 3;
+		case LID:
+		case FUNCBEG:
+		case STRUCTWITHARR:
+		case COPY01:
+		case COPY10:
+		case COPY0ST:
+		case COPY0STASS:
+		case LOADSLICE:
+		case LOADLOAD:
+		case LOADLI:
+		case LIASSV:
+			return 2;
+		case LI:
+		case LOAD:
+		case LOADD:
+		case LA:
+		case SELECT:
+		case SLICE:
+		case CALL2:
+		case RETURNVAL:
+		case B:
+		case BE0:
+		case BNE0:
+		case BEGINIT:
+		case COPY11:
+		case COPY1ST:
+		case COPY1STASS:
+		case PRINT:
+		case PRINTID:
+		case PRINTF:
+		case GETID:
+		case SLICELAT:
+		case LIASSATV:
+		case EQEQBE0:
+		case NOTEQBE0:
+		case LLTBE0:
+		case LGTBE0:
+		case LLEBE0:
+		case LGEBE0:
+			return 1;
+		default:
+			return (code >= REMASS && code <= DIVASS) || (code >= REMASSV && code <= DIVASSV)
+				|| (code >= ASSR && code <= DIVASSR) || (code >= ASSRV && code <= DIVASSRV)
+				|| (code >= POSTINC && code <= DEC) || (code >= POSTINCV && code <= DECV)
+				|| (code >= POSTINCR && code <= DECR) || (code >= POSTINCRV && code <= DECRV);
+	}
+}
+
+static inline int is_branch(const item_t code)
+{
+	return code == B || code == BE0 || code == BNE0 || (code >= EQEQBE0 && code <= LGEBE0);
+}
+
+/** Строковый литерал: LI addr; B end; N; символы */
+static int is_string(const vector *const memory, const size_t address)
+{
+	const size_t size = vector_size(memory);
+	if (address + 4 >= size || vector_get(memory, address) != LI || vector_get(memory, address + 2) != B
+		|| vector_get(memory, address + 1) != (item_t)(address + 5))
+	{
+		return 0;
+	}
+
+	const item_t end = vector_get(memory, address + 3);
+	const item_t length = vector_get(memory, address + 4);
+	return end <= (item_t)size
+		&& (end == (item_t)(address + 5) + length || end == (item_t)(address + 5) + 2 * length);
+}
+
+
+static int program_decode(program *const prg)
+{
+	const vector *const memory = prg->memory;
+	const size_t size = vector_size(memory);
+
+	prg->code = malloc(size * sizeof(instruction));
+	prg->index = malloc((size + 1) * sizeof(size_t));
+	prg->address = malloc((size + 1) * sizeof(size_t));
+	if (prg->code == NULL || prg->index == NULL || prg->address == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i <= size; i++)
+	{
+		prg->index[i] = NONE;
+	}
+
+	prg->size = 0;
+	for (size_t address = CODE_BEGIN; address < size; )
+	{
+		instruction *const instr = &prg->code[prg->size];
+		instr->address = address;
+		instr->code = vector_get(memory, address);
+		instr->is_string = is_string(memory, address);
+		instr->is_label = 0;
+		instr->is_removed = 0;
+
+		const size_t operands = instr->is_string ? 0 : operands_number(instr->code);
+		instr->size = instr->is_string ? (size_t)vector_get(memory, address + 3) - address : 1 + operands;
+		if (address + instr->size > size)
+		{
+			return -1;
+		}
+
+		for (size_t i = 0; i < operands; i++)
+		{
+			instr->operands[i] = vector_get(memory, address + 1 + i);
+		}
+
+		prg->index[address] = prg->size++;
+		address += instr->size;
+	}
+
+	// Конец кода тоже может быть целью ссылок
+	prg->index[size] = prg->size;
+	return 0;
+}
+
+static int program_mark(program *const prg, const size_t address)
+{
+	if (address > vector_size(prg->memory) || prg->index[address] == NONE)
+	{
+		return -1;
+	}
+
+	if (prg->index[address] < prg->size)
+	{
+		prg->code[prg->index[address]].is_label = 1;
+	}
+
+	return 0;
+}
+
+/** Отметка всех команд, на которые возможен переход не из предыдущей команды */
+static int program_mark_labels(program *const prg, const vector *const functions
+	, const vector *const entries, const vector *const processes)
+{
+	for (size_t i = 0; i < prg->size; i++)
+	{
+		const instruction *const instr = &prg->code[i];
+		if (instr->is_string)
+		{
+			continue;
+		}
+
+		int ret = 0;
+		if (is_branch(instr->code))
+		{
+			ret = program_mark(prg, (size_t)instr->operands[0]);
+		}
+		else if (instr->code == FUNCBEG)
+		{
+			// Тело функции начинается сразу после FUNCBEG
+			ret = program_mark(prg, (size_t)instr->operands[1])
+				|| program_mark(prg, instr->address + instr->size);
+		}
+		else if (instr->code == EXITC)
+		{
+			// Родительская нить продолжается после конца t_create_direct
+			ret = program_mark(prg, instr->address + instr->size);
+		}
+		else if ((instr->code == DEFARR && instr->operands[3] != 0) || instr->code == STRUCTWITHARR)
+		{
+			ret = program_mark(prg, (size_t)instr->operands[instr->code == DEFARR ? 3 : 1]);
+		}
+
+		if (ret)
+		{
+			return -1;
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(entries); i++)
+	{
+		if (program_mark(prg, (size_t)vector_get(functions, (size_t)vector_get(entries, i))))
+		{
+			return -1;
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(processes); i++)
+	{
+		const item_t process = vector_get(processes, i);
+		if (process != 0 && program_mark(prg, (size_t)process))
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+static inline size_t program_next(const program *const prg, size_t number)
+{
+	while (++number < prg->size && prg->code[number].is_removed)
+	{
+		continue;
+	}
+
+	return number < prg->size ? number : NONE;
+}
+
+/** Первая оставшаяся команда, начиная с указанного адреса */
+static inline size_t program_target(const program *const prg, const item_t address)
+{
+	size_t number = prg->index[address];
+	while (number < prg->size && prg->code[number].is_removed)
+	{
+		number++;
+	}
+
+	return number;
+}
+
+static inline int program_is_plain(const program *const prg, const size_t number)
+{
+	return number != NONE && !prg->code[number].is_label && !prg->code[number].is_string;
+}
+
+static inline void program_remove(program *const prg, const size_t number)
+{
+	prg->code[number].is_removed = 1;
+}
+
+
+/** Присваивание без значения, после которого значение заново загружается */
+static item_t store_with_value(const item_t store, const item_t load)
+{
+	if (load == LOAD)
+	{
+		if (store >= REMASSV && store <= DIVASSV)
+		{
+			return store - REMASSV + REMASS;
+		}
+
+		if (store == POSTINCV || store == INCV)
+		{
+			return INC;
+		}
+
+		if (store == POSTDECV || store == DECV)
+		{
+			return DEC;
+		}
+	}
+	else if (load == LOADD)
+	{
+		if (store >= ASSRV && store <= DIVASSRV)
+		{
+			return store - ASSRV + ASSR;
+		}
+
+		if (store == POSTINCRV || store == INCRV)
+		{
+			return INCR;
+		}
+
+		if (store == POSTDECRV || store == DECRV)
+		{
+			return DECR;
+		}
+	}
+
+	return 0;
+}
+
+
+static int optimize_constant(program *const prg, const size_t number)
+{
+	instruction *const fst = &prg->code[number];
+	const size_t snd_number = program_next(prg, number);
+	if (fst->code != LI || fst->is_string || !program_is_plain(prg, snd_number))
+	{
+		return 0;
+	}
+
+	instruction *const snd = &prg->code[snd_number];
+	const int32_t value = (int32_t)fst->operands[0];
+	int32_t result;
+
+	// LI c; BE0/BNE0 - условие известно заранее
+	if (snd->code == BE0 || snd->code == BNE0)
+	{
+		if ((snd->code == BE0) == (value == 0))
+		{
+			fst->code = B;
+			fst->operands[0] = snd->operands[0];
+		}
+		else
+		{
+			program_remove(prg, number);
+		}
+
+		program_remove(prg, snd_number);
+		return 1;
+	}
+
+	// LI c; op - операция с единицей или нулём
+	if (is_right_identity(snd->code, fst->operands[0]))
+	{
+		program_remove(prg, number);
+		program_remove(prg, snd_number);
+		return 1;
+	}
+
+	if (fold_int_unary(snd->code, value, &result) == 0 && is_item(result))
+	{
+		fst->operands[0] = result;
+		program_remove(prg, snd_number);
+		return 1;
+	}
+
+	// LI c; WIDEN - сразу вещественная константа
+	if (snd->code == WIDEN)
+	{
+		const double number_double = value;
+		uint64_t bits;
+		memcpy(&bits, &number_double, sizeof(double));
+
+		const int32_t low = (int32_t)(uint32_t)bits;
+		const int32_t high = (int32_t)(uint32_t)(bits >> 32);
+		if (!is_item(low) || !is_item(high))
+		{
+			return 0;
+		}
+
+		fst->code = LID;
+		fst->operands[0] = low;
+		fst->operands[1] = high;
+		program_remove(prg, snd_number);
+		return 1;
+	}
+
+	// LI a; LI b; op - свёртка констант
+	const size_t op_number = program_next(prg, snd_number);
+	if (snd->code != LI || !program_is_plain(prg, op_number)
+		|| fold_int_binary(prg->code[op_number].code, value, (int32_t)snd->operands[0], &result) || !is_item(result))
+	{
+		return 0;
+	}
+
+	fst->operands[0] = result;
+	program_remove(prg, snd_number);
+	program_remove(prg, op_number);
+	return 1;
+}
+
+static int optimize_store(program *const prg, const size_t number)
+{
+	instruction *const store = &prg->code[number];
+	const size_t load_number = program_next(prg, number);
+	if (store->is_string || !program_is_plain(prg, load_number))
+	{
+		return 0;
+	}
+
+	// ASSV d; LOAD d - значение остаётся на стеке после присваивания
+	const instruction *const load = &prg->code[load_number];
+	const item_t code = store_with_value(store->code, load->code);
+	if (code == 0 || store->operands[0] != load->operands[0])
+	{
+		return 0;
+	}
+
+	store->code = code;
+	program_remove(prg, load_number);
+	return 1;
+}
+
+static int optimize_branch(program *const prg, const size_t number)
+{
+	instruction *const instr = &prg->code[number];
+	if (instr->is_string || !is_branch(instr->code))
+	{
+		return 0;
+	}
+
+	// Переход на переход заменяется переходом на конечную цель
+	size_t target = program_target(prg, instr->operands[0]);
+	for (size_t i = 0; i < prg->size && target < prg->size; i++)
+	{
+		const instruction *const next = &prg->code[target];
+		if (next->is_string || next->code != B || next == instr)
+		{
+			break;
+		}
+
+		target = program_target(prg, next->operands[0]);
+	}
+
+	int changed = 0;
+	const item_t address = target < prg->size ? (item_t)prg->code[target].address : (item_t)vector_size(prg->memory);
+	if (instr->operands[0] != address)
+	{
+		instr->operands[0] = address;
+		if (target < prg->size)
+		{
+			prg->code[target].is_label = 1;
+		}
+		changed = 1;
+	}
+
+	// Переход на следующую команду
+	const size_t next = program_next(prg, number);
+	if (instr->code == B && target == (next == NONE ? prg->size : next))
+	{
+		program_remove(prg, number);
+		return 1;
+	}
+
+	return changed;
+}
+
+static int optimize_unreachable(program *const prg, const size_t number)
+{
+	const instruction *const instr = &prg->code[number];
+	if (instr->is_string
+		|| (instr->code != B && instr->code != RETURNVAL && instr->code != RETURNVOID && instr->code != STOP))
+	{
+		return 0;
+	}
+
+	// Команды до ближайшей метки недостижимы, границы t_create_direct сохраняются
+	int changed = 0;
+	for (size_t next = program_next(prg, number); next != NONE; next = program_next(prg, next))
+	{
+		const instruction *const dead = &prg->code[next];
+		if (dead->is_label || (!dead->is_string
+			&& (dead->code == CREATEDIRECTC || dead->code == EXITC || dead->code == FUNCBEG)))
+		{
+			break;
+		}
+
+		program_remove(prg, next);
+		changed = 1;
+	}
+
+	return changed;
+}
+
+static int program_optimize(program *const prg)
+{
+	int changed = 0;
+	for (size_t i = 0; i < prg->size; i++)
+	{
+		if (!prg->code[i].is_removed)
+		{
+			changed |= optimize_unreachable(prg, i);
+			changed |= optimize_constant(prg, i);
+		}
+
+		if (!prg->code[i].is_removed)
+		{
+			changed |= optimize_store(prg, i);
+		}
+
+		if (!prg->code[i].is_removed)
+		{
+			changed |= optimize_branch(prg, i);
+		}
+	}
+
+	return changed;
+}
+
+
+/** Суперинструкция для пары команд, @c 0 если пара не сливается */
+static item_t fused_code(const item_t fst, const item_t snd)
+{
+	if (snd == BE0 && fst >= EQEQ && fst <= LGE)
+	{
+		return fst - EQEQ + EQEQBE0;
+	}
+
+	switch (fst)
+	{
+		case LOAD:
+			return snd == SLICE ? LOADSLICE : snd == LOAD ? LOADLOAD : snd == LI ? LOADLI : 0;
+		case SLICE:
+			return snd == LAT ? SLICELAT : 0;
+		case LI:
+			return snd == ASSV ? LIASSV : snd == ASSATV ? LIASSATV : 0;
+		default:
+			return 0;
+	}
+}
+
+/** Приоритет слияния: LOAD; LOAD; SLICE выгоднее сливать как LOAD; LOADSLICE */
+static inline int fused_priority(const item_t code)
+{
+	return code == LOADLOAD ? 0 : code == LOADLI ? 1 : 2;
+}
+
+static void program_fuse(program *const prg)
+{
+	for (size_t i = 0; i < prg->size; i++)
+	{
+		instruction *const fst = &prg->code[i];
+		const size_t snd_number = program_next(prg, i);
+		if (fst->is_removed || fst->is_string || !program_is_plain(prg, snd_number))
+		{
+			continue;
+		}
+
+		const instruction *const snd = &prg->code[snd_number];
+		const item_t code = fused_code(fst->code, snd->code);
+		if (code == 0)
+		{
+			continue;
+		}
+
+		const size_t next_number = program_next(prg, snd_number);
+		if (program_is_plain(prg, next_number))
+		{
+			const item_t next = fused_code(snd->code, prg->code[next_number].code);
+			if (next != 0 && fused_priority(next) > fused_priority(code))
+			{
+				continue;
+			}
+		}
+
+		// Операнды второй команды дописываются к операндам первой
+		const size_t operands = operands_number(fst->code);
+		for (size_t j = 0; j < operands_number(snd->code); j++)
+		{
+			fst->operands[operands + j] = snd->operands[j];
+		}
+
+		fst->code = code;
+		program_remove(prg, snd_number);
+	}
+}
+
+
+static inline item_t program_relocate(const program *const prg, const item_t address)
+{
+	return (item_t)prg->address[program_target(prg, address)];
+}
+
+static void program_encode(program *const prg, vector *const functions
+	, const vector *const entries, vector *const processes)
+{
+	size_t address = CODE_BEGIN;
+	for (size_t i = 0; i < prg->size; i++)
+	{
+		const instruction *const instr = &prg->code[i];
+		prg->address[i] = address;
+		if (!instr->is_removed)
+		{
+			address += instr->is_string ? instr->size : 1 + operands_number(instr->code);
+		}
+	}
+	prg->address[prg->size] = address;
+
+	vector code = vector_create(address);
+	vector_increase(&code, CODE_BEGIN);
+
+	for (size_t i = 0; i < prg->size; i++)
+	{
+		const instruction *const instr = &prg->code[i];
+		if (instr->is_removed)
+		{
+			continue;
+		}
+
+		if (instr->is_string)
+		{
+			const size_t begin = vector_size(&code);
+			for (size_t j = 0; j < instr->size; j++)
+			{
+				vector_add(&code, vector_get(prg->memory, instr->address + j));
+			}
+
+			vector_set(&code, begin + 1, (item_t)(begin + 5));
+			vector_set(&code, begin + 3, (item_t)(begin + instr->size));
+			continue;
+		}
+
+		vector_add(&code, instr->code);
+		const size_t operands = operands_number(instr->code);
+		for (size_t j = 0; j < operands; j++)
+		{
+			const int is_address = (is_branch(instr->code) && j == 0)
+				|| (instr->code == FUNCBEG && j == 1)
+				|| (instr->code == STRUCTWITHARR && j == 1)
+				|| (instr->code == DEFARR && j == 3 && instr->operands[3] != 0);
+
+			vector_add(&code, is_address ? program_relocate(prg, instr->operands[j]) : instr->operands[j]);
+		}
+	}
+
+	for (size_t i = 0; i < vector_size(entries); i++)
+	{
+		const size_t function = (size_t)vector_get(entries, i);
+		vector_set(functions, function, program_relocate(prg, vector_get(functions, function)));
+	}
+
+	for (size_t i = 0; i < vector_size(processes); i++)
+	{
+		const item_t process = vector_get(processes, i);
+		if (process != 0)
+		{
+			vector_set(processes, i, program_relocate(prg, process));
+		}
+	}
+
+	vector_clear(prg->memory);
+	*prg->memory = code;
+}
+
+static void program_clear(program *const prg)
+{
+	free(prg->code);
+	free(prg->index);
+	free(prg->address);
+}
+
+static int program_init(program *const prg, vector *const memory, const vector *const functions
+	, const vector *const entries, const vector *const processes)
+{
+	if (!vector_is_correct(memory) || !vector_is_correct(functions)
+		|| !vector_is_correct(entries) || !vector_is_correct(processes) || vector_size(memory) <= CODE_BEGIN)
+	{
+		return -1;
+	}
+
+	prg->memory = memory;
+	prg->code = NULL;
+	prg->size = 0;
+	prg->index = NULL;
+	prg->address = NULL;
+
+	if (program_decode(prg) || program_mark_labels(prg, functions, entries, processes))
+	{
+		// Нераспознанный код остаётся без изменений
+		program_clear(prg);
+		return -1;
+	}
+
+	return 0;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int peephole_optimize(vector *const memory, vector *const functions
+	, const vector *const entries, vector *const processes)
+{
+	program prg;
+	if (program_init(&prg, memory, functions, entries, processes))
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < MAX_PASSES && program_optimize(&prg); i++)
+	{
+		continue;
+	}
+
+	program_encode(&prg, functions, entries, processes);
+	program_clear(&prg);
+	return 0;
+}
+
+int peephole_fuse(vector *const memory, vector *const functions
+	, const vector *const entries, vector *const processes)
+{
+	program prg;
+	if (program_init(&prg, memory, functions, entries, processes))
+	{
+		return -1;
+	}
+
+	program_fuse(&prg);
+
+	program_encode(&prg, functions, entries, processes);
+	program_clear(&prg);
+	return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "vector.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Rewrite naive instruction sequences in emitted code,
+ *	branch targets and references from tables are relocated after that
+ *
+ *	@param	memory			Memory table
+ *	@param	functions		Functions table
+ *	@param	entries			Numbers of defined functions in functions table
+ *	@param	processes		Init processes table
+ *
+ *	@return	@c 0 on success, @c -1 if code was not recognized and left unchanged
+ */
+int peephole_optimize(vector *const memory, vector *const functions
+	, const vector *const entries, vector *const processes);
+
+/**
+ *	Fuse frequent instruction pairs into superinstructions,
+ *	pairs are not fused across branch targets
+ *
+ *	@param	memory			Memory table
+ *	@param	functions		Functions table
+ *	@param	entries			Numbers of defined functions in functions table
+ *	@param	processes		Init processes table
+ *
+ *	@return	@c 0 on success, @c -1 if code was not recognized and left unchanged
+ */
+int peephole_fuse(vector *const memory, vector *const functions
+	, const vector *const entries, vector *const processes);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
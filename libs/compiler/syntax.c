@@ -15,8 +15,10 @@
  */
 
 #include "syntax.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include "errors.h"
+#include "hash.h"
 #include "tokens.h"
 #include "tree.h"
 
@@ -151,6 +153,82 @@ void repr_init(map *const reprtab)
 }
 
 
+syntax sx_create_empty()
+{
+	syntax sx;
+	sx.procd = 1;
+
+	sx.predef = vector_create(FUNCSIZE);
+	sx.functions = vector_create(FUNCSIZE);
+	vector_increase(&sx.functions, 2);
+
+	sx.tree = vector_create(MAXTREESIZE);
+	sx.arena = arena_create(NULL);
+
+	sx.identifiers = vector_create(MAXIDENTAB);
+	vector_increase(&sx.identifiers, 2);
+	sx.declarations = vector_create(MAXIDENTAB / 4);
+	sx.cur_id = 2;
+
+	sx.max_displg = 3;
+	sx.ref_main = 0;
+
+	sx.max_displ = 3;
+	sx.displ = -3;
+	sx.lg = -1;
+
+	return sx;
+}
+
+/**	Number of mode record fields which are compared for equality */
+size_t mode_length(const syntax *const sx, const size_t index)
+{
+	const item_t mode = vector_get(&sx->modes, index);
+	return mode == mode_struct || mode == mode_function ? 2 + (size_t)vector_get(&sx->modes, index + 2) : 1;
+}
+
+/**	Hash of mode record fields compared by @c mode_is_equal */
+size_t mode_hash(const syntax *const sx, const size_t index)
+{
+	const size_t length = mode_length(sx, index);
+	return (size_t)hash_mix(hash_bytes(HASH_INIT, &sx->modes.array[index], (length + 1) * sizeof(item_t)));
+}
+
+/**	Put mode record to hash table, table has free slots */
+void mode_index_put(syntax *const sx, const size_t index)
+{
+	const size_t mask = vector_size(&sx->mode_index) - 1;
+
+	size_t slot = mode_hash(sx, index) & mask;
+	while (vector_get(&sx->mode_index, slot) != 0)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	vector_set(&sx->mode_index, slot, (item_t)index);
+}
+
+/**
+ *	Build hash table of mode records,
+ *	table is twice as large as modes table, so it is at most a quarter full
+ */
+void mode_index_build(syntax *const sx)
+{
+	size_t size = 64;
+	while (size < 2 * vector_size(&sx->modes))
+	{
+		size *= 2;
+	}
+
+	vector_resize(&sx->mode_index, 0);
+	vector_resize(&sx->mode_index, size);
+
+	for (size_t old = sx->start_mode; old != 0; old = (size_t)vector_get(&sx->modes, old))
+	{
+		mode_index_put(sx, old + 1);
+	}
+}
+
 void mode_init(syntax *const sx)
 {
 	vector_increase(&sx->modes, 1);
@@ -179,6 +257,7 @@ void mode_init(syntax *const sx)
 	vector_add(&sx->modes, mode_void_pointer);
 
 	sx->start_mode = 14;
+	mode_index_build(sx);
 }
 
 item_t get_static(syntax *const sx, const item_t type)
@@ -206,14 +285,8 @@ int mode_is_equal(const syntax *const sx, const size_t first, const size_t secon
 		return 0;
 	}
 
-	size_t length = 1;
-	const item_t mode = vector_get(&sx->modes, first);
-
 	// Определяем, сколько полей надо сравнивать для различных типов записей
-	if (mode == mode_struct || mode == mode_function)
-	{
-		length = 2 + (size_t)vector_get(&sx->modes, first + 2);
-	}
+	const size_t length = mode_length(sx, first);
 
 	for (size_t i = 1; i <= length; i++)
 	{
@@ -227,6 +300,21 @@ int mode_is_equal(const syntax *const sx, const size_t first, const size_t secon
 }
 
 
+/**
+ *	Restore references of representations shadowed in current scope,
+ *	identifiers of closed nested scopes are already taken off the stack
+ */
+void scope_restore(syntax *const sx)
+{
+	while (vector_size(&sx->declarations) != 0
+		&& (size_t)vector_get(&sx->declarations, vector_size(&sx->declarations) - 1) >= sx->cur_id)
+	{
+		const size_t id = (size_t)vector_remove(&sx->declarations);
+		repr_set_reference(sx, (size_t)ident_get_repr(sx, id), vector_get(&sx->identifiers, id));
+	}
+}
+
+
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
  *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
@@ -238,31 +326,31 @@ int mode_is_equal(const syntax *const sx, const size_t first, const size_t secon
 
 syntax sx_create()
 {
-	syntax sx;
-	sx.procd = 1;
-
-	sx.predef = vector_create(FUNCSIZE);
-	sx.functions = vector_create(FUNCSIZE);
-	vector_increase(&sx.functions, 2);
-
-	sx.tree = vector_create(MAXTREESIZE);
-
-	sx.identifiers = vector_create(MAXIDENTAB);
-	vector_increase(&sx.identifiers, 2);
-	sx.cur_id = 2;
+	syntax sx = sx_create_empty();
 
 	sx.representations = map_create(MAXREPRTAB);
 	repr_init(&sx.representations);
 
 	sx.modes = vector_create(MAXMODETAB);
+	sx.mode_index = vector_create(2 * MAXMODETAB);
 	mode_init(&sx);
 
-	sx.max_displg = 3;
-	sx.ref_main = 0;
+	return sx;
+}
 
-	sx.max_displ = 3;
-	sx.displ = -3;
-	sx.lg = -1;
+syntax sx_create_from(const syntax *const prototype)
+{
+	if (prototype == NULL)
+	{
+		return sx_create();
+	}
+
+	syntax sx = sx_create_empty();
+
+	sx.representations = map_copy(&prototype->representations);
+	sx.modes = vector_copy(&prototype->modes);
+	sx.start_mode = prototype->start_mode;
+	sx.mode_index = vector_copy(&prototype->mode_index);
 
 	return sx;
 }
@@ -299,9 +387,12 @@ int sx_clear(syntax *const sx)
 	vector_clear(&sx->functions);
 
 	vector_clear(&sx->tree);
+	arena_clear(&sx->arena);
 
 	vector_clear(&sx->identifiers);
+	vector_clear(&sx->declarations);
 	vector_clear(&sx->modes);
+	vector_clear(&sx->mode_index);
 	map_clear(&sx->representations);
 
 	return 0;
@@ -373,6 +464,7 @@ size_t ident_add(syntax *const sx, const size_t repr, const item_t type, const i
 	const item_t ref = repr_get_reference(sx, repr);
 	vector_add(&sx->identifiers, ref == ITEM_MAX ? 1 : ref);
 	vector_increase(&sx->identifiers, 3);
+	vector_add(&sx->declarations, (item_t)last_id);
 
 	if (ref == 0) // это может быть только MAIN
 	{
@@ -510,23 +602,30 @@ size_t mode_add(syntax *const sx, const item_t *const record, const size_t size)
 		vector_add(&sx->modes, record[i]);
 	}
 
-	// Checking mode duplicates
-	size_t old = (size_t)vector_get(&sx->modes, sx->start_mode);
-	while (old)
+	// Checking mode duplicates, equal records have equal hashes
+	const size_t index = sx->start_mode + 1;
+	const size_t mask = vector_size(&sx->mode_index) - 1;
+	for (size_t slot = mode_hash(sx, index) & mask; vector_get(&sx->mode_index, slot) != 0; slot = (slot + 1) & mask)
 	{
-		if (mode_is_equal(sx, sx->start_mode + 1, old + 1))
+		const size_t old = (size_t)vector_get(&sx->mode_index, slot);
+		if (mode_is_equal(sx, index, old))
 		{
 			vector_resize(&sx->modes, sx->start_mode + 1);
 			sx->start_mode = (size_t)vector_get(&sx->modes, sx->start_mode);
-			return old + 1;
-		}
-		else
-		{
-			old = (size_t)vector_get(&sx->modes, old);
+			return old;
 		}
 	}
 
-	return sx->start_mode + 1;
+	if (2 * vector_size(&sx->modes) > vector_size(&sx->mode_index))
+	{
+		mode_index_build(sx);
+	}
+	else
+	{
+		mode_index_put(sx, index);
+	}
+
+	return index;
 }
 
 item_t mode_get(const syntax *const sx, const size_t index)
@@ -576,10 +675,7 @@ int scope_block_exit(syntax *const sx, const item_t displ, const item_t lg)
 		return -1;
 	}
 
-	for (size_t i = vector_size(&sx->identifiers) - 4; i >= sx->cur_id; i -= 4)
-	{
-		repr_set_reference(sx, (size_t)ident_get_repr(sx, i), vector_get(&sx->identifiers, i));
-	}
+	scope_restore(sx);
 
 	sx->displ = displ;
 	sx->lg = lg;
@@ -609,10 +705,7 @@ int scope_func_exit(syntax *const sx, const size_t decl_ref, const item_t displ)
 		return -1;
 	}
 
-	for (size_t i = vector_size(&sx->identifiers) - 4; i >= sx->cur_id; i -= 4)
-	{
-		repr_set_reference(sx, (size_t)ident_get_repr(sx, i), vector_get(&sx->identifiers, i));
-	}
+	scope_restore(sx);
 
 	sx->cur_id = 2;	// Все функции описываются на одном уровне
 	vector_set(&sx->tree, decl_ref, sx->max_displ);
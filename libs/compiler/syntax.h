@@ -21,6 +21,7 @@
 #include <stddef.h>
 #include <stdint.h>
 #include "map.h"
+#include "tree.h"
 #include "uniio.h"
 #include "vector.h"
 
@@ -29,8 +30,6 @@
 extern "C" {
 #endif
 
-typedef struct node node;
-
 /** Global vars definition */
 typedef struct syntax
 {
@@ -38,12 +37,15 @@ typedef struct syntax
 	vector functions;			/**< Functions table */
 
 	vector tree;				/**< Tree table */
+	tree_arena arena;			/**< Tree arena */
 
 	vector identifiers;			/**< Identifiers table */
+	vector declarations;		/**< Stack of identifiers which references are not restored yet */
 	size_t cur_id;				/**< Start of current scope in identifiers table */
 
 	vector modes;				/**< Modes table */
 	size_t start_mode;			/**< Start of last record in modetab */
+	vector mode_index;			/**< Hash table of records in modetab, @c 0 for empty slot */
 
 	map representations;		/**< Representations table */
 
@@ -65,6 +67,15 @@ typedef struct syntax
  */
 syntax sx_create();
 
+/**
+ *	Create Syntax structure with keyword and mode tables copied from prototype
+ *
+ *	@param	prototype	Freshly created syntax structure
+ *
+ *	@return	Syntax structure
+ */
+syntax sx_create_from(const syntax *const prototype);
+
 /**
  *	Check if syntax structure is correct
  *
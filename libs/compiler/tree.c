@@ -140,6 +140,7 @@ node node_broken()
 {
 	node nd;
 	nd.tree = NULL;
+	nd.arena = NULL;
 	return nd;
 }
 
@@ -161,7 +162,8 @@ size_t skip_expression(vector *const tree, size_t i)
 	return i;
 }
 
-node node_expression(vector *const tree, const size_t index)
+/** Read node arguments and amount of fixed children without scanning subtree */
+node node_expression_header(vector *const tree, const size_t index)
 {
 	if (index == SIZE_MAX)
 	{
@@ -171,6 +173,7 @@ node node_expression(vector *const tree, const size_t index)
 	node nd;
 
 	nd.tree = tree;
+	nd.arena = NULL;
 	nd.type = index;
 	nd.argv = nd.type + 1;
 
@@ -187,6 +190,7 @@ node node_expression(vector *const tree, const size_t index)
 	{
 		case TBeginit:		// ArrayInit: n + 1 потомков (размерность инициализатора, n выражений-инициализаторов)
 		case TStructinit:	// StructInit: n + 1 потомков (размерность инициализатора, n выражений-инициализаторов)
+		case TCall1:		// Call: n + 1 потомков (число аргументов, n выражений-аргументов)
 			nd.argc = 1;
 			nd.amount = (size_t)node_get_arg(&nd, 0);
 			break;
@@ -208,8 +212,6 @@ node node_expression(vector *const tree, const size_t index)
 		case TIdenttoaddr:
 		case TIdenttovald:
 		case TIdenttoval:
-
-		case TCall1:
 			nd.argc = 1;
 			break;
 		case TCall2:
@@ -272,6 +274,17 @@ node node_expression(vector *const tree, const size_t index)
 	}
 
 	nd.children = nd.argv + nd.argc;
+	return nd;
+}
+
+node node_expression(vector *const tree, const size_t index)
+{
+	node nd = node_expression_header(tree, index);
+	if (!node_is_correct(&nd) || vector_get(tree, index) == TExprend)
+	{
+		return nd;
+	}
+
 	size_t j = nd.children;
 	for (size_t k = 0; k < nd.amount; k++)
 	{
@@ -319,7 +332,24 @@ size_t skip_operator(vector *const tree, size_t i)
 	return i;
 }
 
-node node_operator(vector *const tree, const size_t index)
+/** Get terminator of operator with variable amount of children */
+item_t node_terminator(const item_t type)
+{
+	switch (type)
+	{
+		case TStructbeg:
+			return TStructend;
+		case TBegin:
+			return TEnd;
+		case CREATEDIRECTC:
+			return EXITDIRECTC;
+		default:
+			return ITEM_MAX;
+	}
+}
+
+/** Read operator arguments and amount of fixed children without scanning subtree */
+node node_operator_header(vector *const tree, const size_t index)
 {
 	if (index == SIZE_MAX)
 	{
@@ -329,6 +359,7 @@ node node_operator(vector *const tree, const size_t index)
 	node nd;
 
 	nd.tree = tree;
+	nd.arena = NULL;
 	nd.type = index;
 	nd.argv = nd.type + 1;
 
@@ -353,51 +384,13 @@ node node_operator(vector *const tree, const size_t index)
 		break;
 
 		case TStructbeg:	// StructDecl: n + 2 потомков (размерность структуры, n объявлений полей, инициализатор (может не быть))
-		{
 			nd.argc = 1;
-			size_t j = nd.argv + nd.argc;
-			while (j != SIZE_MAX && vector_get(tree, j) != TStructend)
-			{
-				j = skip_operator(tree, j);
-				nd.amount++;
-			}
-
-			if (j != SIZE_MAX)
-			{
-				skip_operator(tree, j);
-				nd.amount++;
-			}
-			else
-			{
-				return node_broken();
-			}
-		}
-		break;
+			break;
 		case TStructend:
 			nd.argc = 1;
 			break;
 
 		case TBegin:
-		{
-			size_t j = nd.argv + nd.argc;
-			while (j != SIZE_MAX && vector_get(tree, j) != TEnd)
-			{
-				j = skip_operator(tree, j);
-				nd.amount++;
-			}
-
-			if (j != SIZE_MAX)
-			{
-				skip_operator(tree, j);
-				nd.amount++;
-			}
-			else
-			{
-				return node_broken();
-			}
-
-		}
-		break;
 		case TEnd:
 			break;
 
@@ -459,42 +452,310 @@ node node_operator(vector *const tree, const size_t index)
 			break;
 
 		case CREATEDIRECTC:
+		case EXITDIRECTC:
+			break;
+
+		default:
+			return node_broken();
+	}
+
+	nd.children = nd.argv + nd.argc;
+	return nd;
+}
+
+/** Check that node is read as operator, otherwise it is an expression */
+int node_is_operator(vector *const tree, const size_t index)
+{
+	const item_t type = vector_get(tree, index);
+	if (is_operator(type) || type == NOP)
+	{
+		return 1;
+	}
+
+	if (!is_expression(type) && !is_lexeme(type))
+	{
+		warning(NULL, tree_operator_unknown, index, type);
+	}
+
+	return 0;	// CompoundStatement: n + 1 потомков (число потомков, n узлов-операторов)
+				// ExpressionStatement: 1 потомок (выражение)
+}
+
+node node_operator(vector *const tree, const size_t index)
+{
+	if (index == SIZE_MAX)
+	{
+		return node_broken();
+	}
+
+	if (!node_is_operator(tree, index))
+	{
+		return node_expression(tree, index);
+	}
+
+	node nd = node_operator_header(tree, index);
+	const item_t terminator = node_terminator(vector_get(tree, index));
+	if (!node_is_correct(&nd) || terminator == ITEM_MAX)
+	{
+		return nd;
+	}
+
+	size_t j = nd.children;
+	while (j != SIZE_MAX && vector_get(tree, j) != terminator)
+	{
+		j = skip_operator(tree, j);
+		nd.amount++;
+	}
+
+	if (j == SIZE_MAX)
+	{
+		return node_broken();
+	}
+
+	skip_operator(tree, j);
+	nd.amount++;
+	return nd;
+}
+
+
+/**
+ *	Reserve space in arena
+ *
+ *	@param	arena		Tree arena
+ *	@param	nodes		Number of nodes to reserve
+ *	@param	children	Number of children references to reserve
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int arena_reserve(tree_arena *const arena, const size_t nodes, const size_t children)
+{
+	if (arena->nodes_size + nodes > arena->nodes_alloc)
+	{
+		const size_t alloc = 2 * (arena->nodes_size + nodes);
+		tree_node *const array = realloc(arena->nodes, alloc * sizeof(tree_node));
+		if (array == NULL)
 		{
-			size_t j = nd.argv + nd.argc;
-			while (j != SIZE_MAX && vector_get(tree, j) != EXITDIRECTC)
-			{
-				j = skip_operator(tree, j);
-				nd.amount++;
-			}
+			return -1;
+		}
+
+		arena->nodes = array;
+		arena->nodes_alloc = alloc;
+	}
+
+	if (arena->children_size + children > arena->children_alloc)
+	{
+		const size_t alloc = 2 * (arena->children_size + children);
+		size_t *const array = realloc(arena->children, alloc * sizeof(size_t));
+		if (array == NULL)
+		{
+			return -1;
+		}
+
+		arena->children = array;
+		arena->children_alloc = alloc;
+	}
+
+	return 0;
+}
+
+/**
+ *	Add node to arena in pre-order, its children and end are set later
+ *
+ *	@param	arena		Tree arena
+ *	@param	type		Node type
+ *	@param	ref			Reference to node in tree table
+ *	@param	argc		Number of arguments
+ *
+ *	@return	Node number, @c SIZE_MAX on failure
+ */
+size_t arena_add_node(tree_arena *const arena, const item_t type, const size_t ref, const size_t argc)
+{
+	if (arena_reserve(arena, 1, 0))
+	{
+		return SIZE_MAX;
+	}
+
+	tree_node *const record = &arena->nodes[arena->nodes_size];
+	record->type = type;
+	record->ref = ref;
+	record->argc = argc;
+	record->children = 0;
+	record->amount = 0;
+	record->end = SIZE_MAX;
+
+	return arena->nodes_size++;
+}
+
+/**
+ *	Move children numbers from the top of the stack to node's children span
+ *
+ *	@param	arena		Tree arena
+ *	@param	stack		Stack of children numbers
+ *	@param	base		First child on the stack
+ *	@param	id			Node number
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int arena_set_children(tree_arena *const arena, vector *const stack, const size_t base, const size_t id)
+{
+	const size_t amount = vector_size(stack) - base;
+	if (arena_reserve(arena, 0, amount))
+	{
+		return -1;
+	}
+
+	arena->nodes[id].children = arena->children_size;
+	arena->nodes[id].amount = amount;
+
+	for (size_t i = base; i < vector_size(stack); i++)
+	{
+		arena->children[arena->children_size++] = (size_t)vector_get(stack, i);
+	}
+
+	return vector_resize(stack, base);
+}
+
+/**
+ *	Add node with its subtree to arena
+ *
+ *	@param	arena		Tree arena
+ *	@param	stack		Stack of children numbers
+ *	@param	position	Node reference in tree table
+ *	@param	as_operator	Set if node is read as operator
+ *
+ *	@return	End of subtree, @c SIZE_MAX on failure
+ */
+size_t arena_add_subtree(tree_arena *const arena, vector *const stack, const size_t position, const int as_operator)
+{
+	vector *const tree = arena->tree;
+
+	// Продолжение выражения обходится циклом, а не рекурсией, чтобы глубина не зависела от длины выражения.
+	// Все узлы цепочки заканчиваются там же, где её последний узел, поэтому конец проставляется в конце
+	const size_t chain = vector_size(stack);
+	size_t current = position;
+	size_t i = SIZE_MAX;
 
-			if (j != SIZE_MAX)
+	while (1)
+	{
+		const int is_operator_node = as_operator && current == position && node_is_operator(tree, current);
+		const node nd = is_operator_node
+			? node_operator_header(tree, current)
+			: node_expression_header(tree, current);
+		if (!node_is_correct(&nd))
+		{
+			return SIZE_MAX;
+		}
+
+		const size_t id = arena_add_node(arena, vector_get(tree, current), current, nd.argc);
+		if (id == SIZE_MAX)
+		{
+			return SIZE_MAX;
+		}
+
+		const size_t base = vector_size(stack);
+		const item_t terminator = is_operator_node ? node_terminator(vector_get(tree, current)) : ITEM_MAX;
+		i = nd.children;
+
+		for (size_t k = 0; i != SIZE_MAX && k < nd.amount; k++)
+		{
+			vector_add(stack, (item_t)arena->nodes_size);
+			i = arena_add_subtree(arena, stack, i, is_operator_node);
+		}
+
+		if (terminator != ITEM_MAX)
+		{
+			while (i != SIZE_MAX && vector_get(tree, i) != terminator)
 			{
-				skip_operator(tree, j);
-				nd.amount++;
+				vector_add(stack, (item_t)arena->nodes_size);
+				i = arena_add_subtree(arena, stack, i, 1);
 			}
-			else
+
+			if (i != SIZE_MAX)
 			{
-				return node_broken();
+				vector_add(stack, (item_t)arena->nodes_size);
+				i = arena_add_subtree(arena, stack, i, 1);
 			}
 		}
-		break;
-		case EXITDIRECTC:
-			break;
 
-		default:
-			if (!is_expression(vector_get(tree, index)) && !is_lexeme(vector_get(tree, index)))
+		if (i == SIZE_MAX)
+		{
+			return SIZE_MAX;
+		}
+
+		if (is_operator_node || vector_get(tree, current) == TExprend)
+		{
+			if (arena_set_children(arena, stack, base, id))
 			{
-				warning(NULL, tree_operator_unknown, index, vector_get(tree, index));
+				return SIZE_MAX;
 			}
 
-			return node_expression(tree, index);	// CompoundStatement: n + 1 потомков (число потомков, n узлов-операторов)
-													// ExpressionStatement: 1 потомок (выражение)
+			arena->nodes[id].end = i;
+			break;
+		}
+
+		// Выражение продолжается следующим узлом, который будет добавлен сразу за потомками
+		vector_add(stack, (item_t)arena->nodes_size);
+		if (arena_set_children(arena, stack, base, id))
+		{
+			return SIZE_MAX;
+		}
+
+		vector_add(stack, (item_t)id);
+		current = i;
 	}
 
+	for (size_t k = chain; k < vector_size(stack); k++)
+	{
+		arena->nodes[(size_t)vector_get(stack, k)].end = i;
+	}
+
+	vector_resize(stack, chain);
+	return i;
+}
+
+/** Get node from arena */
+node node_from_arena(const tree_arena *const arena, const size_t id)
+{
+	if (id >= arena->nodes_size)
+	{
+		return node_broken();
+	}
+
+	const tree_node *const record = &arena->nodes[id];
+
+	node nd;
+
+	nd.tree = arena->tree;
+	nd.arena = arena;
+	nd.id = id;
+
+	nd.type = record->ref;
+	nd.argv = record->ref != SIZE_MAX ? record->ref + 1 : 0;
+	nd.argc = record->argc;
+
 	nd.children = nd.argv + nd.argc;
+	nd.amount = record->amount;
+
+	nd.parent = SIZE_MAX;
 	return nd;
 }
 
+/** Get end of node subtree */
+size_t node_get_end(node *const nd)
+{
+	if (nd->arena != NULL)
+	{
+		return nd->arena->nodes[nd->id].end;
+	}
+
+	node temp = *nd;
+	while (temp.amount != 0)
+	{
+		temp = node_get_child(&temp, temp.amount - 1);
+	}
+
+	return temp.children;
+}
 
 size_t node_test_recursive(node *const nd, size_t i)
 {
@@ -526,6 +787,28 @@ size_t node_test_recursive(node *const nd, size_t i)
 	return i;
 }
 
+int node_test_arena(node *const nd, node *const from_arena)
+{
+	if (node_get_type(nd) != node_get_type(from_arena) || nd->argc != from_arena->argc
+		|| node_get_amount(nd) != node_get_amount(from_arena) || node_get_end(nd) != node_get_end(from_arena))
+	{
+		system_error(tree_unexpected, node_get_type(from_arena), from_arena->type, node_get_type(nd));
+		return -1;
+	}
+
+	for (size_t i = 0; i < node_get_amount(nd); i++)
+	{
+		node child = node_get_child(nd, i);
+		node arena_child = node_get_child(from_arena, i);
+		if (node_test_arena(&child, &arena_child))
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
 int node_test_copy(node *const dest, node *const nd)
 {
 	node child_dest = node_set_child(dest);
@@ -582,6 +865,7 @@ node node_get_root(vector *const tree)
 	node nd;
 
 	nd.tree = tree;
+	nd.arena = NULL;
 	nd.type = SIZE_MAX;
 	nd.argv = 0;
 	nd.argc = 0;
@@ -604,6 +888,58 @@ node node_get_root(vector *const tree)
 	return nd;
 }
 
+tree_arena arena_create(vector *const tree)
+{
+	tree_arena arena;
+	arena.tree = tree;
+
+	arena.nodes = NULL;
+	arena.nodes_size = 0;
+	arena.nodes_alloc = 0;
+
+	arena.children = NULL;
+	arena.children_size = 0;
+	arena.children_alloc = 0;
+
+	if (!vector_is_correct(tree) || arena_reserve(&arena, vector_size(tree) / 2 + 1, vector_size(tree) / 2))
+	{
+		return arena;
+	}
+
+	vector stack = vector_create(MAXTREESIZE);
+	const size_t root = arena_add_node(&arena, ITEM_MAX, SIZE_MAX, 0);
+
+	size_t i = 0;
+	while (i != SIZE_MAX && vector_get(tree, i) != ITEM_MAX)
+	{
+		vector_add(&stack, (item_t)arena.nodes_size);
+		i = arena_add_subtree(&arena, &stack, i, 1);
+	}
+
+	if (i == SIZE_MAX || arena_set_children(&arena, &stack, 0, root))
+	{
+		arena.nodes_size = 0;
+		arena.children_size = 0;
+	}
+	else
+	{
+		arena.nodes[root].end = i;
+	}
+
+	vector_clear(&stack);
+	return arena;
+}
+
+node arena_get_root(const tree_arena *const arena)
+{
+	if (arena == NULL)
+	{
+		return node_broken();
+	}
+
+	return arena->nodes_size != 0 ? node_from_arena(arena, 0) : node_get_root(arena->tree);
+}
+
 node node_get_child(node *const nd, const size_t index)
 {
 	if (!node_is_correct(nd) || index > nd->amount)
@@ -611,6 +947,19 @@ node node_get_child(node *const nd, const size_t index)
 		return node_broken();
 	}
 
+	if (nd->arena != NULL)
+	{
+		if (index == nd->amount)
+		{
+			return node_broken();
+		}
+
+		const tree_arena *const arena = nd->arena;
+		node child = node_from_arena(arena, arena->children[arena->nodes[nd->id].children + index]);
+		child.parent = nd->type;
+		return child;
+	}
+
 	size_t i = nd->children;
 	for (size_t num = 0; num < index; num++)
 	{
@@ -640,7 +989,12 @@ size_t node_get_amount(const node *const nd)
 
 item_t node_get_type(const node *const nd)
 {
-	return node_is_correct(nd) ? vector_get(nd->tree, nd->type) : ITEM_MAX;
+	if (!node_is_correct(nd))
+	{
+		return ITEM_MAX;
+	}
+
+	return nd->arena != NULL ? nd->arena->nodes[nd->id].type : vector_get(nd->tree, nd->type);
 }
 
 item_t node_get_arg(const node *const nd, const size_t index)
@@ -656,6 +1010,17 @@ node node_get_next(node *const nd)
 		return node_broken();
 	}
 
+	if (nd->arena != NULL)
+	{
+		// Узлы арены хранятся в прямом порядке обхода
+		node next = node_from_arena(nd->arena, nd->id + 1);
+		if (node_get_type(&next) == NOP)
+		{
+			next.amount = 0;	// При обходе пустое выражение читается как оператор
+		}
+		return next;
+	}
+
 	if (nd->type == SIZE_MAX)
 	{
 		return node_operator(nd->tree, 0);
@@ -676,6 +1041,40 @@ int node_set_next(node *const nd)
 	return 0;
 }
 
+node node_get_last(node *const nd)
+{
+	if (!node_is_correct(nd) || nd->arena == NULL)
+	{
+		return node_broken();
+	}
+
+	// Узлы поддерева идут подряд, ищется первый узел за его концом
+	const tree_arena *const arena = nd->arena;
+	const size_t end = arena->nodes[nd->id].end;
+
+	size_t fst = nd->id + 1;
+	size_t snd = arena->nodes_size;
+	while (fst < snd)
+	{
+		const size_t middle = fst + (snd - fst) / 2;
+		if (arena->nodes[middle].ref < end)
+		{
+			fst = middle + 1;
+		}
+		else
+		{
+			snd = middle;
+		}
+	}
+
+	node last = node_from_arena(arena, fst - 1);
+	if (node_get_type(&last) == NOP)
+	{
+		last.amount = 0;	// При обходе пустое выражение читается как оператор
+	}
+	return last;
+}
+
 
 int node_set_type(node *const nd, const item_t type)
 {
@@ -752,6 +1151,7 @@ node node_set_child(node *const nd)
 	node child;
 
 	child.tree = nd->tree;
+	child.arena = NULL;
 	child.type = vector_size(nd->tree);
 
 	child.argv = child.type + 1;
@@ -827,23 +1227,33 @@ int node_swap(node *const fst, const size_t fst_index, node *const snd, const si
 
 	node temp = node_get_child(fst, fst_index);
 	const size_t fst_child_index = temp.type;
-
-	while (temp.amount != 0)
-	{
-		temp = node_get_child(&temp, temp.amount - 1);
-	}
-	const size_t fst_size = temp.type - fst_child_index + temp.argc + 1;
+	const size_t fst_size = node_get_end(&temp) - fst_child_index;
 
 	temp = node_get_child(snd, snd_index);
 	const size_t snd_child_index = temp.type;
+	const size_t snd_size = node_get_end(&temp) - snd_child_index;
 
-	while (temp.amount != 0)
+	return vector_swap(tree, fst_child_index, fst_size, snd_child_index, snd_size);
+}
+
+int arena_clear(tree_arena *const arena)
+{
+	if (arena == NULL)
 	{
-		temp = node_get_child(&temp, temp.amount - 1);
+		return -1;
 	}
-	const size_t snd_size = temp.type - snd_child_index + temp.argc + 1;
 
-	return vector_swap(tree, fst_child_index, fst_size, snd_child_index, snd_size);
+	free(arena->nodes);
+	arena->nodes = NULL;
+	arena->nodes_size = 0;
+	arena->nodes_alloc = 0;
+
+	free(arena->children);
+	arena->children = NULL;
+	arena->children_size = 0;
+	arena->children_alloc = 0;
+
+	return 0;
 }
 
 int node_is_correct(const node *const nd)
@@ -971,3 +1381,20 @@ int tree_test_copy(vector *const tree)
 	vector_clear(&tree_dest);
 	return ret;
 }
+
+int tree_test_arena(vector *const tree)
+{
+	if (!vector_is_correct(tree))
+	{
+		return -1;
+	}
+
+	tree_arena arena = arena_create(tree);
+
+	node nd = node_get_root(tree);
+	node from_arena = arena_get_root(&arena);
+	const int ret = from_arena.arena == NULL || node_test_arena(&nd, &from_arena) ? -1 : 0;
+
+	arena_clear(&arena);
+	return ret;
+}
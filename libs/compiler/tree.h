@@ -25,10 +25,39 @@
 extern "C" {
 #endif
 
+/** Node record in tree arena */
+typedef struct tree_node
+{
+	item_t type;			/**< Node type */
+	size_t ref;				/**< Reference to node in tree table */
+	size_t argc;			/**< Number of arguments, they follow node in tree table */
+
+	size_t children;		/**< Start of children span in arena */
+	size_t amount;			/**< Amount of children */
+
+	size_t end;				/**< End of subtree in tree table */
+} tree_node;
+
+/** Tree arena, nodes are stored in pre-order (NLR) */
+typedef struct tree_arena
+{
+	vector *tree;			/**< Tree reference */
+
+	tree_node *nodes;		/**< Node records, root is the first one */
+	size_t nodes_size;		/**< Number of nodes */
+	size_t nodes_alloc;		/**< Allocated number of nodes */
+
+	size_t *children;		/**< Children spans, numbers of nodes */
+	size_t children_size;	/**< Size of children spans */
+	size_t children_alloc;	/**< Allocated size of children spans */
+} tree_arena;
+
 /** Tree node */
 typedef struct node
 {
 	vector *tree;			/**< Tree reference */
+	const tree_arena *arena;/**< Arena reference, may be @c NULL */
+	size_t id;				/**< Node number in arena */
 	size_t type;			/**< Node type */
 
 	size_t argv;			/**< Reference to arguments */
@@ -50,6 +79,36 @@ typedef struct node
  */
 node node_get_root(vector *const tree);
 
+/**
+ *	Create tree arena from tree table.
+ *	Arena must be recreated after any tree change.
+ *
+ *	@param	tree		Tree table
+ *
+ *	@return	Tree arena, empty on failure
+ */
+tree_arena arena_create(vector *const tree);
+
+/**
+ *	Get tree root node, which is navigated through arena in constant time.
+ *	Falls back to @c node_get_root, if arena is empty.
+ *
+ *	@param	arena		Tree arena
+ *
+ *	@return	Root node
+ */
+node arena_get_root(const tree_arena *const arena);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	arena		Tree arena
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int arena_clear(tree_arena *const arena);
+
+
 /**
  *	Get child from node by index
  *
@@ -108,6 +167,16 @@ node node_get_next(node *const nd);
  */
 int node_set_next(node *const nd);
 
+/**
+ *	Get the last node of subtree in pre-order (NLR),
+ *	subtree is navigated through arena
+ *
+ *	@param	nd			Subtree root
+ *
+ *	@return	Last node, broken node without arena
+ */
+node node_get_last(node *const nd);
+
 
 /**
  *	Set node type
@@ -238,6 +307,15 @@ int tree_test_recursive(vector *const tree);
  */
 int tree_test_copy(vector *const tree);
 
+/**
+ *	Test tree navigation through arena
+ *
+ *	@param	tree		Tree table
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int tree_test_arena(vector *const tree);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
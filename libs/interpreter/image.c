@@ -0,0 +1,334 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "image.h"
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "item.h"
+
+
+#define IMAGE_TABLES		5
+#define BINARY_SIGNATURE	"RUCB"
+#define BINARY_VERSION		1
+#define BINARY_ALIGN		8
+
+
+/** Image file contents */
+typedef struct source
+{
+	const char *buffer;				/**< File contents */
+	size_t size;					/**< File size */
+	size_t position;				/**< Current position */
+} source;
+
+
+static char *file_read(const char *const path, size_t *const size)
+{
+	FILE *file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	size_t alloc = BUFSIZ;
+	char *buffer = malloc(alloc + 1);
+	*size = 0;
+
+	while (buffer != NULL)
+	{
+		*size += fread(&buffer[*size], 1, alloc - *size, file);
+		if (*size < alloc)
+		{
+			buffer[*size] = '\0';
+			break;
+		}
+
+		alloc *= 2;
+		char *const reallocated = realloc(buffer, alloc + 1);
+		if (reallocated == NULL)
+		{
+			free(buffer);
+		}
+		buffer = reallocated;
+	}
+
+	fclose(file);
+	return buffer;
+}
+
+
+static inline vector *image_table(image *const img, const size_t index)
+{
+	switch (index)
+	{
+		case 0:
+			return &img->memory;
+		case 1:
+			return &img->functions;
+		case 2:
+			return &img->identifiers;
+		case 3:
+			return &img->representations;
+		default:
+			return &img->modes;
+	}
+}
+
+
+static int text_read(source *const src, uint64_t *const value)
+{
+	const char *begin = &src->buffer[src->position];
+	while (*begin == ' ' || *begin == '\t' || *begin == '\r' || *begin == '\n')
+	{
+		begin++;
+	}
+
+	char *end = NULL;
+	*value = strtoull(begin, &end, 10);
+	if (end == begin)
+	{
+		return -1;
+	}
+
+	src->position = (size_t)(end - src->buffer);
+	return 0;
+}
+
+/** Загрузка таблиц из текстового вида */
+static int text_load(image *const img, source *const src)
+{
+	uint64_t sizes[IMAGE_TABLES];
+	for (size_t i = 0; i < IMAGE_TABLES; i++)
+	{
+		if (text_read(src, &sizes[i]))
+		{
+			return -1;
+		}
+	}
+
+	uint64_t max_displg;
+	uint64_t max_threads;
+	if (text_read(src, &max_displg) || text_read(src, &max_threads))
+	{
+		return -1;
+	}
+
+	img->max_displg = (size_t)max_displg;
+	img->max_threads = (size_t)max_threads;
+
+	for (size_t i = 0; i < IMAGE_TABLES; i++)
+	{
+		vector *const table = image_table(img, i);
+		*table = vector_create((size_t)sizes[i]);
+		if (!vector_is_correct(table))
+		{
+			return -1;
+		}
+
+		for (uint64_t j = 0; j < sizes[i]; j++)
+		{
+			uint64_t value;
+			if (text_read(src, &value))
+			{
+				return -1;
+			}
+
+			vector_add(table, (item_t)(int64_t)value);
+		}
+	}
+
+	return 0;
+}
+
+
+static uint64_t binary_decode(const char *const buffer, const size_t width)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < width; i++)
+	{
+		value |= (uint64_t)(unsigned char)buffer[i] << (8 * i);
+	}
+
+	return value;
+}
+
+static int binary_read(source *const src, uint64_t *const value, const size_t width)
+{
+	if (src->position + width > src->size)
+	{
+		return -1;
+	}
+
+	*value = binary_decode(&src->buffer[src->position], width);
+	src->position += width;
+	return 0;
+}
+
+static inline void binary_align(source *const src)
+{
+	src->position += (BINARY_ALIGN - src->position % BINARY_ALIGN) % BINARY_ALIGN;
+}
+
+static int64_t binary_extend(const uint64_t value, const size_t width, const item_status target)
+{
+	if (target >= item_uint64 || width == sizeof(uint64_t))
+	{
+		return (int64_t)value;
+	}
+
+	const uint64_t sign = (uint64_t)1 << (8 * width - 1);
+	return (int64_t)((value ^ sign) - sign);
+}
+
+/** Загрузка таблиц из двоичного вида */
+static int binary_load(image *const img, source *const src)
+{
+	uint64_t version;
+	uint64_t target;
+	uint64_t width;
+	uint64_t sections;
+	uint64_t max_displg;
+	uint64_t max_threads;
+
+	if (binary_read(src, &version, sizeof(uint8_t)) || binary_read(src, &target, sizeof(uint8_t))
+		|| binary_read(src, &width, sizeof(uint8_t)) || binary_read(src, &sections, sizeof(uint8_t))
+		|| binary_read(src, &max_displg, sizeof(uint64_t)) || binary_read(src, &max_threads, sizeof(uint64_t))
+		|| version != BINARY_VERSION || sections != IMAGE_TABLES || target >= item_types
+		|| (width != 1 && width != 2 && width != 4 && width != 8))
+	{
+		return -1;
+	}
+
+	img->max_displg = (size_t)max_displg;
+	img->max_threads = (size_t)max_threads;
+	binary_align(src);
+
+	for (size_t i = 0; i < IMAGE_TABLES; i++)
+	{
+		uint64_t id;
+		uint64_t reserved;
+		uint64_t size;
+
+		if (binary_read(src, &id, sizeof(uint32_t)) || binary_read(src, &reserved, sizeof(uint32_t))
+			|| binary_read(src, &size, sizeof(uint64_t)) || id != i + 1
+			|| size > (src->size - src->position) / width)
+		{
+			return -1;
+		}
+
+		vector *const table = image_table(img, i);
+		*table = vector_create((size_t)size);
+		if (!vector_is_correct(table))
+		{
+			return -1;
+		}
+
+		for (uint64_t j = 0; j < size; j++)
+		{
+			const uint64_t value = binary_decode(&src->buffer[src->position], (size_t)width);
+			vector_add(table, (item_t)binary_extend(value, (size_t)width, (item_status)target));
+			src->position += (size_t)width;
+		}
+
+		binary_align(src);
+	}
+
+	return 0;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int image_load(image *const img, const char *const path)
+{
+	if (img == NULL || path == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < IMAGE_TABLES; i++)
+	{
+		image_table(img, i)->array = NULL;
+	}
+
+	size_t size;
+	char *const buffer = file_read(path, &size);
+	if (buffer == NULL)
+	{
+		return -1;
+	}
+
+	source src = { buffer, size, 0 };
+
+	// Первая строка - путь к виртуальной машине
+	if (size > 1 && buffer[0] == '#' && buffer[1] == '!')
+	{
+		const char *const end = strchr(buffer, '\n');
+		src.position = end != NULL ? (size_t)(end - buffer) + 1 : size;
+	}
+
+	const size_t signature = strlen(BINARY_SIGNATURE);
+	int ret;
+	if (src.position + signature <= size && memcmp(&buffer[src.position], BINARY_SIGNATURE, signature) == 0)
+	{
+		src.position += signature;
+		ret = binary_load(img, &src);
+	}
+	else
+	{
+		ret = text_load(img, &src);
+	}
+
+	free(buffer);
+	if (ret || !image_is_correct(img))
+	{
+		image_clear(img);
+		return -1;
+	}
+
+	return 0;
+}
+
+int image_is_correct(const image *const img)
+{
+	return img != NULL && vector_is_correct(&img->memory) && vector_is_correct(&img->functions)
+		&& vector_is_correct(&img->identifiers) && vector_is_correct(&img->representations)
+		&& vector_is_correct(&img->modes) && vector_size(&img->memory) != 0;
+}
+
+int image_clear(image *const img)
+{
+	if (img == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < IMAGE_TABLES; i++)
+	{
+		vector_clear(image_table(img, i));
+	}
+
+	return 0;
+}
@@ -0,0 +1,72 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "vector.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Virtual machine image, tables are in the same order as in export */
+typedef struct image
+{
+	vector memory;					/**< Memory table */
+	vector functions;				/**< Functions table */
+	vector identifiers;				/**< Compressed identifiers table */
+	vector representations;			/**< Compressed representations table */
+	vector modes;					/**< Modes table */
+
+	size_t max_displg;				/**< Size of global data */
+	size_t max_threads;				/**< Number of direct threads */
+} image;
+
+
+/**
+ *	Load virtual machine image from file,
+ *	both text and binary exports are supported
+ *
+ *	@param	img			Image structure
+ *	@param	path		Image file path
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int image_load(image *const img, const char *const path);
+
+/**
+ *	Check that image is correct
+ *
+ *	@param	img			Image structure
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+int image_is_correct(const image *const img);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	img			Image structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int image_clear(image *const img);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
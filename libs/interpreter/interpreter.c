@@ -0,0 +1,2391 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "interpreter.h"
+#include <limits.h>
+#include <math.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "defs.h"
+#include "image.h"
+#include "operations.h"
+#include "runtime.h"
+#include "threads.h"
+#include "utf8.h"
+
+
+// Шитый код требует расширения GCC для адресов меток
+#if defined(__GNUC__) && !defined(SWITCH_DISPATCH)
+	#define DIRECT_THREADING
+#endif
+
+
+#define CODE_BEGIN			4
+#define CODE_PADDING		8
+
+#define FRAME_SIZE			3
+#define MAIN_STACK_SIZE		(1 << 22)
+#define THREAD_STACK_SIZE	(1 << 18)
+#define STACK_MARGIN		256
+
+#define MAX_STRING_SIZE		(MAXSTRINGL * 4 + 1)
+
+
+/**
+ *	List of all instructions supported by interpreter
+ *
+ *	@param	X		Macro applied to every instruction
+ */
+#define INSTRUCTIONS(X) \
+	X(REMASS) X(SHLASS) X(SHRASS) X(ANDASS) X(EXORASS) X(ORASS) \
+	X(ASS) X(PLUSASS) X(MINUSASS) X(MULTASS) X(DIVASS) \
+	X(REMASSAT) X(SHLASSAT) X(SHRASSAT) X(ANDASSAT) X(EXORASSAT) X(ORASSAT) \
+	X(ASSAT) X(PLUSASSAT) X(MINUSASSAT) X(MULTASSAT) X(DIVASSAT) \
+	X(REMASSV) X(SHLASSV) X(SHRASSV) X(ANDASSV) X(EXORASSV) X(ORASSV) \
+	X(ASSV) X(PLUSASSV) X(MINUSASSV) X(MULTASSV) X(DIVASSV) \
+	X(REMASSATV) X(SHLASSATV) X(SHRASSATV) X(ANDASSATV) X(EXORASSATV) X(ORASSATV) \
+	X(ASSATV) X(PLUSASSATV) X(MINUSASSATV) X(MULTASSATV) X(DIVASSATV) \
+	\
+	X(LREM) X(LSHL) X(LSHR) X(LAND) X(LEXOR) X(LOR) X(LOGAND) X(LOGOR) \
+	X(EQEQ) X(NOTEQ) X(LLT) X(LGT) X(LLE) X(LGE) X(LPLUS) X(LMINUS) X(LMULT) X(LDIV) \
+	X(UNMINUS) X(LNOT) X(LOGNOT) \
+	\
+	X(POSTINC) X(POSTDEC) X(INC) X(DEC) X(POSTINCAT) X(POSTDECAT) X(INCAT) X(DECAT) \
+	X(POSTINCV) X(POSTDECV) X(INCV) X(DECV) X(POSTINCATV) X(POSTDECATV) X(INCATV) X(DECATV) \
+	\
+	X(ASSR) X(PLUSASSR) X(MINUSASSR) X(MULTASSR) X(DIVASSR) \
+	X(ASSATR) X(PLUSASSATR) X(MINUSASSATR) X(MULTASSATR) X(DIVASSATR) \
+	X(ASSRV) X(PLUSASSRV) X(MINUSASSRV) X(MULTASSRV) X(DIVASSRV) \
+	X(ASSATRV) X(PLUSASSATRV) X(MINUSASSATRV) X(MULTASSATRV) X(DIVASSATRV) \
+	\
+	X(EQEQR) X(NOTEQR) X(LLTR) X(LGTR) X(LLER) X(LGER) X(LPLUSR) X(LMINUSR) X(LMULTR) X(LDIVR) X(UNMINUSR) \
+	\
+	X(POSTINCR) X(POSTDECR) X(INCR) X(DECR) X(POSTINCATR) X(POSTDECATR) X(INCATR) X(DECATR) \
+	X(POSTINCRV) X(POSTDECRV) X(INCRV) X(DECRV) X(POSTINCATRV) X(POSTDECATRV) X(INCATRV) X(DECATRV) \
+	\
+	X(COPY00) X(COPY01) X(COPY10) X(COPY11) X(COPY0ST) X(COPY1ST) X(COPY0STASS) X(COPY1STASS) X(COPYST) \
+	\
+	X(NOP) X(DEFARR) X(LI) X(LID) X(LOAD) X(LOADD) X(LAT) X(LATD) X(STOP) X(SELECT) X(FUNCBEG) X(LA) \
+	X(CALL1) X(CALL2) X(RETURNVAL) X(RETURNVOID) X(B) X(BE0) X(BNE0) X(SLICE) X(WIDEN) X(WIDEN1) \
+	X(_DOUBLE) X(ARRINIT) X(STRUCTWITHARR) X(BEGINIT) X(ROWING) X(ROWINGD) \
+	\
+	X(LOADSLICE) X(SLICELAT) X(LOADLOAD) X(LOADLI) X(LIASSV) X(LIASSATV) \
+	X(EQEQBE0) X(NOTEQBE0) X(LLTBE0) X(LGTBE0) X(LLEBE0) X(LGEBE0) \
+	\
+	X(ABSIC) X(ABSC) X(SQRTC) X(EXPC) X(SINC) X(COSC) X(LOGC) X(LOG10C) X(ASINC) X(RANDC) X(ROUNDC) \
+	X(STRCPYC) X(STRNCPYC) X(STRCATC) X(STRNCATC) X(STRCMPC) X(STRNCMPC) X(STRSTRC) X(STRLENC) \
+	X(UPBC) X(ASSERTC) \
+	\
+	X(CREATEDIRECTC) X(EXITC) X(MSGSENDC) X(MSGRECEIVEC) X(JOINC) X(SLEEPC) X(SEMCREATEC) X(SEMWAITC) \
+	X(SEMPOSTC) X(CREATEC) X(INITC) X(DESTROYC) X(GETNUMC) \
+	\
+	X(SETMOTORC) X(GETDIGSENSORC) X(GETANSENSORC) X(VOLTAGEC) X(WIFI_CONNECTC) X(BLYNK_AUTHORIZATIONC) \
+	X(BLYNK_SENDC) X(BLYNK_RECEIVEC) X(BLYNK_NOTIFICATIONC) X(BLYNK_PROPERTYC) X(BLYNK_LCDC) \
+	X(BLYNK_TERMINALC) X(SETSIGNALC) X(PIXELC) X(LINEC) X(RECTANGLEC) X(ELLIPSEC) X(CLEARC) \
+	X(DRAW_STRINGC) X(DRAW_NUMBERC) X(ICONC) X(SEND_INTC) X(SEND_FLOATC) X(SEND_STRINGC) \
+	X(RECEIVE_INTC) X(RECEIVE_FLOATC) X(RECEIVE_STRINGC)
+
+/**
+ *	List of instructions with negative codes, labels are named explicitly
+ *
+ *	@param	X		Macro applied to every instruction and its label name
+ */
+#define NAMED_INSTRUCTIONS(X) \
+	X(PRINT, print) X(PRINTID, printid) X(PRINTF, printf) X(GETID, getid)
+
+
+struct machine;
+
+/** Execution context of one thread */
+typedef struct context
+{
+	struct machine *vm;				/**< Virtual machine */
+	int number;						/**< Thread number */
+
+	int pc;							/**< Program counter */
+	int x;							/**< Stack top */
+	int l;							/**< Current frame */
+	int call;						/**< Chain of pending calls */
+	int init;						/**< Chain of pending array initializers */
+	int base;						/**< Struct address for initialization procedures */
+
+	int heap;						/**< Heap bottom, heap grows down from the end of stack region */
+	volatile int guard;				/**< Stack limit, zero if thread should stop */
+	int bottom;						/**< Stack bottom, lowest valid stack top */
+} context;
+
+/** Virtual machine */
+typedef struct machine
+{
+	image img;						/**< Loaded tables */
+
+	int *memory;					/**< Memory: code, globals, stacks */
+	size_t size;					/**< Memory size */
+	int code;						/**< Code size */
+	int globals;					/**< Globals address */
+	int margin;						/**< Minimal distance between stack and heap */
+
+	int *functions;					/**< Functions entries */
+	int functions_size;				/**< Number of functions */
+
+#ifdef DIRECT_THREADING
+	const void **threaded;			/**< Threaded code, parallel to code region */
+#endif
+
+	context contexts[THREADS_MAX];	/**< Threads contexts */
+	threads ths;					/**< Threads and semaphores */
+
+	volatile int status;			/**< Execution status */
+} machine;
+
+
+static int execute(context *const ctx);
+
+#ifdef DIRECT_THREADING
+// Встраивание в цикл исполнения портит распределение регистров в нём
+static int branch_outside(const machine *const vm, const int pc)
+	__attribute__((noinline));
+#endif
+
+
+static inline double double_get(const int *const cell)
+{
+	const uint64_t bits = (uint64_t)(uint32_t)cell[0] | ((uint64_t)(uint32_t)cell[1] << 32);
+
+	double value;
+	memcpy(&value, &bits, sizeof(double));
+	return value;
+}
+
+static inline void double_set(int *const cell, const double value)
+{
+	uint64_t bits;
+	memcpy(&bits, &value, sizeof(double));
+
+	cell[0] = (int)(uint32_t)bits;
+	cell[1] = (int)(uint32_t)(bits >> 32);
+}
+
+/** Операции над целыми, переполнение по модулю 2^32 */
+static inline double double_operation(const int operation, const double fst, const double snd)
+{
+	switch (operation)
+	{
+		case LPLUS:
+			return fst + snd;
+		case LMINUS:
+			return fst - snd;
+		case LMULT:
+			return fst * snd;
+		case LDIV:
+			return fst / snd;
+		default:
+			return snd;
+	}
+}
+
+static inline int mode_get(const machine *const vm, const int mode)
+{
+	return (int)vector_get(&vm->img.modes, (size_t)mode);
+}
+
+static inline int size_of(const machine *const vm, const int mode)
+{
+	return mode > 0 && mode_get(vm, mode) == mode_struct
+		? mode_get(vm, mode + 1)
+		: mode == mode_float
+			? 2
+			: 1;
+}
+
+
+/** Количество операндов команды, нужно для разбора кода */
+static int instruction_operands(const int code)
+{
+	switch (code)
+	{
+		case DEFARR:
+			return 7;
+		case ARRINIT:
+			return 4;
+		case COPY00:
+		case COPYST:
+			return 3;
+		case LID:
+		case FUNCBEG:
+		case STRUCTWITHARR:
+		case COPY01:
+		case COPY10:
+		case COPY0ST:
+		case COPY0STASS:
+		case LOADSLICE:
+		case LOADLOAD:
+		case LOADLI:
+		case LIASSV:
+			return 2;
+		case LI:
+		case LOAD:
+		case LOADD:
+		case LA:
+		case SELECT:
+		case SLICE:
+		case CALL2:
+		case RETURNVAL:
+		case B:
+		case BE0:
+		case BNE0:
+		case BEGINIT:
+		case COPY11:
+		case COPY1ST:
+		case COPY1STASS:
+		case PRINT:
+		case PRINTID:
+		case PRINTF:
+		case GETID:
+		case SLICELAT:
+		case LIASSATV:
+		case EQEQBE0:
+		case NOTEQBE0:
+		case LLTBE0:
+		case LGTBE0:
+		case LLEBE0:
+		case LGEBE0:
+			return 1;
+		default:
+			return (code >= REMASS && code <= DIVASS) || (code >= REMASSV && code <= DIVASSV)
+				|| (code >= ASSR && code <= DIVASSR) || (code >= ASSRV && code <= DIVASSRV)
+				|| (code >= POSTINC && code <= DEC) || (code >= POSTINCV && code <= DECV)
+				|| (code >= POSTINCR && code <= DECR) || (code >= POSTINCRV && code <= DECRV);
+	}
+}
+
+/** Адрес команды после EXITC, парного данному CREATEDIRECTC */
+static int direct_end(const machine *const vm, int pc)
+{
+	const int *const mem = vm->memory;
+	size_t depth = 1;
+
+	while (pc < vm->code)
+	{
+		const int code = mem[pc];
+		if (code == LI && pc + 3 < vm->code && mem[pc + 2] == B && mem[pc + 1] == pc + 5 && mem[pc + 3] > pc)
+		{
+			// Строка в коде, перепрыгиваем через символы
+			pc = mem[pc + 3];
+			continue;
+		}
+
+		if (code == CREATEDIRECTC)
+		{
+			depth++;
+		}
+		else if (code == EXITC && --depth == 0)
+		{
+			return pc + 1;
+		}
+
+		pc += 1 + instruction_operands(code);
+	}
+
+	return vm->code - 1;
+}
+
+#ifdef DIRECT_THREADING
+/** Проверить, выводит ли переход в данной команде за пределы кода */
+static int branch_outside(const machine *const vm, const int pc)
+{
+	const int *const mem = vm->memory;
+	int operand;
+
+	switch (mem[pc])
+	{
+		case B:
+		case BE0:
+		case BNE0:
+		case EQEQBE0:
+		case NOTEQBE0:
+		case LLTBE0:
+		case LGTBE0:
+		case LLEBE0:
+		case LGEBE0:
+			operand = pc + 1;
+			break;
+		case FUNCBEG:
+			operand = pc + 2;
+			break;
+		default:
+			return 0;
+	}
+
+	return operand >= vm->code || (unsigned)mem[operand] >= (unsigned)vm->code;
+}
+#endif
+
+
+static void machine_halt(machine *const vm)
+{
+	threads_halt(&vm->ths);
+	for (size_t i = 0; i < THREADS_MAX; i++)
+	{
+		vm->contexts[i].guard = 0;
+	}
+}
+
+static void machine_fail(machine *const vm)
+{
+	vm->status = -1;
+	machine_halt(vm);
+}
+
+
+static void context_init(machine *const vm, const int number)
+{
+	context *const ctx = &vm->contexts[number];
+	const int main_size = MAIN_STACK_SIZE + vm->margin;
+	const int thread_size = THREAD_STACK_SIZE + vm->margin;
+
+	const int begin = vm->globals + (int)vm->img.max_displg + FRAME_SIZE
+		+ (number == 0 ? 0 : main_size + (number - 1) * thread_size);
+
+	ctx->vm = vm;
+	ctx->number = number;
+
+	ctx->pc = CODE_BEGIN;
+	ctx->l = begin;
+	ctx->x = begin + FRAME_SIZE - 1;
+	ctx->bottom = begin - 1;
+	ctx->call = 0;
+	ctx->init = 0;
+	ctx->base = 0;
+
+	ctx->heap = begin + (number == 0 ? main_size : thread_size);
+	ctx->guard = ctx->heap - vm->margin;
+
+	vm->memory[begin] = 0;
+	vm->memory[begin + 1] = 0;
+	vm->memory[begin + 2] = vm->code - 1;
+
+	if (threads_is_halted(&vm->ths))
+	{
+		ctx->guard = 0;
+	}
+}
+
+/**
+ *	Check context after stack limit was reached
+ *
+ *	@return	@c 1 on halt, @c -1 on stack overflow
+ */
+static int context_check(context *const ctx)
+{
+	if (threads_is_halted(&ctx->vm->ths))
+	{
+		return 1;
+	}
+
+	runtime_error(stack_overflow);
+	return -1;
+}
+
+/**
+ *	Reserve cells on stack top
+ *
+ *	@return	@c 0 on success, @c 1 on halt, @c -1 on stack overflow
+ */
+static int stack_reserve(context *const ctx, const int64_t size)
+{
+	if (size < 0 || ctx->x + size >= ctx->guard)
+	{
+		return context_check(ctx);
+	}
+
+	return 0;
+}
+
+/**
+ *	Allocate cells on heap, memory is zeroed
+ *
+ *	@return	Address, @c 0 on failure
+ */
+static int heap_allocate(context *const ctx, const int64_t size)
+{
+	machine *const vm = ctx->vm;
+	if (size < 0 || ctx->heap - size - vm->margin <= ctx->x)
+	{
+		return 0;
+	}
+
+	ctx->heap -= (int)size;
+	memset(&vm->memory[ctx->heap], 0, (size_t)size * sizeof(int));
+
+	ctx->guard = ctx->heap - vm->margin;
+	if (threads_is_halted(&vm->ths))
+	{
+		ctx->guard = 0;
+	}
+
+	return ctx->heap;
+}
+
+/** Run struct initialization procedure */
+static int procedure_execute(context *const ctx, const int procedure, const int base)
+{
+	const int old_pc = ctx->pc;
+	const int old_base = ctx->base;
+
+	ctx->pc = procedure;
+	ctx->base = base;
+	const int ret = execute(ctx);
+
+	ctx->pc = old_pc;
+	ctx->base = old_base;
+	return ret;
+}
+
+
+static int array_define(context *const ctx, const int *const bounds, const size_t dimensions
+	, const int length, const int procedure, int *const address)
+{
+	int *const mem = ctx->vm->memory;
+	const int bound = bounds[0];
+	if (bound < 0)
+	{
+		runtime_error(negative_array_size, bound);
+		return -1;
+	}
+
+	const int cell = dimensions > 1 ? 1 : length;
+	const int64_t size = 1 + (int64_t)bound * cell;
+	const int ret = stack_reserve(ctx, size);
+	if (ret)
+	{
+		return ret;
+	}
+
+	mem[ctx->x + 1] = bound;
+	*address = ctx->x + 2;
+	memset(&mem[*address], 0, (size_t)(size - 1) * sizeof(int));
+	ctx->x += (int)size;
+
+	for (int i = 0; i < bound; i++)
+	{
+		const int ret_element = dimensions > 1
+			? array_define(ctx, &bounds[1], dimensions - 1, length, procedure, &mem[*address + i])
+			: procedure != 0
+				? procedure_execute(ctx, procedure, *address + i * length)
+				: 0;
+
+		if (ret_element)
+		{
+			return ret_element;
+		}
+	}
+
+	return 0;
+}
+
+/** Description of array initializer */
+typedef struct initializer
+{
+	const int *data;				/**< Initializer values */
+	size_t size;					/**< Number of values */
+	size_t position;				/**< Current value */
+
+	const int *bounds;				/**< Declared bounds */
+	size_t bounds_number;			/**< Number of declared bounds */
+	size_t dimensions;				/**< Number of dimensions */
+	int length;						/**< Element length */
+	int is_strings;					/**< Set if last dimension is initialized by strings */
+} initializer;
+
+/** Строковый литерал в коде имеет вид: LI addr; B end; N; символы */
+static inline int string_is_literal(const machine *const vm, const int address)
+{
+	const int *const mem = vm->memory;
+	return address > CODE_BEGIN + 4 && address < vm->code
+		&& mem[address - 5] == LI && mem[address - 4] == address && mem[address - 3] == B;
+}
+
+static int array_build(context *const ctx, initializer *const init, const size_t level, int *const address)
+{
+	int *const mem = ctx->vm->memory;
+	const int is_last = level + 1 == init->dimensions;
+	const int declared = level < init->bounds_number ? init->bounds[level] : -1;
+
+	if (init->position >= init->size)
+	{
+		runtime_error(wrong_image, "");
+		return -1;
+	}
+
+	const int value = init->data[init->position++];
+	const int is_string = is_last && (init->is_strings || string_is_literal(ctx->vm, value));
+	const int count = is_string ? mem[value - 1] : value;
+	const int bound = declared >= 0 ? declared : count;
+	if (count > bound)
+	{
+		runtime_error(initializer_too_long, count, bound);
+		return -1;
+	}
+
+	const int cell = is_last ? init->length : 1;
+	const int64_t size = 1 + (int64_t)bound * cell;
+	int ret = stack_reserve(ctx, size);
+	if (ret)
+	{
+		return ret;
+	}
+
+	mem[ctx->x + 1] = bound;
+	*address = ctx->x + 2;
+	memset(&mem[*address], 0, (size_t)(size - 1) * sizeof(int));
+	ctx->x += (int)size;
+
+	if (is_string)
+	{
+		memcpy(&mem[*address], &mem[value], (size_t)count * sizeof(int));
+	}
+	else if (is_last)
+	{
+		const size_t cells = (size_t)count * (size_t)cell;
+		if (init->position + cells > init->size)
+		{
+			runtime_error(wrong_image, "");
+			return -1;
+		}
+
+		memcpy(&mem[*address], &init->data[init->position], cells * sizeof(int));
+		init->position += cells;
+	}
+	else
+	{
+		for (int i = 0; i < count && !ret; i++)
+		{
+			ret = array_build(ctx, init, level + 1, &mem[*address + i]);
+		}
+
+		// Оставшиеся строки заполняются нулями, если известны их границы
+		if (init->bounds_number == init->dimensions)
+		{
+			for (int i = count; i < bound && !ret; i++)
+			{
+				ret = array_define(ctx, &init->bounds[level + 1], init->dimensions - level - 1
+					, init->length, 0, &mem[*address + i]);
+			}
+		}
+	}
+
+	return ret;
+}
+
+
+static int array_declare(context *const ctx, const int *const operands)
+{
+	machine *const vm = ctx->vm;
+	int *const mem = vm->memory;
+
+	const int dimensions = operands[0];
+	const int length = operands[1];
+	const int displ = operands[2];
+	const int procedure = operands[3];
+	const int all = operands[5];
+	const int in_struct = operands[6];
+
+	const int target = in_struct
+		? ctx->base + displ
+		: displ < 0 ? vm->globals - displ : ctx->l + displ;
+
+	if (all != 0)
+	{
+		// Инициализатор соберёт массив в ARRINIT, запоминаем, куда записать адрес
+		mem[ctx->x + 1] = ctx->init;
+		mem[ctx->x + 2] = target;
+		ctx->init = ctx->x + 1;
+		ctx->x += 2;
+		return 0;
+	}
+
+	int bounds[MAXBOUNDS];
+	if (dimensions <= 0 || dimensions > MAXBOUNDS)
+	{
+		runtime_error(wrong_image, "");
+		return -1;
+	}
+
+	ctx->x -= dimensions;
+	memcpy(bounds, &mem[ctx->x + 1], (size_t)dimensions * sizeof(int));
+
+	int address = 0;
+	const int ret = array_define(ctx, bounds, (size_t)dimensions, length, procedure, &address);
+	mem[target] = address;
+	return ret;
+}
+
+static int array_initialize(context *const ctx, const int *const operands)
+{
+	int *const mem = ctx->vm->memory;
+
+	const int dimensions = operands[0];
+	const int length = operands[1];
+	const int usual = operands[3];
+
+	const int marker = ctx->init;
+	const int bounds_number = usual & 1 ? dimensions : dimensions - 1;
+	if (marker == 0 || dimensions <= 0 || dimensions > MAXBOUNDS || bounds_number < 0)
+	{
+		runtime_error(wrong_image, "");
+		return -1;
+	}
+
+	const int target = mem[marker + 1];
+	const size_t size = (size_t)(ctx->x - marker - 1);
+
+	int bounds[MAXBOUNDS];
+	memcpy(bounds, &mem[marker - bounds_number], (size_t)bounds_number * sizeof(int));
+
+	int *const data = malloc((size + 1) * sizeof(int));
+	if (data == NULL)
+	{
+		runtime_error(no_memory);
+		return -1;
+	}
+	memcpy(data, &mem[marker + 2], size * sizeof(int));
+
+	ctx->init = mem[marker];
+	ctx->x = marker - bounds_number - 1;
+
+	initializer init = { data, size, 0, bounds, (size_t)bounds_number, (size_t)dimensions, length, usual >= 2 };
+	int address = 0;
+	const int ret = array_build(ctx, &init, 0, &address);
+	mem[target] = address;
+
+	free(data);
+	return ret;
+}
+
+
+static inline int string_length(const int *const mem, const int string)
+{
+	const int bound = mem[string - 1];
+
+	int length = 0;
+	while (length < bound && mem[string + length] != 0)
+	{
+		length++;
+	}
+
+	return length;
+}
+
+/** Копирование строки в массив по указателю, при нехватке места массив переносится в кучу */
+static int string_copy(context *const ctx, const int pointer, const int source, const int count, const int append)
+{
+	int *const mem = ctx->vm->memory;
+	const int destination = mem[pointer];
+	const int prefix = append ? string_length(mem, destination) : 0;
+
+	int length = string_length(mem, source);
+	if (count >= 0 && count < length)
+	{
+		length = count;
+	}
+
+	int result = destination;
+	if (prefix + length > mem[destination - 1])
+	{
+		const int block = heap_allocate(ctx, 1 + (int64_t)prefix + length);
+		if (block == 0)
+		{
+			return context_check(ctx);
+		}
+
+		mem[block] = prefix + length;
+		result = block + 1;
+		memcpy(&mem[result], &mem[destination], (size_t)prefix * sizeof(int));
+	}
+
+	memmove(&mem[result + prefix], &mem[source], (size_t)length * sizeof(int));
+	if (prefix + length < mem[result - 1])
+	{
+		mem[result + prefix + length] = 0;
+	}
+
+	mem[pointer] = result;
+	return 0;
+}
+
+static int string_compare(const int *const mem, const int fst, const int snd, const int count)
+{
+	const int fst_length = string_length(mem, fst);
+	const int snd_length = string_length(mem, snd);
+
+	for (int i = 0; count < 0 || i < count; i++)
+	{
+		const int fst_char = i < fst_length ? mem[fst + i] : 0;
+		const int snd_char = i < snd_length ? mem[snd + i] : 0;
+
+		if (fst_char != snd_char)
+		{
+			return fst_char < snd_char ? -1 : 1;
+		}
+
+		if (fst_char == 0)
+		{
+			break;
+		}
+	}
+
+	return 0;
+}
+
+static int string_find(const int *const mem, const int string, const int substring)
+{
+	const int length = string_length(mem, string);
+	const int sublength = string_length(mem, substring);
+
+	for (int i = 0; i + sublength <= length; i++)
+	{
+		int j = 0;
+		while (j < sublength && mem[string + i + j] == mem[substring + j])
+		{
+			j++;
+		}
+
+		if (j == sublength)
+		{
+			return i;
+		}
+	}
+
+	return -1;
+}
+
+static void string_to_buffer(const int *const mem, const int string, char *const buffer)
+{
+	const int length = string_length(mem, string);
+
+	size_t size = 0;
+	for (int i = 0; i < length && size + 4 < MAX_STRING_SIZE; i++)
+	{
+		size += utf8_to_string(&buffer[size], (char32_t)mem[string + i]);
+	}
+	buffer[size] = '\0';
+}
+
+
+static void print_char(const int symbol)
+{
+	char buffer[8];
+	utf8_to_string(buffer, (char32_t)symbol);
+	printf("%s", buffer);
+}
+
+static void print_string(const machine *const vm, const int string)
+{
+	if (string <= 0 || (size_t)string >= vm->size)
+	{
+		return;
+	}
+
+	const int length = string_length(vm->memory, string);
+	for (int i = 0; i < length; i++)
+	{
+		print_char(vm->memory[string + i]);
+	}
+}
+
+static void print_value(const machine *const vm, const int *const value, const int mode)
+{
+	switch (mode)
+	{
+		case mode_integer:
+			printf("%i", *value);
+			return;
+		case mode_character:
+			print_char(*value);
+			return;
+		case mode_float:
+			printf("%f", double_get(value));
+			return;
+	}
+
+	const int *const mem = vm->memory;
+	const int type = mode > 0 ? mode_get(vm, mode) : mode_undefined;
+
+	if (type == mode_array)
+	{
+		const int element = mode_get(vm, mode + 1);
+		const int array = *value;
+		if (array <= 0 || (size_t)array >= vm->size)
+		{
+			return;
+		}
+
+		if (element == mode_character)
+		{
+			print_string(vm, array);
+			return;
+		}
+
+		const int is_matrix = element > 0 && mode_get(vm, element) == mode_array;
+		const int size = size_of(vm, element);
+		for (int i = 0; i < mem[array - 1]; i++)
+		{
+			if (i != 0)
+			{
+				printf(is_matrix ? "\n" : " ");
+			}
+			print_value(vm, &mem[array + i * size], element);
+		}
+	}
+	else if (type == mode_struct)
+	{
+		const int fields = mode_get(vm, mode + 2) / 2;
+		int displ = 0;
+
+		printf("{");
+		for (int i = 0; i < fields; i++)
+		{
+			const int field = mode_get(vm, mode + 3 + 2 * i);
+			printf(i == 0 ? "" : ", ");
+			print_value(vm, &value[displ], field);
+			displ += size_of(vm, field);
+		}
+		printf("}");
+	}
+	else
+	{
+		printf("%i", *value);
+	}
+}
+
+static void print_format(const machine *const vm, const int *const args, const int format)
+{
+	const int *const mem = vm->memory;
+	const int length = mem[format - 1];
+
+	size_t arg = 0;
+	for (int i = 0; i < length; i++)
+	{
+		const int symbol = mem[format + i];
+		if (symbol != '%' || i + 1 == length)
+		{
+			print_char(symbol);
+			continue;
+		}
+
+		const int placeholder = mem[format + ++i];
+		switch (placeholder)
+		{
+			case 'i':
+			case U'ц':
+				printf("%i", args[arg++]);
+				break;
+			case 'c':
+			case U'л':
+				print_char(args[arg++]);
+				break;
+			case 'f':
+			case U'в':
+				printf("%f", double_get(&args[arg]));
+				arg += 2;
+				break;
+			case 's':
+			case U'с':
+				print_string(vm, args[arg++]);
+				break;
+			case '%':
+				printf("%%");
+				break;
+			default:
+				print_char(symbol);
+				print_char(placeholder);
+				break;
+		}
+	}
+}
+
+static int identifier_displ(const context *const ctx, const int id)
+{
+	const int displ = (int)vector_get(&ctx->vm->img.identifiers, (size_t)id + 3);
+	return displ < 0 ? ctx->vm->globals - displ : ctx->l + displ;
+}
+
+static void print_identifier(const context *const ctx, const int id)
+{
+	const machine *const vm = ctx->vm;
+	const int repr = (int)vector_get(&vm->img.identifiers, (size_t)id + 1);
+	const int mode = (int)vector_get(&vm->img.identifiers, (size_t)id + 2);
+
+	for (size_t i = (size_t)repr + 2; vector_get(&vm->img.representations, i) != 0; i++)
+	{
+		print_char((int)vector_get(&vm->img.representations, i));
+	}
+
+	printf(" = ");
+	print_value(vm, &vm->memory[identifier_displ(ctx, id)], mode);
+	printf("\n");
+}
+
+
+static int scan_char(int *const value)
+{
+	int symbol = getchar();
+	while (symbol == ' ' || symbol == '\t' || symbol == '\r' || symbol == '\n')
+	{
+		symbol = getchar();
+	}
+
+	if (symbol == EOF)
+	{
+		return -1;
+	}
+
+	char buffer[8] = { (char)symbol };
+	const size_t size = utf8_symbol_size(buffer[0]);
+	for (size_t i = 1; i < size && i < sizeof(buffer) - 1; i++)
+	{
+		buffer[i] = (char)getchar();
+	}
+
+	*value = (int)utf8_convert(buffer);
+	return 0;
+}
+
+static int scan_value(const machine *const vm, int *const value, const int mode)
+{
+	switch (mode)
+	{
+		case mode_integer:
+			return scanf("%i", value) == 1 ? 0 : -1;
+		case mode_character:
+			return scan_char(value);
+		case mode_float:
+		{
+			double number;
+			if (scanf("%lf", &number) != 1)
+			{
+				return -1;
+			}
+
+			double_set(value, number);
+			return 0;
+		}
+	}
+
+	int *const mem = vm->memory;
+	const int type = mode > 0 ? mode_get(vm, mode) : mode_undefined;
+
+	if (type == mode_array)
+	{
+		const int element = mode_get(vm, mode + 1);
+		const int array = *value;
+		if (array <= 0 || (size_t)array >= vm->size)
+		{
+			return -1;
+		}
+
+		const int size = size_of(vm, element);
+		for (int i = 0; i < mem[array - 1]; i++)
+		{
+			if (scan_value(vm, &mem[array + i * size], element))
+			{
+				return -1;
+			}
+		}
+	}
+	else if (type == mode_struct)
+	{
+		const int fields = mode_get(vm, mode + 2) / 2;
+		int displ = 0;
+
+		for (int i = 0; i < fields; i++)
+		{
+			const int field = mode_get(vm, mode + 3 + 2 * i);
+			if (scan_value(vm, &value[displ], field))
+			{
+				return -1;
+			}
+			displ += size_of(vm, field);
+		}
+	}
+	else
+	{
+		return scanf("%i", value) == 1 ? 0 : -1;
+	}
+
+	return 0;
+}
+
+
+static void *thread_run(void *const arg)
+{
+	execute((context *)arg);
+	return NULL;
+}
+
+static int thread_start(context *const ctx, context *const child)
+{
+	if (threads_start(&ctx->vm->ths, (size_t)child->number, &thread_run, child))
+	{
+		if (threads_is_halted(&ctx->vm->ths))
+		{
+			return 1;
+		}
+
+		runtime_error(too_many_threads);
+		return -1;
+	}
+
+	return 0;
+}
+
+static int thread_create(context *const ctx, const int function)
+{
+	machine *const vm = ctx->vm;
+	int *const mem = vm->memory;
+
+	if (function < 0 || function >= vm->functions_size || vm->functions[function] <= 0
+		|| vm->functions[function] + 3 >= vm->code)
+	{
+		runtime_error(undefined_function, function);
+		return -1;
+	}
+
+	const int number = threads_reserve(&vm->ths);
+	if (number < 0)
+	{
+		runtime_error(too_many_threads);
+		return -1;
+	}
+
+	context_init(vm, number);
+	context *const child = &vm->contexts[number];
+	const int entry = vm->functions[function];
+
+	// Кадр функции нити, возврат из неё ведёт на завершающий STOP
+	const int top = child->l + mem[entry + 1] - 1;
+	if (top >= child->guard)
+	{
+		runtime_error(stack_overflow);
+		return -1;
+	}
+
+	memset(&mem[child->x + 1], 0, (size_t)(top - child->x) * sizeof(int));
+	child->x = top;
+	child->pc = entry + 3;
+
+	mem[++ctx->x] = number;
+	return thread_start(ctx, child);
+}
+
+static int thread_create_direct(context *const ctx)
+{
+	machine *const vm = ctx->vm;
+	int *const mem = vm->memory;
+
+	const int number = threads_reserve(&vm->ths);
+	if (number < 0)
+	{
+		runtime_error(too_many_threads);
+		return -1;
+	}
+
+	context_init(vm, number);
+	context *const child = &vm->contexts[number];
+
+	// Нить продолжает работу с копией текущего кадра
+	const int size = ctx->x - ctx->l + 1;
+	if (child->l + size >= child->guard)
+	{
+		runtime_error(stack_overflow);
+		return -1;
+	}
+
+	memcpy(&mem[child->l], &mem[ctx->l], (size_t)size * sizeof(int));
+	mem[child->l + 2] = vm->code - 1;
+	child->x = child->l + size - 1;
+	child->pc = ctx->pc;
+
+	ctx->pc = direct_end(vm, ctx->pc);
+	return thread_start(ctx, child);
+}
+
+
+/** Выполнение кода в контексте до STOP или завершения нити */
+static int execute(context *const ctx)
+{
+	machine *const vm = ctx->vm;
+	int *const mem = vm->memory;
+	const int *const functions = vm->functions;
+	const int globals = vm->globals;
+
+	int pc = ctx->pc;
+	int x = ctx->x;
+	int l = ctx->l;
+	int call = ctx->call;
+	int status = 0;
+
+#define SAVE()			ctx->pc = pc; ctx->x = x; ctx->l = l; ctx->call = call
+#define RESTORE()		pc = ctx->pc; x = ctx->x; l = ctx->l; call = ctx->call
+#define INVOKE(expr)	SAVE(); status = (expr); RESTORE(); if (status != 0) goto finish
+#define FAIL(...)		{ runtime_error(__VA_ARGS__); status = -1; goto finish; }
+#define CHECK()			if (x >= ctx->guard) { SAVE(); status = context_check(ctx); goto finish; }
+#define CHECK_PC()		if ((unsigned)pc >= (unsigned)vm->code) goto outside
+#define CHECK_FRAME()	if (l <= ctx->bottom || l >= ctx->heap) goto frame_outside
+
+#define DSP(displ)		((displ) < 0 ? globals - (displ) : l + (displ))
+#define WRAP(value)		((int)(unsigned)(value))
+
+#define CHECK_DIVISOR(operation, value) \
+	if (((operation) == LDIV || (operation) == LREM) && (value) == 0) FAIL(zero_division)
+
+#ifdef DIRECT_THREADING
+	// Коды раскрываются до чисел, поэтому метки именуются по значению кода
+	#define LABEL(code)				LABEL_(code)
+	#define LABEL_(code)			op_##code
+	#define INSTRUCTION(code)		LABEL(code):
+	#define NAMED_INSTRUCTION(code, name)	op_##name:
+	#define DISPATCH()				goto *threaded[pc++]
+	#define TRANSLATE(code)			case code: vm->threaded[i] = &&LABEL(code); break;
+	#define TRANSLATE_NAMED(code, name)	case code: vm->threaded[i] = &&op_##name; break;
+
+	if (vm->threaded == NULL)
+	{
+		// Перевод кода в шитый: в каждой ячейке адрес обработчика её значения,
+		// за концом кода запас на операнды последней команды
+		vm->threaded = malloc((size_t)(vm->code + CODE_PADDING) * sizeof(void *));
+		if (vm->threaded == NULL)
+		{
+			FAIL(no_memory);
+		}
+
+		for (int i = vm->code; i < vm->code + CODE_PADDING; i++)
+		{
+			vm->threaded[i] = &&op_outside;
+		}
+
+		for (int i = 0; i < vm->code; i++)
+		{
+			switch (mem[i])
+			{
+				INSTRUCTIONS(TRANSLATE)
+				NAMED_INSTRUCTIONS(TRANSLATE_NAMED)
+				default:
+					vm->threaded[i] = &&op_unknown;
+					break;
+			}
+
+			if (branch_outside(vm, i))
+			{
+				// Адреса переходов постоянны, поэтому проверяются один раз
+				vm->threaded[i] = &&op_outside;
+			}
+		}
+	}
+
+	const void *const *const threaded = vm->threaded;
+	CHECK_PC();
+	DISPATCH();
+#else
+	#define INSTRUCTION(code)		case code:
+	#define NAMED_INSTRUCTION(code, name)	case code:
+	#define DISPATCH()				continue
+
+	for (;;)
+	{
+		CHECK_PC();
+
+		switch (mem[pc++])
+		{
+#endif
+
+
+#define INT_ASSIGNMENT(code, operation) \
+	INSTRUCTION(code) \
+	{ \
+		const int displ = mem[pc++]; \
+		int *const target = &mem[DSP(displ)]; \
+		CHECK_DIVISOR(operation, mem[x]); \
+		mem[x] = *target = int_operation(operation, *target, mem[x]); \
+	} \
+	DISPATCH();
+
+#define INT_ASSIGNMENT_AT(code, operation) \
+	INSTRUCTION(code) \
+	{ \
+		int *const target = &mem[mem[x - 1]]; \
+		CHECK_DIVISOR(operation, mem[x]); \
+		x--; \
+		mem[x] = *target = int_operation(operation, *target, mem[x + 1]); \
+	} \
+	DISPATCH();
+
+#define INT_ASSIGNMENT_V(code, operation) \
+	INSTRUCTION(code) \
+	{ \
+		const int displ = mem[pc++]; \
+		int *const target = &mem[DSP(displ)]; \
+		CHECK_DIVISOR(operation, mem[x]); \
+		*target = int_operation(operation, *target, mem[x]); \
+		x--; \
+	} \
+	DISPATCH();
+
+#define INT_ASSIGNMENT_ATV(code, operation) \
+	INSTRUCTION(code) \
+	{ \
+		int *const target = &mem[mem[x - 1]]; \
+		CHECK_DIVISOR(operation, mem[x]); \
+		*target = int_operation(operation, *target, mem[x]); \
+		x -= 2; \
+	} \
+	DISPATCH();
+
+#define INT_ASSIGNMENTS(suffix, assignment) \
+	assignment(REM##suffix, LREM) \
+	assignment(SHL##suffix, LSHL) \
+	assignment(SHR##suffix, LSHR) \
+	assignment(AND##suffix, LAND) \
+	assignment(EXOR##suffix, LEXOR) \
+	assignment(OR##suffix, LOR) \
+	assignment(suffix, ASS) \
+	assignment(PLUS##suffix, LPLUS) \
+	assignment(MINUS##suffix, LMINUS) \
+	assignment(MULT##suffix, LMULT) \
+	assignment(DIV##suffix, LDIV)
+
+	INT_ASSIGNMENTS(ASS, INT_ASSIGNMENT)
+	INT_ASSIGNMENTS(ASSAT, INT_ASSIGNMENT_AT)
+	INT_ASSIGNMENTS(ASSV, INT_ASSIGNMENT_V)
+	INT_ASSIGNMENTS(ASSATV, INT_ASSIGNMENT_ATV)
+
+
+#define DOUBLE_ASSIGNMENT(code, operation, is_address, is_void) \
+	INSTRUCTION(code) \
+	{ \
+		const int displ = is_address ? 0 : mem[pc]; \
+		pc += !is_address; \
+		int *const target = is_address ? &mem[mem[x - 2]] : &mem[DSP(displ)]; \
+		const double value = double_get(&mem[x - 1]); \
+		if ((operation) == LDIV && value == 0) FAIL(zero_division); \
+		const double result = double_operation(operation, double_get(target), value); \
+		double_set(target, result); \
+		x -= is_address ? 3 : 2; \
+		if (!is_void) \
+		{ \
+			double_set(&mem[x + 1], result); \
+			x += 2; \
+		} \
+	} \
+	DISPATCH();
+
+#define DOUBLE_ASSIGNMENTS(suffix, is_address, is_void) \
+	DOUBLE_ASSIGNMENT(suffix, ASS, is_address, is_void) \
+	DOUBLE_ASSIGNMENT(PLUS##suffix, LPLUS, is_address, is_void) \
+	DOUBLE_ASSIGNMENT(MINUS##suffix, LMINUS, is_address, is_void) \
+	DOUBLE_ASSIGNMENT(MULT##suffix, LMULT, is_address, is_void) \
+	DOUBLE_ASSIGNMENT(DIV##suffix, LDIV, is_address, is_void)
+
+	DOUBLE_ASSIGNMENTS(ASSR, 0, 0)
+	DOUBLE_ASSIGNMENTS(ASSATR, 1, 0)
+	DOUBLE_ASSIGNMENTS(ASSRV, 0, 1)
+	DOUBLE_ASSIGNMENTS(ASSATRV, 1, 1)
+
+
+#define INT_INCREMENT(code, delta, is_postfix, is_address, is_void) \
+	INSTRUCTION(code) \
+	{ \
+		const int displ = is_address ? 0 : mem[pc]; \
+		pc += !is_address; \
+		int *const target = is_address ? &mem[mem[x]] : &mem[DSP(displ)]; \
+		const int old = *target; \
+		*target = WRAP((unsigned)old + (unsigned)(delta)); \
+		x -= is_address; \
+		if (!is_void) \
+		{ \
+			mem[++x] = is_postfix ? old : *target; \
+		} \
+	} \
+	DISPATCH();
+
+#define INT_INCREMENTS(suffix, is_address, is_void) \
+	INT_INCREMENT(POSTINC##suffix, 1, 1, is_address, is_void) \
+	INT_INCREMENT(POSTDEC##suffix, -1, 1, is_address, is_void) \
+	INT_INCREMENT(INC##suffix, 1, 0, is_address, is_void) \
+	INT_INCREMENT(DEC##suffix, -1, 0, is_address, is_void)
+
+	INT_INCREMENTS(, 0, 0)
+	INT_INCREMENTS(AT, 1, 0)
+	INT_INCREMENTS(V, 0, 1)
+	INT_INCREMENTS(ATV, 1, 1)
+
+
+#define DOUBLE_INCREMENT(code, delta, is_postfix, is_address, is_void) \
+	INSTRUCTION(code) \
+	{ \
+		const int displ = is_address ? 0 : mem[pc]; \
+		pc += !is_address; \
+		int *const target = is_address ? &mem[mem[x]] : &mem[DSP(displ)]; \
+		const double old = double_get(target); \
+		double_set(target, old + (delta)); \
+		x -= is_address; \
+		if (!is_void) \
+		{ \
+			double_set(&mem[x + 1], is_postfix ? old : old + (delta)); \
+			x += 2; \
+		} \
+	} \
+	DISPATCH();
+
+#define DOUBLE_INCREMENTS(suffix, is_address, is_void) \
+	DOUBLE_INCREMENT(POSTINC##suffix, 1.0, 1, is_address, is_void) \
+	DOUBLE_INCREMENT(POSTDEC##suffix, -1.0, 1, is_address, is_void) \
+	DOUBLE_INCREMENT(INC##suffix, 1.0, 0, is_address, is_void) \
+	DOUBLE_INCREMENT(DEC##suffix, -1.0, 0, is_address, is_void)
+
+	DOUBLE_INCREMENTS(R, 0, 0)
+	DOUBLE_INCREMENTS(ATR, 1, 0)
+	DOUBLE_INCREMENTS(RV, 0, 1)
+	DOUBLE_INCREMENTS(ATRV, 1, 1)
+
+
+#define INT_BINARY(code) \
+	INSTRUCTION(code) \
+	{ \
+		x--; \
+		CHECK_DIVISOR(code, mem[x + 1]); \
+		mem[x] = int_operation(code, mem[x], mem[x + 1]); \
+	} \
+	DISPATCH();
+
+	INT_BINARY(LREM)
+	INT_BINARY(LSHL)
+	INT_BINARY(LSHR)
+	INT_BINARY(LAND)
+	INT_BINARY(LEXOR)
+	INT_BINARY(LOR)
+	INT_BINARY(LOGAND)
+	INT_BINARY(LOGOR)
+	INT_BINARY(EQEQ)
+	INT_BINARY(NOTEQ)
+	INT_BINARY(LLT)
+	INT_BINARY(LGT)
+	INT_BINARY(LLE)
+	INT_BINARY(LGE)
+	INT_BINARY(LPLUS)
+	INT_BINARY(LMINUS)
+	INT_BINARY(LMULT)
+	INT_BINARY(LDIV)
+
+	INSTRUCTION(UNMINUS)
+	{
+		mem[x] = WRAP(0u - (unsigned)mem[x]);
+	}
+	DISPATCH();
+
+	INSTRUCTION(LNOT)
+	{
+		mem[x] = ~mem[x];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LOGNOT)
+	{
+		mem[x] = !mem[x];
+	}
+	DISPATCH();
+
+
+#define DOUBLE_BINARY(code, operation) \
+	INSTRUCTION(code) \
+	{ \
+		x -= 2; \
+		const double value = double_get(&mem[x + 1]); \
+		if ((operation) == LDIV && value == 0) FAIL(zero_division); \
+		double_set(&mem[x - 1], double_operation(operation, double_get(&mem[x - 1]), value)); \
+	} \
+	DISPATCH();
+
+#define DOUBLE_COMPARISON(code, operator) \
+	INSTRUCTION(code) \
+	{ \
+		x -= 3; \
+		mem[x] = double_get(&mem[x]) operator double_get(&mem[x + 2]); \
+	} \
+	DISPATCH();
+
+	DOUBLE_BINARY(LPLUSR, LPLUS)
+	DOUBLE_BINARY(LMINUSR, LMINUS)
+	DOUBLE_BINARY(LMULTR, LMULT)
+	DOUBLE_BINARY(LDIVR, LDIV)
+
+	DOUBLE_COMPARISON(EQEQR, ==)
+	DOUBLE_COMPARISON(NOTEQR, !=)
+	DOUBLE_COMPARISON(LLTR, <)
+	DOUBLE_COMPARISON(LGTR, >)
+	DOUBLE_COMPARISON(LLER, <=)
+	DOUBLE_COMPARISON(LGER, >=)
+
+	INSTRUCTION(UNMINUSR)
+	{
+		double_set(&mem[x - 1], -double_get(&mem[x - 1]));
+	}
+	DISPATCH();
+
+
+	INSTRUCTION(COPY00)
+	{
+		const int fst = mem[pc];
+		const int snd = mem[pc + 1];
+		memmove(&mem[DSP(fst)], &mem[DSP(snd)], (size_t)mem[pc + 2] * sizeof(int));
+		pc += 3;
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPY01)
+	{
+		const int displ = mem[pc];
+		memmove(&mem[DSP(displ)], &mem[mem[x--]], (size_t)mem[pc + 1] * sizeof(int));
+		pc += 2;
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPY10)
+	{
+		const int displ = mem[pc];
+		memmove(&mem[mem[x--]], &mem[DSP(displ)], (size_t)mem[pc + 1] * sizeof(int));
+		pc += 2;
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPY11)
+	{
+		memmove(&mem[mem[x - 1]], &mem[mem[x]], (size_t)mem[pc++] * sizeof(int));
+		x -= 2;
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPY0ST)
+	{
+		const int displ = mem[pc];
+		const int length = mem[pc + 1];
+		pc += 2;
+
+		INVOKE(stack_reserve(ctx, length));
+		memcpy(&mem[x + 1], &mem[DSP(displ)], (size_t)length * sizeof(int));
+		x += length;
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPY1ST)
+	{
+		const int length = mem[pc++];
+
+		INVOKE(stack_reserve(ctx, length));
+		memmove(&mem[x], &mem[mem[x]], (size_t)length * sizeof(int));
+		x += length - 1;
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPY0STASS)
+	{
+		const int displ = mem[pc];
+		const int length = mem[pc + 1];
+		pc += 2;
+
+		x -= length;
+		memcpy(&mem[DSP(displ)], &mem[x + 1], (size_t)length * sizeof(int));
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPY1STASS)
+	{
+		const int length = mem[pc++];
+
+		x -= length;
+		memmove(&mem[mem[x]], &mem[x + 1], (size_t)length * sizeof(int));
+		x--;
+	}
+	DISPATCH();
+
+	INSTRUCTION(COPYST)
+	{
+		// На стеке остаётся только выбранное поле структуры
+		const int displ = mem[pc];
+		const int length = mem[pc + 1];
+		const int struct_length = mem[pc + 2];
+		pc += 3;
+
+		x -= struct_length;
+		memmove(&mem[x + 1], &mem[x + 1 + displ], (size_t)length * sizeof(int));
+		x += length;
+	}
+	DISPATCH();
+
+
+	INSTRUCTION(NOP)
+	DISPATCH();
+
+	INSTRUCTION(LI)
+	{
+		mem[++x] = mem[pc++];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LID)
+	{
+		mem[++x] = mem[pc++];
+		mem[++x] = mem[pc++];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LOAD)
+	{
+		const int displ = mem[pc++];
+		mem[++x] = mem[DSP(displ)];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LOADD)
+	{
+		const int displ = mem[pc++];
+		const int address = DSP(displ);
+		mem[++x] = mem[address];
+		mem[++x] = mem[address + 1];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LA)
+	{
+		const int displ = mem[pc++];
+		mem[++x] = DSP(displ);
+	}
+	DISPATCH();
+
+	INSTRUCTION(LAT)
+	{
+		mem[x] = mem[mem[x]];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LATD)
+	{
+		const int address = mem[x];
+		mem[x] = mem[address];
+		mem[++x] = mem[address + 1];
+	}
+	DISPATCH();
+
+	INSTRUCTION(SELECT)
+	{
+		mem[x] += mem[pc++];
+	}
+	DISPATCH();
+
+#define CHECK_INDEX(array, index) \
+	if ((array) <= 0) FAIL(index_out_of_range, index, 0); \
+	if ((unsigned)(index) >= (unsigned)mem[(array) - 1]) FAIL(index_out_of_range, index, mem[(array) - 1])
+
+	INSTRUCTION(SLICE)
+	{
+		const int size = mem[pc++];
+		const int index = mem[x--];
+		const int array = mem[x];
+
+		CHECK_INDEX(array, index);
+		mem[x] = array + index * size;
+	}
+	DISPATCH();
+
+	INSTRUCTION(WIDEN)
+	{
+		double_set(&mem[x], (double)mem[x]);
+		x++;
+	}
+	DISPATCH();
+
+	INSTRUCTION(WIDEN1)
+	{
+		// Расширяется целое под вещественным на вершине стека
+		const double value = double_get(&mem[x - 1]);
+		double_set(&mem[x - 2], (double)mem[x - 2]);
+		double_set(&mem[x], value);
+		x++;
+	}
+	DISPATCH();
+
+	INSTRUCTION(_DOUBLE)
+	{
+		mem[x + 1] = mem[x];
+		x++;
+	}
+	DISPATCH();
+
+	INSTRUCTION(B)
+	{
+		pc = mem[pc];
+		CHECK();
+	}
+	DISPATCH();
+
+	INSTRUCTION(BE0)
+	{
+		pc = mem[x--] ? pc + 1 : mem[pc];
+		CHECK();
+	}
+	DISPATCH();
+
+	INSTRUCTION(BNE0)
+	{
+		pc = mem[x--] ? mem[pc] : pc + 1;
+		CHECK();
+	}
+	DISPATCH();
+
+
+	// Суперинструкции выполняют пару команд за одну диспетчеризацию
+	INSTRUCTION(LOADSLICE)
+	{
+		const int displ = mem[pc++];
+		const int size = mem[pc++];
+		const int index = mem[DSP(displ)];
+		const int array = mem[x];
+
+		CHECK_INDEX(array, index);
+		mem[x] = array + index * size;
+	}
+	DISPATCH();
+
+	INSTRUCTION(SLICELAT)
+	{
+		const int size = mem[pc++];
+		const int index = mem[x--];
+		const int array = mem[x];
+
+		CHECK_INDEX(array, index);
+		mem[x] = mem[array + index * size];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LOADLOAD)
+	{
+		const int fst = mem[pc++];
+		const int snd = mem[pc++];
+		mem[++x] = mem[DSP(fst)];
+		mem[++x] = mem[DSP(snd)];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LOADLI)
+	{
+		const int displ = mem[pc++];
+		mem[++x] = mem[DSP(displ)];
+		mem[++x] = mem[pc++];
+	}
+	DISPATCH();
+
+	INSTRUCTION(LIASSV)
+	{
+		const int value = mem[pc++];
+		const int displ = mem[pc++];
+		mem[DSP(displ)] = value;
+	}
+	DISPATCH();
+
+	INSTRUCTION(LIASSATV)
+	{
+		mem[mem[x--]] = mem[pc++];
+	}
+	DISPATCH();
+
+#define INT_COMPARISON_BRANCH(code, operation) \
+	INSTRUCTION(code) \
+	{ \
+		x -= 2; \
+		pc = int_operation(operation, mem[x + 1], mem[x + 2]) ? pc + 1 : mem[pc]; \
+		CHECK(); \
+	} \
+	DISPATCH();
+
+	INT_COMPARISON_BRANCH(EQEQBE0, EQEQ)
+	INT_COMPARISON_BRANCH(NOTEQBE0, NOTEQ)
+	INT_COMPARISON_BRANCH(LLTBE0, LLT)
+	INT_COMPARISON_BRANCH(LGTBE0, LGT)
+	INT_COMPARISON_BRANCH(LLEBE0, LLE)
+	INT_COMPARISON_BRANCH(LGEBE0, LGE)
+
+	INSTRUCTION(FUNCBEG)
+	{
+		pc = mem[pc + 1];
+	}
+	DISPATCH();
+
+	INSTRUCTION(CALL1)
+	{
+		mem[x + 2] = call;
+		call = x + 1;
+		x += FRAME_SIZE;
+	}
+	DISPATCH();
+
+	INSTRUCTION(CALL2)
+	{
+		const int displ = mem[pc++];
+		const int function = displ > 0 ? displ : mem[l - displ];
+		if (function < 0 || function >= vm->functions_size || functions[function] <= 0
+			|| functions[function] + 3 >= vm->code)
+		{
+			FAIL(undefined_function, function);
+		}
+
+		const int entry = functions[function];
+		const int frame = call;
+		call = mem[frame + 1];
+
+		mem[frame] = l;
+		mem[frame + 2] = pc;
+		l = frame;
+
+		const int top = l + mem[entry + 1] - 1;
+		if (top >= ctx->guard)
+		{
+			SAVE();
+			status = context_check(ctx);
+			goto finish;
+		}
+		if (top < l + FRAME_SIZE - 1)
+		{
+			goto frame_outside;
+		}
+
+		if (top > x)
+		{
+			memset(&mem[x + 1], 0, (size_t)(top - x) * sizeof(int));
+		}
+		x = top;
+		pc = entry + 3;
+	}
+	DISPATCH();
+
+	INSTRUCTION(RETURNVAL)
+	{
+		CHECK_FRAME();
+		const int size = mem[pc];
+		const int frame = l;
+		if (size < 0 || x - size < ctx->bottom)
+		{
+			goto frame_outside;
+		}
+
+		pc = mem[frame + 2];
+		l = mem[frame];
+		memmove(&mem[frame], &mem[x - size + 1], (size_t)size * sizeof(int));
+		x = frame + size - 1;
+		CHECK_PC();
+	}
+	DISPATCH();
+
+	INSTRUCTION(RETURNVOID)
+	{
+		CHECK_FRAME();
+		pc = mem[l + 2];
+		x = l - 1;
+		l = mem[l];
+		CHECK_PC();
+	}
+	DISPATCH();
+
+	INSTRUCTION(STOP)
+	{
+		status = 0;
+		goto finish;
+	}
+
+	INSTRUCTION(DEFARR)
+	{
+		const int *const operands = &mem[pc];
+		pc += 7;
+		INVOKE(array_declare(ctx, operands));
+	}
+	DISPATCH();
+
+	INSTRUCTION(BEGINIT)
+	{
+		mem[++x] = mem[pc++];
+	}
+	DISPATCH();
+
+	INSTRUCTION(ARRINIT)
+	{
+		const int *const operands = &mem[pc];
+		pc += 4;
+		INVOKE(array_initialize(ctx, operands));
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRUCTWITHARR)
+	{
+		const int displ = mem[pc];
+		const int procedure = mem[pc + 1];
+		const int base = ctx->base != 0 ? ctx->base + displ : DSP(displ);
+		pc += 2;
+		INVOKE(procedure_execute(ctx, procedure, base));
+	}
+	DISPATCH();
+
+	INSTRUCTION(ROWING)
+	{
+		SAVE();
+		const int block = heap_allocate(ctx, 2);
+		if (block == 0)
+		{
+			status = context_check(ctx);
+			goto finish;
+		}
+
+		mem[block] = 1;
+		mem[block + 1] = mem[x];
+		mem[x] = block + 1;
+	}
+	DISPATCH();
+
+	INSTRUCTION(ROWINGD)
+	{
+		SAVE();
+		const int block = heap_allocate(ctx, 3);
+		if (block == 0)
+		{
+			status = context_check(ctx);
+			goto finish;
+		}
+
+		mem[block] = 1;
+		mem[block + 1] = mem[x - 1];
+		mem[block + 2] = mem[x];
+		mem[--x] = block + 1;
+	}
+	DISPATCH();
+
+
+	NAMED_INSTRUCTION(PRINT, print)
+	{
+		const int mode = mem[pc++];
+		x -= size_of(vm, mode);
+		print_value(vm, &mem[x + 1], mode);
+	}
+	DISPATCH();
+
+	NAMED_INSTRUCTION(PRINTID, printid)
+	{
+		SAVE();
+		print_identifier(ctx, mem[pc++]);
+	}
+	DISPATCH();
+
+	NAMED_INSTRUCTION(PRINTF, printf)
+	{
+		const int size = mem[pc++];
+		const int format = mem[x--];
+		x -= size;
+		print_format(vm, &mem[x + 1], format);
+	}
+	DISPATCH();
+
+	NAMED_INSTRUCTION(GETID, getid)
+	{
+		SAVE();
+		const int id = mem[pc++];
+		const int mode = (int)vector_get(&vm->img.identifiers, (size_t)id + 2);
+		if (scan_value(vm, &mem[identifier_displ(ctx, id)], mode))
+		{
+			FAIL(wrong_input);
+		}
+	}
+	DISPATCH();
+
+
+	INSTRUCTION(ABSIC)
+	{
+		mem[x] = mem[x] < 0 ? WRAP(0u - (unsigned)mem[x]) : mem[x];
+	}
+	DISPATCH();
+
+	INSTRUCTION(ABSC)
+	{
+		double_set(&mem[x - 1], fabs(double_get(&mem[x - 1])));
+	}
+	DISPATCH();
+
+	INSTRUCTION(SQRTC)
+	{
+		const double value = double_get(&mem[x - 1]);
+		if (value < 0)
+		{
+			FAIL(wrong_function_argument, "sqrt", value);
+		}
+		double_set(&mem[x - 1], sqrt(value));
+	}
+	DISPATCH();
+
+	INSTRUCTION(EXPC)
+	{
+		double_set(&mem[x - 1], exp(double_get(&mem[x - 1])));
+	}
+	DISPATCH();
+
+	INSTRUCTION(SINC)
+	{
+		double_set(&mem[x - 1], sin(double_get(&mem[x - 1])));
+	}
+	DISPATCH();
+
+	INSTRUCTION(COSC)
+	{
+		double_set(&mem[x - 1], cos(double_get(&mem[x - 1])));
+	}
+	DISPATCH();
+
+	INSTRUCTION(LOGC)
+	{
+		const double value = double_get(&mem[x - 1]);
+		if (value <= 0)
+		{
+			FAIL(wrong_function_argument, "log", value);
+		}
+		double_set(&mem[x - 1], log(value));
+	}
+	DISPATCH();
+
+	INSTRUCTION(LOG10C)
+	{
+		const double value = double_get(&mem[x - 1]);
+		if (value <= 0)
+		{
+			FAIL(wrong_function_argument, "log10", value);
+		}
+		double_set(&mem[x - 1], log10(value));
+	}
+	DISPATCH();
+
+	INSTRUCTION(ASINC)
+	{
+		const double value = double_get(&mem[x - 1]);
+		if (value < -1 || value > 1)
+		{
+			FAIL(wrong_function_argument, "asin", value);
+		}
+		double_set(&mem[x - 1], asin(value));
+	}
+	DISPATCH();
+
+	INSTRUCTION(RANDC)
+	{
+		double_set(&mem[x + 1], (double)rand() / ((double)RAND_MAX + 1));
+		x += 2;
+	}
+	DISPATCH();
+
+	INSTRUCTION(ROUNDC)
+	{
+		const double value = round(double_get(&mem[x - 1]));
+		if (!(value >= INT_MIN && value <= INT_MAX))
+		{
+			FAIL(rounding_overflow, value);
+		}
+		mem[--x] = (int)value;
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRCPYC)
+	{
+		x -= 2;
+		INVOKE(string_copy(ctx, mem[x + 1], mem[x + 2], -1, 0));
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRNCPYC)
+	{
+		x -= 3;
+		INVOKE(string_copy(ctx, mem[x + 1], mem[x + 2], mem[x + 3], 0));
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRCATC)
+	{
+		x -= 2;
+		INVOKE(string_copy(ctx, mem[x + 1], mem[x + 2], -1, 1));
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRNCATC)
+	{
+		x -= 3;
+		INVOKE(string_copy(ctx, mem[x + 1], mem[x + 2], mem[x + 3], 1));
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRCMPC)
+	{
+		x--;
+		mem[x] = string_compare(mem, mem[x], mem[x + 1], -1);
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRNCMPC)
+	{
+		x -= 2;
+		mem[x] = string_compare(mem, mem[x], mem[x + 1], mem[x + 2]);
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRSTRC)
+	{
+		x--;
+		mem[x] = string_find(mem, mem[x], mem[x + 1]);
+	}
+	DISPATCH();
+
+	INSTRUCTION(STRLENC)
+	{
+		mem[x] = string_length(mem, mem[x]);
+	}
+	DISPATCH();
+
+	INSTRUCTION(UPBC)
+	{
+		int array = mem[x--];
+		const int dimension = mem[x];
+
+		for (int i = 0; i < dimension && array > 0 && mem[array - 1] > 0; i++)
+		{
+			array = mem[array];
+		}
+
+		if (dimension < 0 || array <= 0)
+		{
+			FAIL(wrong_dimension, dimension);
+		}
+		mem[x] = mem[array - 1];
+	}
+	DISPATCH();
+
+	INSTRUCTION(ASSERTC)
+	{
+		const int string = mem[x--];
+		if (!mem[x--])
+		{
+			char buffer[MAX_STRING_SIZE];
+			string_to_buffer(mem, string, buffer);
+			FAIL(assertion_failed, buffer);
+		}
+	}
+	DISPATCH();
+
+
+	INSTRUCTION(CREATEDIRECTC)
+	{
+		INVOKE(thread_create_direct(ctx));
+	}
+	DISPATCH();
+
+	INSTRUCTION(EXITC)
+	{
+		status = 0;
+		goto finish;
+	}
+
+	INSTRUCTION(CREATEC)
+	{
+		const int function = mem[x--];
+		INVOKE(thread_create(ctx, function));
+	}
+	DISPATCH();
+
+	INSTRUCTION(JOINC)
+	{
+		const int number = mem[x--];
+		SAVE();
+		if (number < 0 || threads_join(&vm->ths, (size_t)number))
+		{
+			FAIL(wrong_thread, number);
+		}
+
+		if (threads_is_halted(&vm->ths))
+		{
+			status = 1;
+			goto finish;
+		}
+	}
+	DISPATCH();
+
+	INSTRUCTION(SLEEPC)
+	{
+		threads_sleep(mem[x--]);
+	}
+	DISPATCH();
+
+	INSTRUCTION(SEMCREATEC)
+	{
+		mem[x] = threads_sem_create(&vm->ths, mem[x]);
+		if (mem[x] < 0)
+		{
+			FAIL(no_memory);
+		}
+	}
+	DISPATCH();
+
+	INSTRUCTION(SEMWAITC)
+	{
+		const int number = mem[x--];
+		SAVE();
+		status = threads_sem_wait(&vm->ths, number);
+		if (status < 0)
+		{
+			FAIL(wrong_semaphore, number);
+		}
+		else if (status > 0)
+		{
+			goto finish;
+		}
+	}
+	DISPATCH();
+
+	INSTRUCTION(SEMPOSTC)
+	{
+		const int number = mem[x--];
+		if (threads_sem_post(&vm->ths, number))
+		{
+			FAIL(wrong_semaphore, number);
+		}
+	}
+	DISPATCH();
+
+	INSTRUCTION(MSGSENDC)
+	{
+		x -= 2;
+		if (threads_msg_send(&vm->ths, ctx->number, mem[x + 1], mem[x + 2]))
+		{
+			FAIL(wrong_thread, mem[x + 1]);
+		}
+	}
+	DISPATCH();
+
+	INSTRUCTION(MSGRECEIVEC)
+	{
+		SAVE();
+		status = threads_msg_receive(&vm->ths, (size_t)ctx->number, &mem[x + 1], &mem[x + 2]);
+		if (status != 0)
+		{
+			goto finish;
+		}
+		x += 2;
+	}
+	DISPATCH();
+
+	INSTRUCTION(GETNUMC)
+	{
+		mem[++x] = ctx->number;
+	}
+	DISPATCH();
+
+	INSTRUCTION(INITC)
+	INSTRUCTION(DESTROYC)
+	DISPATCH();
+
+
+	// Функции роботов и дисплея интерпретатором не поддерживаются
+	INSTRUCTION(SETMOTORC)
+	INSTRUCTION(GETDIGSENSORC)
+	INSTRUCTION(GETANSENSORC)
+	INSTRUCTION(VOLTAGEC)
+	INSTRUCTION(WIFI_CONNECTC)
+	INSTRUCTION(BLYNK_AUTHORIZATIONC)
+	INSTRUCTION(BLYNK_SENDC)
+	INSTRUCTION(BLYNK_RECEIVEC)
+	INSTRUCTION(BLYNK_NOTIFICATIONC)
+	INSTRUCTION(BLYNK_PROPERTYC)
+	INSTRUCTION(BLYNK_LCDC)
+	INSTRUCTION(BLYNK_TERMINALC)
+	INSTRUCTION(SETSIGNALC)
+	INSTRUCTION(PIXELC)
+	INSTRUCTION(LINEC)
+	INSTRUCTION(RECTANGLEC)
+	INSTRUCTION(ELLIPSEC)
+	INSTRUCTION(CLEARC)
+	INSTRUCTION(DRAW_STRINGC)
+	INSTRUCTION(DRAW_NUMBERC)
+	INSTRUCTION(ICONC)
+	INSTRUCTION(SEND_INTC)
+	INSTRUCTION(SEND_FLOATC)
+	INSTRUCTION(SEND_STRINGC)
+	INSTRUCTION(RECEIVE_INTC)
+	INSTRUCTION(RECEIVE_FLOATC)
+	INSTRUCTION(RECEIVE_STRINGC)
+	{
+		FAIL(unsupported_function, mem[pc - 1]);
+	}
+
+
+#ifdef DIRECT_THREADING
+	op_outside:
+	pc--;
+#endif
+	outside:
+	FAIL(wrong_address, pc);
+
+	frame_outside:
+	FAIL(wrong_stack);
+
+
+#ifdef DIRECT_THREADING
+	op_unknown:
+#else
+			default:
+				break;
+		}
+#endif
+	FAIL(unknown_instruction, mem[pc - 1], pc - 1);
+
+#ifndef DIRECT_THREADING
+	}
+#endif
+
+finish:
+	SAVE();
+	if (status < 0)
+	{
+		machine_fail(vm);
+	}
+	return status;
+}
+
+
+static int machine_init(machine *const vm, const char *const path)
+{
+	if (image_load(&vm->img, path))
+	{
+		runtime_error(wrong_image, path);
+		return -1;
+	}
+
+	const size_t code = vector_size(&vm->img.memory);
+	const size_t functions = vector_size(&vm->img.functions);
+	const size_t margin = 2 * code + vector_size(&vm->img.modes) + STACK_MARGIN;
+	const size_t size = code + vm->img.max_displg + FRAME_SIZE + MAIN_STACK_SIZE
+		+ (THREADS_MAX - 1) * (size_t)THREAD_STACK_SIZE + THREADS_MAX * margin;
+
+	if (code <= CODE_BEGIN || size > INT_MAX
+		|| vector_get(&vm->img.memory, code - 1) != STOP || functions > INT_MAX)
+	{
+		runtime_error(wrong_image, path);
+		image_clear(&vm->img);
+		return -1;
+	}
+
+	vm->memory = calloc(size, sizeof(int));
+	vm->functions = malloc((functions + 1) * sizeof(int));
+	if (vm->memory == NULL || vm->functions == NULL || threads_init(&vm->ths))
+	{
+		runtime_error(no_memory);
+		free(vm->memory);
+		free(vm->functions);
+		image_clear(&vm->img);
+		return -1;
+	}
+
+	for (size_t i = 0; i < code; i++)
+	{
+		vm->memory[i] = (int)vector_get(&vm->img.memory, i);
+	}
+
+	for (size_t i = 0; i < functions; i++)
+	{
+		vm->functions[i] = (int)vector_get(&vm->img.functions, i);
+	}
+
+	vm->size = size;
+	vm->code = (int)code;
+	vm->globals = (int)code;
+	vm->margin = (int)margin;
+	vm->functions_size = (int)functions;
+	vm->status = 0;
+
+#ifdef DIRECT_THREADING
+	vm->threaded = NULL;
+#endif
+
+	context_init(vm, 0);
+	return 0;
+}
+
+static void machine_clear(machine *const vm)
+{
+	threads_clear(&vm->ths);
+
+	free(vm->memory);
+	free(vm->functions);
+
+#ifdef DIRECT_THREADING
+	free(vm->threaded);
+#endif
+
+	image_clear(&vm->img);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int interpret(const char *const path)
+{
+	if (path == NULL)
+	{
+		return -1;
+	}
+
+	machine *const vm = malloc(sizeof(machine));
+	if (vm == NULL || machine_init(vm, path))
+	{
+		free(vm);
+		return -1;
+	}
+
+	const int ret = execute(&vm->contexts[0]);
+
+	// Главная нить завершилась, остальные нити останавливаются
+	machine_halt(vm);
+	threads_clear(&vm->ths);
+	fflush(stdout);
+
+	const int status = ret < 0 || vm->status != 0 ? -1 : 0;
+	machine_clear(vm);
+	free(vm);
+	return status;
+}
+
+int auto_interpret(const int argc, const char *const *const argv)
+{
+	return interpret(argc > 1 ? argv[1] : "out.ruc");
+}
@@ -0,0 +1,47 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include "dll.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Execute RuC virtual machine code from export file
+ *
+ *	@param	path	File path
+ *
+ *	@return	Status code
+ */
+EXPORTED int interpret(const char *const path);
+
+/**
+ *	Execute RuC virtual machine code from terminal arguments
+ *
+ *	@param	argc	Number of command line arguments
+ *	@param	argv	Command line arguments
+ *
+ *	@return	Status code
+ */
+EXPORTED int auto_interpret(const int argc, const char *const *const argv);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
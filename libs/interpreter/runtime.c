@@ -0,0 +1,165 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "runtime.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include "logger.h"
+
+
+#define MAX_MSG_SIZE 1024
+
+#define TAG_RUC_VM "ruc-vm"
+
+
+static void get_runtime_error(const runtime_t num, char *const msg, const size_t size, va_list args)
+{
+	switch (num)
+	{
+		case wrong_image:
+		{
+			const char *const path = va_arg(args, char *);
+			snprintf(msg, size, "не удалось загрузить образ виртуальной машины '%s'", path);
+		}
+		break;
+		case no_memory:
+			snprintf(msg, size, "недостаточно памяти для виртуальной машины");
+			break;
+		case unknown_instruction:
+		{
+			const int code = va_arg(args, int);
+			const int address = va_arg(args, int);
+			snprintf(msg, size, "неизвестная команда %i по адресу %i", code, address);
+		}
+		break;
+		case wrong_address:
+		{
+			const int address = va_arg(args, int);
+			snprintf(msg, size, "выход за пределы кода по адресу %i", address);
+		}
+		break;
+		case wrong_stack:
+			snprintf(msg, size, "выход за пределы стека потока");
+			break;
+		case unsupported_function:
+		{
+			const int code = va_arg(args, int);
+			snprintf(msg, size, "стандартная функция с кодом %i не поддерживается", code);
+		}
+		break;
+
+		case stack_overflow:
+			snprintf(msg, size, "переполнение стека");
+			break;
+		case undefined_function:
+		{
+			const int number = va_arg(args, int);
+			snprintf(msg, size, "вызов неописанной функции с номером %i", number);
+		}
+		break;
+		case zero_division:
+			snprintf(msg, size, "деление на ноль");
+			break;
+		case index_out_of_range:
+		{
+			const int index = va_arg(args, int);
+			const int bound = va_arg(args, int);
+			snprintf(msg, size, "индекс %i за пределами массива размера %i", index, bound);
+		}
+		break;
+		case negative_array_size:
+		{
+			const int bound = va_arg(args, int);
+			snprintf(msg, size, "отрицательный размер массива %i", bound);
+		}
+		break;
+		case initializer_too_long:
+		{
+			const int length = va_arg(args, int);
+			const int bound = va_arg(args, int);
+			snprintf(msg, size, "в инициализаторе %i элементов, а в массиве только %i", length, bound);
+		}
+		break;
+		case wrong_dimension:
+		{
+			const int dimension = va_arg(args, int);
+			snprintf(msg, size, "в upb указана несуществующая размерность %i", dimension);
+		}
+		break;
+		case wrong_function_argument:
+		{
+			const char *const function = va_arg(args, char *);
+			const double argument = va_arg(args, double);
+			snprintf(msg, size, "аргумент %f функции %s вне области определения", argument, function);
+		}
+		break;
+		case rounding_overflow:
+		{
+			const double value = va_arg(args, double);
+			snprintf(msg, size, "результат округления %f не помещается в int", value);
+		}
+		break;
+		case wrong_input:
+			snprintf(msg, size, "введённое значение не соответствует типу переменной");
+			break;
+		case assertion_failed:
+		{
+			const char *const text = va_arg(args, char *);
+			snprintf(msg, size, "%s", text);
+		}
+		break;
+
+		case too_many_threads:
+			snprintf(msg, size, "превышено допустимое число нитей");
+			break;
+		case wrong_thread:
+		{
+			const int number = va_arg(args, int);
+			snprintf(msg, size, "нить с номером %i не создана", number);
+		}
+		break;
+		case wrong_semaphore:
+		{
+			const int number = va_arg(args, int);
+			snprintf(msg, size, "семафор с номером %i не создан", number);
+		}
+		break;
+	}
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+void runtime_error(const runtime_t num, ...)
+{
+	va_list args;
+	va_start(args, num);
+
+	char msg[MAX_MSG_SIZE];
+	get_runtime_error(num, msg, MAX_MSG_SIZE, args);
+
+	va_end(args);
+
+	fflush(stdout);
+	log_system_error(TAG_RUC_VM, msg);
+}
@@ -0,0 +1,64 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Runtime errors */
+typedef enum RUNTIME
+{
+	// System errors
+	wrong_image,				/**< Image file is missing or corrupted */
+	no_memory,					/**< Not enough memory for virtual machine */
+	unknown_instruction,		/**< Unknown instruction in code */
+	wrong_address,				/**< Execution outside of code */
+	wrong_stack,				/**< Stack frame outside of current thread stack */
+	unsupported_function,		/**< Standard function is not supported by interpreter */
+
+	// Program errors
+	stack_overflow,				/**< Stack or heap overflow */
+	undefined_function,			/**< Call of undefined function */
+	zero_division,				/**< Integer or float division by zero */
+	index_out_of_range,			/**< Array index is out of range */
+	negative_array_size,		/**< Array declared with negative size */
+	initializer_too_long,		/**< Initializer is longer than array */
+	wrong_dimension,			/**< Wrong dimension in upb */
+	wrong_function_argument,	/**< Math function argument is out of domain */
+	rounding_overflow,			/**< Rounded value is out of int range */
+	wrong_input,				/**< Input does not match variable type */
+	assertion_failed,			/**< Assertion failed */
+
+	// Thread errors
+	too_many_threads,			/**< Thread limit exceeded */
+	wrong_thread,				/**< Thread is not created */
+	wrong_semaphore,			/**< Semaphore is not created */
+} runtime_t;
+
+
+/**
+ *	Emit runtime error
+ *
+ *	@param	num			Error code
+ */
+void runtime_error(const runtime_t num, ...);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
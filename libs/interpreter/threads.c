@@ -0,0 +1,349 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "threads.h"
+#include <time.h>
+
+#ifdef _MSC_VER
+	#include <windows.h>
+#endif
+
+
+/** Thread states */
+enum THREAD
+{
+	thread_free,
+	thread_reserved,
+	thread_running,
+	thread_joined,
+};
+
+
+#ifndef _MSC_VER
+
+static inline void threads_lock(threads *const ths)
+{
+	pthread_mutex_lock(&ths->mutex);
+}
+
+static inline void threads_unlock(threads *const ths)
+{
+	pthread_mutex_unlock(&ths->mutex);
+}
+
+static inline void threads_wait(threads *const ths)
+{
+	pthread_cond_wait(&ths->cond, &ths->mutex);
+}
+
+static inline void threads_notify(threads *const ths)
+{
+	pthread_cond_broadcast(&ths->cond);
+}
+
+#else
+
+// Без pthreads нити не поддерживаются, ожидание не может завершиться
+static inline void threads_lock(threads *const ths)
+{
+	(void)ths;
+}
+
+static inline void threads_unlock(threads *const ths)
+{
+	(void)ths;
+}
+
+static inline void threads_wait(threads *const ths)
+{
+	ths->halt = 1;
+}
+
+static inline void threads_notify(threads *const ths)
+{
+	(void)ths;
+}
+
+#endif
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+int threads_init(threads *const ths)
+{
+	if (ths == NULL)
+	{
+		return -1;
+	}
+
+#ifndef _MSC_VER
+	if (pthread_mutex_init(&ths->mutex, NULL))
+	{
+		return -1;
+	}
+
+	if (pthread_cond_init(&ths->cond, NULL))
+	{
+		pthread_mutex_destroy(&ths->mutex);
+		return -1;
+	}
+#endif
+
+	for (size_t i = 0; i < THREADS_MAX; i++)
+	{
+		ths->states[i] = thread_free;
+		ths->messages[i] = vector_create(0);
+		ths->heads[i] = 0;
+	}
+
+	// Нулевой номер принадлежит главной нити
+	ths->states[0] = thread_joined;
+	ths->semaphores = vector_create(0);
+	ths->halt = 0;
+
+	return 0;
+}
+
+int threads_reserve(threads *const ths)
+{
+	threads_lock(ths);
+	int number = -1;
+	for (size_t i = 1; i < THREADS_MAX && number == -1; i++)
+	{
+		if (ths->states[i] == thread_free)
+		{
+			ths->states[i] = thread_reserved;
+			number = (int)i;
+		}
+	}
+	threads_unlock(ths);
+
+	return number;
+}
+
+int threads_start(threads *const ths, const size_t number, const thread_func func, void *const arg)
+{
+	if (number >= THREADS_MAX)
+	{
+		return -1;
+	}
+
+#ifndef _MSC_VER
+	threads_lock(ths);
+	const int ret = ths->states[number] != thread_reserved || pthread_create(&ths->handles[number], NULL, func, arg);
+	if (!ret)
+	{
+		ths->states[number] = thread_running;
+	}
+	threads_unlock(ths);
+
+	return ret ? -1 : 0;
+#else
+	(void)ths;
+	(void)func;
+	(void)arg;
+	return -1;
+#endif
+}
+
+int threads_join(threads *const ths, const size_t number)
+{
+	if (number >= THREADS_MAX)
+	{
+		return -1;
+	}
+
+	threads_lock(ths);
+	const int state = ths->states[number];
+	if (state == thread_running)
+	{
+		ths->states[number] = thread_joined;
+	}
+	threads_unlock(ths);
+
+	if (state == thread_free || state == thread_reserved)
+	{
+		return -1;
+	}
+
+#ifndef _MSC_VER
+	if (state == thread_running)
+	{
+		pthread_join(ths->handles[number], NULL);
+	}
+#endif
+
+	return 0;
+}
+
+void threads_sleep(const int milliseconds)
+{
+	if (milliseconds <= 0)
+	{
+		return;
+	}
+
+#ifndef _MSC_VER
+	struct timespec time;
+	time.tv_sec = milliseconds / 1000;
+	time.tv_nsec = (long)(milliseconds % 1000) * 1000000;
+	nanosleep(&time, NULL);
+#else
+	Sleep((DWORD)milliseconds);
+#endif
+}
+
+
+int threads_sem_create(threads *const ths, const int value)
+{
+	threads_lock(ths);
+	const size_t number = vector_add(&ths->semaphores, value);
+	threads_unlock(ths);
+
+	return number == SIZE_MAX ? -1 : (int)number;
+}
+
+int threads_sem_wait(threads *const ths, const int number)
+{
+	threads_lock(ths);
+	if (number < 0 || (size_t)number >= vector_size(&ths->semaphores))
+	{
+		threads_unlock(ths);
+		return -1;
+	}
+
+	while (!ths->halt && vector_get(&ths->semaphores, (size_t)number) <= 0)
+	{
+		threads_wait(ths);
+	}
+
+	const int ret = ths->halt;
+	if (!ret)
+	{
+		vector_set(&ths->semaphores, (size_t)number, vector_get(&ths->semaphores, (size_t)number) - 1);
+	}
+	threads_unlock(ths);
+
+	return ret;
+}
+
+int threads_sem_post(threads *const ths, const int number)
+{
+	threads_lock(ths);
+	if (number < 0 || (size_t)number >= vector_size(&ths->semaphores))
+	{
+		threads_unlock(ths);
+		return -1;
+	}
+
+	vector_set(&ths->semaphores, (size_t)number, vector_get(&ths->semaphores, (size_t)number) + 1);
+	threads_notify(ths);
+	threads_unlock(ths);
+
+	return 0;
+}
+
+
+int threads_msg_send(threads *const ths, const int sender, const int receiver, const int data)
+{
+	if (receiver < 0 || receiver >= THREADS_MAX)
+	{
+		return -1;
+	}
+
+	threads_lock(ths);
+	vector_add(&ths->messages[receiver], sender);
+	vector_add(&ths->messages[receiver], data);
+	threads_notify(ths);
+	threads_unlock(ths);
+
+	return 0;
+}
+
+int threads_msg_receive(threads *const ths, const size_t receiver, int *const sender, int *const data)
+{
+	threads_lock(ths);
+	vector *const queue = &ths->messages[receiver];
+	while (!ths->halt && ths->heads[receiver] == vector_size(queue))
+	{
+		threads_wait(ths);
+	}
+
+	const int ret = ths->halt;
+	if (!ret)
+	{
+		*sender = (int)vector_get(queue, ths->heads[receiver]++);
+		*data = (int)vector_get(queue, ths->heads[receiver]++);
+
+		// Очередь опустела - начинаем её заново
+		if (ths->heads[receiver] == vector_size(queue))
+		{
+			vector_resize(queue, 0);
+			ths->heads[receiver] = 0;
+		}
+	}
+	threads_unlock(ths);
+
+	return ret;
+}
+
+
+void threads_halt(threads *const ths)
+{
+	threads_lock(ths);
+	ths->halt = 1;
+	threads_notify(ths);
+	threads_unlock(ths);
+}
+
+int threads_is_halted(threads *const ths)
+{
+	threads_lock(ths);
+	const int ret = ths->halt;
+	threads_unlock(ths);
+
+	return ret;
+}
+
+int threads_clear(threads *const ths)
+{
+	if (ths == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < THREADS_MAX; i++)
+	{
+		threads_join(ths, i);
+		vector_clear(&ths->messages[i]);
+	}
+
+	vector_clear(&ths->semaphores);
+
+#ifndef _MSC_VER
+	pthread_cond_destroy(&ths->cond);
+	pthread_mutex_destroy(&ths->mutex);
+#endif
+
+	return 0;
+}
@@ -0,0 +1,187 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "vector.h"
+
+#ifndef _MSC_VER
+	#include <pthread.h>
+#endif
+
+
+#define THREADS_MAX 32
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Thread function */
+typedef void *(*thread_func)(void *arg);
+
+/** Threads, semaphores and messages of virtual machine */
+typedef struct threads
+{
+#ifndef _MSC_VER
+	pthread_mutex_t mutex;				/**< Lock for all fields */
+	pthread_cond_t cond;				/**< Condition for all waiting operations */
+	pthread_t handles[THREADS_MAX];		/**< Thread handles */
+#endif
+
+	int states[THREADS_MAX];			/**< Thread states */
+	vector semaphores;					/**< Semaphores values */
+
+	vector messages[THREADS_MAX];		/**< Message queues, each message is sender and data */
+	size_t heads[THREADS_MAX];			/**< Message queues heads */
+
+	int halt;							/**< Set if all threads should be stopped */
+} threads;
+
+
+/**
+ *	Initialize threads structure in place, because it contains synchronization primitives
+ *
+ *	@param	ths			Threads structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int threads_init(threads *const ths);
+
+/**
+ *	Reserve number for new thread
+ *
+ *	@param	ths			Threads structure
+ *
+ *	@return	Thread number, @c -1 on failure
+ */
+int threads_reserve(threads *const ths);
+
+/**
+ *	Start new thread with reserved number
+ *
+ *	@param	ths			Threads structure
+ *	@param	number		Thread number
+ *	@param	func		Thread function
+ *	@param	arg			Thread function argument
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int threads_start(threads *const ths, const size_t number, const thread_func func, void *const arg);
+
+/**
+ *	Wait for thread to finish
+ *
+ *	@param	ths			Threads structure
+ *	@param	number		Thread number
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int threads_join(threads *const ths, const size_t number);
+
+/**
+ *	Suspend current thread
+ *
+ *	@param	milliseconds	Sleep time
+ */
+void threads_sleep(const int milliseconds);
+
+
+/**
+ *	Create new semaphore
+ *
+ *	@param	ths			Threads structure
+ *	@param	value		Initial value
+ *
+ *	@return	Semaphore number, @c -1 on failure
+ */
+int threads_sem_create(threads *const ths, const int value);
+
+/**
+ *	Decrement semaphore, wait while it is zero
+ *
+ *	@param	ths			Threads structure
+ *	@param	number		Semaphore number
+ *
+ *	@return	@c 0 on success, @c -1 on wrong semaphore, @c 1 on halt
+ */
+int threads_sem_wait(threads *const ths, const int number);
+
+/**
+ *	Increment semaphore
+ *
+ *	@param	ths			Threads structure
+ *	@param	number		Semaphore number
+ *
+ *	@return	@c 0 on success, @c -1 on wrong semaphore
+ */
+int threads_sem_post(threads *const ths, const int number);
+
+
+/**
+ *	Send message to thread
+ *
+ *	@param	ths			Threads structure
+ *	@param	sender		Sender thread number
+ *	@param	receiver	Receiver thread number
+ *	@param	data		Message data
+ *
+ *	@return	@c 0 on success, @c -1 on wrong receiver
+ */
+int threads_msg_send(threads *const ths, const int sender, const int receiver, const int data);
+
+/**
+ *	Receive message, wait while there is no one
+ *
+ *	@param	ths			Threads structure
+ *	@param	receiver	Receiver thread number
+ *	@param	sender		Sender thread number
+ *	@param	data		Message data
+ *
+ *	@return	@c 0 on success, @c 1 on halt
+ */
+int threads_msg_receive(threads *const ths, const size_t receiver, int *const sender, int *const data);
+
+
+/**
+ *	Stop waiting operations of all threads
+ *
+ *	@param	ths			Threads structure
+ */
+void threads_halt(threads *const ths);
+
+/**
+ *	Check that threads are stopping
+ *
+ *	@param	ths			Threads structure
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+int threads_is_halted(threads *const ths);
+
+/**
+ *	Wait for all threads and free allocated memory
+ *
+ *	@param	ths			Threads structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int threads_clear(threads *const ths);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
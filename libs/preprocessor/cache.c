@@ -0,0 +1,912 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "cache.h"
+#include "constants.h"
+#include "environment.h"
+#include "hash.h"
+#include "linker.h"
+#include "uniio.h"
+#include "workspace.h"
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef _MSC_VER
+	#include <pthread.h>
+#endif
+
+
+#define MAX_CACHE_PATH (MAX_ARG_SIZE + 32)
+#define MAX_CACHE_VECTOR 0x10000000
+
+/** Number of items per nested include: path, is opened, begin, end, content hash */
+#define HC_EVENT 5
+
+
+static const char *const HC_MAGIC = "RUCHC2";
+
+
+/** Scanner state after header, the next file continues from it */
+typedef struct hc_scanner
+{
+	int prep_flag;				/**< Macro substitution flag */
+	int curchar;				/**< Current character */
+	int nextchar;				/**< Next character */
+	int nextch_type;			/**< Type of characters source */
+	int nextp;					/**< Position in characters source */
+	int cur;					/**< Last keyword */
+	int error_string;			/**< Offset of current line in strings */
+} hc_scanner;
+
+/** Preprocessed header with macro state it produced */
+typedef struct hc_entry
+{
+	uint64_t key;				/**< Hash of path, content and state */
+	char path[MAX_ARG_SIZE];	/**< Header path */
+	uint64_t content;			/**< Hash of header content */
+	uint64_t state;				/**< Hash of incoming macro state */
+
+	hc_scanner scanner;			/**< Scanner state after header */
+
+	char *text;					/**< Preprocessed text */
+	size_t text_size;			/**< Size of preprocessed text */
+
+	vector macrotext;			/**< Macro text added by header */
+	vector patches;				/**< Changed macro text before header by pairs: offset, value */
+	vector names;				/**< Changed macros by pairs: name offset in strings, value */
+	vector events;				/**< Nested includes by HC_EVENT items */
+
+	char *strings;				/**< Names and paths storage */
+	size_t strings_size;		/**< Size of strings storage */
+} hc_entry;
+
+struct header_cache
+{
+	hc_entry **entries;			/**< Cached headers */
+	size_t size;				/**< Number of cached headers */
+	size_t alloc;				/**< Allocated size of entries */
+
+	hc_entry **table;			/**< Hash table of entries by key */
+	size_t table_size;			/**< Size of hash table, power of two */
+
+	char dir[MAX_ARG_SIZE];		/**< Directory to keep cache between runs, empty if none */
+
+#ifndef _MSC_VER
+	pthread_mutex_t mutex;		/**< Lock for entries */
+#endif
+};
+
+
+static uint64_t hash_file(const char *const path)
+{
+	FILE *const file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return 0;
+	}
+
+	uint64_t hash = HASH_INIT;
+	char buffer[4096];
+	size_t size;
+	while ((size = fread(buffer, 1, sizeof(buffer), file)) != 0)
+	{
+		hash = hash_bytes(hash, buffer, size);
+	}
+
+	fclose(file);
+	return hash_mix(hash);
+}
+
+/**
+ *	Hash of everything preprocessing of header depends on:
+ *	macro text, names of macros and directories to search nested includes
+ */
+static uint64_t hash_state(const environment *const env)
+{
+	uint64_t hash = hash_bytes(HASH_INIT, &env->mp, sizeof(env->mp));
+	hash = hash_bytes(hash, &env->macrotext_hash, sizeof(env->macrotext_hash));
+	hash = hash_bytes(hash, &env->prep_flag, sizeof(env->prep_flag));
+	hash = hash_bytes(hash, &env->checkif, sizeof(env->checkif));
+	hash = hash_bytes(hash, &env->macros_hash, sizeof(env->macros_hash));
+
+	const workspace *const ws = env->lk->ws;
+	const size_t dirs_num = ws_get_dirs_num(ws);
+	hash = hash_bytes(hash, &dirs_num, sizeof(dirs_num));
+	for (size_t i = 0; i < dirs_num; i++)
+	{
+		const char *const dir = ws_get_dir(ws, i);
+		hash = hash_bytes(hash, dir, strlen(dir) + 1);
+	}
+
+	return hash_mix(hash);
+}
+
+static uint64_t hash_key(const char *const path, const uint64_t content, const uint64_t state)
+{
+	uint64_t hash = hash_bytes(HASH_INIT, path, strlen(path));
+	hash = hash_bytes(hash, &content, sizeof(content));
+	hash = hash_bytes(hash, &state, sizeof(state));
+	return hash_mix(hash);
+}
+
+
+static hc_entry *entry_create()
+{
+	hc_entry *const entry = calloc(1, sizeof(hc_entry));
+	if (entry == NULL)
+	{
+		return NULL;
+	}
+
+	entry->macrotext = vector_create(0);
+	entry->patches = vector_create(0);
+	entry->names = vector_create(0);
+	entry->events = vector_create(0);
+	return entry;
+}
+
+static void entry_free(hc_entry *const entry)
+{
+	if (entry == NULL)
+	{
+		return;
+	}
+
+	free(entry->text);
+	vector_clear(&entry->macrotext);
+	vector_clear(&entry->patches);
+	vector_clear(&entry->names);
+	vector_clear(&entry->events);
+	free(entry->strings);
+	free(entry);
+}
+
+static size_t entry_add_string(hc_entry *const entry, const char *const str)
+{
+	const size_t size = strlen(str) + 1;
+	char *const strings = realloc(entry->strings, entry->strings_size + size);
+	if (strings == NULL)
+	{
+		return SIZE_MAX;
+	}
+
+	entry->strings = strings;
+	memcpy(&entry->strings[entry->strings_size], str, size);
+	entry->strings_size += size;
+	return entry->strings_size - size;
+}
+
+static const char *entry_get_string(const hc_entry *const entry, const item_t offset)
+{
+	return offset >= 0 && (size_t)offset < entry->strings_size ? &entry->strings[offset] : NULL;
+}
+
+
+static int write_data(FILE *const file, uint64_t *const checksum, const void *const data, const size_t size)
+{
+	*checksum = hash_bytes(*checksum, data, size);
+	return size == 0 || fwrite(data, 1, size, file) == size ? 0 : -1;
+}
+
+static int write_size(FILE *const file, uint64_t *const checksum, const size_t size)
+{
+	const uint64_t value = size;
+	return write_data(file, checksum, &value, sizeof(value));
+}
+
+static int write_vector(FILE *const file, uint64_t *const checksum, const vector *const vec)
+{
+	return write_size(file, checksum, vector_size(vec))
+		|| write_data(file, checksum, vec->array, vector_size(vec) * sizeof(item_t));
+}
+
+static int read_data(FILE *const file, uint64_t *const checksum, void *const data, const size_t size)
+{
+	if (size != 0 && fread(data, 1, size, file) != size)
+	{
+		return -1;
+	}
+
+	*checksum = hash_bytes(*checksum, data, size);
+	return 0;
+}
+
+static int read_size(FILE *const file, uint64_t *const checksum, size_t *const size)
+{
+	uint64_t value;
+	if (read_data(file, checksum, &value, sizeof(value)) || value > MAX_CACHE_VECTOR)
+	{
+		return -1;
+	}
+
+	*size = (size_t)value;
+	return 0;
+}
+
+static int read_vector(FILE *const file, uint64_t *const checksum, vector *const vec)
+{
+	size_t size;
+	if (read_size(file, checksum, &size) || vector_resize(vec, size))
+	{
+		return -1;
+	}
+
+	return read_data(file, checksum, vec->array, size * sizeof(item_t));
+}
+
+static void cache_make_path(const header_cache *const hc, const uint64_t key, char *const buffer)
+{
+	sprintf(buffer, "%s/%016" PRIx64 ".hc", hc->dir, key);
+}
+
+/** Save entry to cache directory, write errors are ignored as cache is optional */
+static void cache_save(const header_cache *const hc, const hc_entry *const entry)
+{
+	char path[MAX_CACHE_PATH];
+	char temp[MAX_CACHE_PATH + 4];
+	cache_make_path(hc, entry->key, path);
+	sprintf(temp, "%s.tmp", path);
+
+	FILE *const file = fopen(temp, "wb");
+	if (file == NULL)
+	{
+		return;
+	}
+
+	uint64_t checksum = HASH_INIT;
+	const int ret = write_data(file, &checksum, HC_MAGIC, strlen(HC_MAGIC))
+		|| write_data(file, &checksum, entry->path, MAX_ARG_SIZE)
+		|| write_data(file, &checksum, &entry->content, sizeof(entry->content))
+		|| write_data(file, &checksum, &entry->state, sizeof(entry->state))
+		|| write_data(file, &checksum, &entry->scanner, sizeof(entry->scanner))
+		|| write_size(file, &checksum, entry->text_size)
+		|| write_data(file, &checksum, entry->text, entry->text_size)
+		|| write_size(file, &checksum, entry->strings_size)
+		|| write_data(file, &checksum, entry->strings, entry->strings_size)
+		|| write_vector(file, &checksum, &entry->macrotext)
+		|| write_vector(file, &checksum, &entry->patches)
+		|| write_vector(file, &checksum, &entry->names)
+		|| write_vector(file, &checksum, &entry->events);
+
+	const uint64_t sum = checksum;
+	if (ret || fwrite(&sum, 1, sizeof(sum), file) != sizeof(sum) || fclose(file))
+	{
+		remove(temp);
+		return;
+	}
+
+	remove(path);
+	rename(temp, path);
+}
+
+/** Load entry from cache directory, @c NULL if absent or damaged */
+static hc_entry *cache_load(const header_cache *const hc, const uint64_t key)
+{
+	char path[MAX_CACHE_PATH];
+	cache_make_path(hc, key, path);
+
+	FILE *const file = fopen(path, "rb");
+	if (file == NULL)
+	{
+		return NULL;
+	}
+
+	hc_entry *const entry = entry_create();
+	if (entry == NULL)
+	{
+		fclose(file);
+		return NULL;
+	}
+
+	char magic[8];
+	uint64_t checksum = HASH_INIT;
+	int ret = read_data(file, &checksum, magic, strlen(HC_MAGIC))
+		|| memcmp(magic, HC_MAGIC, strlen(HC_MAGIC)) != 0
+		|| read_data(file, &checksum, entry->path, MAX_ARG_SIZE)
+		|| read_data(file, &checksum, &entry->content, sizeof(entry->content))
+		|| read_data(file, &checksum, &entry->state, sizeof(entry->state))
+		|| read_data(file, &checksum, &entry->scanner, sizeof(entry->scanner))
+		|| read_size(file, &checksum, &entry->text_size);
+
+	if (!ret)
+	{
+		entry->text = malloc(entry->text_size + 1);
+		ret = entry->text == NULL || read_data(file, &checksum, entry->text, entry->text_size)
+			|| read_size(file, &checksum, &entry->strings_size);
+	}
+
+	if (!ret)
+	{
+		entry->strings = malloc(entry->strings_size + 1);
+		ret = entry->strings == NULL || read_data(file, &checksum, entry->strings, entry->strings_size)
+			|| read_vector(file, &checksum, &entry->macrotext)
+			|| read_vector(file, &checksum, &entry->patches)
+			|| read_vector(file, &checksum, &entry->names)
+			|| read_vector(file, &checksum, &entry->events);
+	}
+
+	uint64_t sum = 0;
+	ret = ret || fread(&sum, 1, sizeof(sum), file) != sizeof(sum) || sum != checksum;
+	fclose(file);
+
+	if (ret || entry->path[MAX_ARG_SIZE - 1] != '\0'
+		|| (entry->strings_size != 0 && entry->strings[entry->strings_size - 1] != '\0'))
+	{
+		entry_free(entry);
+		return NULL;
+	}
+
+	entry->key = key;
+	return entry;
+}
+
+
+static void cache_lock(header_cache *const hc)
+{
+#ifndef _MSC_VER
+	pthread_mutex_lock(&hc->mutex);
+#else
+	(void)hc;
+#endif
+}
+
+static void cache_unlock(header_cache *const hc)
+{
+#ifndef _MSC_VER
+	pthread_mutex_unlock(&hc->mutex);
+#else
+	(void)hc;
+#endif
+}
+
+static hc_entry *cache_find(header_cache *const hc, const uint64_t key)
+{
+	if (hc->table_size == 0)
+	{
+		return NULL;
+	}
+
+	const size_t mask = hc->table_size - 1;
+	for (size_t slot = (size_t)key & mask; hc->table[slot] != NULL; slot = (slot + 1) & mask)
+	{
+		if (hc->table[slot]->key == key)
+		{
+			return hc->table[slot];
+		}
+	}
+
+	return NULL;
+}
+
+/** Put entry to hash table, table has free slots */
+static void cache_index_put(header_cache *const hc, hc_entry *const entry)
+{
+	const size_t mask = hc->table_size - 1;
+
+	size_t slot = (size_t)entry->key & mask;
+	while (hc->table[slot] != NULL)
+	{
+		slot = (slot + 1) & mask;
+	}
+
+	hc->table[slot] = entry;
+}
+
+static int cache_add(header_cache *const hc, hc_entry *const entry)
+{
+	if (hc->size == hc->alloc)
+	{
+		const size_t alloc = hc->alloc != 0 ? 2 * hc->alloc : 16;
+		hc_entry **const entries = realloc(hc->entries, alloc * sizeof(hc_entry *));
+		if (entries == NULL)
+		{
+			return -1;
+		}
+
+		// Таблица вдвое больше списка записей, поэтому заполнена не более чем наполовину
+		hc_entry **const table = calloc(2 * alloc, sizeof(hc_entry *));
+		if (table == NULL)
+		{
+			hc->entries = entries;
+			return -1;
+		}
+
+		free(hc->table);
+		hc->entries = entries;
+		hc->alloc = alloc;
+		hc->table = table;
+		hc->table_size = 2 * alloc;
+
+		for (size_t i = 0; i < hc->size; i++)
+		{
+			cache_index_put(hc, hc->entries[i]);
+		}
+	}
+
+	hc->entries[hc->size++] = entry;
+	cache_index_put(hc, entry);
+	return 0;
+}
+
+/** Find entry in memory, then in cache directory */
+static const hc_entry *cache_get(header_cache *const hc, const char *const path
+	, const uint64_t content, const uint64_t state)
+{
+	const uint64_t key = hash_key(path, content, state);
+
+	cache_lock(hc);
+	hc_entry *entry = cache_find(hc, key);
+	if (entry == NULL && hc->dir[0] != '\0')
+	{
+		entry = cache_load(hc, key);
+		if (entry != NULL && cache_add(hc, entry))
+		{
+			entry_free(entry);
+			entry = NULL;
+		}
+	}
+	cache_unlock(hc);
+
+	// Совпадение хеша ключа проверяется полным сравнением
+	return entry != NULL && entry->content == content && entry->state == state && strcmp(entry->path, path) == 0
+		? entry
+		: NULL;
+}
+
+
+static size_t lk_find(const linker *const lk, const char *const path)
+{
+	for (size_t i = 0; i < lk->count; i++)
+	{
+		if (strcmp(ws_get_file(lk->ws, i), path) == 0)
+		{
+			return i;
+		}
+	}
+
+	return SIZE_MAX;
+}
+
+/**
+ *	Check that nested includes will be opened and skipped the same way as recorded
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	entry		Cached header
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static int entry_is_replayable(const environment *const env, const hc_entry *const entry)
+{
+	// Записи из каталога могли быть испорчены, поэтому проверяются все смещения
+	const item_t mp = env->mp;
+	const item_t size = mp + (item_t)vector_size(&entry->macrotext);
+	for (size_t i = 0; i + 1 < vector_size(&entry->patches); i += 2)
+	{
+		const item_t offset = vector_get(&entry->patches, i);
+		if (offset < 0 || offset >= mp)
+		{
+			return 0;
+		}
+	}
+
+	for (size_t i = 0; i + 1 < vector_size(&entry->names); i += 2)
+	{
+		const item_t value = vector_get(&entry->names, i + 1);
+		if (entry_get_string(entry, vector_get(&entry->names, i)) == NULL || value < 0 || value >= size)
+		{
+			return 0;
+		}
+	}
+
+	if (entry_get_string(entry, entry->scanner.error_string) == NULL)
+	{
+		return 0;
+	}
+
+	const linker *const lk = env->lk;
+	const size_t count = vector_size(&entry->events) / HC_EVENT;
+	if (lk->count + count > MAX_PATHS)
+	{
+		return 0;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const item_t *const event = &entry->events.array[i * HC_EVENT];
+		const char *const path = entry_get_string(entry, event[0]);
+		if (path == NULL || event[2] < 0 || event[2] > event[3] || (size_t)event[3] > entry->text_size)
+		{
+			return 0;
+		}
+
+		const size_t index = lk_find(lk, path);
+		int is_included = strcmp(path, entry->path) == 0 || (index != SIZE_MAX && lk->included[index]);
+		for (size_t j = 0; j < i && !is_included; j++)
+		{
+			const item_t *const previous = &entry->events.array[j * HC_EVENT];
+			is_included = previous[1] && strcmp(entry_get_string(entry, previous[0]), path) == 0;
+		}
+
+		if (event[1] == is_included || (event[1] && (item_t)hash_file(path) != event[4]))
+		{
+			return 0;
+		}
+	}
+
+	return 1;
+}
+
+static int entry_replay(environment *const env, const hc_entry *const entry)
+{
+	linker *const lk = env->lk;
+	const size_t base = out_get_position(env->output);
+	if (out_write(env->output, entry->text, entry->text_size) == -1)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < vector_size(&entry->events); i += HC_EVENT)
+	{
+		const item_t *const event = &entry->events.array[i];
+		const size_t index = ws_add_file(lk->ws, entry_get_string(entry, event[0]));
+		if (index >= MAX_PATHS)
+		{
+			return -1;
+		}
+
+		if (index == lk->count)
+		{
+			lk->included[lk->count++] = 0;
+		}
+
+		if (event[1])
+		{
+			lk->included[index]++;
+		}
+
+		if (lk->includes != NULL)
+		{
+			vector_add(lk->includes, (item_t)index);
+			vector_add(lk->includes, (item_t)base + event[2]);
+			vector_add(lk->includes, (item_t)base + event[3]);
+		}
+	}
+
+	for (size_t i = 0; i + 1 < vector_size(&entry->patches); i += 2)
+	{
+		env_set_macrotext(env, (size_t)vector_get(&entry->patches, i), (int)vector_get(&entry->patches, i + 1));
+	}
+
+	for (size_t i = 0; i < vector_size(&entry->macrotext); i++)
+	{
+		if (env_add_macrotext(env, (int)vector_get(&entry->macrotext, i)))
+		{
+			return -1;
+		}
+	}
+
+	for (size_t i = 0; i + 1 < vector_size(&entry->names); i += 2)
+	{
+		const size_t index = map_reserve(&env->representations
+			, entry_get_string(entry, vector_get(&entry->names, i)));
+		env_set_macro(env, index, vector_get(&entry->names, i + 1));
+	}
+
+	env->prep_flag = entry->scanner.prep_flag;
+	env->curchar = entry->scanner.curchar;
+	env->nextchar = entry->scanner.nextchar;
+	env->nextch_type = entry->scanner.nextch_type;
+	env->nextp = entry->scanner.nextp;
+	env->cur = entry->scanner.cur;
+
+	env_clear_error_string(env);
+	for (const char *ch = entry_get_string(entry, entry->scanner.error_string); *ch != '\0'; ch++)
+	{
+		if (env_add_error_string(env, *ch))
+		{
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+
+static void record_free(hc_record *const rec)
+{
+	free(rec->macrotext);
+	free(rec->values);
+	rec->macrotext = NULL;
+	rec->values = NULL;
+	rec->is_active = 0;
+}
+
+static void record_start(environment *const env, hc_record *const rec)
+{
+	rec->output = out_get_position(env->output);
+	rec->checkif = env->checkif;
+	rec->dipp = env->dipp;
+	rec->mp = (size_t)env->mp;
+	rec->values_size = env->representations.values_size;
+
+	rec->macrotext = malloc((rec->mp + 1) * sizeof(int));
+	rec->values = malloc((rec->values_size + 1) * sizeof(item_t));
+	if (rec->macrotext == NULL || rec->values == NULL)
+	{
+		record_free(rec);
+		return;
+	}
+
+	memcpy(rec->macrotext, env->macrotext, rec->mp * sizeof(int));
+	for (size_t i = 0; i < rec->values_size; i++)
+	{
+		rec->values[i] = map_get_by_index(&env->representations, i);
+	}
+
+	// Вложенные заголовки записываются в тот же след, что и при параллельной обработке
+	rec->own_trace = NULL;
+	if (env->lk->includes == NULL)
+	{
+		rec->own_trace = malloc(sizeof(vector));
+		if (rec->own_trace == NULL)
+		{
+			record_free(rec);
+			return;
+		}
+
+		*rec->own_trace = vector_create(3 * MAX_PATHS);
+		env->lk->includes = rec->own_trace;
+	}
+
+	rec->trace = vector_size(env->lk->includes);
+	rec->is_active = 1;
+}
+
+static hc_entry *record_to_entry(environment *const env, const hc_record *const rec)
+{
+	hc_entry *const entry = entry_create();
+	if (entry == NULL)
+	{
+		return NULL;
+	}
+
+	const char *const path = ws_get_file(env->lk->ws, rec->index);
+	strncpy(entry->path, path, MAX_ARG_SIZE - 1);
+	entry->content = rec->content;
+	entry->state = rec->state;
+	entry->key = hash_key(path, rec->content, rec->state);
+
+	entry->scanner.prep_flag = env->prep_flag;
+	entry->scanner.curchar = env->curchar;
+	entry->scanner.nextchar = env->nextchar;
+	entry->scanner.nextch_type = env->nextch_type;
+	entry->scanner.nextp = env->nextp;
+	entry->scanner.cur = env->cur;
+
+	const size_t error_string = entry_add_string(entry, env->error_string);
+	entry->scanner.error_string = (int)error_string;
+	int ret = error_string == SIZE_MAX;
+
+	entry->text_size = out_get_position(env->output) - rec->output;
+	entry->text = malloc(entry->text_size + 1);
+	if (entry->text == NULL)
+	{
+		entry_free(entry);
+		return NULL;
+	}
+	memcpy(entry->text, &out_get_buffer(env->output)[rec->output], entry->text_size);
+
+	for (size_t i = rec->mp; i < (size_t)env->mp; i++)
+	{
+		vector_add(&entry->macrotext, env->macrotext[i]);
+	}
+
+	for (size_t i = 0; i < rec->mp; i++)
+	{
+		if (env->macrotext[i] != rec->macrotext[i])
+		{
+			vector_add(&entry->patches, (item_t)i);
+			vector_add(&entry->patches, env->macrotext[i]);
+		}
+	}
+
+	for (size_t i = 0; i < env->representations.values_size; i++)
+	{
+		const item_t value = map_get_by_index(&env->representations, i);
+		const item_t old = i < rec->values_size ? rec->values[i] : ITEM_MAX;
+		if (value != old && value >= 0 && value != ITEM_MAX)
+		{
+			const size_t name = entry_add_string(entry, map_to_string(&env->representations, i));
+			ret = ret || name == SIZE_MAX;
+			vector_add(&entry->names, (item_t)name);
+			vector_add(&entry->names, value);
+		}
+	}
+
+	const vector *const trace = env->lk->includes;
+	for (size_t i = rec->trace; i + 2 < vector_size(trace); i += 3)
+	{
+		const char *const nested = ws_get_file(env->lk->ws, (size_t)vector_get(trace, i));
+		const item_t begin = vector_get(trace, i + 1) - (item_t)rec->output;
+		const item_t end = vector_get(trace, i + 2) - (item_t)rec->output;
+
+		// Пропущенный заголовок оставляет пустой диапазон
+		const size_t name = entry_add_string(entry, nested);
+		ret = ret || name == SIZE_MAX;
+		vector_add(&entry->events, (item_t)name);
+		vector_add(&entry->events, begin != end);
+		vector_add(&entry->events, begin);
+		vector_add(&entry->events, end);
+		vector_add(&entry->events, begin != end ? (item_t)hash_file(nested) : 0);
+	}
+
+	if (ret || vector_size(&entry->names) % 2 != 0 || vector_size(&entry->events) % HC_EVENT != 0)
+	{
+		entry_free(entry);
+		return NULL;
+	}
+
+	return entry;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+header_cache *hc_create()
+{
+	header_cache *const hc = malloc(sizeof(header_cache));
+	if (hc == NULL)
+	{
+		return NULL;
+	}
+
+	hc->entries = NULL;
+	hc->size = 0;
+	hc->alloc = 0;
+	hc->table = NULL;
+	hc->table_size = 0;
+	hc->dir[0] = '\0';
+
+#ifndef _MSC_VER
+	if (pthread_mutex_init(&hc->mutex, NULL))
+	{
+		free(hc);
+		return NULL;
+	}
+#endif
+
+	return hc;
+}
+
+int hc_set_dir(header_cache *const hc, const char *const dir)
+{
+	if (hc == NULL || (dir != NULL && strlen(dir) >= MAX_ARG_SIZE))
+	{
+		return -1;
+	}
+
+	strcpy(hc->dir, dir != NULL ? dir : "");
+	return 0;
+}
+
+int hc_replay(environment *const env, const size_t index, hc_record *const rec)
+{
+	rec->is_active = 0;
+	rec->macrotext = NULL;
+	rec->values = NULL;
+
+	header_cache *const hc = env->lk->cache;
+	if (hc == NULL)
+	{
+		return 1;
+	}
+
+	const char *const path = ws_get_file(env->lk->ws, index);
+	rec->index = index;
+	rec->content = hash_file(path);
+	rec->state = hash_state(env);
+	if (rec->content == 0)
+	{
+		return 1;
+	}
+
+	const hc_entry *const entry = cache_get(hc, path, rec->content, rec->state);
+	if (entry != NULL && entry_is_replayable(env, entry))
+	{
+		env_clear_error_string(env);
+		env->lk->included[index]++;
+		return entry_replay(env, entry);
+	}
+
+	// Записать можно только вывод в буфер
+	if (out_get_buffer(env->output) != NULL)
+	{
+		record_start(env, rec);
+	}
+
+	return 1;
+}
+
+void hc_store(environment *const env, hc_record *const rec, const int was_error)
+{
+	if (!rec->is_active)
+	{
+		return;
+	}
+
+	hc_entry *const entry = !was_error && env->checkif == rec->checkif && env->dipp == rec->dipp
+		? record_to_entry(env, rec)
+		: NULL;
+
+	if (rec->own_trace != NULL)
+	{
+		vector_clear(rec->own_trace);
+		free(rec->own_trace);
+		env->lk->includes = NULL;
+	}
+	record_free(rec);
+
+	if (entry == NULL)
+	{
+		return;
+	}
+
+	header_cache *const hc = env->lk->cache;
+	cache_lock(hc);
+	const int is_new = cache_find(hc, entry->key) == NULL && !cache_add(hc, entry);
+	cache_unlock(hc);
+
+	if (!is_new)
+	{
+		entry_free(entry);
+		return;
+	}
+
+	if (hc->dir[0] != '\0')
+	{
+		cache_save(hc, entry);
+	}
+}
+
+void hc_clear(header_cache *const hc)
+{
+	if (hc == NULL)
+	{
+		return;
+	}
+
+	for (size_t i = 0; i < hc->size; i++)
+	{
+		entry_free(hc->entries[i]);
+	}
+
+#ifndef _MSC_VER
+	pthread_mutex_destroy(&hc->mutex);
+#endif
+
+	free(hc->entries);
+	free(hc->table);
+	free(hc);
+}
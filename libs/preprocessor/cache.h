@@ -0,0 +1,102 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "vector.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct environment environment;
+
+/** Cache of preprocessed headers */
+typedef struct header_cache header_cache;
+
+/** Header preprocessing, which is recorded to cache */
+typedef struct hc_record
+{
+	int is_active;				/**< Set, if header is recorded */
+
+	size_t index;				/**< Index of header in workspace */
+	uint64_t content;			/**< Hash of header content */
+	uint64_t state;				/**< Hash of incoming macro state */
+
+	size_t output;				/**< Output position before header */
+	size_t trace;				/**< Start of nested includes in linker trace */
+	vector *own_trace;			/**< Linker trace created for this record */
+
+	int *macrotext;				/**< Copy of macro text before header */
+	size_t mp;					/**< Size of macro text before header */
+	item_t *values;				/**< Copy of representations values before header */
+	size_t values_size;			/**< Number of representations before header */
+	int checkif;				/**< Depth of conditions before header */
+	int dipp;					/**< Depth of characters sources before header */
+} hc_record;
+
+
+/**
+ *	Create header cache
+ *
+ *	@return	Header cache, @c NULL on failure
+ */
+header_cache *hc_create();
+
+/**
+ *	Set directory to keep cache between runs
+ *
+ *	@param	hc			Header cache
+ *	@param	dir			Directory path, @c NULL to keep cache in memory only
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int hc_set_dir(header_cache *const hc, const char *const dir);
+
+/**
+ *	Replay cached header with the same content and incoming macro state.
+ *	On miss prepare record of header preprocessing.
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	index		Index of header in workspace
+ *	@param	rec			Record to prepare on miss
+ *
+ *	@return	@c 0 on replay, @c 1 on miss, @c -1 on failure
+ */
+int hc_replay(environment *const env, const size_t index, hc_record *const rec);
+
+/**
+ *	Store recorded header to cache
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	rec			Record prepared by @c hc_replay()
+ *	@param	was_error	Set, if header preprocessing failed
+ */
+void hc_store(environment *const env, hc_record *const rec, const int was_error);
+
+/**
+ *	Free allocated memory
+ *
+ *	@param	hc			Header cache
+ */
+void hc_clear(header_cache *const hc);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
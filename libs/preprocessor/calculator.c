@@ -28,14 +28,12 @@
 #include <string.h>
 
 
-int flagint = 1;
-
 double get_digit(environment *const env, int* error)
 {
 	double k;
 	int d = 1;
 
-	flagint = 1;
+	env->flagint = 1;
 	int num = 0;
 	double numdouble = 0.0;
 	if (env->curchar == '-')
@@ -61,7 +59,7 @@ double get_digit(environment *const env, int* error)
 
 	if (env->curchar == '.')
 	{
-		flagint = 0;
+		env->flagint = 0;
 		m_nextch(env);
 		k = 0.1;
 
@@ -82,7 +80,7 @@ double get_digit(environment *const env, int* error)
 		m_nextch(env);
 		if (env->curchar == '-')
 		{
-			flagint = 0;
+			env->flagint = 0;
 			m_nextch(env);
 			sign = -1;
 		}
@@ -108,7 +106,7 @@ double get_digit(environment *const env, int* error)
 			m_nextch(env);
 		}
 
-		if (flagint)
+		if (env->flagint)
 		{
 			for (i = 1; i <= power; i++)
 			{
@@ -119,7 +117,7 @@ double get_digit(environment *const env, int* error)
 		numdouble *= pow(10.0, sign * power);
 	}
 
-	if (flagint)
+	if (env->flagint)
 	{
 		return num * d;
 	}
@@ -312,7 +310,7 @@ int calculator(const int if_flag, environment *const env)
 			{
 				return -1;
 			}
-			int_flag[i++] = flagint;
+			int_flag[i++] = env->flagint;
 		}
 		else if (utf8_is_letter(env->curchar))
 		{
@@ -18,10 +18,9 @@
 
 #define MACRODEBUG 1
 
-#define MAXTAB		100000
 #define LONGSTR		10000
 #define STRING_SIZE	256
-#define HASH		256
+#define REPRTAB_SIZE 256
 #define DIP			10
 #define CONTROLSIZE 250
 
@@ -81,7 +81,8 @@ int function_scob_collect(int t, int num, environment *const env)
 			{
 				int oldcp1 = env->cp;
 				int oldlsp = env->lsp;
-				int locfchange[STRING_SIZE];
+				int *locfchange = NULL;
+				size_t locfchange_size = 0;
 				int lcp = 0;
 				int ldip;
 
@@ -99,6 +100,15 @@ int function_scob_collect(int t, int num, environment *const env)
 
 				while (get_dipp(env) >= ldip) // 1 переход потому что есть префиксная замена
 				{
+					int *const array = env_reserve(locfchange, &locfchange_size, (size_t)lcp, sizeof(int));
+					if (array == NULL)
+					{
+						env_memory_failure(env);
+						free(locfchange);
+						return -1;
+					}
+
+					locfchange = array;
 					locfchange[lcp++] = env->curchar;
 					m_nextch(env);
 				}
@@ -108,20 +118,31 @@ int function_scob_collect(int t, int num, environment *const env)
 
 				for (i = 0; i < lcp; i++)
 				{
-					env->fchange[env->cp++] = locfchange[i];
+					if (env_add_fchange(env, locfchange[i]))
+					{
+						free(locfchange);
+						return -1;
+					}
 				}
+				free(locfchange);
 			}
 			else
 			{
 				for (i = 0; i < env->msp; i++)
 				{
-					env->fchange[env->cp++] = env->mstring[i];
+					if (env_add_fchange(env, env->mstring[i]))
+					{
+						return -1;
+					}
 				}
 			}
 		}
 		else if (env->curchar == '(')
 		{
-			env->fchange[env->cp++] = env->curchar;
+			if (env_add_fchange(env, env->curchar))
+			{
+				return -1;
+			}
 			m_nextch(env);
 			
 			if(function_scob_collect(0, num, env))
@@ -133,7 +154,10 @@ int function_scob_collect(int t, int num, environment *const env)
 		{
 			if (t == 0)
 			{
-				env->fchange[env->cp++] = env->curchar;
+				if (env_add_fchange(env, env->curchar))
+				{
+					return -1;
+				}
 				m_nextch(env);
 			}
 
@@ -149,20 +173,29 @@ int function_scob_collect(int t, int num, environment *const env)
 				}
 				for (i = 0; i < env->csp; i++)
 				{
-					env->fchange[env->cp++] = env->cstring[i];
+					if (env_add_fchange(env, env->cstring[i]))
+					{
+						return -1;
+					}
 				}
 			}
 			else
 			{
-				for (i = 0; i < env->reprtab[env->rp]; i++)
+				for (i = 0; i < env->ksp; i++)
 				{
-					env->fchange[env->cp++] = env->reprtab[env->rp + 2 + i];
+					if (env_add_fchange(env, (int)env->kstring[i]))
+					{
+						return -1;
+					}
 				}
 			}
 		}
 		else
 		{
-			env->fchange[env->cp++] = env->curchar;
+			if (env_add_fchange(env, env->curchar))
+			{
+				return -1;
+			}
 			m_nextch(env);
 		}
 	}
@@ -177,7 +210,10 @@ int function_stack_create(int n, environment *const env)
 	int num = 0;
 
 	m_nextch(env);
-	env->localstack[num + env->lsp] = env->cp;
+	if (env_set_localstack(env, num + env->lsp, env->cp))
+	{
+		return -1;
+	}
 
 	if (env->curchar == ')')
 	{
@@ -193,12 +229,18 @@ int function_stack_create(int n, environment *const env)
 		{
 			return -1;
 		}
-		env->fchange[env->cp++] = CANGEEND;
+		if (env_add_fchange(env, CANGEEND))
+		{
+			return -1;
+		}
 
 		if (env->curchar == ',')
 		{
 			num++;
-			env->localstack[num + env->lsp] = env->cp;
+			if (env_set_localstack(env, num + env->lsp, env->cp))
+			{
+				return -1;
+			}
 
 			if (num > n)
 			{
@@ -247,8 +289,10 @@ int funktionleter(int flag_macro, environment *const env)
 
 	if ((n = m_equal(env)) != 0)
 	{
-		env->macrotext[env->mp++] = MACROCANGE;
-		env->macrotext[env->mp++] = n - 1;
+		if (env_add_macrotext(env, MACROCANGE) || env_add_macrotext(env, n - 1))
+		{
+			return -1;
+		}
 	}
 	else if (!flag_macro && r)
 	{
@@ -261,7 +305,10 @@ int funktionleter(int flag_macro, environment *const env)
 	{
 		for (i = 0; i < env->msp; i++)
 		{
-			env->macrotext[env->mp++] = env->mstring[i];
+			if (env_add_macrotext(env, env->mstring[i]))
+			{
+				return -1;
+			}
 		}
 	}
 	return 0;
@@ -280,10 +327,16 @@ int to_functionident(environment *const env)
 		{
 			while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar))
 			{
-				env->cstring[env->csp++] = env->curchar;
+				if (env_add_cstring(env, env->curchar))
+				{
+					return -1;
+				}
 				m_nextch(env);
 			}
-			env->cstring[env->csp++] = 0;
+			if (env_add_cstring(env, 0))
+			{
+				return -1;
+			}
 		}
 		else
 		{
@@ -323,11 +376,17 @@ int macrotext_add_function(environment *const env)
 		flag_macro = 1;
 	}
 
-	env->macrotext[env->mp++] = MACROFUNCTION;
+	if (env_add_macrotext(env, MACROFUNCTION))
+	{
+		return -1;
+	}
 
 	if (env->curchar == ')')
 	{
-		env->macrotext[env->mp++] = -1;
+		if (env_add_macrotext(env, -1))
+		{
+			return -1;
+		}
 		empty = 1;
 		m_nextch(env);
 	}
@@ -338,7 +397,10 @@ int macrotext_add_function(environment *const env)
 		{
 			return -1;
 		}
-		env->macrotext[env->mp++] = res;
+		if (env_add_macrotext(env, res))
+		{
+			return -1;
+		}
 	}
 	skip_space(env);
 
@@ -363,27 +425,39 @@ int macrotext_add_function(environment *const env)
 				}
 				for (j = 0; j < env->csp; j++)
 				{
-					env->macrotext[env->mp++] = env->cstring[j];
+					if (env_add_macrotext(env, env->cstring[j]))
+					{
+						return -1;
+					}
 				}
 			}
 			else if (flag_macro && env->cur == SH_ENDM)
 			{
 				m_nextch(env);
-				env->macrotext[env->mp++] = MACROEND;
+				if (env_add_macrotext(env, MACROEND))
+				{
+					return -1;
+				}
 				return 0;
 			}
 			else
 			{
 				env->cur = 0;
-				for (j = 0; j < env->reprtab[env->rp]; j++)
+				for (j = 0; j < env->ksp; j++)
 				{
-					env->macrotext[env->mp++] = env->reprtab[env->rp + 2 + j];
+					if (env_add_macrotext(env, (int)env->kstring[j]))
+					{
+						return -1;
+					}
 				}
 			}
 		}
 		else
 		{
-			env->macrotext[env->mp++] = env->curchar;
+			if (env_add_macrotext(env, env->curchar))
+			{
+				return -1;
+			}
 			m_nextch(env);
 		}
 
@@ -403,12 +477,15 @@ int macrotext_add_function(environment *const env)
 			{
 				return -1;
 			}
-			//env->macrotext[env->mp++] = '\n';
+			//env_add_macrotext(env, '\n');
 			m_nextch(env);
 		}
 	}
 
-	env->macrotext[env->mp++] = MACROEND;
+	if (env_add_macrotext(env, MACROEND))
+	{
+		return -1;
+	}
 	return 0;
 }
 //
@@ -416,7 +493,7 @@ int macrotext_add_function(environment *const env)
 // define
 int define_get_from_macrotext(const int r, environment *const env)
 {
-	int t = env->reprtab[r + 1];
+	int t = (int)map_get_by_index(&env->representations, (size_t)r);
 
 	if (r)
 	{
@@ -449,46 +526,36 @@ int define_get_from_macrotext(const int r, environment *const env)
 
 int define_add_to_reprtab(environment *const env)
 {
-	int r;
-	int oldrepr = env->rp;
-	int hash = 0;
-	env->rp += 2;
+	env->ksp = 0;
 
 	do
 	{
-		hash += env->curchar;
-		env->reprtab[env->rp++] = env->curchar;
+		if (env_add_kstring(env, (char32_t)env->curchar))
+		{
+			return -1;
+		}
 		m_nextch(env);
 	} while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar));
 
-	hash &= 255;
-	env->reprtab[env->rp++] = 0;
-	r = env->hashtab[hash];
+	env->kstring[env->ksp] = '\0';
+	const size_t index = map_reserve_by_utf8(&env->representations, env->kstring);
+	const item_t value = map_get_by_index(&env->representations, index);
 
-	while (r)
+	if (value == ITEM_MAX)
 	{
-		if (equal_reprtab(r, oldrepr, env))
-		{
-			if (env->macrotext[env->reprtab[r + 1]] == MACROUNDEF)
-			{
-				env->rp = oldrepr;
-				return r;
-			}
-			else
-			{
-				size_t position = skip_str(env); 
-				macro_error(repeat_ident, lk_get_current(env->lk)
-			, env->error_string, env->line, position);
-				return -1;
-			}
-		}
-		r = env->reprtab[r];
+		env_set_macro(env, index, env->mp);
+		return 0;
 	}
 
-	env->reprtab[oldrepr] = env->hashtab[hash];
-	env->reprtab[oldrepr + 1] = env->mp;
-	env->hashtab[hash] = oldrepr;
-	return 0;
+	if (value >= 0 && env->macrotext[value] == MACROUNDEF)
+	{
+		return (int)index;
+	}
+
+	size_t position = skip_str(env); 
+	macro_error(repeat_ident, lk_get_current(env->lk)
+			, env->error_string, env->line, position);
+	return -1;
 }
 
 int macrotext_add_define(int r, environment *const env)
@@ -496,7 +563,10 @@ int macrotext_add_define(int r, environment *const env)
 	int j;
 	int lmp = env->mp;
 
-	env->macrotext[env->mp++] = MACRODEF;
+	if (env_add_macrotext(env, MACRODEF))
+	{
+		return -1;
+	}
 	if (env->curchar != '\n')
 	{
 		while (env->curchar != '\n')
@@ -528,14 +598,20 @@ int macrotext_add_define(int r, environment *const env)
 
 					for (j = 0; j < env->csp; j++)
 					{
-						env->macrotext[env->mp++] = env->cstring[j];
+						if (env_add_macrotext(env, env->cstring[j]))
+						{
+							return -1;
+						}
 					}
 				}
 				else
 				{
-					for (j = 0; j < env->reprtab[env->rp]; j++)
+					for (j = 0; j < env->ksp; j++)
 					{
-						env->macrotext[env->mp++] = env->reprtab[env->rp + 2 + j];
+						if (env_add_macrotext(env, (int)env->kstring[j]))
+						{
+							return -1;
+						}
 					}
 				}
 			}
@@ -546,7 +622,7 @@ int macrotext_add_define(int r, environment *const env)
 				{
 					return -1;
 				}
-				//env->macrotext[env->mp++] = '\n';
+				//env_add_macrotext(env, '\n');
 				m_nextch(env);
 			}
 			else if (utf8_is_letter(env->curchar))
@@ -563,33 +639,44 @@ int macrotext_add_define(int r, environment *const env)
 				{
 					for (j = 0; j < env->msp; j++)
 					{
-						env->macrotext[env->mp++] = env->mstring[j];
+						if (env_add_macrotext(env, env->mstring[j]))
+						{
+							return -1;
+						}
 					}
 				}
 			}
 			else
 			{
-				env->macrotext[env->mp++] = env->curchar;
+				if (env_add_macrotext(env, env->curchar))
+				{
+					return -1;
+				}
 				m_nextch(env);
 			}
 		}
 
 		while (env->macrotext[env->mp - 1] == ' ' || env->macrotext[env->mp - 1] == '\t')
 		{
-			env->macrotext[env->mp - 1] = MACROEND;
-			env->mp--;
+			env_pop_macrotext(env);
 		}
 	}
 	else
 	{
-		env->macrotext[env->mp++] = '0';
+		if (env_add_macrotext(env, '0'))
+		{
+			return -1;
+		}
 	}
 
-	env->macrotext[env->mp++] = MACROEND;
+	if (env_add_macrotext(env, MACROEND))
+	{
+		return -1;
+	}
 
 	if (r)
 	{
-		env->reprtab[r + 1] = lmp;
+		env_set_macro(env, (size_t)r, lmp);
 	}
 	return 0;
 }
@@ -653,7 +740,14 @@ int set_implementation(environment *const env)
 
 	j = collect_mident(env);
 
-	if (env->macrotext[env->reprtab[j + 1]] == MACROFUNCTION)
+	if (!j)
+	{
+		size_t position = skip_str(env); 
+		macro_error(macro_does_not_exist, lk_get_current(env->lk)
+			, env->error_string, env->line, position);
+		return -1;
+	}
+	else if (env->macrotext[map_get_by_index(&env->representations, (size_t)j)] == MACROFUNCTION)
 	{
 		size_t position = skip_str(env); 
 		macro_error(functions_cannot_be_changed, lk_get_current(env->lk)
@@ -15,23 +15,119 @@
  */
 
 #include "environment.h"
+#include <stdlib.h>
+#include <string.h>
+#include "error.h"
+#include "hash.h"
 
 
-void env_init(environment *const env, linker *const lk, universal_io *const output)
+/**
+ *	Allocate zeroed array of initial size
+ *
+ *	@param	size		Pointer to allocated size
+ *	@param	element		Size of element
+ *
+ *	@return	Array
+ */
+static void *env_allocate(size_t *const size, const size_t element)
+{
+	void *const array = calloc(STRING_SIZE, element);
+	*size = array != NULL ? STRING_SIZE : 0;
+	return array;
+}
+
+/**
+ *	Add value to the top of growable int array
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	array		Pointer to array
+ *	@param	size		Pointer to allocated size
+ *	@param	top			Pointer to top of array
+ *	@param	value		Value to add
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int env_add(environment *const env, int **const array, size_t *const size, int *const top, const int value)
+{
+	int *const new_array = env_reserve(*array, size, (size_t)*top, sizeof(int));
+	if (new_array == NULL)
+	{
+		env_memory_failure(env);
+		return -1;
+	}
+
+	*array = new_array;
+	(*array)[(*top)++] = value;
+	return 0;
+}
+
+/**
+ *	Hash of macro name with its value, zero for names which are not macros
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	index		Index of name in representations table
+ *
+ *	@return	Hash
+ */
+static uint64_t env_macro_hash(const environment *const env, const size_t index)
+{
+	const item_t value = map_get_by_index(&env->representations, index);
+	if (value < 0 || value == ITEM_MAX)
+	{
+		return 0;
+	}
+
+	const char *const name = map_to_string(&env->representations, index);
+	return hash_mix(hash_bytes(hash_bytes(HASH_INIT, name, strlen(name)), &value, sizeof(value)));
+}
+
+/**
+ *	Hash of macro text cell with its position
+ *
+ *	@param	index		Index of cell
+ *	@param	value		Value of cell
+ *
+ *	@return	Hash
+ */
+static inline uint64_t env_macrotext_hash(const size_t index, const int value)
+{
+	return hash_mix(hash_bytes(hash_bytes(HASH_INIT, &index, sizeof(index)), &value, sizeof(value)));
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+
+int env_init(environment *const env, linker *const lk, universal_io *const output)
 {
 	env->output = output;
 
 	env->lk = lk;
 
-	env->rp = 1;
+	env->representations = map_create(REPRTAB_SIZE);
+	env->macros_hash = 0;
+	env->defines = NULL;
+	env->misses = NULL;
+	env->memory_failure = 0;
+
+	env->ksp = 0;
 	env->mp = 1;
+	env->macrotext_hash = 0;
 	env->cp = 0;
 	env->lsp = 0;
 	env->csp = 0;
 	env->ifsp = 0;
 	env->wsp = 0;
-	env->mfirstrp = -1;
 	env->prep_flag = 0;
+	env->flagint = 1;
+	env->checkif = 0;
 	env->nextch_type = FILETYPE;
 	env->curchar = 0;
 	env->nextchar = 0;
@@ -41,49 +137,192 @@ void env_init(environment *const env, linker *const lk, universal_io *const outp
 	env->line = 1;
 	env->position = 0;
 
-	for (int i = 0; i < HASH; i++)
+	env->kstring = env_allocate(&env->kstring_size, sizeof(char32_t));
+	env->macrotext = env_allocate(&env->macrotext_size, sizeof(int));
+	env->error_string = env_allocate(&env->error_string_size, sizeof(char));
+	env->mstring = env_allocate(&env->mstring_size, sizeof(int));
+	env->fchange = env_allocate(&env->fchange_size, sizeof(int));
+	env->localstack = env_allocate(&env->localstack_size, sizeof(int));
+	env->cstring = env_allocate(&env->cstring_size, sizeof(int));
+	env->ifstring = env_allocate(&env->ifstring_size, sizeof(int));
+	env->wstring = env_allocate(&env->wstring_size, sizeof(int));
+
+	for (int i = 0; i < DIP; i++)
+	{
+		env->oldcurchar[i] = 0;
+		env->oldnextchar[i] = 0;
+		env->oldnextch_type[i] = 0;
+		env->oldnextp[i] = 0;
+	}
+
+	if (!map_is_correct(&env->representations) || env->kstring == NULL || env->macrotext == NULL
+		|| env->error_string == NULL || env->mstring == NULL || env->fchange == NULL
+		|| env->localstack == NULL || env->cstring == NULL || env->ifstring == NULL || env->wstring == NULL)
+	{
+		env_memory_failure(env);
+		return -1;
+	}
+
+	return 0;
+}
+
+void env_clear(environment *const env)
+{
+	map_clear(&env->representations);
+
+	free(env->kstring);
+	free(env->macrotext);
+	free(env->error_string);
+	free(env->mstring);
+	free(env->fchange);
+	free(env->localstack);
+	free(env->cstring);
+	free(env->ifstring);
+	free(env->wstring);
+}
+
+void env_clear_error_string(environment *const env)
+{
+	env->position = 0;
+}
+
+void *env_reserve(void *const array, size_t *const size, const size_t index, const size_t element)
+{
+	if (index + 1 < *size)
 	{
-		env->hashtab[i] = 0;
+		return array;
 	}
 
-	for (int i = 0; i < MAXTAB; i++)
+	size_t new_size = *size != 0 ? *size * 2 : STRING_SIZE;
+	while (index + 1 >= new_size)
 	{
-		env->reprtab[i] = 0;
+		new_size *= 2;
 	}
 
-	for (int i = 0; i < STRING_SIZE; i++)
+	char *const new_array = realloc(array, new_size * element);
+	if (new_array == NULL)
 	{
-		env->mstring[i] = 0;
-		env->error_string[i] = 0;
-		env->localstack[i] = 0;
-		env->cstring[i] = 0;
+		return NULL;
 	}
 
-	for (int i = 0; i < STRING_SIZE * 3; i++)
+	memset(&new_array[*size * element], 0, (new_size - *size) * element);
+	*size = new_size;
+	return new_array;
+}
+
+void env_memory_failure(environment *const env)
+{
+	if (!env->memory_failure)
 	{
-		env->fchange[i] = 0;
+		macro_system_error(lk_get_current(env->lk), not_enough_memory);
 	}
-	
-	for (int i = 0; i < STRING_SIZE * 2; i++)
+
+	env->memory_failure = 1;
+}
+
+void env_set_macro(environment *const env, const size_t index, const item_t value)
+{
+	// Сумма не зависит от порядка определения макросов
+	env->macros_hash -= env_macro_hash(env, index);
+	map_set_by_index(&env->representations, index, value);
+	env->macros_hash += env_macro_hash(env, index);
+
+	if (env->defines != NULL)
 	{
-		env->ifstring[i] = 0;
+		vector_add(env->defines, (item_t)index);
 	}
+}
 
-	for (int i = 0; i < STRING_SIZE * 5; i++)
+int env_add_kstring(environment *const env, const char32_t value)
+{
+	char32_t *const kstring = env_reserve(env->kstring, &env->kstring_size, (size_t)env->ksp, sizeof(char32_t));
+	if (kstring == NULL)
 	{
-		env->wstring[i] = 0;
+		env_memory_failure(env);
+		return -1;
 	}
 
-	for (int i = 0; i < DIP; i++)
+	env->kstring = kstring;
+	env->kstring[env->ksp++] = value;
+	return 0;
+}
+
+void env_set_macrotext(environment *const env, const size_t index, const int value)
+{
+	// Как и для макросов, сумма позволяет заменять и снимать ячейки без пересчёта
+	env->macrotext_hash -= env_macrotext_hash(index, env->macrotext[index]);
+	env->macrotext[index] = value;
+	env->macrotext_hash += env_macrotext_hash(index, value);
+}
+
+void env_pop_macrotext(environment *const env)
+{
+	env->mp--;
+	env->macrotext_hash -= env_macrotext_hash((size_t)env->mp, env->macrotext[env->mp]);
+	env->macrotext[env->mp] = MACROEND;
+}
+
+int env_add_macrotext(environment *const env, const int value)
+{
+	if (env_add(env, &env->macrotext, &env->macrotext_size, &env->mp, value))
 	{
-		env->oldcurchar[i] = 0;
-		env->oldnextchar[i] = 0;
-		env->oldnextch_type[i] = 0;
-		env->oldnextp[i] = 0;
+		return -1;
 	}
+
+	env->macrotext_hash += env_macrotext_hash((size_t)env->mp - 1, value);
+	return 0;
 }
 
-void env_clear_error_string(environment *const env)
+int env_add_error_string(environment *const env, const char value)
 {
-	env->position = 0;
+	char *const error_string = env_reserve(env->error_string, &env->error_string_size, env->position, sizeof(char));
+	if (error_string == NULL)
+	{
+		env_memory_failure(env);
+		return -1;
+	}
+
+	env->error_string = error_string;
+	env->error_string[env->position++] = value;
+	env->error_string[env->position] = '\0';
+	return 0;
+}
+
+int env_add_mstring(environment *const env, const int value)
+{
+	return env_add(env, &env->mstring, &env->mstring_size, &env->msp, value);
+}
+
+int env_add_fchange(environment *const env, const int value)
+{
+	return env_add(env, &env->fchange, &env->fchange_size, &env->cp, value);
+}
+
+int env_set_localstack(environment *const env, const int index, const int value)
+{
+	int *const localstack = env_reserve(env->localstack, &env->localstack_size, (size_t)index, sizeof(int));
+	if (localstack == NULL)
+	{
+		env_memory_failure(env);
+		return -1;
+	}
+
+	env->localstack = localstack;
+	env->localstack[index] = value;
+	return 0;
+}
+
+int env_add_cstring(environment *const env, const int value)
+{
+	return env_add(env, &env->cstring, &env->cstring_size, &env->csp, value);
+}
+
+int env_add_ifstring(environment *const env, const int value)
+{
+	return env_add(env, &env->ifstring, &env->ifstring_size, &env->ifsp, value);
+}
+
+int env_add_wstring(environment *const env, const int value)
+{
+	return env_add(env, &env->wstring, &env->wstring_size, &env->wsp, value);
 }
@@ -16,9 +16,13 @@
 
 #pragma once
 
+#include <stdint.h>
+#include <uchar.h>
 #include "constants.h"
-#include "uniio.h"
 #include "linker.h"
+#include "map.h"
+#include "uniio.h"
+#include "vector.h"
 
 
 #ifdef __cplusplus
@@ -27,37 +31,52 @@ extern "C" {
 
 typedef struct environment
 {
-	int hashtab[256];
-	int reprtab[MAXTAB];
-	int rp;
-
-	int macrotext[MAXTAB];
+	map representations;
+	uint64_t macros_hash;		/**< Sum of hashes of macros names with their values */
+	vector *defines;			/**< Indexes of defined macros names, may be @c NULL */
+	map *misses;				/**< Names which were not macros when looked up, may be @c NULL */
+	int memory_failure;			/**< Set if some buffer could not grow, preprocessing fails then */
+
+	char32_t *kstring;
+	size_t kstring_size;
+	int ksp;
+
+	int *macrotext;
+	size_t macrotext_size;
 	int mp;
+	uint64_t macrotext_hash;	/**< Sum of hashes of macro text cells with their positions */
 
-	char error_string[STRING_SIZE];
+	char *error_string;
+	size_t error_string_size;
 	size_t position;
 
-	int mstring[STRING_SIZE];
+	int *mstring;
+	size_t mstring_size;
 	int msp;
 
-	int fchange[STRING_SIZE * 3];
+	int *fchange;
+	size_t fchange_size;
 	int cp;
 
-	int localstack[STRING_SIZE];
+	int *localstack;
+	size_t localstack_size;
 	int lsp;
 
-	int cstring[STRING_SIZE];
+	int *cstring;
+	size_t cstring_size;
 	int csp;
 
-	int ifstring[STRING_SIZE * 2];
+	int *ifstring;
+	size_t ifstring_size;
 	int ifsp;
 
-	int wstring[STRING_SIZE * 5];
+	int *wstring;
+	size_t wstring_size;
 	int wsp;
 
-	int mfirstrp;
-
 	int prep_flag;
+	int flagint;
+	int checkif;
 
 	int curchar, nextchar;
 	int nextch_type;
@@ -79,9 +98,73 @@ typedef struct environment
 	universal_io *input;
 } environment;
 
-void env_init(environment *const env, linker *const lk, universal_io *const output);
+/**
+ *	Initialize preprocessor environment, it must be cleared even on failure
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	lk			Linker structure
+ *	@param	output		Output io
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int env_init(environment *const env, linker *const lk, universal_io *const output);
+void env_clear(environment *const env);
 void env_clear_error_string(environment *const env);
 
+/**
+ *	Reserve place for element with index and the next one, new memory is zeroed
+ *
+ *	@param	array		Array
+ *	@param	size		Pointer to allocated size
+ *	@param	index		Index of element
+ *	@param	element		Size of element
+ *
+ *	@return	Reallocated array, @c NULL on failure
+ */
+void *env_reserve(void *const array, size_t *const size, const size_t index, const size_t element);
+
+/**
+ *	Report failed memory allocation once and mark preprocessing as failed
+ *
+ *	@param	env			Preprocessor environment
+ */
+void env_memory_failure(environment *const env);
+
+/**
+ *	Set value of macro name in representations table, keeping hash of macros up to date
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	index		Index of name in representations table
+ *	@param	value		Offset of macro in macro text
+ */
+void env_set_macro(environment *const env, const size_t index, const item_t value);
+
+/**
+ *	Set value of macro text cell, keeping hash of macro text up to date
+ *
+ *	@param	env			Preprocessor environment
+ *	@param	index		Index of cell, less than top of macro text
+ *	@param	value		New value
+ */
+void env_set_macrotext(environment *const env, const size_t index, const int value);
+
+/**
+ *	Remove the last cell of macro text, keeping hash of macro text up to date
+ *
+ *	@param	env			Preprocessor environment
+ */
+void env_pop_macrotext(environment *const env);
+
+int env_add_kstring(environment *const env, const char32_t value);
+int env_add_macrotext(environment *const env, const int value);
+int env_add_error_string(environment *const env, const char value);
+int env_add_mstring(environment *const env, const int value);
+int env_add_fchange(environment *const env, const int value);
+int env_set_localstack(environment *const env, const int index, const int value);
+int env_add_cstring(environment *const env, const int value);
+int env_add_ifstring(environment *const env, const int value);
+int env_add_wstring(environment *const env, const int value);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -130,6 +130,9 @@ void get_message_error(const int num, char *const msg)
 		case include_file_not_found:
 			sprintf(msg, "заголовочный файл не найден");
 			break;
+		case not_enough_memory:
+			sprintf(msg, "недостаточно памяти для макрогенерации");
+			break;
 		default:
 			sprintf(msg, "не реализованная ошибка №%d", num);
 			break;
@@ -59,6 +59,7 @@ enum ERROR
 	must_end_endw,
 	include_file_not_found,
 	source_file_not_found,
+	not_enough_memory,
 };
 
 
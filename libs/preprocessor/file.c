@@ -233,8 +233,7 @@ void m_nextch(environment *const env)
 
 	if (env->curchar != '\n' && env->curchar != EOF)
 	{
-		env->error_string[env->position++] = (char)env->curchar;
-		env->error_string[env->position] = '\0';
+		env_add_error_string(env, (char)env->curchar);
 	}
 	else
 	{
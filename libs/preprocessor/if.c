@@ -30,8 +30,6 @@
 #include <string.h>
 
 
-int checkif = 0;
-
 
 int if_check(int type_if, environment *const env)
 {
@@ -79,8 +77,8 @@ int if_end(environment *const env)
 			fl_cur = macro_keywords(env);
 			if (fl_cur == SH_ENDIF)
 			{
-				checkif--;
-				if (checkif < 0)
+				env->checkif--;
+				if (env->checkif < 0)
 				{
 					size_t position = skip_str(env); 
 					macro_error(before_endif
@@ -93,7 +91,7 @@ int if_end(environment *const env)
 
 			if (fl_cur == SH_IF || fl_cur == SH_IFDEF || fl_cur == SH_IFNDEF)
 			{
-				checkif++;
+				env->checkif++;
 				if(if_end(env))
 				{
 					return -1;
@@ -168,8 +166,8 @@ int if_true(int type_if, environment *const env)
 
 		if (env->cur == SH_ENDIF)
 		{
-			checkif--;
-			if (checkif < 0)
+			env->checkif--;
+			if (env->checkif < 0)
 			{
 				size_t position = skip_str(env); 
 				macro_error(before_endif
@@ -188,7 +186,7 @@ int if_true(int type_if, environment *const env)
 		macro_error(dont_elif
 			, lk_get_current(env->lk)
 			, env->error_string, env->line, position);
-		checkif--;
+		env->checkif--;
 		return -1;
 	}
 
@@ -201,11 +199,11 @@ int if_implementation(environment *const env)
 	int flag = if_check(type_if, env); // начало (if)
 	if(flag == -1)
 	{
-		checkif--;
+		env->checkif--;
 		return -1;
 	}
 
-	checkif++;
+	env->checkif++;
 	if (flag)
 	{
 		return if_true(type_if, env);
@@ -215,7 +213,7 @@ int if_implementation(environment *const env)
 		int res = if_false(env);
 		if(!res)
 		{
-			checkif--;
+			env->checkif--;
 			return -1;
 		}
 		env->cur = res;
@@ -227,7 +225,7 @@ int if_implementation(environment *const env)
 		flag = if_check(type_if, env);
 		if(flag == -1 || space_end_line(env))
 		{
-			checkif--;
+			env->checkif--;
 			return -1;
 		}
 
@@ -240,7 +238,7 @@ int if_implementation(environment *const env)
 			int res = if_false(env);
 			if(!res)
 			{
-				checkif--;
+				env->checkif--;
 				return -1;
 			}
 			env->cur = res;
@@ -256,8 +254,8 @@ int if_implementation(environment *const env)
 
 	if (env->cur == SH_ENDIF)
 	{
-		checkif--;
-		if (checkif < 0)
+		env->checkif--;
+		if (env->checkif < 0)
 		{
 			size_t position = skip_str(env); 
 			macro_error(before_endif
@@ -37,6 +37,8 @@ linker lk_create(workspace *const ws)
 	lk.ws = ws;
 	lk.current = MAX_PATHS;
 	lk.count = ws_get_files_num(ws);
+	lk.includes = NULL;
+	lk.cache = NULL;
 
 	for (size_t i = 0; i < lk.count; i++)
 	{
@@ -72,7 +74,7 @@ size_t lk_open_include(environment *const env, const char* const path)
 	char full_path[MAX_ARG_SIZE];
 	lk_make_path(full_path, lk_get_current(env->lk), path, 1);
 	
-	if (in_set_file(env->input, full_path))
+	if (in_set_mmap(env->input, full_path))
 	{
 		size_t i = 0;
 		const char *dir;
@@ -81,7 +83,7 @@ size_t lk_open_include(environment *const env, const char* const path)
 		{
 			dir = ws_get_dir(env->lk->ws, i++);
 			lk_make_path(full_path, dir, path, 0);
-		} while (dir != NULL && in_set_file(env->input, full_path));
+		} while (dir != NULL && in_set_mmap(env->input, full_path));
 		
 	}
 
@@ -99,6 +101,15 @@ size_t lk_open_include(environment *const env, const char* const path)
 	}
 	else if (env->lk->included[index])
 	{
+		vector *const includes = env->lk->includes;
+		if (includes != NULL)
+		{
+			const size_t position = out_get_position(env->output);
+			vector_add(includes, (item_t)index);
+			vector_add(includes, (item_t)position);
+			vector_add(includes, (item_t)position);
+		}
+
 		in_clear(env->input);
 		return SIZE_MAX;
 	}
@@ -108,7 +119,7 @@ size_t lk_open_include(environment *const env, const char* const path)
 
 int lk_open_source(environment *const env, const size_t index)
 {
-	if (in_set_file(env->input, ws_get_file(env->lk->ws, index)))
+	if (in_set_mmap(env->input, ws_get_file(env->lk->ws, index)))
 	{
 		macro_system_error(lk_get_current(env->lk), source_file_not_found);
 		return -1;
@@ -136,7 +147,7 @@ int lk_preprocess_file(environment *const env, const size_t number)
 	}
 
 	int was_error = 0; 
-	while (env->curchar != EOF)
+	while (env->curchar != EOF && !env->memory_failure)
 	{
 		was_error = preprocess_scan(env) || was_error;
 	}
@@ -147,7 +158,23 @@ int lk_preprocess_file(environment *const env, const size_t number)
 	env->lk->current = old_cur;
 
 	in_clear(env->input);
-	return was_error ? -1 : 0;
+	return was_error || env->memory_failure ? -1 : 0;
+}
+
+/** Preprocess header or replay it from cache */
+static int lk_preprocess_header(environment *const env, const size_t index)
+{
+	hc_record rec;
+	const int replay = hc_replay(env, index, &rec);
+	if (replay <= 0)
+	{
+		in_clear(env->input);
+		return replay;
+	}
+
+	const int ret = lk_preprocess_file(env, index);
+	hc_store(env, &rec, ret);
+	return ret;
 }
 
 int lk_preprocess_include(environment *const env)
@@ -186,9 +213,24 @@ int lk_preprocess_include(environment *const env)
 		flag_io_type++;
 	}
 	
-	const int res = 2 * lk_preprocess_file(env, index);
+	// Границы вывода заголовка нужны для слияния параллельно обработанных файлов
+	vector *const includes = env->lk->includes;
+	const size_t range = includes != NULL ? vector_size(includes) : 0;
+	if (includes != NULL)
+	{
+		vector_add(includes, (item_t)index);
+		vector_add(includes, (item_t)out_get_position(env->output));
+		vector_add(includes, 0);
+	}
+
+	const int res = 2 * (flag_io_type ? lk_preprocess_file(env, index) : lk_preprocess_header(env, index));
 	env->input = old_in;
 
+	if (includes != NULL)
+	{
+		vector_set(includes, range + 2, (item_t)out_get_position(env->output));
+	}
+
 	if (flag_io_type)
 	{
 		m_old_nextch_type(env);
@@ -228,6 +270,25 @@ int lk_include(environment *const env)
 	return res;
 }
 
+int lk_preprocess_source(environment *const env, const size_t index)
+{
+	if (env == NULL)
+	{
+		return -1;
+	}
+
+	universal_io input = io_create();
+	env->input = &input;
+
+	if (lk_open_source(env, index) || lk_preprocess_file(env, index))
+	{
+		return -1;
+	}
+
+	in_clear(&input);
+	return 0;
+}
+
 int lk_preprocess_all(environment *const env)
 {
 	if (env == NULL)
@@ -242,14 +303,10 @@ int lk_preprocess_all(environment *const env)
 			continue;
 		}
 
-		universal_io input = io_create();
-		env->input = &input;
-
-		if (lk_open_source(env, i) || lk_preprocess_file(env, i))
+		if (lk_preprocess_source(env, i))
 		{
 			return -1;
 		}
-		in_clear(&input);
 	}
 
 	return 0;
@@ -262,7 +319,7 @@ void lk_add_comment(environment *const env)
 	char buffer[MAX_CMT_SIZE];
 	cmt_to_string(&cmt, buffer);
 
-	uni_printf(env->output, "%s", buffer);
+	uni_print_string(env->output, buffer);
 }
 
 const char *lk_get_current(const linker *const lk)
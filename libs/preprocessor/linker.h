@@ -16,6 +16,8 @@
 
 #pragma once
 
+#include "cache.h"
+#include "vector.h"
 #include "workspace.h"
 
 
@@ -34,6 +36,10 @@ typedef struct linker
 	size_t count; 				/**< Number of added files */
 
 	size_t current; 			/**< Index of the current file */
+
+	vector *includes;			/**< Output ranges of included files by triples: index, begin, end,
+									 skipped files have empty ranges */
+	header_cache *cache;		/**< Cache of preprocessed headers, may be @c NULL */
 } linker;
 
 
@@ -44,6 +50,16 @@ typedef struct linker
  */
 linker lk_create(workspace *const ws);
 
+/**
+ *	Preprocess one source file from workspace
+ *
+ *	@param	env		Preprocessor environment
+ *	@param	index	Index of source file
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+int lk_preprocess_source(environment *const env, const size_t index);
+
 /**
  *	Preprocess all files from workspace
  *
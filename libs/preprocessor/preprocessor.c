@@ -15,6 +15,7 @@
  */
 
 #include "preprocessor.h"
+#include "cache.h"
 #include "calculator.h"
 #include "constants.h"
 #include "define.h"
@@ -35,6 +36,11 @@
 #include <string.h>
 #include <wchar.h>
 
+#ifndef _MSC_VER
+	#include <pthread.h>
+	#include <unistd.h>
+#endif
+
 
 #define H_FILE 1
 #define C_FILE 0
@@ -43,43 +49,42 @@
 const size_t SIZE_OUT_BUFFER = 1024;
 
 
-void to_reprtab(const char str[], int num, environment *const env)
+/** Source file preprocessed as independent translation unit */
+typedef struct unit
 {
-	int i = 0;
-	int oldrepr = env->rp;
-	int hash = 0;
-	//unsigned char firstchar;
-	//unsigned char secondchar;
-	//int p;
-	int c = 0;
-	env->rp += 2;
-
-	while(str[i] != '\0')
-	{
-		/*sscanf(&str[i], "%c%n", &firstchar, &p);
+	workspace ws;				/**< Own copy of workspace, includes add files to it */
+	size_t index;				/**< Index of source file */
+	vector includes;			/**< Output ranges of included files */
+	header_cache *cache;		/**< Shared header cache, may be @c NULL */
+	char *output;				/**< Preprocessed text, @c NULL on failure */
+
+	map names;					/**< Representations table after preprocessing */
+	vector defines;				/**< Indexes of macros defined in unit */
+	map misses;					/**< Names used in unit which were not macros */
+} unit;
+
+/** Queue of units shared by worker threads */
+typedef struct queue
+{
+	unit *units;				/**< Units array */
+	size_t count;				/**< Number of units */
+	size_t next;				/**< Index of next free unit */
 
-		if ((firstchar & 0xE0) == 0xC0)
-		{
-			++i;
-			sscanf(&str[i], "%c%n", &secondchar, &p);
-			c = ((int)(firstchar & 0x1F)) << 6 | (secondchar & 0x3F);
-		}
-		else
-		{
-			c = firstchar;
-		}*/
-		c = utf8_convert(&str[i]);
-		i += (int)utf8_symbol_size(str[i]);
+#ifndef _MSC_VER
+	pthread_mutex_t mutex;		/**< Lock for next unit */
+#endif
+} queue;
 
-		hash += c;
-		env->reprtab[env->rp++] = c;
-	}
 
-	hash &= 255;
-	env->reprtab[env->rp++] = 0;
-	env->reprtab[oldrepr] = env->hashtab[hash];
-	env->reprtab[oldrepr + 1] = num;
-	env->hashtab[hash] = oldrepr;
+/** Keywords prepared once by macro_warm_up() */
+static map keywords;
+
+/** Header cache kept between runs after macro_warm_up() */
+static header_cache *headers = NULL;
+
+void to_reprtab(const char str[], int num, environment *const env)
+{
+	map_add(&env->representations, str, num);
 }
 
 void to_reprtab_full(const char str1[], const char str2[], const char str3[], const char str4[], int num, environment *const env)
@@ -112,6 +117,19 @@ void add_keywods(environment *const env)
 	to_reprtab_full("#INCLUDE", "#include", "#ДОБАВИТЬ", "#добавить", SH_INCLUDE, env);
 }
 
+static void env_add_keywords(environment *const env)
+{
+	if (!map_is_correct(&keywords))
+	{
+		add_keywods(env);
+		return;
+	}
+
+	// Копия заранее подготовленной таблицы вместо повторного заполнения
+	map_clear(&env->representations);
+	env->representations = map_copy(&keywords);
+}
+
 int preprocess_words(environment *const env)
 {
 
@@ -133,7 +151,7 @@ int preprocess_words(environment *const env)
 			int k = collect_mident(env);
 			if(k)
 			{
-				env->macrotext[env->reprtab[k + 1]] = MACROUNDEF;
+				env_set_macrotext(env, (size_t)map_get_by_index(&env->representations, (size_t)k), MACROUNDEF);
 				return space_end_line(env);
 			}
 			else
@@ -258,7 +276,8 @@ int preprocess_scan(environment *const env)
 		}
 		default:
 		{
-			if (utf8_is_letter(env->curchar) && env->prep_flag == 1)
+			// При параллельной обработке имена ищутся всегда, чтобы найти зависимости между файлами
+			if (utf8_is_letter(env->curchar) && (env->prep_flag == 1 || env->misses != NULL))
 			{
 				int r = collect_mident(env);
 
@@ -286,19 +305,308 @@ int preprocess_scan(environment *const env)
 }
 
 
-int macro_form_io(workspace *const ws, universal_io *const output)
+int macro_form_io(workspace *const ws, universal_io *const output, header_cache *const hc)
 {
 	linker lk = lk_create(ws);
+	lk.cache = hc;
 
 	environment env;
-	env_init(&env, &lk, output);
+	if (env_init(&env, &lk, output))
+	{
+		env_clear(&env);
+		return -1;
+	}
 
-	add_keywods(&env);
-	env.mfirstrp = env.rp;
-	
-	return lk_preprocess_all(&env);
+	env_add_keywords(&env);
+
+	const int ret = lk_preprocess_all(&env);
+	env_clear(&env);
+	return ret;
+}
+
+static int macro_is_parallel(const workspace *const ws)
+{
+	return ws_has_flag(ws, "-j") && ws_get_files_num(ws) > 1;
+}
+
+/** Get header cache for this run: kept one, new one if headers can repeat, @c NULL otherwise */
+static header_cache *macro_cache_open(const workspace *const ws)
+{
+	const char *const dir = ws_get_flag_value(ws, "-cache");
+	if (headers != NULL)
+	{
+		hc_set_dir(headers, dir);
+		return headers;
+	}
+
+	if (dir == NULL && !macro_is_parallel(ws))
+	{
+		// При последовательной обработке каждый заголовок добавляется один раз
+		return NULL;
+	}
+
+	header_cache *const hc = hc_create();
+	hc_set_dir(hc, dir);
+	return hc;
+}
+
+static void macro_cache_close(header_cache *const hc)
+{
+	if (hc != headers)
+	{
+		hc_clear(hc);
+	}
+}
+
+static void unit_preprocess(unit *const un)
+{
+	un->output = NULL;
+
+	linker lk = lk_create(&un->ws);
+	lk.includes = &un->includes;
+	lk.cache = un->cache;
+
+	universal_io io = io_create();
+	if (out_set_buffer(&io, SIZE_OUT_BUFFER))
+	{
+		return;
+	}
+
+	environment env;
+	if (env_init(&env, &lk, &io))
+	{
+		env_clear(&env);
+		io_erase(&io);
+		return;
+	}
+
+	env.defines = &un->defines;
+	env.misses = &un->misses;
+
+	env_add_keywords(&env);
+
+	const int ret = lk_preprocess_source(&env, un->index);
+
+	// Таблица имён нужна для проверки зависимостей между файлами, взамен отдаётся пустая
+	const map names = un->names;
+	un->names = env.representations;
+	env.representations = names;
+	env_clear(&env);
+
+	if (ret)
+	{
+		io_erase(&io);
+		return;
+	}
+
+	in_clear(&io);
+	un->output = out_extract_buffer(&io);
+}
+
+static void *queue_worker(void *const arg)
+{
+	queue *const q = arg;
+
+	for (;;)
+	{
+#ifndef _MSC_VER
+		pthread_mutex_lock(&q->mutex);
+#endif
+		const size_t index = q->next < q->count ? q->next++ : q->count;
+#ifndef _MSC_VER
+		pthread_mutex_unlock(&q->mutex);
+#endif
+
+		if (index == q->count)
+		{
+			return NULL;
+		}
+
+		unit_preprocess(&q->units[index]);
+	}
+}
+
+static void queue_run(queue *const q)
+{
+#ifndef _MSC_VER
+	long workers = sysconf(_SC_NPROCESSORS_ONLN);
+	workers = workers < 1 ? 1 : workers > (long)q->count ? (long)q->count : workers;
+
+	pthread_t *const handles = malloc(sizeof(pthread_t) * (size_t)workers);
+	if (handles != NULL && !pthread_mutex_init(&q->mutex, NULL))
+	{
+		// Главная нить тоже обрабатывает файлы, поэтому создаётся на одну нить меньше
+		long started = 0;
+		while (started + 1 < workers && !pthread_create(&handles[started], NULL, &queue_worker, q))
+		{
+			started++;
+		}
+
+		queue_worker(q);
+		for (long i = 0; i < started; i++)
+		{
+			pthread_join(handles[i], NULL);
+		}
+
+		pthread_mutex_destroy(&q->mutex);
+		free(handles);
+		return;
+	}
+
+	free(handles);
+#endif
+
+	// Без pthreads файлы обрабатываются по очереди
+	for (size_t i = 0; i < q->count; i++)
+	{
+		unit_preprocess(&q->units[i]);
+	}
+}
+
+/** Append unit output skipping files which were already included, as in sequential mode */
+static int unit_merge(workspace *const ws, const unit *const un, int *const included, universal_io *const output)
+{
+	const char *const text = un->output;
+	size_t cursor = 0;
+	size_t skip = 0;
+
+	for (size_t i = 0; i + 2 < vector_size(&un->includes); i += 3)
+	{
+		const size_t begin = (size_t)vector_get(&un->includes, i + 1);
+		if (begin < skip)
+		{
+			// Файл внутри уже пропущенного
+			continue;
+		}
+
+		const size_t index = ws_add_file(ws, ws_get_file(&un->ws, (size_t)vector_get(&un->includes, i)));
+		if (index >= MAX_PATHS)
+		{
+			return -1;
+		}
+
+		if (included[index])
+		{
+			const size_t end = (size_t)vector_get(&un->includes, i + 2);
+			if (out_write(output, &text[cursor], begin - cursor) == -1)
+			{
+				return -1;
+			}
+
+			cursor = end;
+			skip = end;
+		}
+		else
+		{
+			included[index] = 1;
+		}
+	}
+
+	const size_t length = strlen(&text[cursor]);
+	return out_write(output, &text[cursor], length) == -1 ? -1 : 0;
+}
+
+/**
+ *	Check that no unit uses macro defined by one of previous units.
+ *	Such macro is visible in sequential mode only, except the ones unit defines itself,
+ *	e.g. guards of shared headers.
+ *
+ *	@param	q		Queue of preprocessed units
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+static int units_are_independent(queue *const q)
+{
+	for (size_t i = 0; i < q->count; i++)
+	{
+		unit *const prev = &q->units[i];
+		for (size_t j = 0; j < vector_size(&prev->defines); j++)
+		{
+			const char *const name = map_to_string(&prev->names, (size_t)vector_get(&prev->defines, j));
+			for (size_t k = i + 1; k < q->count; k++)
+			{
+				unit *const next = &q->units[k];
+				const item_t value = map_get(&next->names, name);
+				if (map_get(&next->misses, name) != ITEM_MAX && (value < 0 || value == ITEM_MAX))
+				{
+					return 0;
+				}
+			}
+		}
+	}
+
+	return 1;
+}
+
+/**
+ *	Preprocess each source file on its own worker thread,
+ *	then merge the outputs in workspace order.
+ *	Falls back to sequential mode if files depend on macros of each other.
+ *
+ *	@param	ws		Workspace
+ *	@param	output	Output io
+ *	@param	hc		Header cache shared by units
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+static int macro_parallel(workspace *const ws, universal_io *const output, header_cache *const hc)
+{
+	const size_t count = ws_get_files_num(ws);
+	queue q;
+	q.units = malloc(sizeof(unit) * count);
+	q.count = count;
+	q.next = 0;
+
+	if (q.units == NULL)
+	{
+		return -1;
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		q.units[i].ws = *ws;
+		q.units[i].index = i;
+		q.units[i].includes = vector_create(3 * MAX_PATHS);
+		q.units[i].cache = hc;
+		q.units[i].names = map_create(1);
+		q.units[i].defines = vector_create(REPRTAB_SIZE);
+		q.units[i].misses = map_create(REPRTAB_SIZE);
+	}
+
+	queue_run(&q);
+
+	// Ошибка в файле тоже может быть вызвана макросом из предыдущего
+	const int sequential = !units_are_independent(&q);
+	int ret = sequential ? macro_form_io(ws, output, hc) : 0;
+	for (size_t i = 0; i < count && !sequential; i++)
+	{
+		ret = ret || q.units[i].output == NULL;
+	}
+
+	int included[MAX_PATHS] = { 0 };
+	for (size_t i = 0; i < count && !ret && !sequential; i++)
+	{
+		if (!included[i])
+		{
+			included[i] = 1;
+			ret = unit_merge(ws, &q.units[i], included, output);
+		}
+	}
+
+	for (size_t i = 0; i < count; i++)
+	{
+		free(q.units[i].output);
+		vector_clear(&q.units[i].includes);
+		map_clear(&q.units[i].names);
+		vector_clear(&q.units[i].defines);
+		map_clear(&q.units[i].misses);
+	}
+
+	free(q.units);
+	return ret ? -1 : 0;
 }
 
+
 /*
  *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
  *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
@@ -321,7 +629,10 @@ char *macro(workspace *const ws)
 		return NULL;
 	}
 
-	int ret = macro_form_io(ws, &io);
+	header_cache *const hc = macro_cache_open(ws);
+	int ret = macro_is_parallel(ws) ? macro_parallel(ws, &io, hc) : macro_form_io(ws, &io, hc);
+	macro_cache_close(hc);
+
 	if (ret)
 	{
 		io_erase(&io);
@@ -345,7 +656,9 @@ int macro_to_file(workspace *const ws, const char *const path)
 		return -1;
 	}
 
-	int ret = macro_form_io(ws, &io);
+	header_cache *const hc = macro_cache_open(ws);
+	int ret = macro_form_io(ws, &io, hc);
+	macro_cache_close(hc);
 
 	io_erase(&io);
 	return ret;
@@ -363,3 +676,33 @@ int auto_macro_to_file(const int argc, const char *const *const argv, const char
 	workspace ws = ws_parse_args(argc, argv);
 	return macro_to_file(&ws, path);
 }
+
+
+int macro_warm_up()
+{
+	if (map_is_correct(&keywords))
+	{
+		return 0;
+	}
+
+	environment env;
+	env.representations = map_create(REPRTAB_SIZE);
+	if (!map_is_correct(&env.representations))
+	{
+		return -1;
+	}
+
+	add_keywods(&env);
+	keywords = env.representations;
+
+	headers = hc_create();
+	return headers != NULL ? 0 : -1;
+}
+
+void macro_cool_down()
+{
+	map_clear(&keywords);
+
+	hc_clear(headers);
+	headers = NULL;
+}
@@ -29,7 +29,9 @@ int preprocess_scan(environment *const env);
 
 
 /**
- *	Preprocess files from workspace
+ *	Preprocess files from workspace,
+ *	files are processed in parallel with @c -j flag,
+ *	preprocessed headers are kept between runs in @c -cache=<dir> directory
  *
  *	@param	ws		Workspace
  *
@@ -69,6 +71,20 @@ EXPORTED char *auto_macro(const int argc, const char *const *const argv);
  */
 EXPORTED int auto_macro_to_file(const int argc, const char *const *const argv, const char *const path);
 
+
+/**
+ *	Prepare keywords table once to copy it in subsequent preprocessing runs
+ *	and keep preprocessed headers between runs
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int macro_warm_up();
+
+/**
+ *	Free keywords table and headers cache prepared by @c macro_warm_up()
+ */
+EXPORTED void macro_cool_down();
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
@@ -28,46 +28,21 @@
 #include <string.h>
 
 
-int equal_reprtab(int i, int j, environment *const env)
-{
-	i += 2;
-	j += 2;
-
-	while (env->reprtab[i] == env->reprtab[j])
-	{
-		i++;
-		j++;
-
-		if (env->reprtab[i] == 0 && env->reprtab[j] == 0)
-		{
-			return 1;
-		}
-	}
-
-	return 0;
-}
-
 void output_keywords(environment *const env)
 {
-	for (int j = 0; j < env->reprtab[env->rp]; j++)
+	for (int j = 0; j < env->ksp; j++)
 	{
-		m_fprintf(env->reprtab[env->rp + 2 + j], env);
+		m_fprintf((int)env->kstring[j], env);
 	}
 }
 
 int macro_keywords(environment *const env)
 {
-	int oldrepr = env->rp;
-	int r = 0;
-	int n = 0;
-
-	env->rp += 2;
-	int hash = 0;
+	env->ksp = 0;
+	int was_error = 0;
 	do
 	{
-		hash += env->curchar;
-		env->reprtab[env->rp++] = env->curchar;
-		n++;
+		was_error = was_error || env_add_kstring(env, (char32_t)env->curchar);
 		m_nextch(env);
 	} while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar));
 
@@ -79,113 +54,48 @@ int macro_keywords(environment *const env)
 			, env->error_string, env->line, position);
 	}*/
 
-	hash &= 255;
-	env->reprtab[env->rp++] = 0;
-	r = env->hashtab[hash];
-	if (r)
-	{
-		do
-		{
-			if (equal_reprtab(r, oldrepr, env))
-			{
-				env->rp = oldrepr;
-				env->reprtab[env->rp] = n;
-				return (env->reprtab[r + 1] < 0) ? env->reprtab[r + 1] : 0;
-			}
-			else
-			{
-				r = env->reprtab[r];
-			}
-		} while (r);
-	}
-
-	env->rp = oldrepr;
-	env->reprtab[env->rp] = n;
-	return 0;
-}
-
-int mf_equal(int i, environment *const env)
-{
-	int j = 0;
-	i += 2;
-
-	while (env->reprtab[i] == env->mstring[j])
-	{
-		i++;
-		j++;
-		if (env->reprtab[i] == 0 && env->mstring[j] == MACROEND)
-		{
-			return 1;
-		}
-	}
-
-	return 0;
+	// Ошибка уже выведена, обрезанное слово не считается ключевым
+	env->kstring[env->ksp] = '\0';
+	const item_t value = was_error ? ITEM_MAX : map_get_by_utf8(&env->representations, env->kstring);
+	return value != ITEM_MAX && value < 0 ? (int)value : 0;
 }
 
 int collect_mident(environment *const env)
 {
-	int r;
-	int hash = 0;
+	env->ksp = 0;
 	env->msp = 0;
+	int was_error = 0;
 
 	while (utf8_is_letter(env->curchar) || utf8_is_digit(env->curchar))
 	{
-		env->mstring[env->msp++] = env->curchar;
-		hash += env->curchar;
+		was_error = was_error || env_add_kstring(env, (char32_t)env->curchar)
+			|| env_add_mstring(env, env->curchar);
 		m_nextch(env);
 	}
 
 	env->mstring[env->msp] = MACROEND;
-	hash &= 255;
-	r = env->hashtab[hash];
-
-	while (r)
+	env->kstring[env->ksp] = '\0';
+	if (was_error)
 	{
-		if (r >= env->mfirstrp && mf_equal(r, env))
-		{
-			return (env->macrotext[env->reprtab[r + 1]] != MACROUNDEF) ? r : 0;
-		}
-
-		r = env->reprtab[r];
+		// Ошибка уже выведена, обрезанное имя не считается макросом
+		return 0;
 	}
 
-	return 0;
-}
-
-int find_file(environment *const env, const char *s)
-{
-	int oldrp = env->rp;
-	env->rp += 2;
-	int r;
-	int hash = 0;
-	int i = 0;
-
-	while (s[i] != '\0')
+	// Имя только ищется, в таблицу его добавляет #define
+	// Ключевые слова добавлены первыми, поэтому индекс макроса не бывает нулевым
+	const size_t index = map_find_by_utf8(&env->representations, env->kstring);
+	const item_t value = index != SIZE_MAX ? map_get_by_index(&env->representations, index) : ITEM_MAX;
+	if (value != ITEM_MAX && value >= 0 && env->macrotext[value] != MACROUNDEF)
 	{
-		env->reprtab[env->rp++] = s[i];
-		hash += s[i];
-		i++;
+		return (int)index;
 	}
 
-	hash &= 255;
-	r = env->hashtab[hash];
-
-	while (r)
+	if (env->misses != NULL)
 	{
-		if (env->reprtab[r + 1] == SH_FILE && equal_reprtab(r, oldrp, env))
-		{
-			env->rp = oldrp;
-			return 0;
-		}
-
-		r = env->reprtab[r];
+		map_add_by_utf8(env->misses, env->kstring, 0);
 	}
 
-	env->reprtab[oldrp] = env->hashtab[hash];
-	env->reprtab[oldrp + 1] = SH_FILE;
-	env->hashtab[hash] = oldrp;
-	env->reprtab[env->rp++] = 0;
-	return 1;
+	return 0;
 }
 
 int space_end_line(environment *const env)
@@ -23,11 +23,9 @@
 extern "C" {
 #endif
 
-int equal_reprtab(int i, int j, environment *const env);
 void output_keywords(environment *const env);
 int macro_keywords(environment *const env);
 int collect_mident(environment *const env);
-int find_file(environment *const env, const char *s);
 
 int space_end_line(environment *const env);
 void skip_space(environment *const env);
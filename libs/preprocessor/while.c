@@ -34,16 +34,24 @@ int while_collect(environment *const env)
 {
 	int oldwsp = env->wsp;
 
-	env->wstring[env->wsp++] = WHILEBEGIN;
-	env->wstring[env->wsp++] = env->ifsp;
+	if (env_add_wstring(env, WHILEBEGIN) || env_add_wstring(env, env->ifsp))
+	{
+		return -1;
+	}
 	env->wsp++;
 
 	while (env->curchar != '\n')
 	{
-		env->ifstring[env->ifsp++] = env->curchar;
+		if (env_add_ifstring(env, env->curchar))
+		{
+			return -1;
+		}
 		m_nextch(env);
 	}
-	env->ifstring[env->ifsp++] = '\n';
+	if (env_add_ifstring(env, '\n'))
+	{
+		return -1;
+	}
 	m_nextch(env);
 
 	while (env->curchar != EOF)
@@ -54,11 +62,17 @@ int while_collect(environment *const env)
 
 			if (env->cur == SH_WHILE)
 			{
-				while_collect(env);
+				if (while_collect(env))
+				{
+					return -1;
+				}
 			}
 			else if (env->cur == SH_ENDW)
 			{	
-				env->wstring[env->wsp++] = ' ';
+				if (env_add_wstring(env, ' '))
+				{
+					return -1;
+				}
 				env->wstring[oldwsp + 2] = env->wsp;
 				env->cur = 0;
 
@@ -68,13 +82,19 @@ int while_collect(environment *const env)
 			{
 				int i = 0;
 
-				for (i = 0; i < env->reprtab[env->rp]; i++)
+				for (i = 0; i < env->ksp; i++)
 				{
-					env->wstring[env->wsp++] = env->reprtab[env->rp + 2 + i];
+					if (env_add_wstring(env, (int)env->kstring[i]))
+					{
+						return -1;
+					}
 				}
 			}
 		}
-		env->wstring[env->wsp++] = env->curchar;
+		if (env_add_wstring(env, env->curchar))
+		{
+			return -1;
+		}
 		m_nextch(env);
 	}
 
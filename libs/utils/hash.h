@@ -0,0 +1,54 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "dll.h"
+
+
+/** Initial value of hash */
+#define HASH_INIT 14695981039346656037ULL
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ *	Add bytes to FNV-1a hash, whole words are added at once
+ *
+ *	@param	hash		Hash, @c HASH_INIT to start a new one
+ *	@param	data		Bytes
+ *	@param	size		Number of bytes
+ *
+ *	@return	Hash
+ */
+EXPORTED uint64_t hash_bytes(uint64_t hash, const void *const data, const size_t size);
+
+/**
+ *	Mix bits of hash, so that its low bits may be used as table index
+ *
+ *	@param	hash		Hash
+ *
+ *	@return	Final hash
+ */
+EXPORTED uint64_t hash_mix(uint64_t hash);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
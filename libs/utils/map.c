@@ -15,19 +15,22 @@
  */
 
 #include "map.h"
+#include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#include "hash.h"
+#include "profiler.h"
 #include "uniscanner.h"
 #include "utf8.h"
 
 
-const size_t MAP_HASH_MAX = 256;
+const size_t MAP_TABLE_MIN = 256;
 const size_t MAP_KEY_SIZE = 8;
 
 
 struct map_hash
 {
-	size_t next;
+	size_t hash;
 	size_t ref;
 	item_t value;
 };
@@ -47,11 +50,20 @@ int map_add_key_symbol(map *const as, const char32_t ch)
 		return -1;
 	}
 
+	prof_allocation(1);
+
 	as->keys_alloc *= 2;
 	as->keys = keys_new;
 	return map_add_key_symbol(as, ch);
 }
 
+/** Hash of the last added key */
+size_t map_hash_key(const map *const as)
+{
+	const uint64_t hash = hash_mix(hash_bytes(HASH_INIT, &as->keys[as->keys_size], as->keys_next - as->keys_size));
+	return (size_t)hash % SIZE_MAX;
+}
+
 size_t map_get_hash(map *const as, const char *const key)
 {
 	char32_t ch = utf8_convert(key);
@@ -66,7 +78,6 @@ size_t map_get_hash(map *const as, const char *const key)
 		return SIZE_MAX;
 	}
 
-	size_t hash = ch;
 	while (key[as->keys_next - as->keys_size] != '\0')
 	{
 		ch = utf8_convert(&key[as->keys_next - as->keys_size]);
@@ -79,11 +90,9 @@ size_t map_get_hash(map *const as, const char *const key)
 		{
 			return SIZE_MAX;
 		}
-
-		hash += ch;
 	}
 
-	return hash % MAP_HASH_MAX;
+	return map_hash_key(as);
 }
 
 size_t map_get_hash_by_utf8(map *const as, const char32_t *const key)
@@ -99,8 +108,6 @@ size_t map_get_hash_by_utf8(map *const as, const char32_t *const key)
 		return SIZE_MAX;
 	}
 
-	size_t hash = key[0];
-
 	size_t i = 1;
 	while (key[i] != '\0')
 	{
@@ -109,15 +116,13 @@ size_t map_get_hash_by_utf8(map *const as, const char32_t *const key)
 			return SIZE_MAX;
 		}
 
-		if (map_add_key_symbol(as, key[i]))
+		if (map_add_key_symbol(as, key[i++]))
 		{
 			return SIZE_MAX;
 		}
-
-		hash += key[i++];
 	}
 
-	return hash % MAP_HASH_MAX;
+	return map_hash_key(as);
 }
 
 size_t map_get_hash_by_io(map *const as, universal_io *const io, char32_t *const last)
@@ -134,7 +139,6 @@ size_t map_get_hash_by_io(map *const as, universal_io *const io, char32_t *const
 		return SIZE_MAX;
 	}
 
-	size_t hash = *last;
 	*last = uni_scan_char(io);
 	while (utf8_is_letter(*last) || utf8_is_digit(*last))
 	{
@@ -143,11 +147,10 @@ size_t map_get_hash_by_io(map *const as, universal_io *const io, char32_t *const
 			return SIZE_MAX;
 		}
 
-		hash += *last;
 		*last = uni_scan_char(io);
 	}
 
-	return hash % MAP_HASH_MAX;
+	return map_hash_key(as);
 }
 
 
@@ -156,33 +159,77 @@ int map_cmp_key(const map *const as, const size_t index)
 	return strcmp(&as->keys[as->values[index].ref], &as->keys[as->keys_size]);
 }
 
-size_t map_add_by_hash(map *const as, const size_t hash, const item_t value)
+/** Find table slot of the last added key: slot with its index or first empty slot */
+size_t map_find_slot(const map *const as, const size_t hash)
 {
-	if (hash == SIZE_MAX)
+	const size_t mask = as->table_size - 1;
+
+	size_t slot = hash & mask;
+	while (as->table[slot] != SIZE_MAX
+		&& (as->values[as->table[slot]].hash != hash || map_cmp_key(as, as->table[slot]) != 0))
 	{
-		return SIZE_MAX;
+		slot = (slot + 1) & mask;
+		prof_count(COUNTER_COLLISIONS, 1);
 	}
 
-	size_t index = hash;
-	while (as->values[index].next != SIZE_MAX)
+	return slot;
+}
+
+int map_rehash(map *const as)
+{
+	const size_t table_size = 2 * as->table_size;
+	size_t *table_new = malloc(table_size * sizeof(size_t));
+	if (table_new == NULL)
 	{
-		if (map_cmp_key(as, index) == 0)
+		return -1;
+	}
+
+	prof_allocation(1);
+
+	for (size_t i = 0; i < table_size; i++)
+	{
+		table_new[i] = SIZE_MAX;
+	}
+
+	for (size_t i = 0; i < as->values_size; i++)
+	{
+		size_t slot = as->values[i].hash & (table_size - 1);
+		while (table_new[slot] != SIZE_MAX)
 		{
-			return value == ITEM_MAX ? index : SIZE_MAX;
+			slot = (slot + 1) & (table_size - 1);
 		}
-		index = as->values[index].next;
+
+		table_new[slot] = i;
 	}
 
-	if (as->values[index].ref == SIZE_MAX)
+	free(as->table);
+	as->table = table_new;
+	as->table_size = table_size;
+	return 0;
+}
+
+size_t map_add_by_hash(map *const as, const size_t hash, const item_t value)
+{
+	if (hash == SIZE_MAX)
 	{
-		as->values[index].ref = as->keys_size;
-		as->keys_size = as->keys_next + 1;
-		as->values[index].value = value;
-		return index;
+		return SIZE_MAX;
 	}
-	else if (map_cmp_key(as, index) == 0)
+
+	size_t slot = map_find_slot(as, hash);
+	if (as->table[slot] != SIZE_MAX)
 	{
-		return value == ITEM_MAX ? index : SIZE_MAX;
+		return value == ITEM_MAX ? as->table[slot] : SIZE_MAX;
+	}
+
+	// Таблица растет до вставки, чтобы при ошибке запись не оставалась в map
+	if (2 * (as->values_size + 1) > as->table_size)
+	{
+		if (map_rehash(as))
+		{
+			return SIZE_MAX;
+		}
+
+		slot = map_find_slot(as, hash);
 	}
 
 	if (as->values_size == as->values_alloc)
@@ -193,17 +240,19 @@ size_t map_add_by_hash(map *const as, const size_t hash, const item_t value)
 			return SIZE_MAX;
 		}
 
+		prof_allocation(1);
+
 		as->values_alloc *= 2;
 		as->values = values_new;
 	}
 
-	as->values[index].next = as->values_size;
-	index = as->values_size++;
-
-	as->values[index].next = SIZE_MAX;
+	const size_t index = as->values_size++;
+	as->values[index].hash = hash;
 	as->values[index].ref = as->keys_size;
 	as->keys_size = as->keys_next + 1;
 	as->values[index].value = value;
+
+	as->table[slot] = index;
 	return index;
 }
 
@@ -214,23 +263,12 @@ size_t map_set_by_hash(map *const as, const size_t hash, const item_t value)
 		return SIZE_MAX;
 	}
 
-	size_t index = hash;
-	while (as->values[index].next != SIZE_MAX)
+	const size_t index = as->table[map_find_slot(as, hash)];
+	if (index != SIZE_MAX)
 	{
-		if (map_cmp_key(as, index) == 0)
-		{
-			as->values[index].value = value;
-			return index;
-		}
-		index = as->values[index].next;
-	}
-
-	if (as->values[index].ref == SIZE_MAX || map_cmp_key(as, index) != 0)
-	{
-		return SIZE_MAX;
+		as->values[index].value = value;
 	}
 
-	as->values[index].value = value;
 	return index;
 }
 
@@ -241,22 +279,8 @@ item_t map_get_by_hash(const map *const as, const size_t hash)
 		return ITEM_MAX;
 	}
 
-	size_t index = hash;
-	while (as->values[index].next != SIZE_MAX)
-	{
-		if (map_cmp_key(as, index) == 0)
-		{
-			return as->values[index].value;
-		}
-		index = as->values[index].next;
-	}
-
-	if (as->values[index].ref == SIZE_MAX || map_cmp_key(as, index) != 0)
-	{
-		return ITEM_MAX;
-	}
-
-	return as->values[index].value;
+	const size_t index = as->table[map_find_slot(as, hash)];
+	return index != SIZE_MAX ? as->values[index].value : ITEM_MAX;
 }
 
 
@@ -265,6 +289,7 @@ map map_broken()
 	map as;
 	as.values = NULL;
 	as.keys = NULL;
+	as.table = NULL;
 	return as;
 }
 
@@ -282,8 +307,8 @@ map map_create(const size_t alloc)
 {
 	map as;
 
-	as.values_size = MAP_HASH_MAX;
-	as.values_alloc = as.values_size + alloc;
+	as.values_size = 0;
+	as.values_alloc = alloc != 0 ? alloc : 1;
 
 	as.values = malloc(as.values_alloc * sizeof(map_hash));
 	if (as.values == NULL)
@@ -291,25 +316,67 @@ map map_create(const size_t alloc)
 		return map_broken();
 	}
 
-	for (size_t i = 0; i < as.values_size; i++)
+	as.table_size = MAP_TABLE_MIN;
+	while (as.table_size < 2 * as.values_alloc)
 	{
-		as.values[i].next = SIZE_MAX;
-		as.values[i].ref = SIZE_MAX;
+		as.table_size *= 2;
+	}
+
+	as.table = malloc(as.table_size * sizeof(size_t));
+	if (as.table == NULL)
+	{
+		free(as.values);
+		return map_broken();
+	}
+
+	for (size_t i = 0; i < as.table_size; i++)
+	{
+		as.table[i] = SIZE_MAX;
 	}
 
 	as.keys_size = 0;
-	as.keys_alloc = as.values_alloc * MAP_KEY_SIZE;
+	as.keys_alloc = (as.values_alloc + 1) * MAP_KEY_SIZE;
 
 	as.keys = malloc(as.keys_alloc * sizeof(char));
 	if (as.keys == NULL)
 	{
 		free(as.values);
+		free(as.table);
 		return map_broken();
 	}
 
+	prof_allocation(3);
 	return as;
 }
 
+map map_copy(const map *const as)
+{
+	if (!map_is_correct(as))
+	{
+		return map_broken();
+	}
+
+	map copy = *as;
+
+	copy.values = malloc(copy.values_alloc * sizeof(map_hash));
+	copy.table = malloc(copy.table_size * sizeof(size_t));
+	copy.keys = malloc(copy.keys_alloc * sizeof(char));
+	if (copy.values == NULL || copy.table == NULL || copy.keys == NULL)
+	{
+		free(copy.values);
+		free(copy.table);
+		free(copy.keys);
+		return map_broken();
+	}
+
+	memcpy(copy.values, as->values, copy.values_size * sizeof(map_hash));
+	memcpy(copy.table, as->table, copy.table_size * sizeof(size_t));
+	memcpy(copy.keys, as->keys, copy.keys_size * sizeof(char));
+
+	prof_allocation(3);
+	return copy;
+}
+
 
 size_t map_reserve(map *const as, const char *const key)
 {
@@ -405,7 +472,7 @@ size_t map_set_by_io(map *const as, universal_io *const io, const item_t value,
 
 int map_set_by_index(map *const as, const size_t index, const item_t value)
 {
-	if (!map_is_correct(as) || index >= as->values_size || as->values[index].ref == SIZE_MAX)
+	if (!map_is_correct(as) || index >= as->values_size)
 	{
 		return -1;
 	}
@@ -436,6 +503,17 @@ item_t map_get_by_utf8(map *const as, const char32_t *const key)
 	return map_get_by_hash(as, map_get_hash_by_utf8(as, key));
 }
 
+size_t map_find_by_utf8(map *const as, const char32_t *const key)
+{
+	if (!map_is_correct(as) || key == NULL)
+	{
+		return SIZE_MAX;
+	}
+
+	const size_t hash = map_get_hash_by_utf8(as, key);
+	return hash != SIZE_MAX ? as->table[map_find_slot(as, hash)] : SIZE_MAX;
+}
+
 item_t map_get_by_io(map *const as, universal_io *const io, char32_t *const last)
 {
 	if (!map_is_correct(as) || !in_is_correct(io) || last == NULL)
@@ -448,7 +526,7 @@ item_t map_get_by_io(map *const as, universal_io *const io, char32_t *const last
 
 item_t map_get_by_index(const map *const as, const size_t index)
 {
-	if (!map_is_correct(as) || index >= as->values_size || as->values[index].ref == SIZE_MAX)
+	if (!map_is_correct(as) || index >= as->values_size)
 	{
 		return ITEM_MAX;
 	}
@@ -459,7 +537,7 @@ item_t map_get_by_index(const map *const as, const size_t index)
 
 const char *map_to_string(const map *const as, const size_t index)
 {
-	if (!map_is_correct(as) || index >= as->values_size || as->values[index].ref == SIZE_MAX)
+	if (!map_is_correct(as) || index >= as->values_size)
 	{
 		return NULL;
 	}
@@ -469,7 +547,7 @@ const char *map_to_string(const map *const as, const size_t index)
 
 int map_is_correct(const map *const as)
 {
-	return as != NULL && as->values != NULL && as->keys != NULL;
+	return as != NULL && as->values != NULL && as->keys != NULL && as->table != NULL;
 }
 
 
@@ -486,5 +564,8 @@ int map_clear(map *const as)
 	free(as->keys);
 	as->keys = NULL;
 
+	free(as->table);
+	as->table = NULL;
+
 	return 0;
 }
@@ -26,7 +26,7 @@
 extern "C" {
 #endif
 
-/** Hash table */
+/** Map record */
 typedef struct map_hash map_hash;
 
 /** Associative array (Dictionary) */
@@ -40,6 +40,9 @@ typedef struct map
 	map_hash *values;			/**< Values storage */
 	size_t values_size;			/**< Size of values storage */
 	size_t values_alloc;		/**< Allocated size of values storage */
+
+	size_t *table;				/**< Hash table of values indexes */
+	size_t table_size;			/**< Size of hash table, power of two */
 } map;
 
 
@@ -52,6 +55,15 @@ typedef struct map
  */
 EXPORTED map map_create(const size_t alloc);
 
+/**
+ *	Create a deep copy of map structure
+ *
+ *	@param	as				Map structure
+ *
+ *	@return	Map structure
+ */
+EXPORTED map map_copy(const map *const as);
+
 
 /**
  *	Reserve new key or return existing
@@ -186,6 +198,16 @@ EXPORTED item_t map_get(map *const as, const char *const key);
  */
 EXPORTED item_t map_get_by_utf8(map *const as, const char32_t *const key);
 
+/**
+ *	Find index of UTF-8 key without adding it
+ *
+ *	@param	as				Map structure
+ *	@param	key				Unique UTF-8 string key
+ *
+ *	@return	Index of record, @c SIZE_MAX if key is not found
+ */
+EXPORTED size_t map_find_by_utf8(map *const as, const char32_t *const key);
+
 /**
  *	Get value by reading key from io
  *
@@ -0,0 +1,226 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "profiler.h"
+#include <stdio.h>
+#include <time.h>
+
+#ifndef _MSC_VER
+	#include <stdatomic.h>
+
+	typedef atomic_size_t prof_size_t;
+#else
+	typedef size_t prof_size_t;
+#endif
+
+
+/** Every SAMPLE_RATE-th call of sampled phase is measured */
+static const size_t SAMPLE_RATE = 64;
+
+static const char *const PHASE_NAMES[PHASE_COUNT] =
+{
+	"none", "macro", "lexer", "parser", "codegen", "export"
+};
+
+static const char *const COUNTER_NAMES[COUNTER_COUNT] =
+{
+	"tokens", "tree_cells", "identifiers", "modes", "memory_items", "map_collisions"
+};
+
+
+/** Profiling is off until started, so counting costs only a check */
+static int is_started = 0;
+
+static phase_t current = PHASE_NONE;
+static double phase_begin = 0;
+
+static double times[PHASE_COUNT];
+static size_t allocations[PHASE_COUNT];
+static double total_begin = 0;
+
+static size_t sample_calls = 0;
+static phase_t sample_prev = PHASE_NONE;
+
+// Выделения памяти и коллизии считаются и в потоках препроцессора
+static prof_size_t allocated = 0;
+static prof_size_t counters[COUNTER_COUNT];
+static size_t phase_allocated = 0;
+
+
+/** Current time in milliseconds */
+static double prof_time()
+{
+	struct timespec ts;
+#ifndef _MSC_VER
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+#else
+	timespec_get(&ts, TIME_UTC);
+#endif
+	return (double)ts.tv_sec * 1000.0 + (double)ts.tv_nsec / 1000000.0;
+}
+
+/** Close current phase at the given time */
+static void prof_close(const double now)
+{
+	const size_t total = allocated;
+	times[current] += now - phase_begin;
+	allocations[current] += total - phase_allocated;
+
+	phase_begin = now;
+	phase_allocated = total;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+void prof_start()
+{
+	for (size_t i = 0; i < PHASE_COUNT; i++)
+	{
+		times[i] = 0;
+		allocations[i] = 0;
+	}
+
+	for (size_t i = 0; i < COUNTER_COUNT; i++)
+	{
+		counters[i] = 0;
+	}
+
+	allocated = 0;
+	phase_allocated = 0;
+	current = PHASE_NONE;
+	sample_calls = 0;
+
+	total_begin = prof_time();
+	phase_begin = total_begin;
+	is_started = 1;
+}
+
+int prof_is_started()
+{
+	return is_started;
+}
+
+phase_t prof_enter(const phase_t ph)
+{
+	const phase_t prev = current;
+	if (!is_started || ph == current || ph >= PHASE_COUNT)
+	{
+		return prev;
+	}
+
+	prof_close(prof_time());
+	current = ph;
+	return prev;
+}
+
+int prof_sample_begin(const phase_t ph)
+{
+	if (!is_started || ph >= PHASE_COUNT || ++sample_calls % SAMPLE_RATE != 0)
+	{
+		return 0;
+	}
+
+	sample_prev = prof_enter(ph);
+	return 1;
+}
+
+void prof_sample_end()
+{
+	const double now = prof_time();
+	const double sample = (now - phase_begin) * (double)(SAMPLE_RATE - 1);
+	const phase_t ph = current;
+	prof_close(now);
+	current = sample_prev;
+
+	// Несэмплированные вызовы были учтены во внешней фазе
+	const double moved = sample < times[current] ? sample : times[current];
+	times[ph] += moved;
+	times[current] -= moved;
+}
+
+void prof_count(const counter_t cnt, const size_t value)
+{
+	if (is_started && cnt < COUNTER_COUNT)
+	{
+		counters[cnt] += value;
+	}
+}
+
+void prof_set(const counter_t cnt, const size_t value)
+{
+	if (is_started && cnt < COUNTER_COUNT)
+	{
+		counters[cnt] = value;
+	}
+}
+
+void prof_allocation(const size_t number)
+{
+	if (is_started)
+	{
+		allocated += number;
+	}
+}
+
+int prof_finish(const char *const path)
+{
+	if (!is_started)
+	{
+		return -1;
+	}
+
+	const double now = prof_time();
+	prof_close(now);
+	is_started = 0;
+
+	FILE *const file = path != NULL ? fopen(path, "w") : stderr;
+	if (file == NULL)
+	{
+		return -1;
+	}
+
+	// Имена полей не меняются, по ним строятся графики между версиями
+	fprintf(file, "{\n\t\"total_ms\": %.3f,\n\t\"phases\": {\n", now - total_begin);
+	for (size_t i = PHASE_NONE + 1; i < PHASE_COUNT; i++)
+	{
+		fprintf(file, "\t\t\"%s\": { \"time_ms\": %.3f, \"allocations\": %zu }%s\n"
+			, PHASE_NAMES[i], times[i], allocations[i], i + 1 < PHASE_COUNT ? "," : "");
+	}
+
+	fprintf(file, "\t},\n\t\"counters\": {\n");
+	for (size_t i = 0; i < COUNTER_COUNT; i++)
+	{
+		fprintf(file, "\t\t\"%s\": %zu%s\n", COUNTER_NAMES[i], (size_t)counters[i], i + 1 < COUNTER_COUNT ? "," : "");
+	}
+	fprintf(file, "\t}\n}\n");
+
+	const int was_written = !ferror(file);
+	if (path != NULL)
+	{
+		return fclose(file) == 0 && was_written ? 0 : -1;
+	}
+
+	fflush(file);
+	return was_written ? 0 : -1;
+}
@@ -0,0 +1,124 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "dll.h"
+
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Compilation phases, time of nested phase is excluded from outer one */
+typedef enum PHASE
+{
+	PHASE_NONE,					/**< Outside of measured phases */
+	PHASE_MACRO,				/**< Preprocessing */
+	PHASE_LEXER,				/**< Lexical analysis */
+	PHASE_PARSER,				/**< Syntax analysis without lexer */
+	PHASE_CODEGEN,				/**< Code generation */
+	PHASE_EXPORT,				/**< Output of generated code */
+
+	PHASE_COUNT,
+} phase_t;
+
+/** Compilation counters */
+typedef enum COUNTER
+{
+	COUNTER_TOKENS,				/**< Number of tokens */
+	COUNTER_TREE,				/**< Number of tree cells */
+	COUNTER_IDENTIFIERS,		/**< Number of identifiers */
+	COUNTER_MODES,				/**< Number of modes table cells */
+	COUNTER_MEMORY,				/**< Number of generated memory items */
+	COUNTER_COLLISIONS,			/**< Number of extra probes in maps */
+
+	COUNTER_COUNT,
+} counter_t;
+
+
+/**
+ *	Reset measurements and start profiling
+ */
+EXPORTED void prof_start();
+
+/**
+ *	Check if profiling is started
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+EXPORTED int prof_is_started();
+
+/**
+ *	Switch to phase, time and allocations go to it until next switch
+ *
+ *	@param	ph			New phase
+ *
+ *	@return	Previous phase
+ */
+EXPORTED phase_t prof_enter(const phase_t ph);
+
+/**
+ *	Switch to phase on sampled calls only, so that short frequent phases are measured cheaply.
+ *	Time of sampled call is taken for all calls between samples.
+ *
+ *	@param	ph			Sampled phase
+ *
+ *	@return	@c 1 if call is sampled and must be finished by @c prof_sample_end(), @c 0 otherwise
+ */
+EXPORTED int prof_sample_begin(const phase_t ph);
+
+/**
+ *	Return to phase before sampled call
+ */
+EXPORTED void prof_sample_end();
+
+/**
+ *	Add value to counter
+ *
+ *	@param	cnt			Counter
+ *	@param	value		Added value
+ */
+EXPORTED void prof_count(const counter_t cnt, const size_t value);
+
+/**
+ *	Set counter value
+ *
+ *	@param	cnt			Counter
+ *	@param	value		New value
+ */
+EXPORTED void prof_set(const counter_t cnt, const size_t value);
+
+/**
+ *	Count memory allocations in current phase, vectors and maps count their own
+ *
+ *	@param	number		Number of allocations
+ */
+EXPORTED void prof_allocation(const size_t number);
+
+/**
+ *	Stop profiling and write JSON report
+ *
+ *	@param	path		Report file, @c NULL for standard error stream
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int prof_finish(const char *const path);
+
+#ifdef __cplusplus
+} /* extern "C" */
+#endif
@@ -21,18 +21,25 @@
 #include "workspace.h"
 
 #ifdef _MSC_VER
+	#include <fcntl.h>
+	#include <io.h>
 	#include <windows.h>
 
 	extern intptr_t _get_osfhandle(int fd);
-#elif __APPLE__
-	#include <fcntl.h>
 #else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
 	#include <unistd.h>
 
-	#define MAX_LINK_SIZE 20
+	#ifndef __APPLE__
+		#define MAX_LINK_SIZE 20
+	#endif
 #endif
 
 #define MAX_FORMAT_SIZE 128
+#define IN_BLOCK_SIZE	65536
+#define OUT_BLOCK_SIZE	65536
 
 
 int is_specifier(const char ch)
@@ -137,8 +144,21 @@ int in_func_position(universal_io *const io, const char *const format, va_list a
 }
 
 
+void in_drop_block(universal_io *const io)
+{
+	if (io->in_block_position < io->in_block_size)
+	{
+		fseek(io->in_file, (long)io->in_position, SEEK_SET);
+	}
+
+	io->in_block_size = 0;
+	io->in_block_position = 0;
+}
+
+
 int in_func_file(universal_io *const io, const char *const format, va_list args)
 {
+	in_drop_block(io);
 	return in_func_position(io, format, args, &scan_file_arg);
 }
 
@@ -155,6 +175,7 @@ int in_func_user(universal_io *const io, const char *const format, va_list args)
 
 int out_func_file(universal_io *const io, const char *const format, va_list args)
 {
+	out_flush(io);
 	return vfprintf(io->out_file, format, args);
 }
 
@@ -189,6 +210,69 @@ int out_func_user(universal_io *const io, const char *const format, va_list args
 	return io->out_user_func(format, args);
 }
 
+int out_func_call(universal_io *const io, const char *const format, ...)
+{
+	va_list args;
+	va_start(args, format);
+
+	int ret = io->out_func(io, format, args);
+
+	va_end(args);
+	return ret;
+}
+
+
+int out_write_file(universal_io *const io, const char *const data, const size_t size)
+{
+	if (io->out_block == NULL)
+	{
+		return fwrite(data, sizeof(char), size, io->out_file) == size ? (int)size : -1;
+	}
+
+	if (io->out_block_position + size > OUT_BLOCK_SIZE)
+	{
+		if (out_flush(io))
+		{
+			return -1;
+		}
+
+		if (size > OUT_BLOCK_SIZE)
+		{
+			return fwrite(data, sizeof(char), size, io->out_file) == size ? (int)size : -1;
+		}
+	}
+
+	memcpy(&io->out_block[io->out_block_position], data, size);
+	io->out_block_position += size;
+	return (int)size;
+}
+
+int out_write_buffer(universal_io *const io, const char *const data, const size_t size)
+{
+	if (io->out_position + size >= io->out_size)
+	{
+		size_t new_size = 2 * io->out_size;
+		while (io->out_position + size >= new_size)
+		{
+			new_size *= 2;
+		}
+
+		char *new_buffer = realloc(io->out_buffer, new_size * sizeof(char));
+		if (new_buffer == NULL)
+		{
+			return -1;
+		}
+
+		io->out_size = new_size;
+		io->out_buffer = new_buffer;
+	}
+
+	memcpy(&io->out_buffer[io->out_position], data, size);
+	io->out_position += size;
+	io->out_buffer[io->out_position] = '\0';
+	return (int)size;
+}
+
 
 size_t io_get_path(FILE *const file, char *const buffer)
 {
@@ -241,6 +325,11 @@ universal_io io_create()
 
 	io.in_size = 0;
 	io.in_position = 0;
+	io.in_map_size = 0;
+
+	io.in_block = NULL;
+	io.in_block_size = 0;
+	io.in_block_position = 0;
 
 	io.in_user_func = NULL;
 	io.in_func = NULL;
@@ -251,6 +340,9 @@ universal_io io_create()
 	io.out_size = 0;
 	io.out_position = 0;
 
+	io.out_block = NULL;
+	io.out_block_position = 0;
+
 	io.out_user_func = NULL;
 	io.out_func = NULL;
 
@@ -271,6 +363,10 @@ int in_set_file(universal_io *const io, const char *const path)
 		return -1;
 	}
 
+	io->in_block = malloc(IN_BLOCK_SIZE * sizeof(char));
+	io->in_block_size = 0;
+	io->in_block_position = 0;
+
 	io->in_position = 0;
 
 	io->in_func = &in_func_file;
@@ -295,6 +391,52 @@ int in_set_buffer(universal_io *const io, const char *const buffer)
 	return 0;
 }
 
+int in_set_mmap(universal_io *const io, const char *const path)
+{
+	if (path == NULL || in_clear(io))
+	{
+		return -1;
+	}
+
+#ifndef _MSC_VER
+	const int fd = open(path, O_RDONLY);
+	if (fd == -1)
+	{
+		return -1;
+	}
+
+	// Mapped buffer must be null-terminated, so zero tail of the last page is needed
+	struct stat stat_buf;
+	const size_t page = (size_t)sysconf(_SC_PAGESIZE);
+	if (fstat(fd, &stat_buf) || !S_ISREG(stat_buf.st_mode) || (size_t)stat_buf.st_size % page == 0)
+	{
+		close(fd);
+		return in_set_file(io, path);
+	}
+
+	const size_t size = (size_t)stat_buf.st_size;
+	void *map = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		return in_set_file(io, path);
+	}
+
+	io->in_buffer = map;
+
+	io->in_size = size;
+	io->in_position = 0;
+	io->in_map_size = size;
+
+	io->in_func = &in_func_buffer;
+
+	return 0;
+#else
+	return in_set_file(io, path);
+#endif
+}
+
 int in_set_func(universal_io *const io, const io_user_func func)
 {
 	if (in_clear(io))
@@ -323,6 +465,7 @@ int in_set_position(universal_io *const io, const size_t position)
 
 	if (in_is_file(io))
 	{
+		in_drop_block(io);
 		if ((position == 0 && fseek(io->in_file, 0, SEEK_SET) == 0)
 			|| (fseek(io->in_file, (long)(position - 1), SEEK_SET) == 0 && fgetc(io->in_file) != EOF))
 		{
@@ -338,6 +481,20 @@ int in_set_position(universal_io *const io, const size_t position)
 }
 
 
+size_t in_read_block(universal_io *const io)
+{
+	if (!in_is_file(io) || io->in_block == NULL)
+	{
+		return 0;
+	}
+
+	io->in_block_size = fread(io->in_block, sizeof(char), IN_BLOCK_SIZE, io->in_file);
+	io->in_block_position = 0;
+
+	return io->in_block_size;
+}
+
+
 int in_is_correct(const universal_io *const io)
 {
 	return io != NULL && (in_is_file(io) || in_is_buffer(io) || in_is_func(io));
@@ -390,6 +547,12 @@ int in_close_file(universal_io *const io)
 	int ret = fclose(io->in_file);
 	io->in_file = NULL;
 
+	free(io->in_block);
+	io->in_block = NULL;
+
+	io->in_block_size = 0;
+	io->in_block_position = 0;
+
 	io->in_position = 0;
 
 	return ret;
@@ -408,6 +571,14 @@ int in_clear(universal_io *const io)
 	}
 	else if (in_is_buffer(io))
 	{
+#ifndef _MSC_VER
+		if (io->in_map_size != 0)
+		{
+			munmap((void *)io->in_buffer, io->in_map_size);
+			io->in_map_size = 0;
+		}
+#endif
+
 		io->in_buffer = NULL;
 
 		io->in_size = 0;
@@ -436,6 +607,9 @@ int out_set_file(universal_io *const io, const char *const path)
 		return -1;
 	}
 
+	io->out_block = malloc(OUT_BLOCK_SIZE * sizeof(char));
+	io->out_block_position = 0;
+
 	io->out_func = &out_func_file;
 
 	return 0;
@@ -479,6 +653,60 @@ int out_set_func(universal_io *const io, const io_user_func func)
 }
 
 
+int out_write(universal_io *const io, const char *const data, const size_t size)
+{
+	if (data == NULL)
+	{
+		return -1;
+	}
+
+	if (out_is_file(io))
+	{
+		return out_write_file(io, data, size);
+	}
+
+	if (out_is_buffer(io))
+	{
+		return out_write_buffer(io, data, size);
+	}
+
+	if (out_is_func(io))
+	{
+		return out_func_call(io, "%.*s", (int)size, data);
+	}
+
+	return -1;
+}
+
+int out_flush(universal_io *const io)
+{
+	if (!out_is_file(io))
+	{
+		return -1;
+	}
+
+	const size_t size = io->out_block_position;
+	io->out_block_position = 0;
+
+	return size == 0 || fwrite(io->out_block, sizeof(char), size, io->out_file) == size ? 0 : -1;
+}
+
+
+int out_set_binary(universal_io *const io)
+{
+	if (!out_is_file(io) || out_flush(io))
+	{
+		return -1;
+	}
+
+#ifdef _MSC_VER
+	return _setmode(_fileno(io->out_file), _O_BINARY) == -1 ? -1 : 0;
+#else
+	return 0;
+#endif
+}
+
+
 int out_is_correct(const universal_io *const io)
 {
 	return io != NULL && (out_is_file(io) || out_is_buffer(io) || out_is_func(io));;
@@ -515,6 +743,16 @@ size_t out_get_path(const universal_io *const io, char *const buffer)
 	return io_get_path(io->out_file, buffer);
 }
 
+size_t out_get_position(const universal_io *const io)
+{
+	return out_is_buffer(io) ? io->out_position : 0;
+}
+
+const char *out_get_buffer(const universal_io *const io)
+{
+	return out_is_buffer(io) ? io->out_buffer : NULL;
+}
+
 
 char *out_extract_buffer(universal_io *const io)
 {
@@ -540,9 +778,13 @@ int out_close_file(universal_io *const io)
 		return -1;
 	}
 
-	int ret = fclose(io->out_file);
+	int ret = out_flush(io);
+	ret = fclose(io->out_file) || ret ? -1 : 0;
 	io->out_file = NULL;
 
+	free(io->out_block);
+	io->out_block = NULL;
+
 	return ret;
 }
 
@@ -553,9 +795,10 @@ int out_clear(universal_io *const io)
 		return -1;
 	}
 
+	int ret = 0;
 	if (out_is_file(io))
 	{
-		out_close_file(io);
+		ret = out_close_file(io);
 	}
 	else if (out_is_buffer(io))
 	{
@@ -567,7 +810,7 @@ int out_clear(universal_io *const io)
 	}
 
 	io->out_func = NULL;
-	return 0;
+	return ret;
 }
 
 
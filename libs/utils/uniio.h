@@ -60,6 +60,11 @@ struct universal_io
 
 	size_t in_size;				/**< Size of input buffer */
 	size_t in_position;			/**< Current position of input buffer */
+	size_t in_map_size;			/**< Size of mapped region, @c 0 if buffer isn't mapped */
+
+	char *in_block;				/**< Read-ahead block of input file */
+	size_t in_block_size;		/**< Number of bytes loaded into block */
+	size_t in_block_position;	/**< Current position of input block */
 
 	io_user_func in_user_func;	/**< Input user function */
 	io_func in_func;			/**< Current input function */
@@ -70,6 +75,9 @@ struct universal_io
 	size_t out_size;			/**< Size of output buffer */
 	size_t out_position;		/**< Current position of output buffer */
 
+	char *out_block;			/**< Write-behind block of output file */
+	size_t out_block_position;	/**< Current position of output block */
+
 	io_user_func out_user_func;	/**< Output user function */
 	io_func out_func;			/**< Current output function */
 };
@@ -103,6 +111,17 @@ EXPORTED int in_set_file(universal_io *const io, const char *const path);
  */
 EXPORTED int in_set_buffer(universal_io *const io, const char *const buffer);
 
+/**
+ *	Set input file mapped to memory as read-only buffer,
+ *	falls back to @c in_set_file() if file couldn't be mapped
+ *
+ *	@param	io			Universal io structure
+ *	@param	path		Input file path
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int in_set_mmap(universal_io *const io, const char *const path);
+
 /**
  *	Set input function
  *
@@ -124,6 +143,16 @@ EXPORTED int in_set_func(universal_io *const io, const io_user_func func);
 EXPORTED int in_set_position(universal_io *const io, const size_t position);
 
 
+/**
+ *	Load next block of input file to read-ahead buffer
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	Number of loaded bytes, @c 0 on end of file or failure
+ */
+EXPORTED size_t in_read_block(universal_io *const io);
+
+
 /**
  *	Check that current input option is correct
  *
@@ -249,6 +278,37 @@ EXPORTED int out_set_buffer(universal_io *const io, const size_t size);
 EXPORTED int out_set_func(universal_io *const io, const io_user_func func);
 
 
+/**
+ *	Write raw bytes to output without formatting
+ *
+ *	@param	io			Universal io structure
+ *	@param	data		Bytes to write
+ *	@param	size		Number of bytes
+ *
+ *	@return	Number of written bytes, @c -1 on failure
+ */
+EXPORTED int out_write(universal_io *const io, const char *const data, const size_t size);
+
+/**
+ *	Flush write-behind block of output file
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int out_flush(universal_io *const io);
+
+
+/**
+ *	Switch output file to binary mode
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int out_set_binary(universal_io *const io);
+
+
 /**
  *	Check that current output option is correct
  *
@@ -305,6 +365,24 @@ EXPORTED io_func out_get_func(const universal_io *const io);
  */
 EXPORTED size_t out_get_path(const universal_io *const io, char *const buffer);
 
+/**
+ *	Get output position from universal io structure
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	Size of written data, if output is buffer
+ */
+EXPORTED size_t out_get_position(const universal_io *const io);
+
+/**
+ *	Get written data from universal io structure without extracting it
+ *
+ *	@param	io			Universal io structure
+ *
+ *	@return	Output buffer, @c NULL if output is not buffer
+ */
+EXPORTED const char *out_get_buffer(const universal_io *const io);
+
 
 /**
  *	Extract output buffer from universal io structure
@@ -16,9 +16,36 @@
 
 #include "uniprinter.h"
 #include <stdarg.h>
+#include <string.h>
 #include "utf8.h"
 
 
+#define MAX_NUMBER_SIZE 24
+
+
+size_t uint_to_string(char *const end, uint64_t value)
+{
+	size_t size = 0;
+	do
+	{
+		*(end - ++size) = (char)('0' + value % 10);
+		value /= 10;
+	} while (value != 0);
+
+	return size;
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
+
 int uni_printf(universal_io *const io, const char *const format, ...)
 {
 	if (!out_is_correct(io))
@@ -40,10 +67,38 @@ int uni_print_char(universal_io *const io, const char32_t wchar)
 {
 	char buffer[8];
 
-	if (!utf8_to_string(buffer, wchar))
+	const size_t size = utf8_to_string(buffer, wchar);
+	if (size == 0 || wchar == 0)
 	{
 		return 0;
 	}
 
-	return uni_printf(io, "%s", buffer);
+	return out_write(io, buffer, size);
+}
+
+int uni_print_string(universal_io *const io, const char *const str)
+{
+	return str != NULL ? out_write(io, str, strlen(str)) : -1;
+}
+
+int uni_print_int(universal_io *const io, const int64_t value)
+{
+	if (value >= 0)
+	{
+		return uni_print_uint(io, (uint64_t)value);
+	}
+
+	char buffer[MAX_NUMBER_SIZE];
+	size_t size = uint_to_string(&buffer[MAX_NUMBER_SIZE], 0 - (uint64_t)value);
+	buffer[MAX_NUMBER_SIZE - ++size] = '-';
+
+	return out_write(io, &buffer[MAX_NUMBER_SIZE - size], size);
+}
+
+int uni_print_uint(universal_io *const io, const uint64_t value)
+{
+	char buffer[MAX_NUMBER_SIZE];
+	const size_t size = uint_to_string(&buffer[MAX_NUMBER_SIZE], value);
+
+	return out_write(io, &buffer[MAX_NUMBER_SIZE - size], size);
 }
@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include <stdint.h>
 #include <stdio.h>
 #include "uniio.h"
 #include "dll.h"
@@ -47,6 +48,36 @@ EXPORTED int uni_printf(universal_io *const io, const char *const format, ...)
  */
 EXPORTED int uni_print_char(universal_io *const io, const char32_t wchar);
 
+/**
+ *	Universal function for printing strings without formatting
+ *
+ *	@param	io			Universal io structure
+ *	@param	str			String
+ *
+ *	@return	Number of printed bytes, @c -1 on failure
+ */
+EXPORTED int uni_print_string(universal_io *const io, const char *const str);
+
+/**
+ *	Universal function for printing signed integers without formatting
+ *
+ *	@param	io			Universal io structure
+ *	@param	value		Integer
+ *
+ *	@return	Number of printed bytes, @c -1 on failure
+ */
+EXPORTED int uni_print_int(universal_io *const io, const int64_t value);
+
+/**
+ *	Universal function for printing unsigned integers without formatting
+ *
+ *	@param	io			Universal io structure
+ *	@param	value		Integer
+ *
+ *	@return	Number of printed bytes, @c -1 on failure
+ */
+EXPORTED int uni_print_uint(universal_io *const io, const uint64_t value);
+
 #ifdef __cplusplus
 } /* extern "C" */
 #endif
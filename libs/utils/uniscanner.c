@@ -19,6 +19,52 @@
 #include "utf8.h"
 
 
+static inline int scan_byte(universal_io *const io)
+{
+	if (io->in_buffer != NULL)
+	{
+		return io->in_position < io->in_size ? (unsigned char)io->in_buffer[io->in_position++] : EOF;
+	}
+
+	if (io->in_block_position == io->in_block_size && in_read_block(io) == 0)
+	{
+		return EOF;
+	}
+
+	io->in_position++;
+	return (unsigned char)io->in_block[io->in_block_position++];
+}
+
+static char32_t scan_char_formatted(universal_io *const io)
+{
+	char buffer[MAX_SYMBOL_SIZE];
+	if (!uni_scanf(io, "%c", &buffer[0]))
+	{
+		return (char32_t)EOF;
+	}
+
+	const size_t size = utf8_symbol_size(buffer[0]);
+	for (size_t i = 1; i < size; i++)
+	{
+		if (!uni_scanf(io, "%c", &buffer[i]))
+		{
+			return (char32_t)EOF;
+		}
+	}
+
+	return utf8_convert(buffer);
+}
+
+
+/*
+ *	 __     __   __     ______   ______     ______     ______   ______     ______     ______
+ *	/\ \   /\ "-.\ \   /\__  _\ /\  ___\   /\  == \   /\  ___\ /\  __ \   /\  ___\   /\  ___\
+ *	\ \ \  \ \ \-.  \  \/_/\ \/ \ \  __\   \ \  __<   \ \  __\ \ \  __ \  \ \ \____  \ \  __\
+ *	 \ \_\  \ \_\\"\_\    \ \_\  \ \_____\  \ \_\ \_\  \ \_\    \ \_\ \_\  \ \_____\  \ \_____\
+ *	  \/_/   \/_/ \/_/     \/_/   \/_____/   \/_/ /_/   \/_/     \/_/\/_/   \/_____/   \/_____/
+ */
+
+
 int uni_scanf(universal_io *const io, const char *const format, ...)
 {
 	if (!in_is_correct(io))
@@ -38,19 +84,29 @@ int uni_scanf(universal_io *const io, const char *const format, ...)
 
 char32_t uni_scan_char(universal_io *const io)
 {
+	if (!in_is_buffer(io) && (!in_is_file(io) || io->in_block == NULL))
+	{
+		return scan_char_formatted(io);
+	}
+
 	char buffer[MAX_SYMBOL_SIZE];
-	if (!uni_scanf(io, "%c", &buffer[0]))
+	int ch = scan_byte(io);
+	if (ch == EOF)
 	{
 		return (char32_t)EOF;
 	}
 
+	buffer[0] = (char)ch;
 	const size_t size = utf8_symbol_size(buffer[0]);
 	for (size_t i = 1; i < size; i++)
 	{
-		if (!uni_scanf(io, "%c", &buffer[i]))
+		ch = scan_byte(io);
+		if (ch == EOF)
 		{
 			return (char32_t)EOF;
 		}
+
+		buffer[i] = (char)ch;
 	}
 
 	return utf8_convert(buffer);
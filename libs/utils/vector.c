@@ -17,6 +17,7 @@
 #include "vector.h"
 #include <stdlib.h>
 #include <string.h>
+#include "profiler.h"
 
 
 int change_size(vector *const vec, const size_t size)
@@ -30,6 +31,8 @@ int change_size(vector *const vec, const size_t size)
 			return -1;
 		}
 
+		prof_allocation(1);
+
 		vec->size_alloc = alloc_new;
 		vec->array = array_new;
 	}
@@ -60,10 +63,26 @@ vector vector_create(const size_t alloc)
 	vec.size = 0;
 	vec.size_alloc = alloc != 0 ? alloc : 1;
 	vec.array = malloc(vec.size_alloc * sizeof(item_t));
+	if (vec.array != NULL)
+	{
+		prof_allocation(1);
+	}
 
 	return vec;
 }
 
+vector vector_copy(const vector *const vec)
+{
+	vector copy = vector_create(vector_is_correct(vec) ? vec->size_alloc : 0);
+	if (vector_is_correct(vec) && copy.array != NULL)
+	{
+		memcpy(copy.array, vec->array, vec->size * sizeof(item_t));
+		copy.size = vec->size;
+	}
+
+	return copy;
+}
+
 
 int vector_increase(vector *const vec, const size_t size)
 {
@@ -118,6 +137,30 @@ int vector_resize(vector *const vec, const size_t size)
 	return vector_is_correct(vec) ? change_size(vec, size) : -1;
 }
 
+int vector_reserve(vector *const vec, const size_t size)
+{
+	if (!vector_is_correct(vec))
+	{
+		return -1;
+	}
+
+	if (size <= vec->size_alloc)
+	{
+		return 0;
+	}
+
+	item_t *array_new = realloc(vec->array, size * sizeof(item_t));
+	if (array_new == NULL)
+	{
+		return -1;
+	}
+
+	prof_allocation(1);
+	vec->size_alloc = size;
+	vec->array = array_new;
+	return 0;
+}
+
 size_t vector_size(const vector *const vec)
 {
 	return vector_is_correct(vec) ? vec->size : SIZE_MAX;
@@ -43,6 +43,15 @@ typedef struct vector
  */
 EXPORTED vector vector_create(const size_t alloc);
 
+/**
+ *	Create a deep copy of vector structure
+ *
+ *	@param	vec				Vector structure
+ *
+ *	@return	Vector structure
+ */
+EXPORTED vector vector_copy(const vector *const vec);
+
 
 /**
  *	Increase vector size
@@ -105,6 +114,16 @@ EXPORTED item_t vector_remove(vector *const vec);
  */
 EXPORTED int vector_resize(vector *const vec, const size_t size);
 
+/**
+ *	Reserve allocated size, vector size is not changed
+ *
+ *	@param	vec				Vector structure
+ *	@param	size			Minimum allocated size
+ *
+ *	@return	@c 0 on success, @c -1 on failure
+ */
+EXPORTED int vector_reserve(vector *const vec, const size_t size);
+
 /**
  *	Get vector size
  *
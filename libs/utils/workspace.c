@@ -345,6 +345,33 @@ size_t ws_get_flags_num(const workspace *const ws)
 	return ws_is_correct(ws) ? ws->flags_num : 0;
 }
 
+int ws_has_flag(const workspace *const ws, const char *const flag)
+{
+	for (size_t i = 0; i < ws_get_flags_num(ws); i++)
+	{
+		if (strcmp(ws->flags[i], flag) == 0)
+		{
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+const char *ws_get_flag_value(const workspace *const ws, const char *const name)
+{
+	const size_t length = strlen(name);
+	for (size_t i = 0; i < ws_get_flags_num(ws); i++)
+	{
+		if (strncmp(ws->flags[i], name, length) == 0 && ws->flags[i][length] == '=')
+		{
+			return &ws->flags[i][length + 1];
+		}
+	}
+
+	return NULL;
+}
+
 
 const char *ws_get_output(const workspace *const ws)
 {
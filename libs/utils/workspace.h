@@ -211,6 +211,26 @@ EXPORTED const char *ws_get_flag(const workspace *const ws, const size_t index);
  */
 EXPORTED size_t ws_get_flags_num(const workspace *const ws);
 
+/**
+ *	Check if flag is set in workspace
+ *
+ *	@param	ws			Workspace structure
+ *	@param	flag		Flag
+ *
+ *	@return	@c 1 on true, @c 0 on false
+ */
+EXPORTED int ws_has_flag(const workspace *const ws, const char *const flag);
+
+/**
+ *	Get value of flag in form <name>=<value>
+ *
+ *	@param	ws			Workspace structure
+ *	@param	name		Flag name with leading dash
+ *
+ *	@return	Flag value, @c NULL if flag is absent
+ */
+EXPORTED const char *ws_get_flag_value(const workspace *const ws, const char *const name);
+
 
 /**
  *	Get output file name
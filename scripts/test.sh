@@ -5,7 +5,6 @@ init()
 	exit_code=1
 	vm_exec=export.txt
 
-	vm_release=master
 	output_time=0.0
 	wait_for=2
 
@@ -18,6 +17,13 @@ init()
 	subdir_warning=warnings
 	subdir_include=include
 
+	dir_cache=cache
+	modes=("-bin" "-O" "-super" "-O -super" "-j" "-cache=$dir_cache -fcache=$dir_cache")
+	# Вывод этих тестов зависит от адресов и порядка выполнения нитей
+	unstable="LAT_9457.c LA_9461.c sveta.c dynamic.c semaphore.c"
+	# Эти тесты читают память, содержимое которой задаёт раскладка виртуальной машины
+	unstable_llvm="easywiden.c LOAD_9456.c"
+
 	while ! [[ -z $1 ]]
 	do
 		case $1 in
@@ -31,14 +37,16 @@ init()
 				echo -e "\tFor tests with expected runtime error, use \"*/$subdir_error/*\" subdirectory."
 				echo -e "\tFor multi-file tests, use \"*/$subdir_include/*\" subdirectory."
 				echo -e "\tFailed tests for debug build only will be marked with \"(Debug)\"."
+				echo -e "\tExecutable tests are also compiled with other keys,"
+				echo -e "\ttheir output should be the same as without keys."
 				echo -e "Keys:"
 				echo -e "\t-h, --help\tTo output help info."
 				echo -e "\t-s, --silence\tFor silence testing."
 				echo -e "\t-f, --fast\tFast testing, Release builds only."
 				echo -e "\t-i, --ignore\tIgnore errors & executing stages."
+				echo -e "\t-m, --modes\tSkip comparing of executable tests in other modes."
 				echo -e "\t-r, --remove\tRemove build folder before testing."
 				echo -e "\t-d, --debug\tSwitch on debug tracing."
-				echo -e "\t-v, --virtual\tSet RuC virtual machine release."
 				echo -e "\t-o, --output\tSet output printing time (default = 0.0)."
 				echo -e "\t-w, --wait\tSet waiting time for timeout result (default = 2)."
 				exit 0
@@ -52,16 +60,15 @@ init()
 			-i|--ignore)
 				ignore=$1
 				;;
+			-m|--modes)
+				no_modes=$1
+				;;
 			-r|--remove)
 				remove=$1
 				;;
 			-d|--debug)
 				debug=$1
 				;;
-			-v|--virtual)
-				vm_release=$2
-				shift
-				;;
 			-o|--output)
 				output_time=$2
 				shift
@@ -87,6 +94,18 @@ init()
 
 	log=tmp
 	buf=buf
+	expected=expected
+	expected_output=expected_output
+	llvm_exec=export.ll
+
+	# Указатели в LLVM IR непрозрачные, LLVM 14 принимает их только с ключом
+	if command -v lli &>/dev/null ; then
+		modes+=("-LLVM")
+		llvm=lli
+		if [[ `lli --version` == *"LLVM version 14."* ]] ; then
+			llvm="lli -opaque-pointers"
+		fi
+	fi
 }
 
 build_folder()
@@ -131,53 +150,19 @@ build_folder()
 	fi
 }
 
-build_vm()
-{
-	if ! [[ -z $remove ]] ; then
-		rm -rf ruc-vm
-	fi
-
-	if ! [[ -d ruc-vm ]] ; then
-		git clone -b $vm_release --recursive https://github.com/andrey-terekhov/RuC-VM ruc-vm
-		cd ruc-vm
-	else
-		cd ruc-vm
-		git checkout $vm_release
-	fi
-
-	if [[ $OSTYPE != "msys" ]] ; then
-		CMAKE_BUILD_TYPE=-DCMAKE_BUILD_TYPE=Release
-	fi
-
-	mkdir -p build && cd build && cmake .. $CMAKE_BUILD_TYPE -DTESTING_EXIT_CODE=$exit_code
-	if ! cmake --build . --config Release ; then
-		exit 1
-	fi
-
-	cd ../..
-	if [[ $OSTYPE == "msys" ]] ; then
-		interpreter=./ruc-vm/build/Release/ruc-vm
-	else
-		interpreter=./ruc-vm/build/ruc-vm
-	fi
-
-	interpreter_debug=$interpreter
-}
-
 build()
 {
 	cd `dirname $0`/..
 	build_folder ruc
 
 	compiler=./Release/ruc
+	interpreter=./Release/ruc-vm
 	if [[ -z $fast ]] ; then
 		compiler_debug=./Debug/ruc
+		interpreter_debug=./Debug/ruc-vm
 	else
 		compiler_debug=$compiler
-	fi
-
-	if [[ -z $ignore ]] ; then
-		build_vm
+		interpreter_debug=$interpreter
 	fi
 }
 
@@ -194,7 +179,7 @@ run()
 	build_type=""
 	if [[ $exec != $exec_debug ]] ; then
 		if [[ $ret == 0 ]] ; then
-			mv $vm_exec $buf
+			cp $vm_exec $buf
 
 			$runner $exec_debug $@ &>$log
 			ret=$?
@@ -450,6 +435,117 @@ test()
 	rm -f $buf
 }
 
+execute_mode()
+{
+	if ! $runner $compiler $sources $mode -o $vm_exec &>$log ; then
+		return 1
+	fi
+
+	$runner $interpreter $vm_exec &>$log
+	echo "exit code $?" >>$log
+}
+
+execute_llvm()
+{
+	if ! $runner $compiler $sources -o $vm_exec &>$log || ! $runner $compiler $sources -LLVM -o $llvm_exec &>$log ; then
+		return 1
+	fi
+
+	# Префиксы сообщений об ошибках различаются, сравниваются только вывод и код возврата
+	$runner $interpreter $vm_exec 2>/dev/null >$expected_output
+	echo "exit code $?" >>$expected_output
+
+	$runner $llvm $llvm_exec 2>/dev/null >$log
+	echo "exit code $?" >>$log
+}
+
+compare_mode()
+{
+	action="mode $mode"
+	if [[ $mode == -cache=* ]] ; then
+		# Первый запуск заполняет кеши, второй проверяет попадание в них
+		rm -rf $dir_cache && mkdir $dir_cache
+		execute_mode && execute_mode && cmp -s $log $expected
+	elif [[ $mode == -LLVM ]] ; then
+		execute_llvm && cmp -s $log $expected_output
+	else
+		execute_mode && cmp -s $log $expected
+	fi
+
+	if [[ $? == 0 ]] ; then
+		message_success
+		let success++
+	else
+		message_failure
+		let failure++
+
+		if ! [[ -z $debug ]] ; then
+			if [[ $mode == -LLVM ]] ; then
+				diff $expected_output $log
+			else
+				diff $expected $log
+			fi
+		fi
+	fi
+}
+
+compare_sources()
+{
+	mode=""
+	if execute_mode ; then
+		mv $log $expected
+		for mode in "${modes[@]}"
+		do
+			if [[ $mode != -LLVM || " $unstable_llvm " != *" ${path##*/} "* ]] ; then
+				compare_mode
+			fi
+		done
+	fi
+}
+
+compare_modes()
+{
+	success=0
+	failure=0
+
+	# Do not use names with spaces!
+	for path in `find $dir_exec -name *.c`
+	do
+		sources=$path
+
+		if [[ $path != */$subdir_include/* && " $unstable " != *" ${path##*/} "* ]] ; then
+			compare_sources
+		fi
+	done
+
+	for include in `find $dir_exec -name $subdir_include -type d`
+	do
+		for path in `ls -d $include/*`
+		do
+			sources=`find $path -name *.c`
+
+			for subdir in `find $path -name *.h`
+			do
+				temp=`dirname $subdir`
+				sources="$sources -I$temp"
+			done
+
+			compare_sources
+		done
+	done
+
+	if [[ -z $silence ]] ; then
+		echo
+	fi
+
+	echo -e "\x1B[1;39m modes: success = $success, failure = $failure"
+	rm -f $log
+	rm -f $expected
+	rm -f $expected_output
+	rm -f $llvm_exec
+	rm -rf $dir_cache
+}
+
 main()
 {
 	init $@
@@ -465,6 +561,18 @@ main()
 		exit 1
 	fi
 
+	if [[ -z $ignore && -z $no_modes ]] ; then
+		if [[ -z $debug ]] ; then
+			compare_modes 2>/dev/null
+		else
+			compare_modes
+		fi
+
+		if [[ $failure != 0 ]] ; then
+			exit 1
+		fi
+	fi
+
 	exit 0
 }
 
@@ -0,0 +1,22 @@
+int sum(int a, int b)
+{
+	return a + b;
+}
+
+void main()
+{
+	int i;
+	int s = 0;
+	for (i = 0; i < sum(1, 2); i++)
+	{
+		s += 10;
+	}
+	assert(s == 30, "s != 30");
+
+	s = 0;
+	for (i = sum(0, 1); i < 5; i += sum(1, 1))
+	{
+		s += i;
+	}
+	assert(s == 4, "s != 4");
+}
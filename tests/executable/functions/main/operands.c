@@ -0,0 +1,11 @@
+void main()
+{
+	int a, b, i;
+
+	a = (b = 1, b + 1), assert(a == 2, "a != 2");
+	for (i = 0, assert(b == 1, "b != 1"); i < 3; i++, b++)
+	{
+		assert(i < 3, "i >= 3"), a += i;
+	}
+	assert(a == 5 && b == 4, "a != 5 or b != 4");
+}
@@ -0,0 +1,38 @@
+int calls = 0;
+
+int touch(int value)
+{
+	calls++;
+	return value;
+}
+
+void main()
+{
+	int a = 7;
+	float f = 1.5 * 4 - 0.5;
+
+	assert(2 + 3 * 4 - 6 / 2 == 11, "2 + 3 * 4 - 6 / 2 != 11");
+	assert(-7 / 2 == -3, "-7 / 2 != -3");
+	assert(-7 % 3 == -1, "-7 % 3 != -1");
+	assert((1 << 10) + (1024 >> 3) == 1152, "(1 << 10) + (1024 >> 3) != 1152");
+	assert(((12 & 10 | 1) ^ 3) == 10, "(12 & 10 | 1) ^ 3 != 10");
+	assert(~0 == -1 && !0 == 1 && !5 == 0, "~0, !0 or !5 are wrong");
+	assert((3 < 4) + (4 <= 4) + (5 > 6) + (7 != 7) == 2, "comparisons are wrong");
+	assert((1 ? 10 : 20) + (0 ? 10 : 20) == 30, "ternary operator is wrong");
+
+	assert(a * 1 + 0 == 7 && (a - 0) / 1 == 7, "identities are wrong");
+	assert(a * (2 + 3) == 35, "a * (2 + 3) != 35");
+
+	assert(f == 5.5, "1.5 * 4 - 0.5 != 5.5");
+	assert(1 / 2 * 2.0 == 0, "1 / 2 * 2.0 != 0");
+
+	if (0 && touch(1))
+	{
+		assert(0, "0 && x is true");
+	}
+	if (1 || touch(1))
+	{
+		a = touch(2) && 1;
+	}
+	assert(calls == 1 && a == 1, "logical operators have wrong side effects");
+}
@@ -0,0 +1,27 @@
+/*
+ *	Copyright 2021 Andrey Terekhov, Victor Y. Fadeev
+ *
+ *	Licensed under the Apache License, Version 2.0 (the "License");
+ *	you may not use this file except in compliance with the License.
+ *	You may obtain a copy of the License at
+ *
+ *		http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *	Unless required by applicable law or agreed to in writing, software
+ *	distributed under the License is distributed on an "AS IS" BASIS,
+ *	WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *	See the License for the specific language governing permissions and
+ *	limitations under the License.
+ */
+
+#include "interpreter.h"
+
+
+int main(int argc, const char *argv[])
+{
+#ifdef TESTING_EXIT_CODE
+	return auto_interpret(argc, argv) ? TESTING_EXIT_CODE : 0;
+#else
+	return auto_interpret(argc, argv) ? 1 : 0;
+#endif
+}